@@ -0,0 +1,289 @@
+/**
+ * @file ctrl_client.cpp
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the host client of the binary control channel for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the POSIX serial port and the request, response and event handling of the
+ * client. The packets are built and parsed by the same ctrl_proto.c as on the board.
+ */
+
+#include "ctrl_client.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace vlc {
+
+namespace {
+
+/**
+ * @brief Gets the termios speed of a baud rate.
+ *
+ * @param baud Baud rate.
+ * @return The speed, B0 if the rate is not a standard one.
+ */
+speed_t baud_to_speed(int baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+#ifdef B460800
+        case 460800: return B460800;
+#endif
+#ifdef B921600
+        case 921600: return B921600;
+#endif
+        default: return B0;
+    }
+}
+
+/**
+ * @brief Gets the milliseconds left before a deadline.
+ *
+ * @param deadline The deadline.
+ * @return Milliseconds left, 0 once it passed.
+ */
+int remaining_ms(std::chrono::steady_clock::time_point deadline) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return left.count() > 0 ? static_cast<int>(left.count()) : 0;
+}
+
+} // namespace
+
+SerialPort::SerialPort(const std::string& device, int baud) {
+    speed_t speed = baud_to_speed(baud);
+    if (speed == B0) {
+        throw std::runtime_error("unsupported baud rate " + std::to_string(baud));
+    }
+    fd_ = ::open(device.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd_ < 0) {
+        throw std::runtime_error("cannot open " + device + ": " + std::strerror(errno));
+    }
+    struct termios tty;
+    if (tcgetattr(fd_, &tty) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("cannot read the settings of " + device + ": " + std::strerror(errno));
+    }
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    if (tcsetattr(fd_, TCSANOW, &tty) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("cannot configure " + device + ": " + std::strerror(errno));
+    }
+    flush_input();
+}
+
+SerialPort::~SerialPort() {
+    ::close(fd_);
+}
+
+bool SerialPort::write(const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = ::write(fd_, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return tcdrain(fd_) == 0;
+}
+
+int SerialPort::read(uint8_t* data, size_t max, int timeout_ms) {
+    struct pollfd descriptor = { fd_, POLLIN, 0 };
+    int ready = ::poll(&descriptor, 1, timeout_ms);
+    if (ready <= 0) {
+        return (ready == 0 || errno == EINTR) ? 0 : -1;
+    }
+    ssize_t count = ::read(fd_, data, max);
+    return count < 0 ? (errno == EAGAIN || errno == EINTR ? 0 : -1) : static_cast<int>(count);
+}
+
+void SerialPort::flush_input() {
+    tcflush(fd_, TCIFLUSH);
+}
+
+CtrlClient::CtrlClient(const std::string& device, int baud) : port_(device, baud) {
+    frame_.reserve(CTRL_FRAME_MAX);
+}
+
+esp_err_t CtrlClient::ping(const std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> echo;
+    esp_err_t err = request(CTRL_MSG_PING, payload.data(), payload.size(), &echo);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return echo == payload ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t CtrlClient::configure(const ctrl_configure_t& configure, uint32_t* job_id) {
+    uint8_t payload[CTRL_CONFIGURE_BYTES];
+    std::vector<uint8_t> response;
+    esp_err_t err = request(CTRL_MSG_CONFIGURE, payload, ctrl_configure_write(&configure, payload), &response);
+    if (response.size() >= 4) {
+        *job_id = ctrl_get_u32(response.data());
+    }
+    return err;
+}
+
+esp_err_t CtrlClient::transmit(const std::string& data, uint32_t* job_id) {
+    std::vector<uint8_t> response;
+    esp_err_t err = request(CTRL_MSG_TRANSMIT, reinterpret_cast<const uint8_t*>(data.data()), data.size(), &response);
+    if (response.size() >= 4) {
+        *job_id = ctrl_get_u32(response.data());
+    }
+    return err;
+}
+
+esp_err_t CtrlClient::stats(std::vector<uint32_t>* values) {
+    std::vector<uint8_t> response;
+    esp_err_t err = request(CTRL_MSG_STATS, nullptr, 0, &response);
+    values->clear();
+    for (size_t i = 0; i + 4 <= response.size(); i += 4) {
+        values->push_back(ctrl_get_u32(&response[i]));
+    }
+    return err;
+}
+
+esp_err_t CtrlClient::subscribe(bool on) {
+    const uint8_t payload = on ? 1 : 0;
+    std::vector<uint8_t> response;
+    return request(CTRL_MSG_SUBSCRIBE, &payload, 1, &response);
+}
+
+esp_err_t CtrlClient::wait_job(uint32_t id, int timeout_ms, esp_err_t* result) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        auto done = jobs_done_.find(id);
+        if (done != jobs_done_.end()) {
+            *result = done->second;
+            jobs_done_.erase(done);
+            return ESP_OK;
+        }
+        ctrl_packet_t packet;
+        if (!read_packet(&packet, remaining_ms(deadline))) {
+            return ESP_ERR_TIMEOUT;
+        }
+        keep_event(packet);
+    }
+}
+
+esp_err_t CtrlClient::wait_received(std::string* data, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (received_.empty()) {
+        ctrl_packet_t packet;
+        if (!read_packet(&packet, remaining_ms(deadline))) {
+            return ESP_ERR_TIMEOUT;
+        }
+        keep_event(packet);
+    }
+    *data = std::move(received_.front());
+    received_.pop_front();
+    return ESP_OK;
+}
+
+esp_err_t CtrlClient::request(uint8_t type, const uint8_t* payload, size_t length, std::vector<uint8_t>* response) {
+    uint8_t frame[CTRL_FRAME_MAX];
+    const uint8_t seq = seq_++;
+    ctrl_packet_t packet = { type, seq, static_cast<uint16_t>(length), payload };
+    size_t bytes = (length <= CTRL_MAX_PAYLOAD) ? ctrl_frame_build(&packet, frame) : 0;
+    response->clear();
+    if (bytes == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (!port_.write(frame, bytes)) {
+        return ESP_FAIL;
+    }
+
+    // Events may come first; responses to an earlier, timed-out request are skipped
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kResponseTimeoutMs);
+    while (read_packet(&packet, remaining_ms(deadline))) {
+        if (keep_event(packet) || packet.type != (type | CTRL_RESPONSE) || packet.seq != seq || packet.length < 4) {
+            continue;
+        }
+        response->assign(packet.payload + 4, packet.payload + packet.length);
+        return static_cast<esp_err_t>(ctrl_get_u32(packet.payload));
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+bool CtrlClient::read_packet(ctrl_packet_t* packet, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        while (!pending_.empty()) {
+            // The frame of the last packet returned is only dropped now, as the packet pointed into it
+            if (frame_parsed_) {
+                frame_.clear();
+                frame_parsed_ = false;
+            }
+            uint8_t byte = pending_.front();
+            pending_.pop_front();
+            if (byte != 0) {
+                if (frame_.size() < CTRL_FRAME_MAX) {
+                    frame_.push_back(byte);
+                } else {
+                    overflow_ = true;
+                }
+                continue;
+            }
+            // Delimiter: as on the board, an overlong frame is dropped whole and empty frames are ignored
+            bool valid = false;
+            if (overflow_) {
+                frame_errors_++;
+            } else if (!frame_.empty()) {
+                valid = ctrl_frame_parse(frame_.data(), frame_.size(), packet) == 0;
+                frame_errors_ += valid ? 0 : 1;
+            }
+            overflow_ = false;
+            if (valid) {
+                frame_parsed_ = true;
+                return true;
+            }
+            frame_.clear();
+        }
+        uint8_t bytes[256];
+        int count = port_.read(bytes, sizeof(bytes), remaining_ms(deadline));
+        if (count <= 0) {
+            return false;
+        }
+        pending_.insert(pending_.end(), bytes, bytes + count);
+    }
+}
+
+bool CtrlClient::keep_event(const ctrl_packet_t& packet) {
+    if (packet.type == CTRL_MSG_JOB_DONE) {
+        if (packet.length == CTRL_JOB_DONE_BYTES) {
+            jobs_done_[ctrl_get_u32(packet.payload)] = static_cast<esp_err_t>(ctrl_get_u32(packet.payload + 4));
+        }
+        return true;
+    }
+    if (packet.type == CTRL_MSG_RX_NOTIFY) {
+        received_.emplace_back(reinterpret_cast<const char*>(packet.payload), packet.length);
+        return true;
+    }
+    return false;
+}
+
+} // namespace vlc
@@ -0,0 +1,206 @@
+/**
+ * @file ctrl_client.hpp
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the host client of the binary control channel for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the host side of the control channel served by ctrl_server.c: a raw serial port
+ * and a client that frames the requests with ctrl_proto.c, matches the responses by sequence number and keeps
+ * the events that arrive in between. Requests return the esp_err_t of their response, or ESP_ERR_TIMEOUT if
+ * none arrived in time; only opening the port throws.
+ */
+
+#ifndef CTRL_CLIENT_HPP
+#define CTRL_CLIENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "common_utils/host_compat.h"
+#include "control/ctrl_proto.h"
+}
+
+namespace vlc {
+
+/**
+ * @brief Serial port in raw mode, 8N1 without flow control.
+ */
+class SerialPort {
+public:
+    /**
+     * @brief Opens and configures a serial port.
+     *
+     * @param device Path of the device, e.g. /dev/ttyUSB0.
+     * @param baud Baud rate; standard rates only.
+     * @throws std::runtime_error if the port cannot be opened or configured.
+     */
+    SerialPort(const std::string& device, int baud);
+    ~SerialPort();
+
+    SerialPort(const SerialPort&) = delete;
+    SerialPort& operator=(const SerialPort&) = delete;
+
+    /**
+     * @brief Writes all the bytes and waits until they are sent.
+     *
+     * @param data Bytes to write.
+     * @param length Number of bytes.
+     * @return true on success.
+     */
+    bool write(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Reads the bytes available, waiting for the first one.
+     *
+     * @param data Buffer for the bytes.
+     * @param max Size of the buffer.
+     * @param timeout_ms Maximum time to wait for the first byte.
+     * @return Number of bytes read, 0 on timeout, -1 on error.
+     */
+    int read(uint8_t* data, size_t max, int timeout_ms);
+
+    /**
+     * @brief Discards the bytes received and not read yet.
+     */
+    void flush_input();
+
+private:
+    int fd_;    /**< File descriptor of the port */
+};
+
+/**
+ * @brief Client of the binary control channel.
+ */
+class CtrlClient {
+public:
+    /** @brief Default time in milliseconds a request waits for its response. */
+    static constexpr int kResponseTimeoutMs = 1000;
+
+    /**
+     * @brief Opens the port of the control channel.
+     *
+     * @param device Path of the device wired to CTRL_UART_NUM.
+     * @param baud Baud rate, CTRL_UART_BAUD on the board.
+     * @throws std::runtime_error if the port cannot be opened.
+     */
+    CtrlClient(const std::string& device, int baud);
+
+    /**
+     * @brief Sends CTRL_MSG_PING and checks the echo.
+     *
+     * @param payload Bytes to echo.
+     * @return ESP_OK if the echo matched, ESP_FAIL if it did not, or the status of the response.
+     */
+    esp_err_t ping(const std::vector<uint8_t>& payload);
+
+    /**
+     * @brief Sends CTRL_MSG_CONFIGURE.
+     *
+     * @param configure Keys of one side.
+     * @param job_id Pointer to store the ID of the warm-up job.
+     * @return The status of the response; the job ends with a CTRL_MSG_JOB_DONE event, see wait_job().
+     */
+    esp_err_t configure(const ctrl_configure_t& configure, uint32_t* job_id);
+
+    /**
+     * @brief Sends CTRL_MSG_TRANSMIT.
+     *
+     * @param data Text to send, without NUL and shorter than CTRL_MAX_PAYLOAD.
+     * @param job_id Pointer to store the ID of the transmit job.
+     * @return The status of the response; the job ends with a CTRL_MSG_JOB_DONE event, see wait_job().
+     */
+    esp_err_t transmit(const std::string& data, uint32_t* job_id);
+
+    /**
+     * @brief Sends CTRL_MSG_STATS.
+     *
+     * @param values Pointer to store the u32 counters, in the order of ctrl_handle_stats().
+     * @return The status of the response.
+     */
+    esp_err_t stats(std::vector<uint32_t>* values);
+
+    /**
+     * @brief Sends CTRL_MSG_SUBSCRIBE.
+     *
+     * @param on true to receive the frames as events.
+     * @return The status of the response.
+     */
+    esp_err_t subscribe(bool on);
+
+    /**
+     * @brief Waits for the CTRL_MSG_JOB_DONE event of a job, which may have arrived already.
+     *
+     * @param id ID of the job.
+     * @param timeout_ms Maximum time to wait.
+     * @param result Pointer to store the result carried by the event.
+     * @return ESP_OK once the event arrived, ESP_ERR_TIMEOUT otherwise.
+     */
+    esp_err_t wait_job(uint32_t id, int timeout_ms, esp_err_t* result);
+
+    /**
+     * @brief Waits for a CTRL_MSG_RX_NOTIFY event, which may have arrived already.
+     *
+     * @param data Pointer to store the plaintext of the frame.
+     * @param timeout_ms Maximum time to wait.
+     * @return ESP_OK once a frame arrived, ESP_ERR_TIMEOUT otherwise.
+     */
+    esp_err_t wait_received(std::string* data, int timeout_ms);
+
+    /**
+     * @brief Frames dropped by the client for a COBS, length or CRC error.
+     *
+     * @return Number of frames.
+     */
+    uint32_t frame_errors() const { return frame_errors_; }
+
+private:
+    /**
+     * @brief Sends a request and waits for its response, keeping the events that arrive in between.
+     *
+     * @param type Type of the request.
+     * @param payload Payload.
+     * @param length Payload length.
+     * @param response Pointer to store the payload of the response after its status.
+     * @return The status of the response, or ESP_ERR_TIMEOUT.
+     */
+    esp_err_t request(uint8_t type, const uint8_t* payload, size_t length, std::vector<uint8_t>* response);
+
+    /**
+     * @brief Reads frames until one packet is complete and valid.
+     *
+     * @param packet Pointer to store the packet, its payload pointing into the client.
+     * @param timeout_ms Maximum time to wait.
+     * @return true if a packet was read.
+     */
+    bool read_packet(ctrl_packet_t* packet, int timeout_ms);
+
+    /**
+     * @brief Stores an event for wait_job() or wait_received().
+     *
+     * @param packet The event.
+     * @return true if the packet was an event.
+     */
+    bool keep_event(const ctrl_packet_t& packet);
+
+    SerialPort port_;                           /**< Port of the control channel */
+    uint8_t seq_ = 0;                           /**< Sequence number of the next request */
+    std::vector<uint8_t> frame_;                /**< Frame being reassembled, without its delimiter */
+    bool overflow_ = false;                     /**< The frame being reassembled is longer than CTRL_FRAME_MAX */
+    bool frame_parsed_ = false;                 /**< frame_ holds the last packet returned by read_packet() */
+    std::deque<uint8_t> pending_;               /**< Bytes read past the last frame */
+    std::map<uint32_t, esp_err_t> jobs_done_;   /**< Results of the ended jobs not waited for yet */
+    std::deque<std::string> received_;          /**< Received frames not waited for yet */
+    uint32_t frame_errors_ = 0;                 /**< Frames dropped */
+};
+
+} // namespace vlc
+
+#endif /* CTRL_CLIENT_HPP */
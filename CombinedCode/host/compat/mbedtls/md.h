@@ -0,0 +1,72 @@
+/**
+ * @file md.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Stand-in for the HMAC-SHA256 subset of mbedtls/md.h on host builds for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details frame.c computes its tags with the message digest API of mbedtls, which ESP-IDF ships. The host build
+ * (CombinedCode/host) uses the system mbedtls when it finds one and this header otherwise, so framing and its test
+ * build everywhere. Only SHA-256 is provided, with the same names, types and return codes, by md_sha256.c.
+ */
+
+#ifndef HOST_COMPAT_MBEDTLS_MD_H
+#define HOST_COMPAT_MBEDTLS_MD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Error code of mbedtls for a bad argument. */
+#define MBEDTLS_ERR_MD_BAD_INPUT_DATA -0x5100
+
+/** @brief Size of a SHA-256 digest in bytes. */
+#define MBEDTLS_MD_MAX_SIZE 32
+
+/**
+ * @brief Digests, SHA-256 only.
+ */
+typedef enum {
+    MBEDTLS_MD_NONE = 0,
+    MBEDTLS_MD_SHA256 = 9,
+} mbedtls_md_type_t;
+
+/**
+ * @brief Description of a digest.
+ */
+typedef struct mbedtls_md_info_t {
+    mbedtls_md_type_t type;     /**< The digest */
+    uint8_t size;               /**< Size of the digest in bytes */
+    uint8_t block_size;         /**< Size of a block in bytes */
+} mbedtls_md_info_t;
+
+/**
+ * @brief State of a SHA-256 computation.
+ */
+typedef struct {
+    uint32_t state[8];      /**< Hash values */
+    uint64_t length;        /**< Bytes hashed so far */
+    uint8_t block[64];      /**< Bytes not hashed yet */
+} host_sha256_t;
+
+/**
+ * @brief State of an HMAC computation.
+ */
+typedef struct {
+    const mbedtls_md_info_t* md_info;   /**< The digest, NULL until set up */
+    host_sha256_t inner;                /**< Hash of the inner padded key and the message */
+    host_sha256_t outer;                /**< Hash of the outer padded key */
+} mbedtls_md_context_t;
+
+const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t md_type);
+void mbedtls_md_init(mbedtls_md_context_t* ctx);
+void mbedtls_md_free(mbedtls_md_context_t* ctx);
+int mbedtls_md_setup(mbedtls_md_context_t* ctx, const mbedtls_md_info_t* md_info, int hmac);
+int mbedtls_md_hmac_starts(mbedtls_md_context_t* ctx, const unsigned char* key, size_t keylen);
+int mbedtls_md_hmac_update(mbedtls_md_context_t* ctx, const unsigned char* input, size_t ilen);
+int mbedtls_md_hmac_finish(mbedtls_md_context_t* ctx, unsigned char* output);
+int mbedtls_md_hmac(const mbedtls_md_info_t* md_info, const unsigned char* key, size_t keylen,
+                    const unsigned char* input, size_t ilen, unsigned char* output);
+
+#endif /* HOST_COMPAT_MBEDTLS_MD_H */
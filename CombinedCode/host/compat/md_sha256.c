@@ -0,0 +1,213 @@
+/**
+ * @file md_sha256.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Software SHA-256 and HMAC behind the mbedtls/md.h stand-in on host builds for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details SHA-256 as specified by FIPS 180-4 and HMAC as specified by RFC 2104, written for clarity rather than
+ * speed: only the host build uses them, when no system mbedtls is found.
+ */
+
+#include <string.h>
+
+#include "mbedtls/md.h"
+
+/** @brief The only digest provided. */
+static const mbedtls_md_info_t host_sha256_info = { MBEDTLS_MD_SHA256, 32, 64 };
+
+/** @brief Round constants of SHA-256. */
+static const uint32_t host_sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/**
+ * @brief Rotates a word right.
+ *
+ * @param x The word.
+ * @param n Number of bits, 1 to 31.
+ * @return The rotated word.
+ */
+static inline uint32_t host_sha256_rotr(uint32_t x, unsigned n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+/**
+ * @brief Hashes one 64-byte block into the state.
+ *
+ * @param sha Pointer to the computation.
+ * @param block The block.
+ */
+static void host_sha256_block(host_sha256_t* sha, const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)block[4 * i] << 24) | ((uint32_t)block[4 * i + 1] << 16)
+             | ((uint32_t)block[4 * i + 2] << 8) | (uint32_t)block[4 * i + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = host_sha256_rotr(w[i - 15], 7) ^ host_sha256_rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = host_sha256_rotr(w[i - 2], 17) ^ host_sha256_rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = sha->state[0], b = sha->state[1], c = sha->state[2], d = sha->state[3];
+    uint32_t e = sha->state[4], f = sha->state[5], g = sha->state[6], h = sha->state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (host_sha256_rotr(e, 6) ^ host_sha256_rotr(e, 11) ^ host_sha256_rotr(e, 25))
+                    + ((e & f) ^ (~e & g)) + host_sha256_k[i] + w[i];
+        uint32_t t2 = (host_sha256_rotr(a, 2) ^ host_sha256_rotr(a, 13) ^ host_sha256_rotr(a, 22))
+                    + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    sha->state[0] += a; sha->state[1] += b; sha->state[2] += c; sha->state[3] += d;
+    sha->state[4] += e; sha->state[5] += f; sha->state[6] += g; sha->state[7] += h;
+}
+
+/**
+ * @brief Starts a SHA-256 computation.
+ *
+ * @param sha Pointer to the computation.
+ */
+static void host_sha256_start(host_sha256_t* sha) {
+    static const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    memcpy(sha->state, initial, sizeof(initial));
+    sha->length = 0;
+}
+
+/**
+ * @brief Adds bytes to a SHA-256 computation.
+ *
+ * @param sha Pointer to the computation.
+ * @param data The bytes.
+ * @param length Number of bytes.
+ */
+static void host_sha256_update(host_sha256_t* sha, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        size_t used = (size_t)(sha->length % 64);
+        size_t take = 64 - used < length ? 64 - used : length;
+        memcpy(&sha->block[used], data, take);
+        sha->length += take;
+        data += take;
+        length -= take;
+        if (used + take == 64) {
+            host_sha256_block(sha, sha->block);
+        }
+    }
+}
+
+/**
+ * @brief Ends a SHA-256 computation.
+ *
+ * @param sha Pointer to the computation.
+ * @param digest Array of 32 bytes to store the digest.
+ */
+static void host_sha256_finish(host_sha256_t* sha, uint8_t* digest) {
+    uint64_t bits = sha->length * 8;
+    uint8_t pad[72] = {0x80};
+    size_t used = (size_t)(sha->length % 64);
+    size_t pad_length = (used < 56 ? 56 - used : 120 - used);
+    for (int i = 0; i < 8; i++) {
+        pad[pad_length + i] = (uint8_t)(bits >> (56 - 8 * i));
+    }
+    host_sha256_update(sha, pad, pad_length + 8);
+    for (int i = 0; i < 8; i++) {
+        digest[4 * i] = (uint8_t)(sha->state[i] >> 24);
+        digest[4 * i + 1] = (uint8_t)(sha->state[i] >> 16);
+        digest[4 * i + 2] = (uint8_t)(sha->state[i] >> 8);
+        digest[4 * i + 3] = (uint8_t)sha->state[i];
+    }
+}
+
+const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t md_type) {
+    return md_type == MBEDTLS_MD_SHA256 ? &host_sha256_info : NULL;
+}
+
+void mbedtls_md_init(mbedtls_md_context_t* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_md_free(mbedtls_md_context_t* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_md_setup(mbedtls_md_context_t* ctx, const mbedtls_md_info_t* md_info, int hmac) {
+    if (md_info == NULL || !hmac) {
+        return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    }
+    ctx->md_info = md_info;
+    return 0;
+}
+
+int mbedtls_md_hmac_starts(mbedtls_md_context_t* ctx, const unsigned char* key, size_t keylen) {
+    if (ctx->md_info == NULL) {
+        return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    }
+    uint8_t block_key[64] = {0};
+    uint8_t pad[64];
+    if (keylen > sizeof(block_key)) {
+        host_sha256_start(&ctx->inner);
+        host_sha256_update(&ctx->inner, key, keylen);
+        host_sha256_finish(&ctx->inner, block_key);
+    } else {
+        memcpy(block_key, key, keylen);
+    }
+    for (size_t i = 0; i < sizeof(pad); i++) {
+        pad[i] = block_key[i] ^ 0x36;
+    }
+    host_sha256_start(&ctx->inner);
+    host_sha256_update(&ctx->inner, pad, sizeof(pad));
+    for (size_t i = 0; i < sizeof(pad); i++) {
+        pad[i] = block_key[i] ^ 0x5c;
+    }
+    host_sha256_start(&ctx->outer);
+    host_sha256_update(&ctx->outer, pad, sizeof(pad));
+    return 0;
+}
+
+int mbedtls_md_hmac_update(mbedtls_md_context_t* ctx, const unsigned char* input, size_t ilen) {
+    if (ctx->md_info == NULL) {
+        return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    }
+    host_sha256_update(&ctx->inner, input, ilen);
+    return 0;
+}
+
+int mbedtls_md_hmac_finish(mbedtls_md_context_t* ctx, unsigned char* output) {
+    if (ctx->md_info == NULL) {
+        return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+    }
+    uint8_t inner[MBEDTLS_MD_MAX_SIZE];
+    host_sha256_finish(&ctx->inner, inner);
+    host_sha256_update(&ctx->outer, inner, sizeof(inner));
+    host_sha256_finish(&ctx->outer, output);
+    return 0;
+}
+
+int mbedtls_md_hmac(const mbedtls_md_info_t* md_info, const unsigned char* key, size_t keylen,
+                    const unsigned char* input, size_t ilen, unsigned char* output) {
+    mbedtls_md_context_t ctx;
+    mbedtls_md_init(&ctx);
+    int ret = mbedtls_md_setup(&ctx, md_info, 1);
+    if (ret == 0) ret = mbedtls_md_hmac_starts(&ctx, key, keylen);
+    if (ret == 0) ret = mbedtls_md_hmac_update(&ctx, input, ilen);
+    if (ret == 0) ret = mbedtls_md_hmac_finish(&ctx, output);
+    mbedtls_md_free(&ctx);
+    return ret;
+}
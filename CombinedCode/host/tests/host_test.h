@@ -0,0 +1,33 @@
+/**
+ * @file host_test.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Minimal assertions of the host unit tests for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Each test is an executable run by ctest: a failed check prints its location and the test exits
+ * with the number of failed checks.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+/** @brief Number of failed checks of the test. */
+static int host_test_failures = 0;
+
+/** @brief Checks a condition, printing it with its location if it does not hold. */
+#define CHECK(condition) do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            host_test_failures++; \
+        } \
+    } while (0)
+
+/** @brief Exit status of the test: 0 if all checks held. */
+#define HOST_TEST_RESULT() (host_test_failures == 0 ? 0 : 1)
+
+#endif /* HOST_TEST_H */
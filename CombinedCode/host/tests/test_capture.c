@@ -0,0 +1,146 @@
+/**
+ * @file test_capture.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test of the RX capture dumps for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Builds the ideal trace of pseudo-random words, lists its edges as the capture ISR does, writes it as a
+ * dump and reads it back, then checks that replaying the samples gives the words back, that the VCD holds one value
+ * change per edge plus the initial level, that every edge of the ideal trace falls on phase 0 of the eye, and that
+ * dumps with a wrong magic number or cut short are rejected.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "reception/RX_capture_file.h"
+#include "reception/RX_decoder.h"
+#include "host_test.h"
+
+/** @brief Number of words in the trace. */
+#define TEST_CAPTURE_WORDS 64
+/** @brief Samples per bit period. */
+#define TEST_CAPTURE_OVERSAMPLING 4
+/** @brief Samples of the trace. */
+#define TEST_CAPTURE_SAMPLES (TEST_CAPTURE_WORDS * (RX_DECODER_WORD_SAMPLES + 2 * RX_DECODER_SYNTH_IDLE_BITS) * TEST_CAPTURE_OVERSAMPLING)
+/** @brief Size of the edge buffer, every bit of every word changing at most. */
+#define TEST_CAPTURE_EDGES (TEST_CAPTURE_WORDS * RX_DECODER_WORD_SAMPLES)
+
+/**
+ * @brief Reads a whole stream into a word-aligned buffer.
+ *
+ * @param file Stream, read from the start.
+ * @param length Pointer to store the number of bytes.
+ * @return The buffer, to free.
+ */
+static uint32_t* read_all(FILE* file, size_t* length) {
+    fseek(file, 0, SEEK_END);
+    *length = (size_t)ftell(file);
+    rewind(file);
+    uint32_t* data = malloc(*length + sizeof(uint32_t));
+    if (data != NULL && fread(data, 1, *length, file) != *length) {
+        *length = 0;
+    }
+    return data;
+}
+
+/**
+ * @brief Counts the value changes of the rx wire in a VCD.
+ *
+ * @param file Stream holding the VCD, read from the start.
+ * @return Number of lines setting the wire.
+ */
+static uint32_t count_vcd_changes(FILE* file) {
+    char line[128];
+    uint32_t changes = 0;
+    rewind(file);
+    while (fgets(line, sizeof(line), file) != NULL) {
+        changes += (line[0] == '0' || line[0] == '1') && line[1] == '!';
+    }
+    return changes;
+}
+
+int main(void) {
+    static uint32_t samples[RX_CAPTURE_SAMPLE_WORDS(TEST_CAPTURE_SAMPLES)];
+    static uint32_t edges[TEST_CAPTURE_EDGES];
+    uint32_t words[TEST_CAPTURE_WORDS];
+    uint32_t state = 0x2545F491;
+    for (size_t i = 0; i < TEST_CAPTURE_WORDS; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        words[i] = state;
+    }
+
+    // Capture: the ideal trace and its edges
+    rx_capture_header_t header = {
+        .magic = RX_CAPTURE_MAGIC,
+        .version = RX_CAPTURE_VERSION,
+        .oversampling = TEST_CAPTURE_OVERSAMPLING,
+        .sample_period_ns = 250000,
+        .bit_period_ns = 1000000,
+    };
+    header.sample_count = rx_decoder_synthesize(words, TEST_CAPTURE_WORDS, TEST_CAPTURE_OVERSAMPLING, samples,
+                                                TEST_CAPTURE_SAMPLES);
+    CHECK(header.sample_count > 0);
+    header.edge_count = rx_capture_file_find_edges(samples, header.sample_count, edges, TEST_CAPTURE_EDGES,
+                                                   &header.dropped_edges);
+    CHECK(header.edge_count > 2 * TEST_CAPTURE_WORDS && header.dropped_edges == 0);
+    uint32_t dropped;
+    CHECK(rx_capture_file_find_edges(samples, header.sample_count, edges, 2, &dropped) == 2
+          && dropped == header.edge_count - 2);
+    rx_capture_file_find_edges(samples, header.sample_count, edges, TEST_CAPTURE_EDGES, &dropped);
+
+    // Dump and read back
+    FILE* dump = tmpfile();
+    CHECK(dump != NULL);
+    if (dump == NULL) {
+        return HOST_TEST_RESULT();
+    }
+    size_t written = rx_capture_file_write(dump, &header, samples, edges);
+    size_t length;
+    uint32_t* data = read_all(dump, &length);
+    fclose(dump);
+    CHECK(data != NULL && length == written);
+    rx_capture_view_t capture;
+    CHECK(rx_capture_file_parse(data, length, &capture) == ESP_OK);
+    CHECK(memcmp(capture.header, &header, sizeof(header)) == 0);
+    CHECK(memcmp(capture.edges, edges, header.edge_count * sizeof(uint32_t)) == 0);
+
+    // Replay gives the words back
+    uint32_t replayed[TEST_CAPTURE_WORDS + 1];
+    rx_decoder_stats_t stats = {0};
+    size_t replayed_count = rx_decoder_replay(capture.samples, capture.header->sample_count, capture.header->oversampling,
+                                              replayed, TEST_CAPTURE_WORDS + 1, &stats);
+    CHECK(replayed_count == TEST_CAPTURE_WORDS);
+    CHECK(memcmp(replayed, words, sizeof(words)) == 0);
+    CHECK(stats.false_starts == 0 && stats.framing_errors == 0);
+
+    // VCD: the initial level and one change per edge
+    FILE* vcd = tmpfile();
+    CHECK(vcd != NULL);
+    if (vcd != NULL) {
+        uint32_t changes = rx_capture_file_write_vcd(vcd, capture.header, capture.samples);
+        CHECK(changes == header.edge_count + 1);
+        CHECK(count_vcd_changes(vcd) == changes);
+        fclose(vcd);
+    }
+
+    // Eye: every edge of the ideal trace is on a bit boundary
+    uint32_t bins[TEST_CAPTURE_OVERSAMPLING];
+    rx_capture_file_edge_histogram(capture.header, capture.edges, bins);
+    CHECK(bins[0] == header.edge_count);
+    printf("Capture round trip: %lu samples, %lu edges, %zu bytes, %zu words replayed\n",
+           (unsigned long)header.sample_count, (unsigned long)header.edge_count, written, replayed_count);
+
+    // Corrupted and truncated dumps
+    CHECK(rx_capture_file_parse(data, length - 1, &capture) == ESP_ERR_INVALID_SIZE);
+    CHECK(rx_capture_file_parse(data, sizeof(header) - 1, &capture) == ESP_ERR_INVALID_SIZE);
+    data[0] ^= 1;
+    CHECK(rx_capture_file_parse(data, length, &capture) == ESP_ERR_INVALID_ARG);
+    free(data);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,126 @@
+/**
+ * @file test_ctrl_proto.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test of the framing of the binary control protocol for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Checks the CRC against its check value, COBS round trips around zeros and full 254-byte groups,
+ * that packets of every length up to CTRL_MAX_PAYLOAD round-trip through a frame, that corrupted, truncated
+ * and overlong frames are rejected with the right code, and the CONFIGURE and u32 packing.
+ */
+
+#include <stdio.h>
+
+#include "control/ctrl_proto.h"
+#include "host_test.h"
+
+/**
+ * @brief COBS-encodes a buffer, checks the encoding holds no zero, and decodes it back.
+ *
+ * @param data Bytes to encode.
+ * @param length Number of bytes.
+ * @return true if the decoding matches the input.
+ */
+static bool cobs_round_trip(const uint8_t* data, size_t length) {
+    uint8_t encoded[CTRL_COBS_MAX(CTRL_PACKET_MAX)];
+    uint8_t decoded[CTRL_PACKET_MAX];
+    size_t encoded_length = ctrl_cobs_encode(data, length, encoded);
+    if (encoded_length > CTRL_COBS_MAX(length) || memchr(encoded, 0, encoded_length) != NULL) {
+        return false;
+    }
+    size_t decoded_length;
+    return ctrl_cobs_decode(encoded, encoded_length, decoded, sizeof(decoded), &decoded_length)
+        && decoded_length == length && memcmp(decoded, data, length) == 0;
+}
+
+int main(void) {
+    // CRC-16/CCITT-FALSE check value
+    CHECK(ctrl_crc16((const uint8_t*)"123456789", 9) == 0x29B1);
+    CHECK(ctrl_crc16(NULL, 0) == 0xFFFF);
+
+    // COBS: the empty buffer, zeros alone and at the ends, and groups of exactly 254 non-zero bytes
+    uint8_t buffer[CTRL_PACKET_MAX];
+    CHECK(cobs_round_trip(buffer, 0));
+    const uint8_t zeros[] = {0, 0, 0};
+    CHECK(cobs_round_trip(zeros, sizeof(zeros)));
+    const uint8_t mixed[] = {0, 0x11, 0, 0x22, 0x33, 0};
+    CHECK(cobs_round_trip(mixed, sizeof(mixed)));
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)(i % 255 + 1);
+    }
+    CHECK(cobs_round_trip(buffer, 254));
+    CHECK(cobs_round_trip(buffer, 255));
+    CHECK(cobs_round_trip(buffer, sizeof(buffer)));
+    buffer[253] = 0;
+    CHECK(cobs_round_trip(buffer, 254));
+    CHECK(cobs_round_trip(buffer, 300));
+
+    // COBS: a zero in the encoding, a code past the end and an overflow are errors
+    uint8_t encoded[8];
+    size_t decoded;
+    const uint8_t with_zero[] = {3, 0x11, 0};
+    CHECK(!ctrl_cobs_decode(with_zero, sizeof(with_zero), buffer, sizeof(buffer), &decoded));
+    const uint8_t past_end[] = {5, 0x11, 0x22};
+    CHECK(!ctrl_cobs_decode(past_end, sizeof(past_end), buffer, sizeof(buffer), &decoded));
+    size_t encoded_length = ctrl_cobs_encode(mixed, sizeof(mixed), encoded);
+    CHECK(!ctrl_cobs_decode(encoded, encoded_length, buffer, sizeof(mixed) - 1, &decoded));
+
+    // Frames of every payload length round-trip, with a single delimiter at the end
+    uint8_t payload[CTRL_MAX_PAYLOAD];
+    uint8_t frame[CTRL_FRAME_MAX];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7);
+    }
+    int frame_failures = 0;
+    for (size_t length = 0; length <= CTRL_MAX_PAYLOAD; length++) {
+        ctrl_packet_t packet = { CTRL_MSG_TRANSMIT, (uint8_t)length, (uint16_t)length, payload };
+        ctrl_packet_t parsed;
+        size_t bytes = ctrl_frame_build(&packet, frame);
+        if (bytes == 0 || bytes > CTRL_FRAME_MAX || frame[bytes - 1] != 0 || memchr(frame, 0, bytes - 1) != NULL
+            || ctrl_frame_parse(frame, bytes - 1, &parsed) != 0 || parsed.type != packet.type
+            || parsed.seq != packet.seq || parsed.length != length || memcmp(parsed.payload, payload, length) != 0) {
+            frame_failures++;
+        }
+    }
+    CHECK(frame_failures == 0);
+    ctrl_packet_t overlong = { CTRL_MSG_TRANSMIT, 0, CTRL_MAX_PAYLOAD + 1, payload };
+    CHECK(ctrl_frame_build(&overlong, frame) == 0);
+
+    // A flipped payload bit fails the CRC, a dropped byte the length or the COBS check
+    const uint8_t done_payload[CTRL_JOB_DONE_BYTES] = {1, 0, 0, 0, 0, 0, 0, 0};
+    ctrl_packet_t done = { CTRL_MSG_JOB_DONE, 9, sizeof(done_payload), done_payload };
+    ctrl_packet_t parsed;
+    size_t bytes = ctrl_frame_build(&done, frame);
+    frame[5] ^= 0x40;
+    CHECK(ctrl_frame_parse(frame, bytes - 1, &parsed) == -3);
+    bytes = ctrl_frame_build(&done, frame);
+    memmove(&frame[3], &frame[4], bytes - 4);
+    CHECK(ctrl_frame_parse(frame, bytes - 2, &parsed) < 0);
+    bytes = ctrl_frame_build(&done, frame);
+    CHECK(ctrl_frame_parse(frame, 2, &parsed) < 0);
+
+    // The header length must match the decoded bytes
+    uint8_t raw[CTRL_HEADER_BYTES + 1 + CTRL_CRC_BYTES] = {CTRL_MSG_PING, 0, 2, 0, 0x55};
+    uint16_t crc = ctrl_crc16(raw, CTRL_HEADER_BYTES + 1);
+    raw[CTRL_HEADER_BYTES + 1] = (uint8_t)crc;
+    raw[CTRL_HEADER_BYTES + 2] = (uint8_t)(crc >> 8);
+    bytes = ctrl_cobs_encode(raw, sizeof(raw), frame);
+    CHECK(ctrl_frame_parse(frame, bytes, &parsed) == -2);
+
+    // CONFIGURE and u32 packing
+    ctrl_configure_t configure = { 1, 2, -0.25, 0.5, 1000, 0.125, -1.0, 200000 };
+    ctrl_configure_t read;
+    CHECK(ctrl_configure_write(&configure, payload) == CTRL_CONFIGURE_BYTES);
+    CHECK(ctrl_configure_read(payload, CTRL_CONFIGURE_BYTES, &read));
+    CHECK(read.rx == 1 && read.map == 2 && read.x1 == -0.25 && read.y1 == 0.5 && read.iterations1 == 1000);
+    CHECK(read.x2 == 0.125 && read.y2 == -1.0 && read.iterations2 == 200000);
+    CHECK(!ctrl_configure_read(payload, CTRL_CONFIGURE_BYTES - 1, &read));
+    CHECK(ctrl_put_u32(payload, 0x12345678) == 4);
+    CHECK(payload[0] == 0x78 && payload[3] == 0x12);
+    CHECK(ctrl_get_u32(payload) == 0x12345678);
+
+    return HOST_TEST_RESULT();
+}
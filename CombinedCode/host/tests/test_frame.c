@@ -0,0 +1,118 @@
+/**
+ * @file test_frame.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test of framing and frame authentication for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Sends a stream of authenticated frames through the frame assembler, with a bit error in one header,
+ * and checks that only that frame is lost: every word consumes one key on both sides, tag words included, so the
+ * receiver resynchronises on the next header. Then plays the first frame back at the end of the stream and checks
+ * that its tag, bound to the keystream index of its header, is rejected there. The HMAC itself is checked against
+ * RFC 4231, as the host build may use the software stand-in of host/compat.
+ */
+
+#include "common_utils/frame.h"
+#include "host_test.h"
+
+/** @brief Number of frames of the stream. */
+#define TEST_FRAMES 16
+
+/** @brief Frame whose header gets a bit error. */
+#define TEST_CORRUPT_FRAME 5
+
+/**
+ * @brief Sets up a key generator with fixed settings.
+ * @param vars Encryption variables to set up.
+ * @param msws32 Storage of the MSWS32 variables.
+ */
+static void setup_keys(encryption_vars_t* vars, msws32_var_t* msws32) {
+    *msws32 = (msws32_var_t){0};
+    *vars = (encryption_vars_t){
+        .type = MAP_LOGISTIC,
+        .chaotic_map1 = { .x = 0.31, .y = 0.47, .iterations = 200 },
+        .chaotic_map2 = { .x = 0.53, .y = 0.29, .iterations = 200 },
+        .msws32_variables = msws32,
+    };
+    key_generator_setup(vars);
+}
+
+int main(void) {
+    // RFC 4231 test cases 2 and 6: a short key and a key longer than the block
+    static const uint8_t expected_short[] = {
+        0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e, 0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7,
+        0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83, 0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43,
+    };
+    static const uint8_t expected_long[] = {
+        0x60, 0xe4, 0x31, 0x59, 0x1e, 0xe0, 0xb6, 0x7f, 0x0d, 0x8a, 0x26, 0xaa, 0xcb, 0xf5, 0xb7, 0x7f,
+        0x8e, 0x0b, 0xc6, 0x21, 0x37, 0x28, 0xc5, 0x14, 0x05, 0x46, 0x04, 0x0f, 0x0e, 0xe3, 0x7f, 0x54,
+    };
+    static const char long_data[] = "Test Using Larger Than Block-Size Key - Hash Key First";
+    uint8_t long_key[131];
+    uint8_t digest[32];
+    memset(long_key, 0xaa, sizeof(long_key));
+    const mbedtls_md_info_t* sha256 = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    CHECK(mbedtls_md_hmac(sha256, (const unsigned char*)"Jefe", 4, (const unsigned char*)"what do ya want for nothing?",
+                          28, digest) == 0);
+    CHECK(memcmp(digest, expected_short, sizeof(digest)) == 0);
+    CHECK(mbedtls_md_hmac(sha256, long_key, sizeof(long_key), (const unsigned char*)long_data, strlen(long_data),
+                          digest) == 0);
+    CHECK(memcmp(digest, expected_long, sizeof(digest)) == 0);
+
+    static const char* texts[] = {"hello", "secure visible light", "x", "0123456789abcdef0123"};
+    static uint32_t stream[TEST_FRAMES * FRAME_MAX_WORDS];
+    encryption_vars_t tx_vars, rx_vars;
+    msws32_var_t tx_msws32, rx_msws32;
+    size_t frame_start[TEST_FRAMES];
+    size_t stream_words = 0;
+
+    setup_keys(&tx_vars, &tx_msws32);
+    setup_keys(&rx_vars, &rx_msws32);
+    for (int f = 0; f < TEST_FRAMES; f++) {
+        frame_start[f] = stream_words;
+        size_t count = frame_build(&tx_vars, texts[f % 4], true, &stream[stream_words]);
+        CHECK(count == frame_total_words((uint16_t)((strlen(texts[f % 4]) + 3) / 4), FRAME_FLAG_AUTH));
+        stream_words += count;
+    }
+    stream[frame_start[TEST_CORRUPT_FRAME]] ^= 1UL << 27; // Marker bit of the header
+
+    frame_assembler_t assembler;
+    uint32_t payload[FRAME_MAX_PAYLOAD_WORDS];
+    int opened = 0, invalid = 0;
+    bool received[TEST_FRAMES] = {false};
+    frame_assembler_reset(&assembler);
+    for (size_t i = 0; i < stream_words; i++) {
+        frame_assembler_status_t status = frame_assembler_push(&assembler, &rx_vars, stream[i]);
+        invalid += (status == FRAME_ASSEMBLER_INVALID_HEADER);
+        if (status != FRAME_ASSEMBLER_COMPLETE) {
+            continue;
+        }
+        if (!frame_open(&assembler, &rx_vars, payload)) {
+            continue;
+        }
+        opened++;
+        for (int f = 0; f < TEST_FRAMES; f++) {
+            if (i + 1 - assembler.expected == frame_start[f]) {
+                const char* text = texts[f % 4];
+                received[f] = memcmp(payload, text, strlen(text)) == 0;
+            }
+        }
+    }
+
+    CHECK(opened == TEST_FRAMES - 1);
+    CHECK(invalid >= 1);
+    for (int f = 0; f < TEST_FRAMES; f++) {
+        CHECK(received[f] == (f != TEST_CORRUPT_FRAME));
+    }
+
+    // Replay: the same ciphertext and tag at a later keystream index
+    CHECK(rx_vars.key_index == tx_vars.key_index);
+    frame_assembler_status_t status = FRAME_ASSEMBLER_PENDING;
+    for (size_t i = 0; i < frame_start[1]; i++) {
+        status = frame_assembler_push(&assembler, &rx_vars, stream[i]);
+    }
+    CHECK(status != FRAME_ASSEMBLER_COMPLETE || !frame_open(&assembler, &rx_vars, payload));
+    return HOST_TEST_RESULT();
+}
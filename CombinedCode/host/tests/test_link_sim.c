@@ -0,0 +1,72 @@
+/**
+ * @file test_link_sim.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test of the VLC link simulator for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Checks that a clean link of either framing decodes every word, that the measured latency matches
+ * the air time of the frame up to the last stop bit, and that a run only depends on its parameters.
+ */
+
+#include <stdlib.h>
+
+#include "simulation/link_sim.h"
+#include "host_test.h"
+
+/** @brief Words sent by each simulation. */
+#define TEST_WORDS 16
+
+/**
+ * @brief Runs a clean link and checks its results.
+ * @param workspace Buffers of the simulation.
+ * @param framing Framing mode.
+ * @param expected_bits Bits on air from the first bit to the sample that completes the last word.
+ */
+static void check_clean_link(link_sim_workspace_t* workspace, link_sim_framing_t framing, double expected_bits) {
+    link_sim_params_t params = {
+        .bit_period_micros = 10,
+        .noise_ppm = 0,
+        .drift_ppm = 0,
+        .map_type = MAP_LOGISTIC,
+        .framing = framing,
+        .front_end = LINK_SIM_FRONT_END_GPIO,
+        .branches = 1,
+        .diversity = RX_DIVERSITY_OFF,
+        .led = LINK_SIM_LED_IDEAL,
+        .word_count = TEST_WORDS,
+        .seed = 7,
+    };
+    link_sim_result_t result, again;
+    link_sim_run(&params, workspace, &result);
+    CHECK(result.words_decoded == TEST_WORDS);
+    CHECK(result.words_correct == TEST_WORDS);
+    CHECK(result.bit_errors == 0);
+    // The decoder completes a word within one bit period of the bit that ends it
+    CHECK(result.latency_us > (expected_bits - 1) * params.bit_period_micros);
+    CHECK(result.latency_us <= (expected_bits + 1) * params.bit_period_micros);
+
+    link_sim_run(&params, workspace, &again);
+    CHECK(again.words_correct == result.words_correct && again.latency_us == result.latency_us);
+}
+
+int main(void) {
+    link_sim_workspace_t* workspace = malloc(sizeof(link_sim_workspace_t));
+    CHECK(workspace != NULL);
+    if (workspace == NULL) {
+        return HOST_TEST_RESULT();
+    }
+
+    // One start bit, 32 data bits and the stop bit per word, idle bits between words
+    check_clean_link(workspace, LINK_SIM_FRAMING_WORD,
+                     TEST_WORDS * (1 + RX_DECODER_WORD_BITS) + (TEST_WORDS - 1) * RX_DECODER_SYNTH_IDLE_BITS + 1);
+    // Sync pattern, length word and the words
+    rx_sync_config_t sync_config;
+    rx_sync_default_config(&sync_config);
+    check_clean_link(workspace, LINK_SIM_FRAMING_SYNC, sync_config.bits + (TEST_WORDS + 1) * RX_DECODER_WORD_BITS);
+
+    free(workspace);
+    return HOST_TEST_RESULT();
+}
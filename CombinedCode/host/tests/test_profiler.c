@@ -0,0 +1,81 @@
+/**
+ * @file test_profiler.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test of the cycle-budget profiler for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Checks that a probe opened before the profiler started records nothing, that a probe records its
+ * cycles from the time-stamp counter, and that samples recorded by several threads at once are all counted.
+ */
+
+#include <pthread.h>
+
+#include "common_utils/profiler.h"
+#include "host_test.h"
+
+/** @brief Number of recording threads. */
+#define TEST_THREADS 4
+/** @brief Samples recorded by each thread. */
+#define TEST_SAMPLES 100000
+/** @brief Cycles of each sample of the threads. */
+#define TEST_CYCLES 5
+
+/**
+ * @brief Records TEST_SAMPLES samples in the pack slot.
+ * @param arg Unused.
+ * @return NULL.
+ */
+static void* record_samples(void* arg) {
+    (void)arg;
+    for (int i = 0; i < TEST_SAMPLES; i++) {
+        profiler_record(PROFILE_PACK, TEST_CYCLES, 4);
+    }
+    return NULL;
+}
+
+int main(void) {
+    profile_histogram_t histogram;
+
+    profiler_stop();
+    profiler_reset();
+    {
+        PROFILE_BEGIN(start);
+        profiler_start();
+        PROFILE_END(PROFILE_XOR, start);
+    }
+    profiler_get(PROFILE_XOR, &histogram);
+    CHECK(histogram.count == 0);
+
+    {
+        PROFILE_BEGIN(start);
+        PROFILE_END_BYTES(PROFILE_XOR, start, 4);
+    }
+    profiler_get(PROFILE_XOR, &histogram);
+    CHECK(histogram.count == 1);
+    CHECK(histogram.bytes == 4);
+    CHECK(histogram.max < 0x80000000UL);
+
+    pthread_t threads[TEST_THREADS];
+    for (int t = 0; t < TEST_THREADS; t++) {
+        CHECK(pthread_create(&threads[t], NULL, record_samples, NULL) == 0);
+    }
+    for (int t = 0; t < TEST_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    profiler_stop();
+    profiler_get(PROFILE_PACK, &histogram);
+    CHECK(histogram.count == TEST_THREADS * TEST_SAMPLES);
+    CHECK(histogram.total == (uint64_t)TEST_THREADS * TEST_SAMPLES * TEST_CYCLES);
+    CHECK(histogram.bytes == (uint64_t)TEST_THREADS * TEST_SAMPLES * 4);
+    CHECK(histogram.buckets[2] == TEST_THREADS * TEST_SAMPLES);
+    CHECK(histogram.min == TEST_CYCLES && histogram.max == TEST_CYCLES);
+
+    profiler_reset();
+    profiler_get(PROFILE_PACK, &histogram);
+    CHECK(histogram.count == 0);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,163 @@
+/**
+ * @file test_replay.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host replay of RX traces against the expected plaintext for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details The host counterpart of the replay console command: builds authenticated frames of known texts, turns
+ * them into the ideal oversampled trace of the transmitter, decodes the trace with the mid-bit decoder and with the
+ * edge decoder, and checks that the frames assembled and opened from the words give back the texts. Prints the
+ * decoding speed of each decoder in bits per second of CPU time, over TEST_REPLAY_RUNS runs. Then flips one payload
+ * bit of the trace and checks that its frame is rejected by its tag.
+ */
+
+#include <time.h>
+
+#include "common_utils/frame.h"
+#include "reception/RX_decoder.h"
+#include "reception/RX_edges.h"
+#include "host_test.h"
+
+/** @brief Samples per bit period of the trace, as RX_CAPTURE_OVERSAMPLING on the board. */
+#define TEST_REPLAY_OVERSAMPLING 4
+/** @brief Decoding runs timed for each decoder. */
+#define TEST_REPLAY_RUNS 200
+/** @brief Frames of the trace. */
+#define TEST_REPLAY_FRAMES 8
+/** @brief Largest number of words of the trace. */
+#define TEST_REPLAY_MAX_WORDS (TEST_REPLAY_FRAMES * 16)
+/** @brief Largest number of samples of the trace. */
+#define TEST_REPLAY_MAX_SAMPLES \
+    (TEST_REPLAY_MAX_WORDS * (RX_DECODER_WORD_SAMPLES + 2 * RX_DECODER_SYNTH_IDLE_BITS) * TEST_REPLAY_OVERSAMPLING)
+
+/** @brief Texts of the frames, sent in turn. */
+static const char* const replay_texts[] = {"hello", "secure visible light", "x", "0123456789abcdef0123456789abcdef"};
+
+/** @brief Number of texts. */
+#define TEST_REPLAY_TEXTS (sizeof(replay_texts) / sizeof(replay_texts[0]))
+
+/**
+ * @brief Sets up a key generator with fixed settings.
+ * @param vars Encryption variables to set up.
+ * @param msws32 Storage of the MSWS32 variables.
+ */
+static void setup_keys(encryption_vars_t* vars, msws32_var_t* msws32) {
+    *msws32 = (msws32_var_t){0};
+    *vars = (encryption_vars_t){
+        .type = MAP_LOGISTIC,
+        .chaotic_map1 = { .x = 0.31, .y = 0.47, .iterations = 200 },
+        .chaotic_map2 = { .x = 0.53, .y = 0.29, .iterations = 200 },
+        .msws32_variables = msws32,
+    };
+    key_generator_setup(vars);
+}
+
+/**
+ * @brief Gets the CPU time of the process.
+ *
+ * @return Seconds of CPU time.
+ */
+static double cpu_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (double)now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Assembles and opens the frames of decoded words and compares them with the texts sent.
+ *
+ * @param keys Receiver keys at the start of the trace, not advanced.
+ * @param words Decoded words.
+ * @param word_count Number of words.
+ * @return Number of frames opened that match their text.
+ */
+static int count_matching_frames(const encryption_vars_t* keys, const uint32_t* words, size_t word_count) {
+    static frame_assembler_t assembler;
+    encryption_vars_t vars;
+    msws32_var_t msws32;
+    uint32_t payload[FRAME_MAX_PAYLOAD_WORDS];
+    int matching = 0, frame = 0;
+    key_generator_clone(&vars, &msws32, keys);
+    frame_assembler_reset(&assembler);
+    for (size_t i = 0; i < word_count; i++) {
+        if (frame_assembler_push(&assembler, &vars, words[i]) != FRAME_ASSEMBLER_COMPLETE) {
+            continue;
+        }
+        const char* text = replay_texts[frame++ % TEST_REPLAY_TEXTS];
+        if (frame_open(&assembler, &vars, payload) && assembler.payload_words == (strlen(text) + 3) / 4
+            && memcmp(payload, text, strlen(text)) == 0) {
+            matching++;
+        }
+    }
+    return matching;
+}
+
+/**
+ * @brief Decodes a trace with one decoder, times it and checks the frames.
+ *
+ * @param name Name of the decoder.
+ * @param edges true for the edge decoder, false for the mid-bit decoder.
+ * @param keys Receiver keys at the start of the trace.
+ * @param samples Packed samples.
+ * @param sample_count Number of samples.
+ * @param sent Number of words sent.
+ * @return Number of frames opened that match their text.
+ */
+static int replay(const char* name, bool edges, const encryption_vars_t* keys, const uint32_t* samples,
+                  uint32_t sample_count, size_t sent) {
+    uint32_t words[TEST_REPLAY_MAX_WORDS];
+    size_t word_count = 0;
+    rx_decoder_stats_t rejected = {0};
+    double start = cpu_seconds();
+    for (int r = 0; r < TEST_REPLAY_RUNS; r++) {
+        rejected = (rx_decoder_stats_t){0};
+        word_count = edges ? rx_edges_replay(samples, sample_count, TEST_REPLAY_OVERSAMPLING, words, TEST_REPLAY_MAX_WORDS, &rejected)
+                           : rx_decoder_replay(samples, sample_count, TEST_REPLAY_OVERSAMPLING, words, TEST_REPLAY_MAX_WORDS, &rejected);
+    }
+    double seconds = cpu_seconds() - start;
+    double bits = (double)word_count * RX_DECODER_WORD_BITS * TEST_REPLAY_RUNS;
+    int matching = count_matching_frames(keys, words, word_count);
+    printf("Replay (%s): %zu of %zu words from %lu samples, %d runs, %.0f bits/s of CPU time (%.0fx real time), "
+           "%d of %d frames match\n", name, word_count, sent, (unsigned long)sample_count, TEST_REPLAY_RUNS,
+           seconds > 0 ? bits / seconds : 0.0, seconds > 0 ? bits * RX_PERIOD_MICROS / 1e6 / seconds : 0.0,
+           matching, TEST_REPLAY_FRAMES);
+    CHECK(word_count == sent);
+    CHECK(rejected.false_starts == 0 && rejected.framing_errors == 0);
+    return matching;
+}
+
+int main(void) {
+    static uint32_t samples[(TEST_REPLAY_MAX_SAMPLES + 31) / 32];
+    uint32_t stream[TEST_REPLAY_MAX_WORDS];
+    size_t stream_words = 0;
+    encryption_vars_t tx_vars, rx_vars;
+    msws32_var_t tx_msws32, rx_msws32;
+    setup_keys(&tx_vars, &tx_msws32);
+    setup_keys(&rx_vars, &rx_msws32);
+
+    for (int f = 0; f < TEST_REPLAY_FRAMES; f++) {
+        size_t count = frame_build(&tx_vars, replay_texts[f % TEST_REPLAY_TEXTS], true, &stream[stream_words]);
+        CHECK(count > 0);
+        stream_words += count;
+    }
+    uint32_t sample_count = rx_decoder_synthesize(stream, stream_words, TEST_REPLAY_OVERSAMPLING, samples,
+                                                  TEST_REPLAY_MAX_SAMPLES);
+    CHECK(sample_count > 0);
+
+    CHECK(replay("mid-bit", false, &rx_vars, samples, sample_count, stream_words) == TEST_REPLAY_FRAMES);
+    CHECK(replay("edges", true, &rx_vars, samples, sample_count, stream_words) == TEST_REPLAY_FRAMES);
+
+    // One flipped bit in the first payload word of the first frame: only that frame is lost
+    uint32_t first = (2 * RX_DECODER_SYNTH_IDLE_BITS + 1 + RX_DECODER_WORD_BITS + 1) * TEST_REPLAY_OVERSAMPLING;
+    for (uint32_t sample = first; sample < first + TEST_REPLAY_OVERSAMPLING; sample++) {
+        samples[sample / 32] ^= 1UL << (sample % 32);
+    }
+    uint32_t words[TEST_REPLAY_MAX_WORDS];
+    size_t word_count = rx_decoder_replay(samples, sample_count, TEST_REPLAY_OVERSAMPLING, words, TEST_REPLAY_MAX_WORDS, NULL);
+    CHECK(word_count == stream_words && words[1] != stream[1]);
+    CHECK(count_matching_frames(&rx_vars, words, word_count) == TEST_REPLAY_FRAMES - 1);
+    return HOST_TEST_RESULT();
+}
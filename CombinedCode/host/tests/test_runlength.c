@@ -0,0 +1,80 @@
+/**
+ * @file test_runlength.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test and benchmark of the TX run-length encoder for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Checks the runs of the idle and alternating patterns, that the decoder rejects malformed runs, and
+ * that pseudo-random words round-trip through tx_runlength_benchmark(), whose cycles per word are printed.
+ */
+
+#include "common_utils/profiler.h"
+#include "transmission/TX_runlength.h"
+#include "host_test.h"
+
+/** @brief Number of words of the benchmark. */
+#define TEST_RUNLENGTH_WORDS 1000000
+
+/**
+ * @brief Encodes a word and decodes it back.
+ *
+ * @param word Word to encode.
+ * @param runs Array to store the runs.
+ * @param count Pointer to store the number of runs.
+ * @return true if the runs are valid and decode to the word.
+ */
+static bool round_trip(uint32_t word, uint8_t runs[TX_RUNLENGTH_MAX_RUNS], uint8_t* count) {
+    bool valid;
+    *count = tx_runlength_encode(word, runs);
+    return tx_runlength_decode(runs, *count, &valid) == word && valid;
+}
+
+int main(void) {
+    uint8_t runs[TX_RUNLENGTH_MAX_RUNS];
+    uint8_t count;
+    bool valid;
+
+    // Start bit and zeros, then the stop bit
+    CHECK(round_trip(0, runs, &count));
+    CHECK(count == 2 && runs[0] == TX_RUNLENGTH_WORD_BITS - 1 && runs[1] == 1);
+    // Start bit, then ones and the stop bit
+    CHECK(round_trip(UINT32_MAX, runs, &count));
+    CHECK(count == 2 && runs[0] == 1 && runs[1] == TX_RUNLENGTH_WORD_BITS - 1);
+    // Every bit on the line differs from the one before
+    CHECK(round_trip(0x55555555, runs, &count));
+    CHECK(count == TX_RUNLENGTH_MAX_RUNS);
+    // The first data bit extends the start bit and the last one the stop bit
+    CHECK(round_trip(0xAAAAAAAA, runs, &count));
+    CHECK(count == TX_RUNLENGTH_MAX_RUNS - 2 && runs[0] == 2 && runs[count - 1] == 2);
+    for (uint32_t bit = 0; bit < RX_DECODER_WORD_BITS; bit++) {
+        CHECK(round_trip(1UL << bit, runs, &count));
+        CHECK(round_trip(~(1UL << bit), runs, &count));
+    }
+
+    // Odd count, empty run, too short and too long
+    const uint8_t odd[] = {1, 32, 1};
+    const uint8_t empty[] = {1, 0, 32, 1};
+    const uint8_t short_word[] = {1, 32};
+    const uint8_t long_word[] = {2, 33};
+    tx_runlength_decode(odd, sizeof(odd), &valid);
+    CHECK(!valid);
+    tx_runlength_decode(empty, sizeof(empty), &valid);
+    CHECK(!valid);
+    tx_runlength_decode(short_word, sizeof(short_word), &valid);
+    CHECK(!valid);
+    tx_runlength_decode(long_word, sizeof(long_word), &valid);
+    CHECK(!valid);
+
+    tx_runlength_bench_t result;
+    tx_runlength_benchmark(TEST_RUNLENGTH_WORDS, 1, profiler_cycles, &result);
+    CHECK(result.words == TEST_RUNLENGTH_WORDS);
+    CHECK(result.mismatches == 0);
+    CHECK(result.runs >= 2 * result.words && result.runs <= (uint64_t)TX_RUNLENGTH_MAX_RUNS * result.words);
+    printf("Run-length: %lu words, %.1f cycles/word, %.2f runs/word against %d bits\n", (unsigned long)result.words,
+           (double)result.cycles / result.words, (double)result.runs / result.words, TX_RUNLENGTH_WORD_BITS);
+
+    return HOST_TEST_RESULT();
+}
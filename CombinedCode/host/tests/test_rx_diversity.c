@@ -0,0 +1,38 @@
+/**
+ * @file test_rx_diversity.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test of receive diversity combining for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Checks the majority vote, and that a mode change requested while sampling only takes effect, and
+ * clears the counters, on the next combined sample.
+ */
+
+#include "reception/RX_diversity.h"
+#include "host_test.h"
+
+int main(void) {
+    rx_diversity_t diversity;
+    rx_diversity_init(&diversity, 3, RX_DIVERSITY_MAJORITY);
+    CHECK(rx_diversity_combine(&diversity, 0x3) == 1);
+    CHECK(rx_diversity_combine(&diversity, 0x1) == 0);
+    CHECK(rx_diversity_combine(&diversity, 0x6) == 1);
+    CHECK(diversity.stats[0].disagreements == 2);
+
+    rx_diversity_set_mode(&diversity, RX_DIVERSITY_OFF);
+    CHECK(rx_diversity_get_mode(&diversity) == RX_DIVERSITY_OFF);
+    CHECK(diversity.mode == RX_DIVERSITY_MAJORITY);
+    CHECK(diversity.stats[0].disagreements == 2);
+
+    // Branch 0 alone decides once the request is applied
+    CHECK(rx_diversity_combine(&diversity, 0x6) == 0);
+    CHECK(diversity.mode == RX_DIVERSITY_OFF);
+    CHECK(diversity.requested == 0);
+    CHECK(diversity.stats[0].disagreements == 0);
+    CHECK(rx_diversity_get_mode(&diversity) == RX_DIVERSITY_OFF);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,114 @@
+/**
+ * @file test_rx_edges.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test of the RX edge-timestamp decoder for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Feeds the decoder the edges of pseudo-random words sent by a transmitter whose clock is 10% slow or
+ * fast, every edge moved by up to 0.2 bit periods, and checks that the tracked bit period follows the clock and
+ * that at most TEST_EDGES_MAX_BAD of TEST_EDGES_WORDS words are lost or wrong.
+ */
+
+#include <stdlib.h>
+#include "reception/RX_edges.h"
+#include "host_test.h"
+
+/** @brief Nominal bit period, in ticks. */
+#define TEST_EDGES_PERIOD 100
+/** @brief Number of words sent at each drift. */
+#define TEST_EDGES_WORDS 5000
+/** @brief Largest number of words lost or wrong at each drift. */
+#define TEST_EDGES_MAX_BAD 5
+/** @brief Largest time an edge is moved by, in bit periods. */
+#define TEST_EDGES_JITTER 0.2
+/** @brief Bit periods the line idles high between words. */
+#define TEST_EDGES_IDLE_BITS 2
+
+/**
+ * @brief Gets the next pseudo-random word.
+ *
+ * @param state Pointer to the generator state, not 0.
+ * @return The next word.
+ */
+static uint32_t next_word(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief Gets a pseudo-random time offset.
+ *
+ * @param state Pointer to the generator state, not 0.
+ * @param period Bit period of the transmitter, in ticks.
+ * @return An offset of -TEST_EDGES_JITTER to TEST_EDGES_JITTER bit periods, in ticks.
+ */
+static double next_jitter(uint32_t* state, double period) {
+    return ((double)next_word(state) / UINT32_MAX * 2.0 - 1.0) * TEST_EDGES_JITTER * period;
+}
+
+/**
+ * @brief Sends TEST_EDGES_WORDS words at a drifted bit period through the decoder.
+ *
+ * @param drift Relative error of the transmitter clock, e.g. 0.1 for a bit period 10% long.
+ * @param period_ticks Pointer to store the tracked bit period at the end, in ticks.
+ * @return Number of words lost or wrong.
+ */
+static uint32_t run_drift(double drift, double* period_ticks) {
+    rx_edges_t decoder;
+    uint32_t words_state = 1, jitter_state = 7;
+    uint32_t sent[TEST_EDGES_WORDS];
+    uint32_t received = 0, bad = 0;
+    uint32_t word;
+    double period = TEST_EDGES_PERIOD * (1.0 + drift);
+    double bit_start = TEST_EDGES_IDLE_BITS * period;
+
+    rx_edges_init(&decoder, TEST_EDGES_PERIOD);
+    for (uint32_t n = 0; n < TEST_EDGES_WORDS; n++) {
+        sent[n] = next_word(&words_state);
+        // Levels of the start bit, the data bits and the stop bit
+        uint32_t previous = 1;
+        for (uint32_t bit = 0; bit < RX_EDGES_WORD_BITS; bit++) {
+            uint32_t level = (bit == 0) ? 0 : (bit > RX_DECODER_WORD_BITS) ? 1 : (sent[n] >> (bit - 1)) & 0x1;
+            double edge = bit_start + bit * period;
+            if (level != previous) {
+                uint32_t time = (uint32_t)(edge + next_jitter(&jitter_state, period)) & RX_EDGES_TIME_MASK;
+                rx_decoder_status_t status = rx_edges_push(&decoder, time, level, &word);
+                if (status == RX_DECODER_DONE) {
+                    bad += (received >= TEST_EDGES_WORDS || word != sent[received]);
+                    received++;
+                } else if (status != RX_DECODER_BUSY) {
+                    received++;
+                    bad++;
+                }
+                previous = level;
+            }
+        }
+        bit_start += (RX_EDGES_WORD_BITS + TEST_EDGES_IDLE_BITS) * period;
+    }
+    if (rx_edges_flush(&decoder, (uint32_t)bit_start & RX_EDGES_TIME_MASK, &word) == RX_DECODER_DONE) {
+        bad += (received >= TEST_EDGES_WORDS || word != sent[received]);
+        received++;
+    }
+    *period_ticks = (double)decoder.period_ticks / 256.0;
+    return bad + (received < TEST_EDGES_WORDS ? TEST_EDGES_WORDS - received : 0);
+}
+
+int main(void) {
+    const double drifts[] = {-0.1, 0.1};
+    for (size_t i = 0; i < sizeof(drifts) / sizeof(drifts[0]); i++) {
+        double period;
+        uint32_t bad = run_drift(drifts[i], &period);
+        printf("Drift %+.0f%%, jitter %.1f bit: %lu bad words of %d, tracked period %.1f ticks\n",
+               drifts[i] * 100, TEST_EDGES_JITTER, (unsigned long)bad, TEST_EDGES_WORDS, period);
+        CHECK(bad <= TEST_EDGES_MAX_BAD);
+        CHECK(period > TEST_EDGES_PERIOD * (1.0 + drifts[i]) - 1.0 && period < TEST_EDGES_PERIOD * (1.0 + drifts[i]) + 1.0);
+    }
+    return HOST_TEST_RESULT();
+}
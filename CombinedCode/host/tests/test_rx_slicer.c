@@ -0,0 +1,182 @@
+/**
+ * @file test_rx_slicer.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test of the adaptive slicer of the analog RX front end for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Builds the ADC samples of pseudo-random bits at the conversion rate of the analog backend, with noise,
+ * over an ambient light that steps up by more than the signal swing, drifts down while the line idles and drifts
+ * up again while it carries data, and slices them in DMA frames as phy_adc does. Checks, with and without a DC
+ * offset on top, that every bit read at its middle sample is right outside the settling time after locking and
+ * after the step. Then prints the samples sliced per second of CPU time against PHY_ADC_SAMPLE_FREQ_HZ.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "reception/RX_slicer.h"
+#include "host_test.h"
+
+/** @brief ADC samples per bit of the analog backend. */
+#define TEST_SLICER_OVERSAMPLING (PHY_ADC_SAMPLE_FREQ_HZ / (1000000 / PHY_ADC_PERIOD_MICROS))
+/** @brief Signal swing between the LED off and on, in ADC counts. */
+#define TEST_SLICER_SWING 1000
+/** @brief Largest noise added to a sample, in ADC counts. */
+#define TEST_SLICER_NOISE 50
+/** @brief Bits of data before the ambient step. */
+#define TEST_SLICER_BEFORE_STEP 200
+/** @brief Bits of data after the ambient step. */
+#define TEST_SLICER_AFTER_STEP 200
+/** @brief Idle bits while the ambient light drifts down. */
+#define TEST_SLICER_IDLE 100
+/** @brief Bits of data while the ambient light drifts up. */
+#define TEST_SLICER_DRIFT 200
+/** @brief Bits of the trace. */
+#define TEST_SLICER_BITS (TEST_SLICER_BEFORE_STEP + TEST_SLICER_AFTER_STEP + TEST_SLICER_IDLE + TEST_SLICER_DRIFT)
+/** @brief Samples of the trace. */
+#define TEST_SLICER_SAMPLES (TEST_SLICER_BITS * TEST_SLICER_OVERSAMPLING)
+/** @brief Bits allowed to be wrong at the start and after the step, eight blocks of the slicer. */
+#define TEST_SLICER_SETTLE_BITS (8 * RX_SLICER_BLOCK_SAMPLES / TEST_SLICER_OVERSAMPLING)
+/** @brief Slicing runs timed by the benchmark. */
+#define TEST_SLICER_RUNS 2000
+
+/**
+ * @brief Gets the next pseudo-random word.
+ *
+ * @param state Pointer to the generator state, not 0.
+ * @return The next word.
+ */
+static uint32_t next_word(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief Gets the CPU time of the process.
+ *
+ * @return Seconds of CPU time.
+ */
+static double cpu_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (double)now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Gets the ambient light level at a bit of the trace.
+ *
+ * @param bit Index of the bit.
+ * @return Ambient level, in ADC counts.
+ */
+static int32_t ambient_at(uint32_t bit) {
+    if (bit < TEST_SLICER_BEFORE_STEP) {
+        return 600;
+    }
+    bit -= TEST_SLICER_BEFORE_STEP;
+    if (bit < TEST_SLICER_AFTER_STEP) {
+        return 2000; // Step up by more than the swing
+    }
+    bit -= TEST_SLICER_AFTER_STEP;
+    if (bit < TEST_SLICER_IDLE) {
+        return 2000 - (int32_t)(600 * bit / TEST_SLICER_IDLE);
+    }
+    bit -= TEST_SLICER_IDLE;
+    return 1400 + (int32_t)(400 * bit / TEST_SLICER_DRIFT);
+}
+
+/**
+ * @brief Builds the bits and ADC samples of the trace.
+ *
+ * @param offset DC offset added to every sample, in ADC counts.
+ * @param bits Array to store the bits sent.
+ * @param samples Array to store the samples.
+ */
+static void build_trace(int32_t offset, uint8_t* bits, uint16_t* samples) {
+    uint32_t bit_state = 1, noise_state = 7;
+    for (uint32_t bit = 0; bit < TEST_SLICER_BITS; bit++) {
+        bool idle = bit >= TEST_SLICER_BEFORE_STEP + TEST_SLICER_AFTER_STEP
+                 && bit < TEST_SLICER_BEFORE_STEP + TEST_SLICER_AFTER_STEP + TEST_SLICER_IDLE;
+        bits[bit] = idle ? 1 : (uint8_t)(next_word(&bit_state) & 0x1);
+        for (uint32_t s = 0; s < TEST_SLICER_OVERSAMPLING; s++) {
+            int32_t noise = (int32_t)(next_word(&noise_state) % (2 * TEST_SLICER_NOISE + 1)) - TEST_SLICER_NOISE;
+            samples[bit * TEST_SLICER_OVERSAMPLING + s] =
+                (uint16_t)(offset + ambient_at(bit) + bits[bit] * TEST_SLICER_SWING + noise);
+        }
+    }
+}
+
+/**
+ * @brief Slices a trace in DMA frames, as phy_adc does.
+ *
+ * @param samples Samples of the trace.
+ * @param levels Array to store the levels.
+ */
+static void slice(const uint16_t* samples, uint8_t* levels) {
+    rx_slicer_t slicer;
+    rx_slicer_init(&slicer);
+    for (size_t start = 0; start < TEST_SLICER_SAMPLES; start += PHY_ADC_FRAME_SAMPLES) {
+        size_t count = TEST_SLICER_SAMPLES - start < PHY_ADC_FRAME_SAMPLES ? TEST_SLICER_SAMPLES - start : PHY_ADC_FRAME_SAMPLES;
+        rx_slicer_process(&slicer, samples + start, count, levels + start);
+    }
+}
+
+/**
+ * @brief Counts the wrong bits of a sliced trace outside the settling times.
+ *
+ * @param bits Bits sent.
+ * @param levels Sliced levels.
+ * @param settling Pointer to store the number of wrong bits within the settling times.
+ * @return Number of wrong bits elsewhere.
+ */
+static uint32_t count_errors(const uint8_t* bits, const uint8_t* levels, uint32_t* settling) {
+    uint32_t errors = 0;
+    *settling = 0;
+    for (uint32_t bit = 0; bit < TEST_SLICER_BITS; bit++) {
+        bool wrong = levels[bit * TEST_SLICER_OVERSAMPLING + TEST_SLICER_OVERSAMPLING / 2] != bits[bit];
+        bool settle = bit < TEST_SLICER_SETTLE_BITS
+                   || (bit >= TEST_SLICER_BEFORE_STEP && bit < TEST_SLICER_BEFORE_STEP + TEST_SLICER_SETTLE_BITS);
+        if (settle) {
+            *settling += wrong;
+        } else {
+            errors += wrong;
+        }
+    }
+    return errors;
+}
+
+int main(void) {
+    static uint8_t bits[TEST_SLICER_BITS];
+    static uint16_t samples[TEST_SLICER_SAMPLES];
+    static uint8_t levels[TEST_SLICER_SAMPLES];
+    const int32_t offsets[] = {0, 1000};
+
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        build_trace(offsets[i], bits, samples);
+        memset(levels, 0xFF, sizeof(levels));
+        slice(samples, levels);
+        uint32_t settling;
+        uint32_t errors = count_errors(bits, levels, &settling);
+        printf("Slicer, DC offset %ld: %lu wrong bits of %d after settling, %lu while settling\n", (long)offsets[i],
+               (unsigned long)errors, TEST_SLICER_BITS, (unsigned long)settling);
+        CHECK(errors == 0);
+    }
+
+    // Speed, against the conversion rate of the analog backend
+    double start = cpu_seconds();
+    for (int r = 0; r < TEST_SLICER_RUNS; r++) {
+        slice(samples, levels);
+    }
+    double seconds = cpu_seconds() - start;
+    double rate = seconds > 0 ? (double)TEST_SLICER_SAMPLES * TEST_SLICER_RUNS / seconds : 0.0;
+    printf("Slicer: %.0f samples/s of CPU time on the host, %.0fx the %d Hz of the ADC\n", rate,
+           rate / PHY_ADC_SAMPLE_FREQ_HZ, PHY_ADC_SAMPLE_FREQ_HZ);
+    CHECK(rate > PHY_ADC_SAMPLE_FREQ_HZ);
+    return HOST_TEST_RESULT();
+}
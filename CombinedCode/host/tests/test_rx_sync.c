@@ -0,0 +1,163 @@
+/**
+ * @file test_rx_sync.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test of the sync-word frame synchronizer for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Builds the ideal trace of a frame of pseudo-random words, flips whole bits of its sync pattern and
+ * checks, for several tolerances, that the frame is still found with up to tolerance flipped bits and that the
+ * pattern is not detected at all with one more. Then times the synchronizer on frames and on noise, where it
+ * correlates every sample, and prints the cost per sample against the sampling period of the sync timer ISR,
+ * RX_PERIOD_MICROS / RX_SYNC_OVERSAMPLING.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "reception/RX_sync.h"
+#include "host_test.h"
+
+/** @brief Words of the frame. */
+#define TEST_SYNC_WORDS 16
+/** @brief Samples of the frame trace. */
+#define TEST_SYNC_MAX_SAMPLES ((2 * RX_DECODER_SYNTH_IDLE_BITS + 64 + (TEST_SYNC_WORDS + 1) * RX_DECODER_WORD_BITS) * RX_SYNC_OVERSAMPLING)
+/** @brief Replays of the frame timed by the benchmark. */
+#define TEST_SYNC_RUNS 20000
+/** @brief Packed words of noise timed by the benchmark. */
+#define TEST_SYNC_NOISE_WORDS 4096
+/** @brief Stride between the flipped sync bits, coprime with every pattern length tested. */
+#define TEST_SYNC_FLIP_STRIDE 7
+
+/**
+ * @brief Gets the next pseudo-random word.
+ *
+ * @param state Pointer to the generator state, not 0.
+ * @return The next word.
+ */
+static uint32_t next_word(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief Gets the CPU time of the process.
+ *
+ * @return Seconds of CPU time.
+ */
+static double cpu_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (double)now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Flips whole bits of the sync pattern of a frame trace.
+ *
+ * @param samples Packed samples of the trace built by rx_sync_synthesize.
+ * @param config Sync pattern of the trace.
+ * @param flips Number of distinct pattern bits to flip.
+ */
+static void flip_sync_bits(uint32_t* samples, const rx_sync_config_t* config, uint32_t flips) {
+    for (uint32_t i = 0; i < flips; i++) {
+        uint32_t bit = (i * TEST_SYNC_FLIP_STRIDE) % config->bits;
+        uint32_t first = (RX_DECODER_SYNTH_IDLE_BITS + bit) * RX_SYNC_OVERSAMPLING;
+        for (uint32_t sample = first; sample < first + RX_SYNC_OVERSAMPLING; sample++) {
+            samples[sample / 32] ^= 1UL << (sample % 32);
+        }
+    }
+}
+
+/**
+ * @brief Sends a frame with some corrupted sync bits through the synchronizer.
+ *
+ * @param config Sync pattern and tolerance.
+ * @param words Words of the frame.
+ * @param flips Number of sync bits to flip.
+ * @param stats Pointer to store the counters.
+ * @return true if every word came back, false otherwise.
+ */
+static bool run_flips(const rx_sync_config_t* config, const uint32_t* words, uint32_t flips, rx_sync_stats_t* stats) {
+    static uint32_t samples[(TEST_SYNC_MAX_SAMPLES + 31) / 32];
+    uint32_t received[TEST_SYNC_WORDS];
+    memset(samples, 0, sizeof(samples));
+    uint32_t sample_count = rx_sync_synthesize(words, TEST_SYNC_WORDS, RX_SYNC_OVERSAMPLING, config, samples,
+                                               TEST_SYNC_MAX_SAMPLES);
+    CHECK(sample_count > 0);
+    flip_sync_bits(samples, config, flips);
+    *stats = (rx_sync_stats_t){0};
+    size_t count = rx_sync_replay(samples, sample_count, RX_SYNC_OVERSAMPLING, config, received, TEST_SYNC_WORDS, stats);
+    return count == TEST_SYNC_WORDS && memcmp(received, words, sizeof(received)) == 0;
+}
+
+/**
+ * @brief Times the synchronizer on a trace and prints its cost per sample against the ISR budget.
+ *
+ * @param name Name of the trace.
+ * @param config Sync pattern and tolerance.
+ * @param samples Packed samples.
+ * @param sample_count Number of samples.
+ * @param runs Number of replays timed.
+ * @return Nanoseconds of CPU time per sample.
+ */
+static double benchmark(const char* name, const rx_sync_config_t* config, const uint32_t* samples,
+                        uint32_t sample_count, int runs) {
+    uint32_t words[TEST_SYNC_WORDS];
+    size_t decoded = 0;
+    double start = cpu_seconds();
+    for (int r = 0; r < runs; r++) {
+        decoded += rx_sync_replay(samples, sample_count, RX_SYNC_OVERSAMPLING, config, words, TEST_SYNC_WORDS, NULL);
+    }
+    double seconds = cpu_seconds() - start;
+    double ns = seconds * 1e9 / ((double)sample_count * runs);
+    double budget_ns = RX_PERIOD_MICROS * 1000.0 / RX_SYNC_OVERSAMPLING;
+    printf("Sync (%s): %.2f ns of CPU time per sample on the host, %.3f%% of the %.0f ns ISR period, %zu words\n",
+           name, ns, 100.0 * ns / budget_ns, budget_ns, decoded);
+    return ns;
+}
+
+int main(void) {
+    uint32_t words[TEST_SYNC_WORDS];
+    uint32_t state = 0x2545F491;
+    for (size_t i = 0; i < TEST_SYNC_WORDS; i++) {
+        words[i] = next_word(&state);
+    }
+
+    // Up to tolerance flipped sync bits are accepted, one more is not
+    rx_sync_config_t config;
+    rx_sync_default_config(&config);
+    const uint8_t tolerances[] = {0, 3, RX_SYNC_TOLERANCE};
+    for (size_t t = 0; t < sizeof(tolerances) / sizeof(tolerances[0]); t++) {
+        config.tolerance = tolerances[t];
+        rx_sync_stats_t stats;
+        for (uint32_t flips = 0; flips <= config.tolerance; flips++) {
+            CHECK(run_flips(&config, words, flips, &stats));
+            CHECK(stats.syncs == 1 && stats.length_errors == 0);
+        }
+        CHECK(!run_flips(&config, words, config.tolerance + 1u, &stats));
+        CHECK(stats.syncs == 0);
+        printf("Tolerance %u: frame found with 0 to %u flipped sync bits, %s with %u\n", config.tolerance,
+               config.tolerance, stats.syncs == 0 ? "rejected" : "FOUND", config.tolerance + 1u);
+    }
+
+    // Cost per sample, locked on frames and hunting in noise
+    rx_sync_default_config(&config);
+    static uint32_t frame[(TEST_SYNC_MAX_SAMPLES + 31) / 32];
+    static uint32_t noise[TEST_SYNC_NOISE_WORDS];
+    uint32_t frame_samples = rx_sync_synthesize(words, TEST_SYNC_WORDS, RX_SYNC_OVERSAMPLING, &config, frame,
+                                                TEST_SYNC_MAX_SAMPLES);
+    for (size_t i = 0; i < TEST_SYNC_NOISE_WORDS; i++) {
+        noise[i] = next_word(&state);
+    }
+    double budget_ns = RX_PERIOD_MICROS * 1000.0 / RX_SYNC_OVERSAMPLING;
+    CHECK(benchmark("frames", &config, frame, frame_samples, TEST_SYNC_RUNS) < budget_ns);
+    CHECK(benchmark("noise", &config, noise, TEST_SYNC_NOISE_WORDS * 32,
+                    (int)((double)TEST_SYNC_RUNS * frame_samples / (TEST_SYNC_NOISE_WORDS * 32)) + 1) < budget_ns);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,163 @@
+/**
+ * @file test_trace.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Host unit test of the scheduling trace dumps for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Writes a synthetic trace of both cores as trace_dump() does and reads it back, then checks the per-core
+ * summary of trace_decode against the spans of the events: task time from switch-in to switch-out or to the last
+ * event, ISR time, console output across a wrap of the cycle counter, and the FreeRTOS queue operations. Checks as
+ * well that the timeline prints one line per event and that dumps with a wrong magic number, a wrong version or cut
+ * short are rejected.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common_utils/trace_file.h"
+#include "host_test.h"
+
+/** @brief Events of core 0: two runs of the RX task around the idle task. */
+static const trace_event_t core0_events[] = {
+    {0, TRACE_EVENT_TASK_IN, 0, TRACE_TASK_RX},
+    {100, TRACE_EVENT_ISR_ENTER, 0, TRACE_ISR_RX_GPIO},
+    {160, TRACE_EVENT_ISR_EXIT, 0, TRACE_ISR_RX_GPIO},
+    {200, TRACE_EVENT_RTOS_SEND, 0, TRACE_QUEUE_JOBS},
+    {250, TRACE_EVENT_RTOS_BLOCK_RECEIVE, 0, TRACE_QUEUE_RX_KEYS},
+    {300, TRACE_EVENT_TASK_OUT, 0, TRACE_TASK_RX},
+    {300, TRACE_EVENT_TASK_IN, 0, TRACE_TASK_IDLE},
+    {1000, TRACE_EVENT_TASK_OUT, 0, TRACE_TASK_IDLE},
+    {1000, TRACE_EVENT_TASK_IN, 0, TRACE_TASK_RX},
+    {1100, TRACE_EVENT_ISR_ENTER, 0, TRACE_ISR_RX_GPIO},
+    {1140, TRACE_EVENT_ISR_EXIT, 0, TRACE_ISR_RX_GPIO},
+    {1200, TRACE_EVENT_QUEUE_PUSH, 0, 1},
+    {1240, TRACE_EVENT_RTOS_RECEIVE, 0, TRACE_QUEUE_RX_KEYS},
+};
+
+/** @brief Events of core 1: the console task, with the cycle counter wrapping during its output. */
+static const trace_event_t core1_events[] = {
+    {0xFFFFFF00, TRACE_EVENT_TASK_IN, 1, TRACE_TASK_CONSOLE},
+    {0xFFFFFF80, TRACE_EVENT_LOG_BEGIN, 1, 0},
+    {0x00000040, TRACE_EVENT_LOG_END, 1, 0},
+    {0x00000080, TRACE_EVENT_RTOS_SEND_FAILED, 1, TRACE_QUEUE_LOG_BATCH},
+    {0x00000090, TRACE_EVENT_QUEUE_POP, 1, 0},
+    {0x00000100, TRACE_EVENT_TASK_OUT, 1, TRACE_TASK_CONSOLE},
+};
+
+/** @brief Number of events of core 0. */
+#define TEST_TRACE_CORE0 (sizeof(core0_events) / sizeof(core0_events[0]))
+/** @brief Number of events of core 1. */
+#define TEST_TRACE_CORE1 (sizeof(core1_events) / sizeof(core1_events[0]))
+
+/**
+ * @brief Reads a whole stream into a word-aligned buffer.
+ *
+ * @param file Stream, read from the start.
+ * @param length Pointer to store the number of bytes.
+ * @return The buffer, to free.
+ */
+static uint32_t* read_all(FILE* file, size_t* length) {
+    fseek(file, 0, SEEK_END);
+    *length = (size_t)ftell(file);
+    rewind(file);
+    uint32_t* data = malloc(*length + sizeof(uint32_t));
+    if (data != NULL && fread(data, 1, *length, file) != *length) {
+        *length = 0;
+    }
+    return data;
+}
+
+/**
+ * @brief Counts the lines of a stream.
+ *
+ * @param file Stream, read from the start.
+ * @return Number of lines.
+ */
+static uint32_t count_lines(FILE* file) {
+    char line[128];
+    uint32_t lines = 0;
+    rewind(file);
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lines++;
+    }
+    return lines;
+}
+
+int main(void) {
+    trace_header_t header = {
+        .magic = TRACE_MAGIC,
+        .version = TRACE_VERSION,
+        .cpu_freq_mhz = 240,
+        .event_count = {TEST_TRACE_CORE0, TEST_TRACE_CORE1},
+        .dropped = {0, 3},
+    };
+    const trace_event_t* const events[TRACE_CORES] = {core0_events, core1_events};
+
+    // Dump and read back
+    FILE* dump = tmpfile();
+    CHECK(dump != NULL);
+    if (dump == NULL) {
+        return HOST_TEST_RESULT();
+    }
+    size_t written = trace_file_write(dump, &header, events);
+    size_t length;
+    uint32_t* data = read_all(dump, &length);
+    fclose(dump);
+    CHECK(data != NULL && length == written);
+    CHECK(written == sizeof(header) + (TEST_TRACE_CORE0 + TEST_TRACE_CORE1) * sizeof(trace_event_t));
+    trace_view_t trace;
+    CHECK(trace_file_parse(data, length, &trace) == ESP_OK);
+    CHECK(memcmp(trace.header, &header, sizeof(header)) == 0);
+    CHECK(memcmp(trace.events[0], core0_events, sizeof(core0_events)) == 0);
+    CHECK(memcmp(trace.events[1], core1_events, sizeof(core1_events)) == 0);
+
+    // Core 0: RX switched in twice, the second time until the last event
+    static trace_summary_t summary;
+    trace_file_summarise(trace.events[0], header.event_count[0], &summary);
+    CHECK(summary.events == TEST_TRACE_CORE0 && summary.window_cycles == 1240);
+    CHECK(summary.task_cycles[TRACE_TASK_RX] == 300 + 240 && summary.task_switches[TRACE_TASK_RX] == 2);
+    CHECK(summary.task_cycles[TRACE_TASK_IDLE] == 700 && summary.task_switches[TRACE_TASK_IDLE] == 1);
+    CHECK(summary.task_switches[TRACE_TASK_CONSOLE] == 0);
+    CHECK(summary.isr_calls[TRACE_ISR_RX_GPIO] == 2 && summary.isr_cycles[TRACE_ISR_RX_GPIO] == 100);
+    CHECK(summary.ring_pushes == 1 && summary.ring_pops == 0);
+    CHECK(summary.queue_ops[TRACE_QUEUE_JOBS][TRACE_EVENT_RTOS_SEND - TRACE_EVENT_RTOS_SEND] == 1);
+    CHECK(summary.queue_ops[TRACE_QUEUE_RX_KEYS][TRACE_EVENT_RTOS_BLOCK_RECEIVE - TRACE_EVENT_RTOS_SEND] == 1);
+    CHECK(summary.queue_ops[TRACE_QUEUE_RX_KEYS][TRACE_EVENT_RTOS_RECEIVE - TRACE_EVENT_RTOS_SEND] == 1);
+
+    // Core 1: spans across the wrap of the cycle counter
+    trace_file_summarise(trace.events[1], header.event_count[1], &summary);
+    CHECK(summary.window_cycles == 0x200);
+    CHECK(summary.task_cycles[TRACE_TASK_CONSOLE] == 0x200 && summary.task_switches[TRACE_TASK_CONSOLE] == 1);
+    CHECK(summary.log_cycles == 0xC0);
+    CHECK(summary.ring_pops == 1);
+    CHECK(summary.queue_ops[TRACE_QUEUE_LOG_BATCH][TRACE_EVENT_RTOS_SEND_FAILED - TRACE_EVENT_RTOS_SEND] == 1);
+    printf("Trace round trip: %zu + %zu events, %zu bytes, core 0 RX %.1f%% CPU\n", TEST_TRACE_CORE0,
+           TEST_TRACE_CORE1, written, 100.0 * 540 / 1240);
+
+    // Timeline: one line per event
+    FILE* timeline = tmpfile();
+    CHECK(timeline != NULL);
+    if (timeline != NULL) {
+        trace_file_print_timeline(timeline, trace.header, trace.events[0], header.event_count[0]);
+        CHECK(count_lines(timeline) == TEST_TRACE_CORE0);
+        fclose(timeline);
+    }
+
+    // Empty core
+    trace_file_summarise(NULL, 0, &summary);
+    CHECK(summary.events == 0 && summary.window_cycles == 0);
+
+    // Corrupted and truncated dumps
+    CHECK(trace_file_parse(data, length - 1, &trace) == ESP_ERR_INVALID_SIZE);
+    CHECK(trace_file_parse(data, sizeof(header) - 1, &trace) == ESP_ERR_INVALID_SIZE);
+    ((trace_header_t*)data)->version++;
+    CHECK(trace_file_parse(data, length, &trace) == ESP_ERR_INVALID_ARG);
+    ((trace_header_t*)data)->version--;
+    data[0] ^= 1;
+    CHECK(trace_file_parse(data, length, &trace) == ESP_ERR_INVALID_ARG);
+    free(data);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,189 @@
+/**
+ * @file capture_host.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Offline analysis of RX captures on the host for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Reads a file holding the bytes written by the capture --dump console command and, with -v, converts
+ * its samples to a Value Change Dump for a waveform viewer; with -e, prints the edge phase histogram of its eye
+ * diagram like capture --eye; with -r, replays its samples into the decoder of the board and prints the words.
+ * With -s, writes instead a dump of the ideal trace of the given words, so the other options can be tried
+ * without a board.
+ *
+ *   capture_host [-v vcd_file] [-e] [-r] dump_file
+ *   capture_host -s word[,word...] [-o oversampling] [-p bit_period_ns] dump_file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "reception/RX_capture_file.h"
+#include "reception/RX_decoder.h"
+
+/** @brief Largest number of words given to -s. */
+#define CAPTURE_HOST_MAX_WORDS 256
+
+/** @brief Largest number of edges listed in a synthetic dump. */
+#define CAPTURE_HOST_MAX_EDGES 4096
+
+/**
+ * @brief Reads a whole file into a word-aligned buffer.
+ *
+ * @param path Path of the file.
+ * @param length Pointer to store the number of bytes.
+ * @return The buffer, to free, or NULL on error.
+ */
+static uint32_t* read_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    uint32_t* data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = malloc((size_t)size + sizeof(uint32_t));
+            if (data != NULL && fread(data, 1, (size_t)size, file) != (size_t)size) {
+                free(data);
+                data = NULL;
+            }
+            *length = (size_t)size;
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+/**
+ * @brief Writes a dump of the ideal trace of some words.
+ *
+ * @param path Path of the dump.
+ * @param list Words, comma-separated, in any base strtoul takes.
+ * @param oversampling Samples per bit period.
+ * @param bit_period_ns Bit period in nanoseconds.
+ * @return 0 on success, 1 on error.
+ */
+static int write_synthetic(const char* path, char* list, uint16_t oversampling, uint32_t bit_period_ns) {
+    uint32_t words[CAPTURE_HOST_MAX_WORDS];
+    size_t word_count = 0;
+    for (char* token = strtok(list, ","); token != NULL && word_count < CAPTURE_HOST_MAX_WORDS; token = strtok(NULL, ",")) {
+        words[word_count++] = (uint32_t)strtoul(token, NULL, 0);
+    }
+    uint32_t max_samples = (uint32_t)word_count * (RX_DECODER_WORD_SAMPLES + 2 * RX_DECODER_SYNTH_IDLE_BITS) * oversampling;
+    uint32_t* samples = calloc(RX_CAPTURE_SAMPLE_WORDS(max_samples), sizeof(uint32_t));
+    uint32_t* edges = malloc(CAPTURE_HOST_MAX_EDGES * sizeof(uint32_t));
+    FILE* out = fopen(path, "wb");
+    int result = 1;
+    if (samples != NULL && edges != NULL && out != NULL) {
+        rx_capture_header_t header = {
+            .magic = RX_CAPTURE_MAGIC,
+            .version = RX_CAPTURE_VERSION,
+            .oversampling = oversampling,
+            .sample_period_ns = bit_period_ns / oversampling,
+            .bit_period_ns = bit_period_ns,
+        };
+        header.sample_count = rx_decoder_synthesize(words, word_count, oversampling, samples, max_samples);
+        header.edge_count = rx_capture_file_find_edges(samples, header.sample_count, edges, CAPTURE_HOST_MAX_EDGES,
+                                                       &header.dropped_edges);
+        size_t written = rx_capture_file_write(out, &header, samples, edges);
+        printf("%zu words, %lu samples, %lu edges: %zu bytes\n", word_count, (unsigned long)header.sample_count,
+               (unsigned long)header.edge_count, written);
+        result = 0;
+    }
+    if (out != NULL) {
+        fclose(out);
+    }
+    free(samples);
+    free(edges);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const char* vcd_path = NULL;
+    char* synth_words = NULL;
+    bool eye = false, replay = false;
+    unsigned long oversampling = 4, bit_period_ns = 1000000;
+    int opt;
+    while ((opt = getopt(argc, argv, "v:ers:o:p:")) != -1) {
+        switch (opt) {
+            case 'v': vcd_path = optarg; break;
+            case 'e': eye = true; break;
+            case 'r': replay = true; break;
+            case 's': synth_words = optarg; break;
+            case 'o': oversampling = strtoul(optarg, NULL, 0); break;
+            case 'p': bit_period_ns = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-v vcd_file] [-e] [-r] dump_file\n"
+                                "       %s -s word[,word...] [-o oversampling] [-p bit_period_ns] dump_file\n",
+                        argv[0], argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1 || oversampling == 0 || oversampling > UINT16_MAX) {
+        fprintf(stderr, "Give one dump file and an oversampling of 1 to %u\n", UINT16_MAX);
+        return 2;
+    }
+    if (synth_words != NULL) {
+        return write_synthetic(argv[optind], synth_words, (uint16_t)oversampling, (uint32_t)bit_period_ns);
+    }
+
+    size_t length = 0;
+    uint32_t* data = read_file(argv[optind], &length);
+    rx_capture_view_t capture;
+    if (data == NULL) {
+        fprintf(stderr, "Could not read %s\n", argv[optind]);
+        return 1;
+    }
+    if (rx_capture_file_parse(data, length, &capture) != ESP_OK) {
+        fprintf(stderr, "%s is not a complete capture dump\n", argv[optind]);
+        free(data);
+        return 1;
+    }
+    const rx_capture_header_t* header = capture.header;
+    printf("Capture: %lu samples at %lu ns, %lu samples per bit, %lu edges, %lu dropped edges\n",
+           (unsigned long)header->sample_count, (unsigned long)header->sample_period_ns,
+           (unsigned long)header->oversampling, (unsigned long)header->edge_count, (unsigned long)header->dropped_edges);
+
+    int result = 0;
+    if (vcd_path != NULL) {
+        FILE* vcd = fopen(vcd_path, "w");
+        if (vcd == NULL) {
+            fprintf(stderr, "Could not write %s\n", vcd_path);
+            result = 1;
+        } else {
+            uint32_t changes = rx_capture_file_write_vcd(vcd, header, capture.samples);
+            fclose(vcd);
+            printf("VCD: %lu value changes written to %s\n", (unsigned long)changes, vcd_path);
+        }
+    }
+    if (eye) {
+        uint32_t* bins = malloc(header->oversampling * sizeof(uint32_t));
+        if (bins != NULL) {
+            rx_capture_file_edge_histogram(header, capture.edges, bins);
+            for (uint32_t i = 0; i < header->oversampling; i++) {
+                printf("Edge phase %lu/%u: %lu\n", (unsigned long)i, header->oversampling, (unsigned long)bins[i]);
+            }
+            free(bins);
+        }
+    }
+    if (replay) {
+        size_t max_words = header->sample_count / ((size_t)RX_DECODER_WORD_SAMPLES * header->oversampling) + 1;
+        uint32_t* words = malloc(max_words * sizeof(uint32_t));
+        rx_decoder_stats_t stats = {0};
+        size_t word_count = words != NULL
+            ? rx_decoder_replay(capture.samples, header->sample_count, header->oversampling, words, max_words, &stats) : 0;
+        for (size_t i = 0; i < word_count; i++) {
+            printf("Word %zu: 0x%08lx\n", i, (unsigned long)words[i]);
+        }
+        printf("Replay: %zu words, %lu false starts, %lu framing errors\n", word_count,
+               (unsigned long)stats.false_starts, (unsigned long)stats.framing_errors);
+        free(words);
+    }
+    free(data);
+    return result;
+}
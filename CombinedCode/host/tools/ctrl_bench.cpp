@@ -0,0 +1,312 @@
+/**
+ * @file ctrl_bench.cpp
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief End-to-end benchmark of the binary control channel against the text console for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Sends the same messages to a board through both channels, one at a time, and times each of them on
+ * the host: on the control port (-c) a TRANSMIT request, its response and its CTRL_MSG_JOB_DONE event; on the
+ * console port (-t) a transmit command line, the "Job <id>: transmit" line and the "Job <id> (transmit) done"
+ * line. Either port may be left out. With -k, sets fixed TX and RX keys through the control channel first, as
+ * both must be set before transmitting.
+ *
+ *   ctrl_bench [-c ctrl_device] [-b ctrl_baud] [-t console_device] [-B console_baud] [-n messages] [-l bytes] [-k]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "client/ctrl_client.hpp"
+
+namespace {
+
+/** @brief Time a job may take before the message is counted as failed, in milliseconds. */
+constexpr int kJobTimeoutMs = 10000;
+
+/** @brief Longest payload the console takes on one transmit command line. */
+constexpr size_t kConsoleMaxBytes = 500;
+
+/**
+ * @brief Latencies and wire bytes of one channel.
+ */
+struct ChannelResult {
+    std::vector<double> ack_micros;     /**< From sending to the acknowledgement of each message */
+    std::vector<double> done_micros;    /**< From sending to the end of the job of each message */
+    double elapsed_micros = 0;          /**< Time of the whole run */
+    size_t bytes_out = 0;               /**< Bytes sent to the board */
+    size_t bytes_in = 0;                /**< Bytes received from the board */
+    int failures = 0;                   /**< Messages refused, failed or timed out */
+};
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Gets the microseconds since a time point.
+ *
+ * @param start The time point.
+ * @return Microseconds elapsed.
+ */
+double micros_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Text console of the board, read line by line.
+ */
+class TextConsole {
+public:
+    TextConsole(const std::string& device, int baud) : port_(device, baud) {}
+
+    /**
+     * @brief Sends a command line.
+     *
+     * @param line Command, without the line ending.
+     * @return Number of bytes sent, 0 on error.
+     */
+    size_t send(const std::string& line) {
+        std::string bytes = line + "\r\n";
+        return port_.write(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()) ? bytes.size() : 0;
+    }
+
+    /**
+     * @brief Reads lines until one contains all the given texts.
+     *
+     * @param needles Texts to find.
+     * @param timeout_ms Maximum time to wait.
+     * @param line Pointer to store the line.
+     * @return true if such a line arrived.
+     */
+    bool wait_line(const std::vector<std::string>& needles, int timeout_ms, std::string* line) {
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (true) {
+            size_t end;
+            while ((end = buffer_.find('\n')) != std::string::npos) {
+                *line = buffer_.substr(0, end);
+                buffer_.erase(0, end + 1);
+                if (std::all_of(needles.begin(), needles.end(),
+                                [&](const std::string& needle) { return line->find(needle) != std::string::npos; })) {
+                    return true;
+                }
+            }
+            int left = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count());
+            uint8_t bytes[256];
+            int count = left > 0 ? port_.read(bytes, sizeof(bytes), left) : 0;
+            if (count <= 0) {
+                return false;
+            }
+            bytes_in_ += static_cast<size_t>(count);
+            buffer_.append(reinterpret_cast<const char*>(bytes), static_cast<size_t>(count));
+        }
+    }
+
+    /**
+     * @brief Bytes received so far.
+     *
+     * @return Number of bytes.
+     */
+    size_t bytes_in() const { return bytes_in_; }
+
+private:
+    vlc::SerialPort port_;  /**< Port of the console */
+    std::string buffer_;    /**< Bytes received and not split into lines yet */
+    size_t bytes_in_ = 0;   /**< Bytes received */
+};
+
+/**
+ * @brief Sets fixed TX and RX keys through the control channel and waits for their warm-up.
+ *
+ * @param client The control channel.
+ * @return true on success.
+ */
+bool configure_keys(vlc::CtrlClient& client) {
+    for (uint8_t rx = 0; rx < 2; rx++) {
+        ctrl_configure_t configure = { rx, 0, 0.1, 0.2, 1000, 0.3, 0.4, 1000 };
+        uint32_t id = 0;
+        esp_err_t result = ESP_FAIL;
+        if (client.configure(configure, &id) != ESP_OK || client.wait_job(id, kJobTimeoutMs, &result) != ESP_OK
+            || result != ESP_OK) {
+            std::fprintf(stderr, "Could not set the %s keys\n", rx ? "RX" : "TX");
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Sends the messages through the control channel.
+ *
+ * @param client The control channel.
+ * @param payload Payload of each message.
+ * @param messages Number of messages.
+ * @return The latencies and wire bytes.
+ */
+ChannelResult run_binary(vlc::CtrlClient& client, const std::string& payload, int messages) {
+    ChannelResult result;
+    uint8_t frame[CTRL_FRAME_MAX];
+    uint8_t status[4 + 4] = {};
+    ctrl_packet_t request = { CTRL_MSG_TRANSMIT, 0, static_cast<uint16_t>(payload.size()),
+                              reinterpret_cast<const uint8_t*>(payload.data()) };
+    ctrl_packet_t response = { CTRL_MSG_TRANSMIT | CTRL_RESPONSE, 0, sizeof(status), status };
+    ctrl_packet_t done = { CTRL_MSG_JOB_DONE, 0, CTRL_JOB_DONE_BYTES, status };
+    const size_t request_bytes = ctrl_frame_build(&request, frame);
+    const size_t reply_bytes = ctrl_frame_build(&response, frame) + ctrl_frame_build(&done, frame);
+
+    auto run_start = Clock::now();
+    for (int m = 0; m < messages; m++) {
+        auto start = Clock::now();
+        uint32_t id = 0;
+        esp_err_t job_result = ESP_FAIL;
+        if (client.transmit(payload, &id) != ESP_OK) {
+            result.failures++;
+            continue;
+        }
+        result.ack_micros.push_back(micros_since(start));
+        if (client.wait_job(id, kJobTimeoutMs, &job_result) != ESP_OK || job_result != ESP_OK) {
+            result.failures++;
+            continue;
+        }
+        result.done_micros.push_back(micros_since(start));
+    }
+    result.elapsed_micros = micros_since(run_start);
+    result.bytes_out = request_bytes * static_cast<size_t>(messages);
+    result.bytes_in = reply_bytes * static_cast<size_t>(messages);
+    return result;
+}
+
+/**
+ * @brief Sends the messages through the text console.
+ *
+ * @param console The console.
+ * @param payload Payload of each message.
+ * @param messages Number of messages.
+ * @return The latencies and wire bytes.
+ */
+ChannelResult run_text(TextConsole& console, const std::string& payload, int messages) {
+    ChannelResult result;
+    size_t bytes_in_start = console.bytes_in();
+    auto run_start = Clock::now();
+    for (int m = 0; m < messages; m++) {
+        auto start = Clock::now();
+        std::string line;
+        size_t sent = console.send("transmit " + payload);
+        result.bytes_out += sent;
+        if (sent == 0 || !console.wait_line({"Job ", ": transmit"}, kJobTimeoutMs, &line)) {
+            result.failures++;
+            continue;
+        }
+        result.ack_micros.push_back(micros_since(start));
+        std::string id = line.substr(line.find("Job ") + 4);
+        id = id.substr(0, id.find(':'));
+        if (!console.wait_line({"Job " + id + " (transmit) "}, kJobTimeoutMs, &line)
+            || line.find(" done ") == std::string::npos) {
+            result.failures++;
+            continue;
+        }
+        result.done_micros.push_back(micros_since(start));
+    }
+    result.elapsed_micros = micros_since(run_start);
+    result.bytes_in = console.bytes_in() - bytes_in_start;
+    return result;
+}
+
+/**
+ * @brief Prints the results of one channel.
+ *
+ * @param name Name of the channel.
+ * @param result Its results.
+ * @param messages Number of messages sent.
+ */
+void print_result(const char* name, const ChannelResult& result, int messages) {
+    auto mean = [](const std::vector<double>& values) {
+        double sum = 0;
+        for (double value : values) {
+            sum += value;
+        }
+        return values.empty() ? 0.0 : sum / values.size();
+    };
+    auto max = [](const std::vector<double>& values) {
+        return values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+    };
+    std::printf("%s: %d messages, %d failed, %.1f messages/s\n", name, messages, result.failures,
+                result.elapsed_micros > 0 ? (messages - result.failures) * 1e6 / result.elapsed_micros : 0.0);
+    std::printf("  acknowledged in %.0f us (max %.0f), done in %.0f us (max %.0f)\n", mean(result.ack_micros),
+                max(result.ack_micros), mean(result.done_micros), max(result.done_micros));
+    std::printf("  %.1f bytes out, %.1f in per message\n", static_cast<double>(result.bytes_out) / messages,
+                static_cast<double>(result.bytes_in) / messages);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string ctrl_device;
+    std::string console_device;
+    int ctrl_baud = 921600;
+    int console_baud = 115200;
+    int messages = 100;
+    size_t bytes = 64;
+    bool keys = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:b:t:B:n:l:k")) != -1) {
+        switch (opt) {
+            case 'c': ctrl_device = optarg; break;
+            case 'b': ctrl_baud = std::atoi(optarg); break;
+            case 't': console_device = optarg; break;
+            case 'B': console_baud = std::atoi(optarg); break;
+            case 'n': messages = std::atoi(optarg); break;
+            case 'l': bytes = std::strtoul(optarg, nullptr, 0); break;
+            case 'k': keys = true; break;
+            default:
+                std::fprintf(stderr, "usage: %s [-c ctrl_device] [-b ctrl_baud] [-t console_device] [-B console_baud] "
+                             "[-n messages] [-l bytes] [-k]\n", argv[0]);
+                return 2;
+        }
+    }
+    if ((ctrl_device.empty() && console_device.empty()) || messages < 1 || bytes < 1 || bytes > kConsoleMaxBytes) {
+        std::fprintf(stderr, "Give -c and/or -t, at least 1 message and 1 to %zu bytes\n", kConsoleMaxBytes);
+        return 2;
+    }
+    if (keys && ctrl_device.empty()) {
+        std::fprintf(stderr, "-k sets the keys through the control channel, give -c\n");
+        return 2;
+    }
+
+    // Letters only, so the console passes the payload as one argument
+    std::string payload(bytes, 'a');
+    for (size_t i = 0; i < bytes; i++) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+
+    try {
+        int failures = 0;
+        if (!ctrl_device.empty()) {
+            vlc::CtrlClient client(ctrl_device, ctrl_baud);
+            if (keys && !configure_keys(client)) {
+                return 1;
+            }
+            ChannelResult result = run_binary(client, payload, messages);
+            print_result("Binary", result, messages);
+            std::printf("  %u frames dropped by the client\n", static_cast<unsigned>(client.frame_errors()));
+            failures += result.failures;
+        }
+        if (!console_device.empty()) {
+            TextConsole console(console_device, console_baud);
+            ChannelResult result = run_text(console, payload, messages);
+            print_result("Text", result, messages);
+            failures += result.failures;
+        }
+        return failures == 0 ? 0 : 1;
+    } catch (const std::runtime_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+}
@@ -0,0 +1,223 @@
+/**
+ * @file sim_sweep_host.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Parameter sweep of the link simulator on the host for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Runs the same grid as the sweep console command, with the same simulator, on one thread per CPU
+ * of the development machine, and prints the same CSV on stdout. With -l, simulates 1 to n links at once
+ * like sweep -l. With -p, prints the rate probe budget of the modeled cost profile like sweep -p. Timings go to
+ * stderr, so the CSV of a given set of arguments is the same as on the board.
+ *
+ *   sim_sweep_host [-s seeds] [-w words] [-b base_seed] [-j threads] [-l links] [-r rounds] [-p]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common_utils/rate_probe.h"
+#include "simulation/link_sim.h"
+
+/**
+ * @brief State shared by the sweep threads.
+ */
+typedef struct {
+    size_t total;                 /**< Number of simulations in the sweep */
+    size_t next;                  /**< Index of the next unclaimed simulation */
+    uint32_t base_seed;           /**< Seed of the first simulation */
+    uint32_t word_count;          /**< Number of words sent by each simulation */
+    uint32_t rounds;              /**< Transfers of each link, for the scaling benchmark */
+    link_sim_result_t* results;   /**< Results, indexed like the grid */
+} host_sweep_t;
+
+/**
+ * @brief State of one sweep thread.
+ */
+typedef struct {
+    host_sweep_t* sweep;          /**< Shared state */
+    uint32_t seed;                /**< Seed of the first transfer, for the scaling benchmark */
+    uint64_t bits_correct;        /**< Payload bits decoded correctly, for the scaling benchmark */
+    uint64_t bit_errors;          /**< Payload bits wrong or lost, for the scaling benchmark */
+    pthread_t thread;             /**< Thread handle */
+} host_worker_t;
+
+/**
+ * @brief Gets a monotonic time.
+ * @return Time in microseconds.
+ */
+static int64_t host_time_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * @brief Sweep thread: claims and runs simulations until the grid is exhausted.
+ * @param arg Pointer to the host_worker_t.
+ * @return NULL.
+ */
+static void* host_sweep_worker(void* arg) {
+    host_sweep_t* sweep = ((host_worker_t*)arg)->sweep;
+    link_sim_workspace_t* workspace = malloc(sizeof(link_sim_workspace_t));
+    size_t index;
+    if (workspace == NULL) {
+        return NULL;
+    }
+    while ((index = __atomic_fetch_add(&sweep->next, 1, __ATOMIC_RELAXED)) < sweep->total) {
+        link_sim_params_t params;
+        link_sim_grid_params(index, sweep->base_seed, sweep->word_count, &params);
+        link_sim_run(&params, workspace, &sweep->results[index]);
+    }
+    free(workspace);
+    return NULL;
+}
+
+/**
+ * @brief Link thread of the scaling benchmark: runs its transfers of the first combination of the grid.
+ * @param arg Pointer to the host_worker_t.
+ * @return NULL.
+ */
+static void* host_link_worker(void* arg) {
+    host_worker_t* worker = (host_worker_t*)arg;
+    link_sim_workspace_t* workspace = malloc(sizeof(link_sim_workspace_t));
+    if (workspace == NULL) {
+        return NULL;
+    }
+    for (uint32_t r = 0; r < worker->sweep->rounds; r++) {
+        link_sim_params_t params;
+        link_sim_result_t result;
+        link_sim_grid_params(0, worker->seed + r, worker->sweep->word_count, &params);
+        link_sim_run(&params, workspace, &result);
+        worker->bits_correct += (uint64_t)result.words_correct * RX_DECODER_WORD_BITS;
+        worker->bit_errors += result.bit_errors;
+    }
+    free(workspace);
+    return NULL;
+}
+
+/**
+ * @brief Starts threads and waits for all of them.
+ * @param workers Threads to run.
+ * @param count Number of threads.
+ * @param routine Function run by every thread.
+ * @return 0 on success, -1 if a thread could not be created.
+ */
+static int host_run_workers(host_worker_t* workers, uint32_t count, void* (*routine)(void*)) {
+    uint32_t started = 0;
+    for (; started < count; started++) {
+        if (pthread_create(&workers[started].thread, NULL, routine, &workers[started]) != 0) {
+            break;
+        }
+    }
+    for (uint32_t k = 0; k < started; k++) {
+        pthread_join(workers[k].thread, NULL);
+    }
+    return started == count ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    host_sweep_t sweep = {0};
+    uint32_t seeds = 1, threads = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN), max_links = 0;
+    bool rate = false;
+    int option;
+    sweep.word_count = 16;
+    sweep.base_seed = 1;
+    sweep.rounds = 20;
+    while ((option = getopt(argc, argv, "s:w:b:j:l:r:p")) != -1) {
+        uint32_t value = optarg != NULL ? (uint32_t)strtoul(optarg, NULL, 0) : 0;
+        switch (option) {
+            case 's': seeds = value; break;
+            case 'w': sweep.word_count = value; break;
+            case 'b': sweep.base_seed = value; break;
+            case 'j': threads = value; break;
+            case 'l': max_links = value; break;
+            case 'r': sweep.rounds = value; break;
+            case 'p': rate = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-s seeds] [-w words] [-b base_seed] [-j threads] [-l links] [-r rounds] [-p]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (rate) {
+        rate_probe_print_model(stdout);
+        return 0;
+    }
+    if (seeds == 0 || threads == 0 || sweep.word_count == 0 || sweep.word_count > LINK_SIM_MAX_WORDS
+        || max_links > SIM_SWEEP_MAX_LINKS) {
+        fprintf(stderr, "seeds and threads must be at least 1, words 1 to %d, links at most %d\n",
+                LINK_SIM_MAX_WORDS, SIM_SWEEP_MAX_LINKS);
+        return 2;
+    }
+
+    uint32_t worker_count = max_links > threads ? max_links : threads;
+    host_worker_t* workers = calloc(worker_count, sizeof(host_worker_t));
+    if (workers == NULL) {
+        return 1;
+    }
+
+    if (max_links != 0) {
+        double single_bps = 0;
+        printf("links,rounds,words,bits_correct,bit_errors,wall_ms,throughput_bps,speedup\n");
+        for (uint32_t n = 1; n <= max_links; n++) {
+            for (uint32_t k = 0; k < n; k++) {
+                workers[k] = (host_worker_t){ .sweep = &sweep, .seed = sweep.base_seed + k * sweep.rounds };
+            }
+            int64_t start = host_time_us();
+            if (host_run_workers(workers, n, host_link_worker) != 0) {
+                fprintf(stderr, "Failed to create the threads of %lu links\n", (unsigned long)n);
+                free(workers);
+                return 1;
+            }
+            int64_t elapsed = host_time_us() - start;
+            uint64_t bits_correct = 0, bit_errors = 0;
+            for (uint32_t k = 0; k < n; k++) {
+                bits_correct += workers[k].bits_correct;
+                bit_errors += workers[k].bit_errors;
+            }
+            double throughput = elapsed > 0 ? bits_correct * 1e6 / (double)elapsed : 0;
+            single_bps = (n == 1) ? throughput : single_bps;
+            printf("%lu,%lu,%lu,%llu,%llu,%.1f,%.1f,%.2f\n", (unsigned long)n, (unsigned long)sweep.rounds,
+                   (unsigned long)sweep.word_count, (unsigned long long)bits_correct, (unsigned long long)bit_errors,
+                   elapsed / 1000.0, throughput, single_bps > 0 ? throughput / single_bps : 0);
+        }
+        free(workers);
+        return 0;
+    }
+
+    sweep.total = link_sim_grid_size(seeds);
+    sweep.results = calloc(sweep.total, sizeof(link_sim_result_t));
+    if (sweep.results == NULL) {
+        fprintf(stderr, "Failed to allocate memory for %zu simulations\n", sweep.total);
+        free(workers);
+        return 1;
+    }
+    for (uint32_t k = 0; k < threads; k++) {
+        workers[k].sweep = &sweep;
+    }
+    int64_t start = host_time_us();
+    int err = host_run_workers(workers, threads, host_sweep_worker);
+    int64_t elapsed = host_time_us() - start;
+    if (err != 0 || sweep.next < sweep.total) {
+        fprintf(stderr, "Failed to run the sweep threads\n");
+        free(sweep.results);
+        free(workers);
+        return 1;
+    }
+
+    link_sim_print_header(stdout);
+    for (size_t i = 0; i < sweep.total; i++) {
+        link_sim_params_t params;
+        link_sim_grid_params(i, sweep.base_seed, sweep.word_count, &params);
+        link_sim_print_row(stdout, &params, &sweep.results[i]);
+    }
+    fprintf(stderr, "%zu simulations on %lu threads in %lld ms\n", sweep.total, (unsigned long)threads, (long long)(elapsed / 1000));
+    free(sweep.results);
+    free(workers);
+    return 0;
+}
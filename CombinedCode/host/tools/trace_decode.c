@@ -0,0 +1,146 @@
+/**
+ * @file trace_decode.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Offline analysis of scheduling traces on the host for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details Reads a file holding the bytes written by the trace --dump console command and prints, for each core,
+ * the CPU share and switches of each task, the calls and cost of each ISR, the console output, the ring buffer
+ * and the operations on each registered FreeRTOS queue, like trace --report on the board. With -t, prints the
+ * timeline of the events as well; with -c, keeps only the given core.
+ *
+ *   trace_decode [-t] [-c core] dump_file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "common_utils/trace_file.h"
+
+/**
+ * @brief Reads a whole file into a word-aligned buffer.
+ *
+ * @param path Path of the file.
+ * @param length Pointer to store the number of bytes.
+ * @return The buffer, to free, or NULL on error.
+ */
+static uint32_t* read_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    uint32_t* data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = malloc((size_t)size + sizeof(uint32_t));
+            if (data != NULL && fread(data, 1, (size_t)size, file) != (size_t)size) {
+                free(data);
+                data = NULL;
+            }
+            *length = (size_t)size;
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+/**
+ * @brief Prints the summary of the events of one core.
+ *
+ * @param header Header of the trace.
+ * @param core The core.
+ * @param summary Summary of its events.
+ */
+static void print_report(const trace_header_t* header, int core, const trace_summary_t* summary) {
+    if (summary->events == 0) {
+        printf("Core %d: no events\n", core);
+        return;
+    }
+    double window = summary->window_cycles;
+    printf("Core %d: %lu events, %lu dropped, %.3f ms window\n", core, (unsigned long)summary->events,
+           (unsigned long)header->dropped[core], window / (header->cpu_freq_mhz * 1000.0));
+    for (int t = 0; t < TRACE_TASK_COUNT; t++) {
+        if (summary->task_switches[t] != 0) {
+            printf("  Task %-8s %5.1f%% CPU, %lu switches in\n", trace_file_task_name(t),
+                   window > 0 ? 100.0 * summary->task_cycles[t] / window : 0.0, (unsigned long)summary->task_switches[t]);
+        }
+    }
+    for (int isr = 0; isr < TRACE_ISR_COUNT; isr++) {
+        if (summary->isr_calls[isr] != 0) {
+            printf("  ISR %-14s %lu calls, %.1f cycles avg, %.2f%% CPU\n", trace_file_isr_name(isr),
+                   (unsigned long)summary->isr_calls[isr], (double)summary->isr_cycles[isr] / summary->isr_calls[isr],
+                   window > 0 ? 100.0 * summary->isr_cycles[isr] / window : 0.0);
+        }
+    }
+    if (summary->log_cycles != 0) {
+        printf("  Console output %.2f%% CPU\n", window > 0 ? 100.0 * summary->log_cycles / window : 0.0);
+    }
+    printf("  Ring buffer: %lu pushes, %lu pops, %lu rejected\n", (unsigned long)summary->ring_pushes,
+           (unsigned long)summary->ring_pops, (unsigned long)summary->ring_full);
+    for (int q = 0; q < TRACE_QUEUE_COUNT; q++) {
+        const uint32_t* ops = summary->queue_ops[q];
+        uint32_t sent = ops[TRACE_EVENT_RTOS_SEND - TRACE_EVENT_RTOS_SEND];
+        uint32_t received = ops[TRACE_EVENT_RTOS_RECEIVE - TRACE_EVENT_RTOS_SEND];
+        uint32_t failed = ops[TRACE_EVENT_RTOS_SEND_FAILED - TRACE_EVENT_RTOS_SEND]
+                        + ops[TRACE_EVENT_RTOS_RECEIVE_FAILED - TRACE_EVENT_RTOS_SEND];
+        uint32_t blocked = ops[TRACE_EVENT_RTOS_BLOCK_SEND - TRACE_EVENT_RTOS_SEND]
+                         + ops[TRACE_EVENT_RTOS_BLOCK_RECEIVE - TRACE_EVENT_RTOS_SEND];
+        if (sent + received + failed + blocked != 0) {
+            printf("  Queue %-14s %lu sent, %lu received, %lu failed, %lu blocked\n", trace_file_queue_name(q),
+                   (unsigned long)sent, (unsigned long)received, (unsigned long)failed, (unsigned long)blocked);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    bool timeline = false;
+    long only_core = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "tc:")) != -1) {
+        switch (opt) {
+            case 't': timeline = true; break;
+            case 'c': only_core = strtol(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-t] [-c core] dump_file\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1 || only_core >= TRACE_CORES) {
+        fprintf(stderr, "Give one dump file and a core below %d\n", TRACE_CORES);
+        return 2;
+    }
+
+    size_t length = 0;
+    uint32_t* data = read_file(argv[optind], &length);
+    trace_view_t trace;
+    if (data == NULL) {
+        fprintf(stderr, "Could not read %s\n", argv[optind]);
+        return 1;
+    }
+    if (trace_file_parse(data, length, &trace) != ESP_OK) {
+        fprintf(stderr, "%s is not a complete trace dump\n", argv[optind]);
+        free(data);
+        return 1;
+    }
+    printf("Trace: %u MHz, %lu + %lu events\n", trace.header->cpu_freq_mhz,
+           (unsigned long)trace.header->event_count[0], (unsigned long)trace.header->event_count[1]);
+
+    static trace_summary_t summary;
+    for (int core = 0; core < TRACE_CORES; core++) {
+        if (only_core >= 0 && core != only_core) {
+            continue;
+        }
+        if (timeline) {
+            trace_file_print_timeline(stdout, trace.header, trace.events[core], trace.header->event_count[core]);
+        }
+        trace_file_summarise(trace.events[core], trace.header->event_count[core], &summary);
+        print_report(trace.header, core, &summary);
+    }
+    free(data);
+    return 0;
+}
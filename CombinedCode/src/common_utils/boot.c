@@ -0,0 +1,143 @@
+/**
+ * @file boot.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the boot sequencing and timing for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the boot event group, the recording of the stage times and the detection of the
+ * time the link became ready.
+ */
+
+#include "boot.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+
+/** @brief Tag for logging boot messages */
+static const char *BOOT_TAG = "BOOT";
+
+/** @brief Event group of the stage and key bits. */
+static EventGroupHandle_t boot_events = NULL;
+
+/** @brief Times of the boot. */
+static boot_times_t boot_times;
+
+/** @brief Protects boot_times. */
+static portMUX_TYPE boot_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void boot_init(void) {
+    int64_t now = esp_timer_get_time();
+    boot_events = xEventGroupCreate();
+    configASSERT(boot_events != NULL);
+    for (int s = 0; s < BOOT_STAGE_COUNT; s++) {
+        boot_times.stages[s].core = -1;
+    }
+    boot_times.stages[BOOT_STAGE_STARTUP].core = (int8_t)esp_cpu_get_core_id();
+    boot_times.stages[BOOT_STAGE_STARTUP].end_micros = now;
+    xEventGroupSetBits(boot_events, BOOT_STAGE_BIT(BOOT_STAGE_STARTUP));
+}
+
+/**
+ * @brief Records the time the link became ready if every stage has ended and both keys are set, and sets
+ * BOOT_BIT_LINK_READY.
+ *
+ * @param bits Bits of the event group after the last change.
+ */
+static void boot_check_link_ready(EventBits_t bits) {
+    const EventBits_t ready = BOOT_BITS_STAGES | BOOT_BIT_TX_KEYS | BOOT_BIT_RX_KEYS;
+    bool first = false;
+    if ((bits & ready) != ready) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&boot_lock);
+    if (boot_times.link_ready_micros == 0) {
+        boot_times.link_ready_micros = now;
+        first = true;
+    }
+    portEXIT_CRITICAL(&boot_lock);
+    if (first) {
+        xEventGroupSetBits(boot_events, BOOT_BIT_LINK_READY);
+        ESP_LOGI(BOOT_TAG, "Link ready %lu ms after boot", (unsigned long)(now / 1000));
+    }
+}
+
+void boot_stage_begin(boot_stage_t stage) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&boot_lock);
+    boot_times.stages[stage].start_micros = now;
+    boot_times.stages[stage].core = (int8_t)esp_cpu_get_core_id();
+    portEXIT_CRITICAL(&boot_lock);
+}
+
+void boot_stage_end(boot_stage_t stage) {
+    int64_t now = esp_timer_get_time();
+    bool init_done;
+    portENTER_CRITICAL(&boot_lock);
+    boot_times.stages[stage].end_micros = now;
+    init_done = true;
+    for (int s = 0; s < BOOT_STAGE_COUNT; s++) {
+        init_done &= (boot_times.stages[s].end_micros != 0 || boot_times.stages[s].skipped);
+    }
+    if (init_done && boot_times.init_micros == 0) {
+        boot_times.init_micros = now;
+    }
+    portEXIT_CRITICAL(&boot_lock);
+    boot_check_link_ready(xEventGroupSetBits(boot_events, BOOT_STAGE_BIT(stage)));
+}
+
+void boot_stage_skip(boot_stage_t stage) {
+    portENTER_CRITICAL(&boot_lock);
+    boot_times.stages[stage].skipped = true;
+    portEXIT_CRITICAL(&boot_lock);
+    boot_stage_end(stage);
+}
+
+void boot_signal(EventBits_t bits) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&boot_lock);
+    if ((bits & BOOT_BIT_TX_KEYS) && boot_times.tx_keys_micros == 0) {
+        boot_times.tx_keys_micros = now;
+    }
+    if ((bits & BOOT_BIT_RX_KEYS) && boot_times.rx_keys_micros == 0) {
+        boot_times.rx_keys_micros = now;
+    }
+    portEXIT_CRITICAL(&boot_lock);
+    boot_check_link_ready(xEventGroupSetBits(boot_events, bits));
+}
+
+esp_err_t boot_wait(EventBits_t bits, TickType_t timeout) {
+    EventBits_t set = xEventGroupWaitBits(boot_events, bits, pdFALSE, pdTRUE, timeout);
+    return ((set & bits) == bits) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+bool boot_done(EventBits_t bits) {
+    return (xEventGroupGetBits(boot_events) & bits) == bits;
+}
+
+void boot_get_times(boot_times_t* times) {
+    portENTER_CRITICAL(&boot_lock);
+    *times = boot_times;
+    portEXIT_CRITICAL(&boot_lock);
+}
+
+const char* boot_stage_name(boot_stage_t stage) {
+    static const char* const names[BOOT_STAGE_COUNT] = {
+        "startup", "power", "nvs", "console", "tx phy", "rate probe", "rx phy"
+    };
+    return (stage < BOOT_STAGE_COUNT) ? names[stage] : "?";
+}
+
+void boot_nvs_init(void) {
+    boot_stage_begin(BOOT_STAGE_NVS);
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
+    boot_stage_end(BOOT_STAGE_NVS);
+}
@@ -0,0 +1,152 @@
+/**
+ * @file boot.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the boot sequencing and timing for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the stages of the boot, from app_main() to a link ready to carry frames, and the
+ * event group the tasks wait on instead of polling flags. Each stage records its start and end times and the
+ * core it ran on, and sets its bit in the event group when it ends; stages run by different tasks overlap.
+ *
+ * The link is ready once every stage has ended and both the TX and the RX keys are set, which is the time
+ * reported as time to link-ready. Times are from the start of esp_timer, so the ROM and second-stage bootloader
+ * are not included.
+ */
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+#include "common_utils/config.h"
+
+/**
+ * @brief Stages of the boot.
+ */
+typedef enum {
+    BOOT_STAGE_STARTUP,         /**< From esp_timer start to app_main() */
+    BOOT_STAGE_POWER,           /**< Frequency scaling and power management locks */
+    BOOT_STAGE_NVS,             /**< NVS flash partition */
+    BOOT_STAGE_CONSOLE,         /**< Logging, command registration and REPL start */
+    BOOT_STAGE_TX_PHY,          /**< TX side of every PHY backend */
+    BOOT_STAGE_RATE_PROBE,      /**< Bit rate probe */
+    BOOT_STAGE_RX_PHY,          /**< RX side of every PHY backend and the probed bit period */
+    BOOT_STAGE_COUNT,
+} boot_stage_t;
+
+/** @brief Bit set in the boot event group once a stage has ended. */
+#define BOOT_STAGE_BIT(stage) ((EventBits_t)1 << (stage))
+
+/** @brief Bits of all the stages. */
+#define BOOT_BITS_STAGES (BOOT_STAGE_BIT(BOOT_STAGE_COUNT) - 1)
+
+/** @brief Bit set once the TX keys are set. */
+#define BOOT_BIT_TX_KEYS BOOT_STAGE_BIT(BOOT_STAGE_COUNT)
+
+/** @brief Bit set once the RX keys are set. */
+#define BOOT_BIT_RX_KEYS BOOT_STAGE_BIT(BOOT_STAGE_COUNT + 1)
+
+/** @brief Bit set once every stage has ended and both keys are set. */
+#define BOOT_BIT_LINK_READY BOOT_STAGE_BIT(BOOT_STAGE_COUNT + 2)
+
+/**
+ * @brief Times of one stage.
+ */
+typedef struct {
+    int64_t start_micros;       /**< Time the stage started, 0 if it has not */
+    int64_t end_micros;         /**< Time the stage ended, 0 if it has not */
+    int8_t core;                /**< Core the stage ran on, -1 if it has not started */
+    bool skipped;               /**< The stage is disabled in this build */
+} boot_stage_times_t;
+
+/**
+ * @brief Times of the boot.
+ */
+typedef struct {
+    boot_stage_times_t stages[BOOT_STAGE_COUNT];    /**< Times of each stage */
+    int64_t init_micros;        /**< Time the last stage ended, 0 if one has not */
+    int64_t tx_keys_micros;     /**< Time the TX keys were first set, 0 if they have not */
+    int64_t rx_keys_micros;     /**< Time the RX keys were first set, 0 if they have not */
+    int64_t link_ready_micros;  /**< Time the link became ready, 0 if it has not */
+} boot_times_t;
+
+/**
+ * @brief Creates the boot event group and records the startup stage. Called first in app_main().
+ */
+void boot_init(void);
+
+/**
+ * @brief Records the start of a stage on the calling core.
+ *
+ * @param stage Stage starting.
+ */
+void boot_stage_begin(boot_stage_t stage);
+
+/**
+ * @brief Records the end of a stage and sets its bit.
+ *
+ * @param stage Stage ending.
+ */
+void boot_stage_end(boot_stage_t stage);
+
+/**
+ * @brief Marks a stage disabled in this build as ended, with no duration.
+ *
+ * @param stage Stage to skip.
+ */
+void boot_stage_skip(boot_stage_t stage);
+
+/**
+ * @brief Sets bits of the boot event group, recording the time of the key bits the first time they are set.
+ *
+ * @param bits BOOT_BIT_TX_KEYS and/or BOOT_BIT_RX_KEYS.
+ */
+void boot_signal(EventBits_t bits);
+
+/**
+ * @brief Waits until all the given bits are set.
+ *
+ * @param bits Bits to wait for.
+ * @param timeout Maximum time to wait, portMAX_DELAY for no limit.
+ * @return ESP_OK once the bits are set, ESP_ERR_TIMEOUT otherwise.
+ */
+esp_err_t boot_wait(EventBits_t bits, TickType_t timeout);
+
+/**
+ * @brief Checks whether all the given bits are set, without waiting.
+ *
+ * @param bits Bits to check.
+ * @return true if they are all set.
+ */
+bool boot_done(EventBits_t bits);
+
+/**
+ * @brief Reads the times of the boot.
+ *
+ * @param times Pointer to store the times.
+ */
+void boot_get_times(boot_times_t* times);
+
+/**
+ * @brief Gets the name of a stage.
+ *
+ * @param stage Stage of the boot.
+ * @return The name.
+ */
+const char* boot_stage_name(boot_stage_t stage);
+
+/**
+ * @brief Initialises the NVS flash partition, erasing it if it is full or from a newer NVS version, as the
+ * BOOT_STAGE_NVS stage.
+ */
+void boot_nvs_init(void);
+
+#endif /* BOOT_H */
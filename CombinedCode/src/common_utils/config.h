@@ -1,166 +1,908 @@
-/**
- * @file config.h
- * @author Ricardo Jorge Dias Sampaio
- * @brief Project-wide configuration constants and defines for the Secure VLC Project
- * @version 1.0
- * @date 2024-09-03 
- * \par License:
- *   \ref mit_license "MIT License".
- * @details This file contains various configuration parameters and constants used throughout the Secure VLC Project,
- * including GPIO pin assignments, timer settings, and buffer sizes.
- */
-
-#ifndef CONFIG_H
-#define CONFIG_H
-
-#include "driver/gpio.h"
-#include "soc/gpio_periph.h"
-#include "soc/gpio_reg.h"
-#include "soc/gpio_struct.h"
-
-
-// GPIO Configuration
-/**
- * @brief GPIO pin number used for transmission (TX) output.
- *
- * This macro defines the GPIO pin number used for the TX output in the project.
- */
-#define TX_GPIO_PIN_NUM       GPIO_NUM_6
-
-/**
- * @brief GPIO pin mask for the TX bundle.
- *
- * This macro creates a bitmask for the TX GPIO pin. The pin is the first in the bundle.
- */
-#define TX_GPIO_PIN_SEL (1ULL << TX_GPIO_PIN_NUM)
-
-/**
- * @brief GPIO pin number used for reception (RX) input.
- *
- * This macro defines the GPIO pin number used for the RX input in the project.
- */
-#define RX_GPIO_PIN_NUM       GPIO_NUM_7
-
-/**
- * @brief GPIO pin selection bitmask for the RX input pin.
- *
- * This macro creates a 64-bit bitmask with only the RX_GPIO_PIN_NUM bit set.
- */
-#define RX_GPIO_PIN_SEL  (1ULL << RX_GPIO_PIN_NUM)
-
-// Timer Configuration
-/**
- * @brief TX toggling period in microseconds.
- *
- * This macro defines the period for toggling the TX signal in microseconds.
- */
-#define TX_PERIOD_MICROS 20
-
-/**
- * @brief Period for reception in microseconds.
- *
- * This macro defines the period for reception, set to be the same as the TX period.
- */
-#define RX_PERIOD_MICROS TX_PERIOD_MICROS
-
-/**
- * @brief Timer resolution in Hz.
- *
- * This macro sets the timer resolution in Hertz for the project.
- */
-#define TIMER_RESOLUTION_HZ 1000000
-
-/**
- * @brief Timer interrupt priority.
- *
- * This macro sets the priority level for timer interrupts in the project.
- */
-#define TIMER_INTERRUPTION_PRIORITY 3
-
-// Interrupt Configuration
-/**
- * @brief Default interrupt flag.
- *
- * This macro defines the default interrupt flag for the project.
- */
-#define INTR_LEVEL ESP_INTR_FLAG_LEVEL2
-
-// Buffer and Console Configuration
-/**
- * @brief Maximum size of the ring buffer.
- *
- * This macro defines the maximum number of elements that can be stored in the ring buffer.
- */
-#define BUFFER_MAX_SIZE 128
-
-/**
- * @brief Maximum length of a command line in the console.
- *
- * This macro defines the maximum length of a command line, set to four times the buffer size.
- */
-#define MAX_CMDLINE_LENGTH BUFFER_MAX_SIZE * 4
-
-/**
- * @brief Maximum length of data that can be processed.
- *
- * This macro defines the maximum length of data that can be processed, set to be the same as the maximum command line length.
- */
-#define MAX_DATA_LENGTH MAX_CMDLINE_LENGTH
-
-/**
- * @brief Prompt string for the console.
- *
- * This macro defines the prompt string to be displayed in the console.
- */
-#define PROMPT_STR CONFIG_IDF_TARGET " >"
-
-// Task Configuration
-/**
- * @brief Defines the core on which the Console and Logging task will run.
- *
- * This macro specifies the core number for the Console and Logging task execution.
- * It's used to pin the Console and Logging task to a specific core for better performance management.
- */
-#define CONSOLE_TASK_CORE 0
-
-/**
- * @brief Defines the stack size in bytes for the Console and Logging task.
- *
- * This macro sets the stack size in bytes allocated for the Console and Logging task.
- * Ensure this value is sufficient for the task's memory requirements.
- */
-#define CONSOLE_STACK_SIZE 16384
-
-/**
- * @brief Defines the core on which the TX task will run.
- *
- * This macro specifies the core number for the TX task execution.
- * It's used to pin the TX task to a specific core for better performance management.
- */
-#define TX_TASK_CORE 0
-
-/**
- * @brief Defines the stack size in bytes for the TX task.
- *
- * This macro sets the stack size in bytes allocated for the TX task.
- * Ensure this value is sufficient for the task's memory requirements.
- */
-#define TX_STACK_SIZE 16384
-
-/**
- * @brief Defines the core on which the RX task will run.
- *
- * This macro specifies the core number for the RX task execution.
- * It's used to pin the RX task to a specific core, separate from the TX task.
- */
-#define RX_TASK_CORE 1
-
-/**
- * @brief Defines the stack size in bytes for the RX task.
- *
- * This macro sets the stack size in bytes allocated for the RX task.
- * Ensure this value is sufficient for the task's memory requirements.
- */
-#define RX_STACK_SIZE 16384
-
+/**
+ * @file config.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Project-wide configuration constants and defines for the Secure VLC Project
+ * @version 1.0
+ * @date 2024-09-03 
+ * \par License:
+ *   \ref mit_license "MIT License".
+ * @details This file contains various configuration parameters and constants used throughout the Secure VLC Project,
+ * including GPIO pin assignments, timer settings, and buffer sizes. The driver headers are only included on the
+ * target (ESP_PLATFORM), so the host build can share the constants of the codecs and the simulator.
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#ifdef ESP_PLATFORM
+#include "driver/gpio.h"
+#include "soc/gpio_periph.h"
+#include "soc/gpio_reg.h"
+#include "soc/gpio_struct.h"
+#endif
+
+
+// GPIO Configuration
+/**
+ * @brief GPIO pin number used for transmission (TX) output.
+ *
+ * This macro defines the GPIO pin number used for the TX output in the project.
+ */
+#define TX_GPIO_PIN_NUM       GPIO_NUM_6
+
+/**
+ * @brief GPIO pin mask for the TX bundle.
+ *
+ * This macro creates a bitmask for the TX GPIO pin. The pin is the first in the bundle.
+ */
+#define TX_GPIO_PIN_SEL (1ULL << TX_GPIO_PIN_NUM)
+
+/**
+ * @brief GPIO pin number used for reception (RX) input.
+ *
+ * This macro defines the GPIO pin number used for the RX input in the project.
+ */
+#define RX_GPIO_PIN_NUM       GPIO_NUM_7
+
+/**
+ * @brief GPIO pin selection bitmask for the RX input pin.
+ *
+ * This macro creates a 64-bit bitmask with only the RX_GPIO_PIN_NUM bit set.
+ */
+#define RX_GPIO_PIN_SEL  (1ULL << RX_GPIO_PIN_NUM)
+
+/**
+ * @brief Maximum number of photodiode inputs of the receive-diversity mode.
+ */
+#define RX_DIVERSITY_MAX_BRANCHES 4
+
+/**
+ * @brief Number of photodiode inputs sampled by the receiver, 1 to RX_DIVERSITY_MAX_BRANCHES.
+ *
+ * With 1, the receiver only uses RX_GPIO_PIN_NUM and diversity combining is off.
+ */
+#define RX_DIVERSITY_BRANCHES 1
+
+/**
+ * @brief GPIO pin numbers of the photodiode inputs, branch 0 first.
+ *
+ * Only the first RX_DIVERSITY_BRANCHES entries are used. They are read together by the RX bundle,
+ * so branch b is bit b of every read.
+ */
+#define RX_DIVERSITY_GPIO_PINS {RX_GPIO_PIN_NUM, GPIO_NUM_15, GPIO_NUM_16, GPIO_NUM_17}
+
+/**
+ * @brief Number of samples after which the diversity combiner re-chooses its selected branch.
+ */
+#define RX_DIVERSITY_WINDOW_SAMPLES 128
+
+// Timer Configuration
+/**
+ * @brief TX toggling period in microseconds.
+ *
+ * This macro defines the period for toggling the TX signal in microseconds. It is the period until the boot
+ * rate probe replaces it (RATE_PROBE_BOOT_ENABLE).
+ */
+#define TX_PERIOD_MICROS 20
+
+/**
+ * @brief Period for reception in microseconds.
+ *
+ * This macro defines the period for reception, set to be the same as the TX period.
+ */
+#define RX_PERIOD_MICROS TX_PERIOD_MICROS
+
+/**
+ * @brief Timer resolution in Hz.
+ *
+ * This macro sets the timer resolution in Hertz for the project.
+ */
+#define TIMER_RESOLUTION_HZ 1000000
+
+/**
+ * @brief Clock source of the bit timers.
+ *
+ * The crystal does not follow frequency scaling, so the bit timing holds while the CPU clock changes,
+ * and unlike APB it takes no lock forbidding light sleep while the timers are enabled.
+ */
+#define TIMER_CLOCK_SOURCE GPTIMER_CLK_SRC_XTAL
+
+/**
+ * @brief Enables the hardware glitch filter on the RX pin.
+ *
+ * When set to 1, pulses shorter than two IO MUX clock cycles are removed before they can
+ * trigger a start edge. Longer noise is rejected by the mid-bit start bit check.
+ */
+#define RX_GLITCH_FILTER_ENABLE 1
+
+/**
+ * @brief Timer interrupt priority.
+ *
+ * This macro sets the priority level for timer interrupts in the project.
+ */
+#define TIMER_INTERRUPTION_PRIORITY 3
+
+// PHY Configuration
+/**
+ * @brief Maximum duration in milliseconds of a PHY benchmark run.
+ */
+#define PHY_BENCH_TIMEOUT_MS 10000
+
+/**
+ * @brief NVS namespace written over and over by the flash stress test, and erased after it.
+ */
+#define PHY_FLASH_STRESS_NVS_NAMESPACE "vlc_stress"
+
+/**
+ * @brief Size in bytes of the blob committed by each write of the flash stress test.
+ *
+ * Large enough to span several flash words, so the NVS pages fill and get erased during a run.
+ */
+#define PHY_FLASH_STRESS_BLOB_BYTES 1024
+
+/**
+ * @brief Default number of frames sent by each run of the flash stress test.
+ */
+#define PHY_FLASH_STRESS_FRAMES 100
+
+// Sync Configuration
+/**
+ * @brief Sync pattern of the sync-word framing mode, sent most significant bit first.
+ *
+ * The default is a 63-bit maximal-length sequence followed by a zero: it differs from every
+ * shifted copy of itself, and from the idle line, in at least 19 bits.
+ */
+#define RX_SYNC_PATTERN 0xFC10C53D1C96ECD4ULL
+
+/**
+ * @brief Number of bits of RX_SYNC_PATTERN used, 1 to 64.
+ */
+#define RX_SYNC_PATTERN_BITS 64
+
+/**
+ * @brief Maximum number of sync pattern bits that may be corrupted for a frame to be detected.
+ */
+#define RX_SYNC_TOLERANCE 6
+
+/**
+ * @brief Number of samples per bit period taken by the sync-word receiver.
+ */
+#define RX_SYNC_OVERSAMPLING 4
+
+/**
+ * @brief Timer resolution in Hz of the sync-word PHY.
+ *
+ * A finer resolution than TIMER_RESOLUTION_HZ is needed so the sampling period
+ * can be a fraction of the bit period.
+ */
+#define PHY_SYNC_RESOLUTION_HZ 10000000
+
+// Edge RX Configuration
+/**
+ * @brief Number of RX pin edges the ISR can queue for the RX task, a power of two.
+ *
+ * A word has at most 34 edges, so the default holds about 30 words of alternating bits.
+ */
+#define RX_EDGES_QUEUE_SIZE 1024
+
+// ADC Configuration
+/**
+ * @brief ADC unit sampling the analog photodiode output.
+ */
+#define PHY_ADC_UNIT ADC_UNIT_1
+
+/**
+ * @brief ADC channel sampling the analog photodiode output (ADC1 channel 3 is GPIO4 on the ESP32-S3).
+ */
+#define PHY_ADC_CHANNEL ADC_CHANNEL_3
+
+/**
+ * @brief Attenuation of the ADC input, setting its full-scale voltage.
+ */
+#define PHY_ADC_ATTEN ADC_ATTEN_DB_12
+
+/**
+ * @brief ADC conversions per second in continuous mode.
+ *
+ * The ESP32-S3 converts at most about 83 kHz, so the analog backend runs at a
+ * slower bit rate than the GPIO backends.
+ */
+#define PHY_ADC_SAMPLE_FREQ_HZ 80000
+
+/**
+ * @brief Bit period in microseconds of the analog backend at boot.
+ *
+ * Must give between 3 and RX_SYNC_MAX_OVERSAMPLING conversions per bit.
+ */
+#define PHY_ADC_PERIOD_MICROS 50
+
+/**
+ * @brief Number of conversions handed over by the DMA at a time.
+ */
+#define PHY_ADC_FRAME_SAMPLES 256
+
+/**
+ * @brief Number of conversions the ADC driver can hold between two polls.
+ */
+#define PHY_ADC_BUFFER_SAMPLES 4096
+
+/**
+ * @brief Number of samples sharing one threshold in the adaptive slicer.
+ */
+#define RX_SLICER_BLOCK_SAMPLES 32
+
+/**
+ * @brief Smallest peak-to-peak swing, in ADC counts, for a slicer block to be taken as carrying both levels.
+ *
+ * Flatter blocks only move the threshold with the ambient light.
+ */
+#define RX_SLICER_MIN_SWING 300
+
+/**
+ * @brief Time constant of the slicer level trackers, as a power of two of blocks.
+ */
+#define RX_SLICER_TRACK_SHIFT 2
+
+// Shaping Configuration
+/**
+ * @brief Time constant in nanoseconds of the LED turning on, used to precompute the pre-emphasis table.
+ */
+#define TX_SHAPING_LED_RISE_NS 1000
+
+/**
+ * @brief Time constant in nanoseconds of the LED turning off, used to precompute the pre-emphasis table.
+ *
+ * The phosphor of white LEDs keeps glowing after the current stops, so the fall is the slower edge.
+ */
+#define TX_SHAPING_LED_FALL_NS 3000
+
+/**
+ * @brief Enables pre-emphasis on the rmt backend at boot.
+ */
+#define TX_SHAPING_ENABLE 1
+
+/**
+ * @brief Resolution in Hz of the RMT channel driving the TX pin.
+ */
+#define PHY_RMT_RESOLUTION_HZ 10000000
+
+/**
+ * @brief Number of symbols of RMT channel memory, refilled from the frame while it is sent.
+ */
+#define PHY_RMT_MEM_BLOCK_SYMBOLS 64
+
+// Calibration Configuration
+/**
+ * @brief Word sent over and over while the receiver calibrates its sampling instant.
+ *
+ * It holds isolated ones and zeros as well as runs of four and eight bits, so both
+ * short pulses and pulses stretched by the LED are checked.
+ */
+#define RX_CAL_TRAINING_WORD 0x5A0FF0A5
+
+/**
+ * @brief Number of training words that must arrive intact for a sampling offset to be taken as error-free.
+ */
+#define RX_CAL_WORDS_PER_STEP 32
+
+/**
+ * @brief Maximum number of sampling offsets tried by a calibration sweep, one microsecond apart at short bit periods.
+ */
+#define RX_CAL_MAX_STEPS 32
+
+/**
+ * @brief Maximum time in milliseconds spent waiting for the training words of one sampling offset.
+ */
+#define RX_CAL_STEP_TIMEOUT_MS 2000
+
+/**
+ * @brief Time in milliseconds left after moving the sampling instant for words sampled before to drain.
+ */
+#define RX_CAL_SETTLE_MS 30
+
+/**
+ * @brief NVS namespace holding the calibration of every peer.
+ */
+#define RX_CAL_NVS_NAMESPACE "vlc_cal"
+
+// Frame Configuration
+/**
+ * @brief Enables the per-frame authentication tag.
+ *
+ * When set to 1, transmitted frames carry a truncated HMAC-SHA256 of their ciphertext
+ * and received frames without a valid tag are rejected before delivery.
+ */
+#define FRAME_AUTH_ENABLE 1
+
+// Capture Configuration
+/**
+ * @brief Number of raw samples taken per RX bit period while a capture is running.
+ *
+ * The capture timer period is derived from this value and RX_PERIOD_MICROS.
+ */
+#define RX_CAPTURE_OVERSAMPLING 4
+
+/**
+ * @brief Capture timer resolution in Hz.
+ *
+ * A finer resolution than TIMER_RESOLUTION_HZ is needed so the capture period
+ * can be a fraction of the RX bit period.
+ */
+#define RX_CAPTURE_RESOLUTION_HZ 10000000
+
+/**
+ * @brief Maximum number of raw samples stored by one capture.
+ *
+ * Samples are packed one bit per sample, so the default uses 32 KB of RAM (or PSRAM when available).
+ */
+#define RX_CAPTURE_MAX_SAMPLES (256 * 1024)
+
+/**
+ * @brief Maximum number of edge timestamps stored by one capture.
+ */
+#define RX_CAPTURE_MAX_EDGES 4096
+
+// Simulation Configuration
+/**
+ * @brief Number of samples per bit period used by the link simulator channel.
+ */
+#define LINK_SIM_OVERSAMPLING 8
+
+/**
+ * @brief Maximum number of words sent by one simulated link.
+ */
+#define LINK_SIM_MAX_WORDS 64
+
+/**
+ * @brief ADC reading with the LED off and no ambient light in the simulated analog front end.
+ */
+#define LINK_SIM_ADC_DARK 500
+
+/**
+ * @brief ADC swing between the LED off and on in the simulated analog front end.
+ */
+#define LINK_SIM_ADC_SWING 1000
+
+/**
+ * @brief Peak ADC contribution of the flickering ambient light in the simulated analog front end.
+ *
+ * It exceeds half the swing, so a fixed threshold cannot slice the signal.
+ */
+#define LINK_SIM_ADC_AMBIENT 1200
+
+/**
+ * @brief Frequency of the ambient light flicker in the simulated analog front end (mains lighting).
+ */
+#define LINK_SIM_ADC_FLICKER_HZ 100
+
+/**
+ * @brief Standard deviation of the ADC noise in the simulated analog front end, in ADC counts.
+ */
+#define LINK_SIM_ADC_SIGMA 40
+
+/**
+ * @brief Stack size in bytes for each parameter sweep worker task.
+ *
+ * The traces and words of the simulations are in a link_sim_workspace_t on the heap, the stack only holds the
+ * state of the LED, channel and decoders.
+ */
+#define SIM_WORKER_STACK_SIZE 8192
+
+/**
+ * @brief Largest number of simulated links of the link scaling benchmark, each a worker with a workspace on the
+ * heap.
+ */
+#define SIM_SWEEP_MAX_LINKS 16
+
+// Trace Configuration
+/**
+ * @brief Enables the scheduling trace hooks.
+ *
+ * When set to 0 the hooks compile to nothing.
+ */
+#define TRACE_ENABLE 1
+
+/**
+ * @brief Number of trace events stored per core.
+ */
+#define TRACE_BUFFER_EVENTS 2048
+
+// Profiler Configuration
+/**
+ * @brief Enables the cycle-budget profiler around the keystream and crypto hot path.
+ *
+ * When set to 0 the probes compile to nothing. When set to 1 they cost one branch
+ * until profiling is started from the console.
+ */
+#define PROFILER_ENABLE 1
+
+// Power Configuration
+/**
+ * @brief CPU frequency in MHz while a frame is in flight or keys are generated.
+ */
+#define POWER_CPU_MAX_MHZ 240
+
+/**
+ * @brief CPU frequency in MHz while the link is idle, the crystal frequency.
+ */
+#define POWER_CPU_MIN_MHZ 40
+
+/**
+ * @brief Enables light sleep while the link is idle, woken by a low level on the RX pins.
+ *
+ * Can be changed at runtime from the console.
+ */
+#define POWER_LIGHT_SLEEP_ENABLE 1
+
+/**
+ * @brief Assumes the peer may light-sleep while the link is idle, so a frame sent after the hold time starts
+ * with a wake preamble.
+ *
+ * Independent of POWER_LIGHT_SLEEP_ENABLE, which only concerns this device. Set to 0 when the peer never
+ * sleeps. Can be changed at runtime from the console.
+ */
+#define POWER_PEER_LIGHT_SLEEP 1
+
+/**
+ * @brief Time in milliseconds a side of the link stays awake after its last word, on top of one longest frame.
+ */
+#define POWER_IDLE_HOLD_MS 50
+
+/**
+ * @brief Longest time in milliseconds an idle task blocks before checking the link again.
+ */
+#define POWER_IDLE_POLL_MS 1000
+
+/**
+ * @brief Duration in microseconds of the low level sent ahead of a frame when the peer may be asleep.
+ *
+ * Must exceed the wake-up latency of the receiver, see the power command.
+ */
+#define POWER_WAKE_PREAMBLE_MICROS 3000
+
+/**
+ * @brief Supply voltage in millivolts used by the energy estimate.
+ *
+ * The estimate is a model: the time in each state times the currents below, which are typical figures,
+ * not measured on the board.
+ */
+#define POWER_SUPPLY_MV 3300
+
+/**
+ * @brief Current in microamperes while the link is active, both cores at POWER_CPU_MAX_MHZ.
+ */
+#define POWER_ACTIVE_UA 45000
+
+/**
+ * @brief Current in microamperes while the link is idle and awake, at POWER_CPU_MIN_MHZ.
+ */
+#define POWER_IDLE_UA 15000
+
+/**
+ * @brief Current in microamperes in light sleep.
+ */
+#define POWER_SLEEP_UA 240
+
+// RX Loop Configuration
+/**
+ * @brief Rate of received words, per second, from which the RX loop busy-polls the PHY instead of waiting for
+ * a notification per wake-up.
+ *
+ * The TX ISR of the peer sends the words it has queued back to back, 34 bit periods each, so a frame arrives
+ * at the line rate, about 1470 words per second at TX_PERIOD_MICROS. The default is half that rate at
+ * TX_PERIOD_MICROS, 36 words over a RX_LOOP_WINDOW_MS window: single frames are received in the notify mode,
+ * and the loop only polls while frames stream in.
+ */
+#define RX_LOOP_POLL_ENTER_WPS (1000000 / (34 * TX_PERIOD_MICROS) / 2)
+
+/**
+ * @brief Window in milliseconds over which the rate of received words is measured.
+ */
+#define RX_LOOP_WINDOW_MS 50
+
+/**
+ * @brief Time in milliseconds without a word after which the busy-polling RX loop goes back to notifications.
+ *
+ * Longer than the 10 ms the TX task of the peer waits between two bursts of queued words, so the loop stays
+ * in the poll mode while frames stream in.
+ */
+#define RX_LOOP_POLL_EXIT_MS 30
+
+/**
+ * @brief Interval in milliseconds at which the notify mode of the RX loop polls backends that decode in the RX
+ * task and so do not notify it (rx_notifies). The RX task waits for the others without a timeout.
+ */
+#define RX_LOOP_WAIT_MS 10
+
+/**
+ * @brief Longest time in milliseconds the RX loop busy-polls before blocking for one tick, so the idle task
+ * of its core still runs and feeds the task watchdog.
+ */
+#define RX_LOOP_POLL_SLICE_MS 50
+
+// RX Pipeline Configuration
+/**
+ * @brief Number of received words the RX ISRs can queue for the decode task, a power of two.
+ *
+ * The ISRs and the decode task share the queue without a lock, so they may run on different cores.
+ */
+#define RX_PIPELINE_QUEUE_SIZE 256
+
+/**
+ * @brief Largest number of words the decode task drains from the RX queue at a time.
+ */
+#define RX_PIPELINE_BATCH_WORDS 32
+
+// Rate Probe Configuration
+/**
+ * @brief Runs the rate probe at boot and logs the bit period it finds.
+ *
+ * The period is not applied: the boards of a link would start at different rates whenever their probes
+ * disagree, so TX_PERIOD_MICROS stays in use until the freq -p command is run on both boards.
+ */
+#define RATE_PROBE_BOOT_ENABLE 1
+
+/**
+ * @brief Resolution in Hz of the timer measuring the ISR entry latency, the highest the APB clock allows.
+ */
+#define RATE_PROBE_TIMER_HZ 40000000
+
+/**
+ * @brief Alarm period of the ISR entry latency measurement, in ticks of RATE_PROBE_TIMER_HZ.
+ */
+#define RATE_PROBE_ISR_PERIOD_TICKS 400
+
+/**
+ * @brief Number of alarms over which the ISR entry latency is measured.
+ */
+#define RATE_PROBE_ISR_SAMPLES 1000
+
+/**
+ * @brief Number of keys generated to time the key generator.
+ */
+#define RATE_PROBE_KEYGEN_WORDS 256
+
+/**
+ * @brief Number of push and pop pairs timed on a ring buffer.
+ */
+#define RATE_PROBE_QUEUE_OPS 1024
+
+/**
+ * @brief Cycles of the body of the RX timer ISR per bit, on top of its entry and return.
+ *
+ * Modeled rather than measured, from the rx_isr_cycles of a gptimer backend receiving at full rate.
+ */
+#define RATE_PROBE_ISR_BODY_CYCLES 150
+
+/**
+ * @brief Largest ISR entry latency, as a percentage of the bit period.
+ *
+ * A late sample stays within the middle half of its bit.
+ */
+#define RATE_PROBE_JITTER_PERCENT 25
+
+/**
+ * @brief Largest share, in percent, of the RX core taken by the per-bit interrupts.
+ */
+#define RATE_PROBE_ISR_LOAD_PERCENT 50
+
+/**
+ * @brief Largest share, in percent, of the decode core taken by the key generation and queueing of each word.
+ */
+#define RATE_PROBE_TASK_LOAD_PERCENT 50
+
+/**
+ * @brief Margin, in percent, added to the shortest bit period the costs allow.
+ */
+#define RATE_PROBE_MARGIN_PERCENT 50
+
+/**
+ * @brief Shortest bit period in microseconds the probe picks, whatever the costs.
+ */
+#define RATE_PROBE_MIN_PERIOD_MICROS 4
+
+/**
+ * @brief Bit periods in microseconds the probe picks from, in increasing order.
+ *
+ * The probe rounds its bound up to the next one, so two boards whose costs differ slightly still agree on the
+ * period; a bound past the last one is kept as it is.
+ */
+#define RATE_PROBE_PERIODS_MICROS {4, 5, 10, 20, 25, 50, 100, 200, 500, 1000}
+
+/**
+ * @brief Modeled average ISR entry latency in cycles, used by the simulator.
+ */
+#define RATE_PROBE_MODEL_ISR_ENTRY_CYCLES 360
+
+/**
+ * @brief Modeled longest ISR entry latency in cycles, used by the simulator.
+ */
+#define RATE_PROBE_MODEL_ISR_ENTRY_MAX_CYCLES 720
+
+/**
+ * @brief Modeled cycles per key of each map, in the order of map_type_t, used by the simulator.
+ *
+ * The maps iterate in software double precision, which the ESP32-S3 FPU does not handle.
+ */
+#define RATE_PROBE_MODEL_KEYGEN_CYCLES {5200, 2100, 4300}
+
+/**
+ * @brief Modeled cycles of one push and one pop of a ring buffer, lock included, used by the simulator.
+ */
+#define RATE_PROBE_MODEL_QUEUE_CYCLES 80
+
+// Link Configuration
+/**
+ * @brief Maximum number of link instances, the console link (index 0) included.
+ *
+ * Every running link takes two of the four general-purpose timers of the ESP32-S3, so only one extra link runs
+ * next to the console link, and only while no other backend or capture holds a timer.
+ */
+#define VLC_LINK_MAX 2
+
+/**
+ * @brief TX pins of the links, the console link first.
+ */
+#define VLC_LINK_TX_GPIO_PINS {TX_GPIO_PIN_NUM, GPIO_NUM_8}
+
+/**
+ * @brief RX pins of the links, the console link first. The extra links have no diversity branches.
+ */
+#define VLC_LINK_RX_GPIO_PINS {RX_GPIO_PIN_NUM, GPIO_NUM_9}
+
+/**
+ * @brief Stack size in bytes for the task of each extra link.
+ */
+#define VLC_LINK_STACK_SIZE 8192
+
+// Boot Configuration
+/**
+ * @brief Maximum time in milliseconds a command using NVS waits for the NVS partition to be initialised.
+ *
+ * NVS is initialised by app_main() while the console starts, so a command typed right at boot may run first.
+ */
+#define BOOT_NVS_WAIT_MS 2000
+
+// Job Configuration
+/**
+ * @brief Number of console jobs kept in the job table, queued, running or ended. At most 24.
+ */
+#define JOB_MAX 8
+
+/**
+ * @brief Number of worker tasks running console jobs.
+ */
+#define JOB_WORKERS 2
+
+/**
+ * @brief Core the worker tasks are pinned to, the core of the RX ISRs, which preempt them, rather than that of
+ * the RX decode task, so long jobs do not delay the decoding of frames.
+ */
+#define JOB_WORKER_CORE RX_TASK_CORE
+
+/**
+ * @brief Stack size in bytes for each worker task, as for the console task the jobs come from.
+ */
+#define JOB_STACK_SIZE CONSOLE_STACK_SIZE
+
+/**
+ * @brief Maximum size in bytes of the arguments copied into a job.
+ */
+#define JOB_ARG_BYTES MAX_DATA_LENGTH
+
+/**
+ * @brief Size of the name of a job, terminator included.
+ */
+#define JOB_NAME_LENGTH 16
+
+// Control Configuration
+/**
+ * @brief Enables the binary control channel on its own UART, alongside the text console.
+ */
+#define CTRL_ENABLE 1
+
+/**
+ * @brief UART of the binary control channel. The console keeps UART0.
+ */
+#define CTRL_UART_NUM UART_NUM_1
+
+/**
+ * @brief GPIO pin number of the control channel TX line.
+ */
+#define CTRL_UART_TX_GPIO GPIO_NUM_1
+
+/**
+ * @brief GPIO pin number of the control channel RX line.
+ */
+#define CTRL_UART_RX_GPIO GPIO_NUM_2
+
+/**
+ * @brief Baud rate of the control channel.
+ */
+#define CTRL_UART_BAUD 921600
+
+/**
+ * @brief Size in bytes of each of the RX and TX buffers of the control UART driver.
+ */
+#define CTRL_UART_BUFFER_BYTES 4096
+
+/**
+ * @brief Number of received frames waiting to be sent as notifications. Further frames are dropped and counted.
+ */
+#define CTRL_NOTIFY_QUEUE_SIZE 8
+
+/**
+ * @brief Core the control task is pinned to, next to the console rather than the RX ISRs.
+ */
+#define CTRL_TASK_CORE CONSOLE_TASK_CORE
+
+/**
+ * @brief Stack size in bytes for the control task.
+ */
+#define CTRL_STACK_SIZE 8192
+
+/**
+ * @brief Maximum time in milliseconds the control task waits for UART input before sending notifications and
+ * checking its jobs.
+ */
+#define CTRL_POLL_MS 10
+
+// Interrupt Configuration
+/**
+ * @brief Default interrupt flag.
+ *
+ * This macro defines the default interrupt flag for the project.
+ */
+#define INTR_LEVEL ESP_INTR_FLAG_LEVEL2
+
+/**
+ * @brief Flags of the GPIO ISR service.
+ *
+ * The service is placed in IRAM so the edge interrupts are still served while the flash cache is disabled by
+ * NVS or OTA writes; every handler it dispatches to must be IRAM_ATTR.
+ */
+#define GPIO_ISR_FLAGS (INTR_LEVEL | ESP_INTR_FLAG_IRAM)
+
+// Buffer and Console Configuration
+/**
+ * @brief Maximum size of the ring buffer.
+ *
+ * This macro defines the maximum number of elements that can be stored in the ring buffer.
+ */
+#define BUFFER_MAX_SIZE 128
+
+/**
+ * @brief Maximum length of a command line in the console.
+ *
+ * This macro defines the maximum length of a command line, set to four times the buffer size.
+ */
+#define MAX_CMDLINE_LENGTH BUFFER_MAX_SIZE * 4
+
+/**
+ * @brief Maximum length of data that can be processed.
+ *
+ * This macro defines the maximum length of data that can be processed, set to be the same as the maximum command line length.
+ */
+#define MAX_DATA_LENGTH MAX_CMDLINE_LENGTH
+
+/**
+ * @brief Prompt string for the console.
+ *
+ * This macro defines the prompt string to be displayed in the console.
+ */
+#define PROMPT_STR CONFIG_IDF_TARGET " >"
+
+/**
+ * @brief Console output is batched from boot.
+ *
+ * Off by default: lines still batched when the firmware aborts are lost, the last error before a panic among
+ * them, while a restart flushes them. Turn it on with the log command for sustained RX logging. The console
+ * transport is chosen with CONFIG_ESP_CONSOLE_* in menuconfig: UART, USB Serial/JTAG or USB CDC.
+ */
+#define LOG_BATCH_ENABLE_DEFAULT false
+
+/**
+ * @brief Size in bytes of each of the two console output buffers.
+ */
+#define LOG_BATCH_BUFFER_BYTES 4096
+
+/**
+ * @brief Bytes of console output after which a buffer is written out.
+ */
+#define LOG_BATCH_FLUSH_BYTES 2048
+
+/**
+ * @brief Maximum time in milliseconds a line waits in a buffer that is not full.
+ */
+#define LOG_BATCH_FLUSH_MS 20
+
+/**
+ * @brief Maximum time in milliseconds a restart waits for the batched lines to be written.
+ */
+#define LOG_BATCH_SHUTDOWN_MS 200
+
+/**
+ * @brief Stack size in bytes for the task writing the console output.
+ */
+#define LOG_BATCH_STACK_SIZE 4096
+
+/**
+ * @brief Default number of lines logged by each run of the console output benchmark.
+ */
+#define LOG_BENCH_LINES 200
+
+/**
+ * @brief Default number of words in each hex dump line of the console output benchmark.
+ */
+#define LOG_BENCH_WORDS 32
+
+// Task Configuration
+/**
+ * @brief Defines the core on which the Console and Logging task will run.
+ *
+ * This macro specifies the core number for the Console and Logging task execution.
+ * It's used to pin the Console and Logging task to a specific core for better performance management.
+ */
+#define CONSOLE_TASK_CORE 0
+
+/**
+ * @brief Defines the stack size in bytes for the Console and Logging task.
+ *
+ * This macro sets the stack size in bytes allocated for the Console and Logging task.
+ * Ensure this value is sufficient for the task's memory requirements.
+ */
+#define CONSOLE_STACK_SIZE 16384
+
+/**
+ * @brief Defines the core on which the TX task will run.
+ *
+ * This macro specifies the core number for the TX task execution.
+ * It's used to pin the TX task to a specific core for better performance management.
+ */
+#define TX_TASK_CORE 0
+
+/**
+ * @brief Defines the stack size in bytes for the TX task.
+ *
+ * This macro sets the stack size in bytes allocated for the TX task.
+ * Ensure this value is sufficient for the task's memory requirements.
+ */
+#define TX_STACK_SIZE 16384
+
+/**
+ * @brief Defines the core on which the RX task will run.
+ *
+ * This macro specifies the core number for the RX task execution.
+ * It's used to pin the RX task to a specific core, separate from the TX task.
+ */
+#define RX_TASK_CORE 1
+
+/**
+ * @brief Defines the stack size in bytes for the RX task.
+ *
+ * This macro sets the stack size in bytes allocated for the RX task.
+ * Ensure this value is sufficient for the task's memory requirements.
+ */
+#define RX_STACK_SIZE 16384
+
+/**
+ * @brief Defines the core on which the RX decode task will run, the other core than the RX ISRs.
+ *
+ * The RX task sets up the RX side, so the RX ISRs sample on RX_TASK_CORE, then hands over to the decode task,
+ * which drains the received words and assembles, authenticates and decrypts the frames. Words arrive back
+ * to back at the line rate, so the decode task runs on the other core: the RX ISRs never wait behind its
+ * critical sections on their core, nor preempt it, and the lock-free queue carries the words across. To
+ * leave it room next to the TX task and ISRs, the console and the control channel, the job workers run on
+ * RX_TASK_CORE (JOB_WORKER_CORE).
+ */
+#define RX_DECODE_TASK_CORE (!RX_TASK_CORE)
+
+/**
+ * @brief Stack size in bytes for the RX decode task.
+ *
+ * The largest frames are formatted on the stack, as text and as hex, next to the HMAC of mbedtls and a batch
+ * of words.
+ */
+#define RX_DECODE_STACK_SIZE 8192
+
 #endif // CONFIG_H
\ No newline at end of file
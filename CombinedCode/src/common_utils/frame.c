@@ -0,0 +1,150 @@
+/**
+ * @file frame.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of framing and frame authentication for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of frame building, header parsing, frame assembly and
+ * the per-frame HMAC-SHA256 authentication tag.
+ */
+
+#include "frame.h"
+
+/**
+ * @brief Combines four bytes into a 32-bit unsigned integer.
+ * 
+ * @param b0 Least significant byte
+ * @param b1 Second byte
+ * @param b2 Third byte
+ * @param b3 Most significant byte
+ * @return uint32_t Combined 32-bit unsigned integer
+ */
+static uint32_t combineCharsToUint32(unsigned char b0, unsigned char b1, unsigned char b2, unsigned char b3) {
+    return  ((uint32_t)b3 << 24) | 
+            ((uint32_t)b2 << 16) | 
+            ((uint32_t)b1 << 8)  | 
+            (uint32_t)b0;
+}
+
+bool frame_header_parse(uint32_t header, uint16_t* payload_words, uint8_t* flags) {
+    *payload_words = (uint16_t)(header & 0xFFFF);
+    *flags = (uint8_t)((header >> 16) & 0xFF);
+    return ((header >> 24) == FRAME_MARKER) && (*payload_words <= FRAME_MAX_PAYLOAD_WORDS);
+}
+
+size_t frame_build(encryption_vars_t* vars, const char* str, bool authenticate, uint32_t* frame) {
+    size_t len = strlen(str);
+    size_t payload_words = (len + 3) / 4;
+    if (payload_words > FRAME_MAX_PAYLOAD_WORDS) {
+        return 0;
+    }
+    uint8_t flags = authenticate ? FRAME_FLAG_AUTH : 0;
+    uint64_t key_index = vars->key_index;
+    frame[0] = frame_header_build((uint16_t)payload_words, flags) ^ key_generator(vars);
+
+    for (size_t w = 0, i = 0; w < payload_words; w++, i += 4) {
+        PROFILE_BEGIN(pack_start);
+        uint32_t plain = combineCharsToUint32((unsigned char)str[i],
+                                              (i + 1 < len) ? (unsigned char)str[i + 1] : 0,
+                                              (i + 2 < len) ? (unsigned char)str[i + 2] : 0,
+                                              (i + 3 < len) ? (unsigned char)str[i + 3] : 0);
+        PROFILE_END(PROFILE_PACK, pack_start);
+        uint32_t key = key_generator(vars);
+        PROFILE_BEGIN(xor_start);
+        frame[1 + w] = plain ^ key;
+        PROFILE_END(PROFILE_XOR, xor_start);
+    }
+
+    if (authenticate) {
+        if (frame_auth_tag(vars->mac_key, key_index, frame, 1 + payload_words, &frame[1 + payload_words]) != ESP_OK) {
+            return 0;
+        }
+        frame_skip_keys(vars, FRAME_TAG_WORDS);
+    }
+    return frame_total_words((uint16_t)payload_words, flags);
+}
+
+void frame_skip_keys(encryption_vars_t* vars, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        key_generator(vars);
+    }
+}
+
+esp_err_t frame_auth_tag(const uint8_t key[MAC_KEY_BYTES], uint64_t key_index, const uint32_t* words, size_t count,
+                         uint32_t tag[FRAME_TAG_WORDS]) {
+    uint8_t digest[32];
+    uint8_t index_bytes[sizeof(key_index)];
+    for (size_t i = 0; i < sizeof(index_bytes); i++) {
+        index_bytes[i] = (uint8_t)(key_index >> (8 * i));
+    }
+    mbedtls_md_context_t context;
+    mbedtls_md_init(&context);
+    PROFILE_BEGIN(mac_start);
+    int ret = mbedtls_md_setup(&context, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    if (ret == 0) ret = mbedtls_md_hmac_starts(&context, key, MAC_KEY_BYTES);
+    if (ret == 0) ret = mbedtls_md_hmac_update(&context, index_bytes, sizeof(index_bytes));
+    if (ret == 0) ret = mbedtls_md_hmac_update(&context, (const unsigned char*)words, count * sizeof(uint32_t));
+    if (ret == 0) ret = mbedtls_md_hmac_finish(&context, digest);
+    PROFILE_END_BYTES(PROFILE_MAC, mac_start, count * sizeof(uint32_t));
+    mbedtls_md_free(&context);
+    if (ret != 0) {
+        return ESP_FAIL;
+    }
+    memcpy(tag, digest, FRAME_TAG_WORDS * sizeof(uint32_t));
+    return ESP_OK;
+}
+
+bool frame_auth_verify(const uint8_t key[MAC_KEY_BYTES], uint64_t key_index, const uint32_t* words, size_t count,
+                       const uint32_t tag[FRAME_TAG_WORDS]) {
+    uint32_t expected[FRAME_TAG_WORDS];
+    if (frame_auth_tag(key, key_index, words, count, expected) != ESP_OK) {
+        return false;
+    }
+    uint32_t diff = 0;
+    for (int i = 0; i < FRAME_TAG_WORDS; i++) {
+        diff |= expected[i] ^ tag[i];
+    }
+    return diff == 0;
+}
+
+void frame_assembler_reset(frame_assembler_t* assembler) {
+    assembler->received = 0;
+    assembler->expected = 0;
+}
+
+frame_assembler_status_t frame_assembler_push(frame_assembler_t* assembler, encryption_vars_t* vars, uint32_t word) {
+    if (assembler->expected == 0 || assembler->received == assembler->expected) {
+        assembler->key_index = vars->key_index;
+        assembler->header = word ^ key_generator(vars);
+        if (!frame_header_parse(assembler->header, &assembler->payload_words, &assembler->flags)) {
+            assembler->expected = 0;
+            return FRAME_ASSEMBLER_INVALID_HEADER;
+        }
+        assembler->expected = frame_total_words(assembler->payload_words, assembler->flags);
+        assembler->received = 0;
+    }
+    assembler->words[assembler->received++] = word;
+    return (assembler->received == assembler->expected) ? FRAME_ASSEMBLER_COMPLETE : FRAME_ASSEMBLER_PENDING;
+}
+
+bool frame_open(const frame_assembler_t* assembler, encryption_vars_t* vars, uint32_t* payload) {
+    uint16_t payload_words = assembler->payload_words;
+    bool authentic = (assembler->flags & FRAME_FLAG_AUTH)
+                   ? frame_auth_verify(vars->mac_key, assembler->key_index, assembler->words, 1 + payload_words, &assembler->words[1 + payload_words])
+                   : !FRAME_AUTH_ENABLE;
+    for (uint16_t i = 0; i < payload_words; i++) {
+        uint32_t key = key_generator(vars);
+        if (authentic) {
+            PROFILE_BEGIN(xor_start);
+            payload[i] = assembler->words[1 + i] ^ key;
+            PROFILE_END(PROFILE_XOR, xor_start);
+        }
+    }
+    if (assembler->flags & FRAME_FLAG_AUTH) {
+        frame_skip_keys(vars, FRAME_TAG_WORDS);
+    }
+    return authentic;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file frame.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for framing and frame authentication for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the frame format and of the per-frame authentication tag.
+ * A frame is a sequence of words sent back to back:
+ * - one encrypted header word: payload length in words (bits 0..15), flags (bits 16..23) and FRAME_MARKER (bits 24..31);
+ * - the encrypted payload words;
+ * - FRAME_TAG_WORDS tag words when FRAME_FLAG_AUTH is set, holding a truncated HMAC-SHA256 of the keystream index of the
+ *   header and of the header and payload ciphertext.
+ *
+ * The tag is computed once per frame over the ciphertext (encrypt-then-MAC) with the key derived by key_generator_setup().
+ * The keystream index, the number of keys both ends generated before the header, is authenticated as a little-endian
+ * 64-bit prefix: it is not sent, so a frame recorded and played back later, or moved within the stream, fails its tag
+ * even though the MAC key never changes.
+ *
+ * Every word on the link consumes exactly one key on both sides, tag words included: they are sent in the clear and
+ * their keys are discarded. The keystream position is therefore the number of words seen, whatever they were, and a
+ * receiver that fails to parse a header resynchronises by taking every following word as a candidate header, one key
+ * each, until one parses. A corrupted but valid-looking header only misplaces the frame boundaries, never the keys.
+ * mbedtls uses the SHA accelerator on the ESP32-S3 and its software implementation on a host; host builds without
+ * mbedtls use the stand-in of CombinedCode/host/compat instead.
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "mbedtls/md.h"
+
+#include "common_utils/config.h"
+#include "common_utils/encryption.h"
+#include "common_utils/profiler.h"
+
+/** @brief Marker stored in the top byte of every frame header. */
+#define FRAME_MARKER 0xA5
+
+/** @brief Header flag set when the frame carries an authentication tag. */
+#define FRAME_FLAG_AUTH 0x01
+
+/** @brief Number of words of the authentication tag. */
+#define FRAME_TAG_WORDS 2
+
+/** @brief Maximum number of payload words, so a whole frame fits in the ring buffer. */
+#define FRAME_MAX_PAYLOAD_WORDS (BUFFER_MAX_SIZE - 1 - FRAME_TAG_WORDS)
+
+/** @brief Maximum number of words of a frame. */
+#define FRAME_MAX_WORDS (1 + FRAME_MAX_PAYLOAD_WORDS + FRAME_TAG_WORDS)
+
+/**
+ * @brief Builds a plaintext frame header.
+ *
+ * @param payload_words Number of payload words.
+ * @param flags Frame flags.
+ * @return uint32_t The header word.
+ */
+static inline uint32_t frame_header_build(uint16_t payload_words, uint8_t flags) {
+    return ((uint32_t)FRAME_MARKER << 24) | ((uint32_t)flags << 16) | payload_words;
+}
+
+/**
+ * @brief Result of pushing a word into a frame assembler.
+ */
+typedef enum {
+    FRAME_ASSEMBLER_PENDING,            /**< The frame is not complete yet */
+    FRAME_ASSEMBLER_COMPLETE,           /**< The word completed a frame */
+    FRAME_ASSEMBLER_INVALID_HEADER,     /**< The word was expected to be a header and was dropped */
+} frame_assembler_status_t;
+
+/**
+ * @brief State of the assembly of received words into a frame, one per receiver.
+ */
+typedef struct {
+    uint32_t words[FRAME_MAX_WORDS];    /**< Ciphertext of the frame, header included */
+    size_t received;                    /**< Words of the frame received so far */
+    size_t expected;                    /**< Words of the frame, 0 while waiting for a header */
+    uint32_t header;                    /**< Plaintext of the last header word */
+    uint64_t key_index;                 /**< Keystream index of the last header word */
+    uint16_t payload_words;             /**< Payload words of the frame */
+    uint8_t flags;                      /**< Flags of the frame */
+} frame_assembler_t;
+
+/**
+ * @brief Parses a plaintext frame header.
+ *
+ * @param header The header word.
+ * @param payload_words Pointer to store the number of payload words.
+ * @param flags Pointer to store the frame flags.
+ * @return true if the header is valid, false otherwise.
+ */
+bool frame_header_parse(uint32_t header, uint16_t* payload_words, uint8_t* flags);
+
+/**
+ * @brief Gets the total number of words of a frame from its header fields.
+ *
+ * @param payload_words Number of payload words.
+ * @param flags Frame flags.
+ * @return size_t Number of words, header and tag included.
+ */
+static inline size_t frame_total_words(uint16_t payload_words, uint8_t flags) {
+    return 1 + payload_words + ((flags & FRAME_FLAG_AUTH) ? FRAME_TAG_WORDS : 0);
+}
+
+/**
+ * @brief Builds an encrypted frame from a string.
+ *
+ * The string is packed into words four bytes at a time, least significant byte first,
+ * and every word, header included, is XORed with the next key.
+ *
+ * @param vars Pointer to the encryption variables, advanced by one key per word of the frame.
+ * @param str The string to send.
+ * @param authenticate true to append an authentication tag.
+ * @param frame Array of at least FRAME_MAX_WORDS words to store the frame.
+ * @return Number of words of the frame, 0 if the string is too long.
+ */
+size_t frame_build(encryption_vars_t* vars, const char* str, bool authenticate, uint32_t* frame);
+
+/**
+ * @brief Discards keys for words that are not encrypted, such as the tag words.
+ *
+ * @param vars Pointer to the encryption variables.
+ * @param count Number of keys to discard.
+ */
+void frame_skip_keys(encryption_vars_t* vars, size_t count);
+
+/**
+ * @brief Computes the authentication tag of a frame.
+ *
+ * @param key Authentication key.
+ * @param key_index Keystream index of the header word.
+ * @param words Header and payload ciphertext.
+ * @param count Number of words.
+ * @param tag Array to store the tag.
+ * @return ESP_OK on success, ESP_FAIL if the HMAC could not be computed.
+ */
+esp_err_t frame_auth_tag(const uint8_t key[MAC_KEY_BYTES], uint64_t key_index, const uint32_t* words, size_t count,
+                         uint32_t tag[FRAME_TAG_WORDS]);
+
+/**
+ * @brief Verifies the authentication tag of a frame in constant time.
+ *
+ * @param key Authentication key.
+ * @param key_index Keystream index of the header word.
+ * @param words Header and payload ciphertext.
+ * @param count Number of words.
+ * @param tag Received tag.
+ * @return true if the tag is valid, false otherwise.
+ */
+bool frame_auth_verify(const uint8_t key[MAC_KEY_BYTES], uint64_t key_index, const uint32_t* words, size_t count,
+                       const uint32_t tag[FRAME_TAG_WORDS]);
+
+/**
+ * @brief Clears a frame assembler, dropping any partial frame.
+ *
+ * @param assembler Pointer to the assembler.
+ */
+void frame_assembler_reset(frame_assembler_t* assembler);
+
+/**
+ * @brief Adds a received word to the frame being assembled.
+ *
+ * The header is decrypted as soon as it arrives to learn the frame length. An invalid
+ * header is dropped on its own with its key, as the transmitter consumed one key per word. Once a frame
+ * is complete, it stays in the assembler until the next word is pushed.
+ *
+ * @param assembler Pointer to the assembler.
+ * @param vars Pointer to the encryption variables of the receiver, advanced by one key per header.
+ * @param word The received word.
+ * @return The status of the frame.
+ */
+frame_assembler_status_t frame_assembler_push(frame_assembler_t* assembler, encryption_vars_t* vars, uint32_t word);
+
+/**
+ * @brief Checks the tag of a complete frame and decrypts its payload.
+ *
+ * Frames without a tag are rejected when FRAME_AUTH_ENABLE is set. A rejected frame still consumes
+ * one key per payload and tag word, so the keystream stays in step with the transmitter.
+ *
+ * @param assembler Pointer to the assembler holding a complete frame.
+ * @param vars Pointer to the encryption variables of the receiver.
+ * @param payload Array of at least FRAME_MAX_PAYLOAD_WORDS words to store the plaintext payload.
+ * @return true if the frame was accepted and decrypted, false otherwise.
+ */
+bool frame_open(const frame_assembler_t* assembler, encryption_vars_t* vars, uint32_t* payload);
+
+#endif /* FRAME_H */
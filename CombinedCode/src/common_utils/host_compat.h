@@ -0,0 +1,50 @@
+/**
+ * @file host_compat.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Stand-ins for the ESP-IDF attributes, error codes and logging on host builds for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details The codecs, decoders and the simulator are also compiled by the host build (CombinedCode/host) for
+ * unit tests and benchmarks. Their headers include this file instead of esp_attr.h: on the target it pulls in
+ * the ESP-IDF headers, elsewhere it defines the section attributes away, declares the error codes and sends the
+ * logs to stderr.
+ */
+
+#ifndef HOST_COMPAT_H
+#define HOST_COMPAT_H
+
+#ifdef ESP_PLATFORM
+
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "esp_log.h"
+
+#else
+
+#include <stdio.h>
+
+/** @brief Error codes of esp_err.h, with the same values. */
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_TIMEOUT 0x107
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) fprintf(stderr, "I (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) do { (void)(tag); } while (0)
+
+#endif /* ESP_PLATFORM */
+
+#endif /* HOST_COMPAT_H */
@@ -0,0 +1,439 @@
+/**
+ * @file power.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the power management of the link for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the lock handling of both sides of the link, the wake-up of the RX side
+ * on its pins and the time accounting behind the energy estimate.
+ */
+
+#include "power.h"
+#include "phy/phy.h"
+#include "phy/phy_pins.h"
+#include "reception/RX_loop.h"
+
+/** @brief Tag for logging power management messages */
+static const char *POWER_TAG = "POWER";
+
+/** @brief Period in microseconds of the timer wake-ups of power_measure_timer_wake(). */
+#define POWER_WAKE_TEST_MICROS 100000
+
+/** @brief Max-CPU lock of each side. */
+static esp_pm_lock_handle_t power_cpu_locks[POWER_SIDE_COUNT];
+
+/** @brief No-light-sleep lock of each side. */
+static esp_pm_lock_handle_t power_awake_locks[POWER_SIDE_COUNT];
+
+/** @brief Max-CPU lock of key generation bursts. */
+static esp_pm_lock_handle_t power_burst_lock;
+
+/** @brief Side holding its locks. */
+static bool power_held[POWER_SIDE_COUNT];
+
+/** @brief Light sleep is enabled. */
+static volatile bool power_light_sleep = false;
+
+/** @brief The peer may light-sleep, see POWER_PEER_LIGHT_SLEEP. */
+static volatile bool power_peer_light_sleep = POWER_PEER_LIGHT_SLEEP;
+
+/** @brief Protects the lock flags and the time accounting. */
+static portMUX_TYPE power_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/** @brief Counters, the wake-up ones only written by the RX task. */
+static power_stats_t power_stats;
+
+/** @brief Time of power_init(). */
+static int64_t power_start_micros;
+
+/** @brief Time up to which power_stats is accounted. */
+static int64_t power_account_micros;
+
+/** @brief TX task, woken by power_tx_activity(). */
+static TaskHandle_t power_tx_task = NULL;
+
+/** @brief Time of the last TX activity. */
+static int64_t power_tx_last_micros;
+
+/** @brief Time of the last word sent, for the wake preamble. */
+static int64_t power_tx_word_micros;
+
+/** @brief Words sent by the active backend at the last check. */
+static uint32_t power_tx_words;
+
+/** @brief RX task, woken by the RX pins. */
+static TaskHandle_t power_rx_task = NULL;
+
+/** @brief Time of the last RX activity. */
+static int64_t power_rx_last_micros;
+
+/** @brief RX events of the active backend at the last check. */
+static uint32_t power_rx_events;
+
+/** @brief Protects the RX pins while they are armed, used by the RX task and the console. */
+static SemaphoreHandle_t power_rx_mutex = NULL;
+
+/** @brief The RX pins are armed for wake-up. */
+static bool power_rx_armed = false;
+
+/** @brief Backend disabled while the RX pins are armed. */
+static const vlc_phy_ops_t* power_rx_armed_phy = NULL;
+
+/** @brief Time of the wake-up interrupt, 0 if none since the pins were armed. */
+static volatile int64_t power_rx_wake_micros = 0;
+
+/** @brief Time the test timer fired. */
+static volatile int64_t power_test_fired_micros;
+
+/**
+ * @brief Accounts the time since the last call. Must be called with power_lock held, before a state change.
+ *
+ * @param now Current time.
+ */
+static void power_account(int64_t now) {
+    uint64_t span = (uint64_t)(now - power_account_micros);
+    if (power_held[POWER_SIDE_TX] || power_held[POWER_SIDE_RX]) {
+        power_stats.active_micros += span;
+    } else if (power_light_sleep) {
+        power_stats.sleep_micros += span;
+    }
+    power_account_micros = now;
+}
+
+/**
+ * @brief Acquires the locks of a side if it does not hold them yet.
+ *
+ * @param side Side of the link.
+ */
+static void power_hold(power_side_t side) {
+    bool acquire;
+    portENTER_CRITICAL(&power_lock);
+    acquire = !power_held[side];
+    if (acquire) {
+        power_account(esp_timer_get_time());
+        power_held[side] = true;
+    }
+    portEXIT_CRITICAL(&power_lock);
+    if (acquire) {
+        esp_pm_lock_acquire(power_cpu_locks[side]);
+        esp_pm_lock_acquire(power_awake_locks[side]);
+    }
+}
+
+/**
+ * @brief Releases the locks of a side if it holds them.
+ *
+ * @param side Side of the link.
+ */
+static void power_release(power_side_t side) {
+    bool release;
+    portENTER_CRITICAL(&power_lock);
+    release = power_held[side];
+    if (release) {
+        power_account(esp_timer_get_time());
+        power_held[side] = false;
+    }
+    portEXIT_CRITICAL(&power_lock);
+    if (release) {
+        esp_pm_lock_release(power_awake_locks[side]);
+        esp_pm_lock_release(power_cpu_locks[side]);
+    }
+}
+
+/**
+ * @brief Computes how long a side stays awake after its last activity at the current bit period.
+ *
+ * @return The hold time, in microseconds.
+ */
+static int64_t power_hold_micros(void) {
+    vlc_phy_stats_t stats;
+    phy_active()->get_stats(&stats);
+    return (int64_t)POWER_IDLE_HOLD_MS * 1000 + (int64_t)stats.bit_period_micros * POWER_FRAME_BITS;
+}
+
+void power_init(void) {
+    static const char* const cpu_names[POWER_SIDE_COUNT] = { "vlc_tx_cpu", "vlc_rx_cpu" };
+    static const char* const awake_names[POWER_SIDE_COUNT] = { "vlc_tx_awake", "vlc_rx_awake" };
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = POWER_CPU_MAX_MHZ,
+        .min_freq_mhz = POWER_CPU_MIN_MHZ,
+        .light_sleep_enable = POWER_LIGHT_SLEEP_ENABLE,
+    };
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err != ESP_OK) {
+        ESP_LOGW(POWER_TAG, "Power management unavailable (%s), running at a fixed frequency", esp_err_to_name(err));
+    }
+    for (int side = 0; side < POWER_SIDE_COUNT; side++) {
+        esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, cpu_names[side], &power_cpu_locks[side]);
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, awake_names[side], &power_awake_locks[side]);
+    }
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "vlc_burst", &power_burst_lock);
+    power_rx_mutex = xSemaphoreCreateMutex();
+
+    // The console stays usable in light sleep, at the cost of the first characters typed
+    esp_sleep_enable_gpio_wakeup();
+    #if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+    uart_set_wakeup_threshold(CONFIG_ESP_CONSOLE_UART_NUM, 3);
+    esp_sleep_enable_uart_wakeup(CONFIG_ESP_CONSOLE_UART_NUM);
+    #endif
+
+    power_start_micros = power_account_micros = esp_timer_get_time();
+    power_light_sleep = (err == ESP_OK) && POWER_LIGHT_SLEEP_ENABLE;
+    ESP_LOGI(POWER_TAG, "CPU %d-%d MHz, light sleep %s", POWER_CPU_MIN_MHZ, POWER_CPU_MAX_MHZ, power_light_sleep ? "on" : "off");
+}
+
+esp_err_t power_set_light_sleep(bool enable) {
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = POWER_CPU_MAX_MHZ,
+        .min_freq_mhz = POWER_CPU_MIN_MHZ,
+        .light_sleep_enable = enable,
+    };
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err != ESP_OK) {
+        return err;
+    }
+    portENTER_CRITICAL(&power_lock);
+    power_account(esp_timer_get_time());
+    power_light_sleep = enable;
+    portEXIT_CRITICAL(&power_lock);
+    if (power_rx_task != NULL) {
+        xTaskNotifyGive(power_rx_task);
+    }
+    return ESP_OK;
+}
+
+void power_set_peer_light_sleep(bool may_sleep) {
+    power_peer_light_sleep = may_sleep;
+}
+
+void power_burst_begin(void) {
+    esp_pm_lock_acquire(power_burst_lock);
+}
+
+void power_burst_end(void) {
+    esp_pm_lock_release(power_burst_lock);
+}
+
+void power_tx_activity(void) {
+    power_tx_last_micros = esp_timer_get_time();
+    power_hold(POWER_SIDE_TX);
+    if (power_tx_task != NULL) {
+        xTaskNotifyGive(power_tx_task);
+    }
+}
+
+void power_tx_wait(void) {
+    vlc_phy_stats_t stats;
+    int64_t now = esp_timer_get_time();
+    power_tx_task = xTaskGetCurrentTaskHandle();
+    phy_active()->get_stats(&stats);
+    if (stats.tx_words != power_tx_words) {
+        power_tx_words = stats.tx_words;
+        power_tx_last_micros = now;
+        power_hold(POWER_SIDE_TX);
+    } else if (now - power_tx_last_micros > power_hold_micros()) {
+        power_release(POWER_SIDE_TX);
+    }
+
+    portENTER_CRITICAL(&power_lock);
+    bool held = power_held[POWER_SIDE_TX];
+    portEXIT_CRITICAL(&power_lock);
+    if (held) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    } else {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(POWER_IDLE_POLL_MS));
+    }
+}
+
+bool power_tx_wake_peer(void) {
+    int64_t now = esp_timer_get_time();
+    bool wake = power_peer_light_sleep && (power_tx_word_micros == 0 || now - power_tx_word_micros > power_hold_micros());
+    power_tx_word_micros = now;
+    return wake;
+}
+
+/**
+ * @brief ISR for a low level on an armed RX pin, run once the device is awake.
+ *
+ * The level interrupt stays asserted while the pin is low, so it is disabled until the RX task takes the pins back.
+ *
+ * @param arg Unused.
+ */
+static void IRAM_ATTR power_wake_ISR(void* arg) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    for (int b = 0; b < RX_DIVERSITY_BRANCHES; b++) {
+        gpio_intr_disable(phy_pins_rx_gpios[b]);
+    }
+    power_rx_wake_micros = esp_timer_get_time();
+    vTaskNotifyGiveFromISR(power_rx_task, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+/**
+ * @brief Disables a backend and arms the RX pins for wake-up.
+ *
+ * @param phy Backend to disable, skipped if it is no longer the active one.
+ * @return true if the pins are armed.
+ */
+static bool power_rx_arm(const vlc_phy_ops_t* phy) {
+    xSemaphoreTake(power_rx_mutex, portMAX_DELAY);
+    if (!power_rx_armed && phy == phy_active() && phy->enable != NULL) {
+        phy->enable(false);
+        power_rx_wake_micros = 0;
+        for (int b = 0; b < RX_DIVERSITY_BRANCHES; b++) {
+            gpio_isr_handler_add(phy_pins_rx_gpios[b], power_wake_ISR, NULL);
+            gpio_wakeup_enable(phy_pins_rx_gpios[b], GPIO_INTR_LOW_LEVEL);
+        }
+        power_rx_armed = true;
+        power_rx_armed_phy = phy;
+    }
+    bool armed = power_rx_armed;
+    xSemaphoreGive(power_rx_mutex);
+    return armed;
+}
+
+void power_rx_resume(void) {
+    if (power_rx_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(power_rx_mutex, portMAX_DELAY);
+    if (power_rx_armed) {
+        for (int b = 0; b < RX_DIVERSITY_BRANCHES; b++) {
+            gpio_wakeup_disable(phy_pins_rx_gpios[b]);
+            gpio_isr_handler_remove(phy_pins_rx_gpios[b]);
+            gpio_set_intr_type(phy_pins_rx_gpios[b], GPIO_INTR_NEGEDGE);
+            gpio_intr_enable(phy_pins_rx_gpios[b]);
+        }
+        if (power_rx_armed_phy == phy_active()) {
+            power_rx_armed_phy->enable(true);
+        }
+        power_rx_armed = false;
+
+        int64_t woken = power_rx_wake_micros;
+        if (woken != 0) {
+            uint32_t latency = (uint32_t)(esp_timer_get_time() - woken);
+            if (power_stats.wakes == 0 || latency < power_stats.wake_min_micros) {
+                power_stats.wake_min_micros = latency;
+            }
+            if (latency > power_stats.wake_max_micros) {
+                power_stats.wake_max_micros = latency;
+            }
+            power_stats.wake_total_micros += latency;
+            power_stats.wakes++;
+        }
+    }
+    xSemaphoreGive(power_rx_mutex);
+    if (power_rx_task != NULL && power_rx_task != xTaskGetCurrentTaskHandle()) {
+        // The RX task may be blocked for POWER_IDLE_POLL_MS with its locks released
+        xTaskNotifyGive(power_rx_task);
+    }
+}
+
+void power_rx_wait(bool busy) {
+    vlc_phy_stats_t stats;
+    const vlc_phy_ops_t* phy = phy_active();
+    int64_t now = esp_timer_get_time();
+    power_rx_task = xTaskGetCurrentTaskHandle();
+    phy->get_stats(&stats);
+    uint32_t events = stats.rx_words + stats.rx_dropped + stats.rx_false_starts + stats.rx_framing_errors + stats.rx_syncs;
+
+    if (busy || !phy->rx_wake_on_edge || !power_light_sleep || events != power_rx_events) {
+        power_rx_resume();
+        power_rx_events = events;
+        power_rx_last_micros = now;
+        power_hold(POWER_SIDE_RX);
+    } else if (!power_rx_armed && now - power_rx_last_micros > power_hold_micros()) {
+        if (power_rx_arm(phy)) {
+            power_release(POWER_SIDE_RX);
+        }
+    }
+
+    if (!power_rx_armed) {
+        TickType_t timeout = pdMS_TO_TICKS(RX_LOOP_WAIT_MS);
+        if (phy->rx_notifies && !busy) {
+            // Only the end of the hold time needs a wake-up without a word
+            timeout = portMAX_DELAY;
+            if (phy->rx_wake_on_edge && power_light_sleep) {
+                int64_t left = power_rx_last_micros + power_hold_micros() - now;
+                timeout = left > 0 ? pdMS_TO_TICKS(left / 1000) + 1 : 1;
+            }
+        }
+        rx_loop_wait(timeout);
+        return;
+    }
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(POWER_IDLE_POLL_MS)) > 0 && power_rx_wake_micros != 0) {
+        power_hold(POWER_SIDE_RX);
+        power_rx_resume();
+        power_rx_last_micros = esp_timer_get_time();
+    }
+}
+
+void power_get_stats(power_stats_t* stats) {
+    portENTER_CRITICAL(&power_lock);
+    int64_t now = esp_timer_get_time();
+    power_account(now);
+    *stats = power_stats;
+    stats->light_sleep = power_light_sleep;
+    stats->peer_light_sleep = power_peer_light_sleep;
+    stats->elapsed_micros = (uint64_t)(now - power_start_micros);
+    portEXIT_CRITICAL(&power_lock);
+}
+
+double power_energy_micro_joules(const power_stats_t* stats) {
+    double idle_micros = (double)(stats->elapsed_micros - stats->active_micros - stats->sleep_micros);
+    double charge = (double)POWER_ACTIVE_UA * (double)stats->active_micros + (double)POWER_SLEEP_UA * (double)stats->sleep_micros
+                  + (double)POWER_IDLE_UA * idle_micros;
+    // mV x uA x us = 1e-15 J
+    return (double)POWER_SUPPLY_MV * charge / 1e9;
+}
+
+/**
+ * @brief Callback of the test timer.
+ *
+ * @param arg Semaphore to give.
+ */
+static void power_test_timer_cb(void* arg) {
+    power_test_fired_micros = esp_timer_get_time();
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+esp_err_t power_measure_timer_wake(uint32_t runs, uint32_t* min_micros, uint32_t* max_micros) {
+    portENTER_CRITICAL(&power_lock);
+    bool held = power_held[POWER_SIDE_TX] || power_held[POWER_SIDE_RX];
+    portEXIT_CRITICAL(&power_lock);
+    if (held) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    SemaphoreHandle_t done = xSemaphoreCreateBinary();
+    if (done == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_timer_handle_t timer = NULL;
+    esp_timer_create_args_t timer_args = {
+        .callback = power_test_timer_cb,
+        .arg = done,
+        .name = "power_test",
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &timer);
+
+    *min_micros = UINT32_MAX;
+    *max_micros = 0;
+    for (uint32_t i = 0; i < runs && err == ESP_OK; i++) {
+        int64_t due = esp_timer_get_time() + POWER_WAKE_TEST_MICROS;
+        err = esp_timer_start_once(timer, POWER_WAKE_TEST_MICROS);
+        if (err == ESP_OK) {
+            xSemaphoreTake(done, portMAX_DELAY);
+            uint32_t late = power_test_fired_micros > due ? (uint32_t)(power_test_fired_micros - due) : 0;
+            *min_micros = late < *min_micros ? late : *min_micros;
+            *max_micros = late > *max_micros ? late : *max_micros;
+        }
+    }
+    if (timer != NULL) {
+        esp_timer_delete(timer);
+    }
+    vSemaphoreDelete(done);
+    return err;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file power.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the power management of the link for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the power management of the link. The CPU scales between
+ * POWER_CPU_MIN_MHZ and POWER_CPU_MAX_MHZ and may light-sleep whenever no power management lock is held.
+ *
+ * Each side of the link holds a max-CPU lock and a no-light-sleep lock from its first word until it has seen
+ * no word for the hold time, POWER_IDLE_HOLD_MS after one longest frame; its task then blocks until there is
+ * work again instead of waking every 10 ms. Key generation bursts hold their own max-CPU lock.
+ *
+ * The RX side only lets go with backends that need the CPU from a start edge on (rx_wake_on_edge). It then
+ * disables the backend and arms a low-level wake-up on the RX pins; the edge that wakes the device is lost,
+ * so a transmitter that has been idle for the hold time sends a POWER_WAKE_PREAMBLE_MICROS low level first.
+ * Whether the peer may sleep is a setting of its own (POWER_PEER_LIGHT_SLEEP), as the local light sleep setting
+ * says nothing about the peer. Other backends sample continuously and keep the RX locks held.
+ *
+ * Two figures of the report are model estimates rather than measurements:
+ * - the energy per byte, from the time spent active, idle and asleep and the currents of the
+ *   "Power Configuration" section of config.h;
+ * - the wake-up latency, from the wake-up interrupt to listening again: the interrupt only runs once the device
+ *   is awake, so the time from the preamble edge to the interrupt is not included.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "common_utils/config.h"
+
+/** @brief Bits of the longest frame, start and stop bits of every word included. */
+#define POWER_FRAME_BITS ((BUFFER_MAX_SIZE + 1) * 34)
+
+/**
+ * @brief Sides of the link, each holding its own locks.
+ */
+typedef enum {
+    POWER_SIDE_TX,
+    POWER_SIDE_RX,
+    POWER_SIDE_COUNT,
+} power_side_t;
+
+/**
+ * @brief Time and wake-up counters of the link.
+ */
+typedef struct {
+    bool light_sleep;               /**< Light sleep is enabled */
+    bool peer_light_sleep;          /**< The peer is assumed to light-sleep while idle */
+    uint64_t elapsed_micros;        /**< Time since power_init() */
+    uint64_t active_micros;         /**< Time with at least one side holding its locks */
+    uint64_t sleep_micros;          /**< Idle time with light sleep enabled */
+    uint32_t wakes;                 /**< Wake-ups on the RX pins */
+    uint32_t wake_min_micros;       /**< Shortest time from the wake-up interrupt to listening again */
+    uint32_t wake_max_micros;       /**< Longest time from the wake-up interrupt to listening again */
+    uint64_t wake_total_micros;     /**< Sum of the times from the wake-up interrupt to listening again */
+} power_stats_t;
+
+/**
+ * @brief Configures frequency scaling and light sleep and creates the locks. Called once before the tasks start.
+ */
+void power_init(void);
+
+/**
+ * @brief Turns light sleep while idle on or off.
+ *
+ * @param enable true to allow light sleep.
+ * @return ESP_OK on success, or the error of esp_pm_configure().
+ */
+esp_err_t power_set_light_sleep(bool enable);
+
+/**
+ * @brief Sets whether the peer may light-sleep while the link is idle, so idle frames need a wake preamble.
+ *
+ * @param may_sleep true if the peer may sleep.
+ */
+void power_set_peer_light_sleep(bool may_sleep);
+
+/**
+ * @brief Raises the CPU to POWER_CPU_MAX_MHZ for a key generation burst.
+ */
+void power_burst_begin(void);
+
+/**
+ * @brief Ends a key generation burst.
+ */
+void power_burst_end(void);
+
+/**
+ * @brief Wakes the TX side after frames were submitted.
+ */
+void power_tx_activity(void);
+
+/**
+ * @brief Waits for the next iteration of the TX task, blocking until power_tx_activity() once the TX side is idle.
+ */
+void power_tx_wait(void);
+
+/**
+ * @brief Checks whether the peer may be asleep before a word is sent, and counts the word as activity.
+ *
+ * The peer is taken to sleep after the local hold time, as it runs the same POWER_IDLE_HOLD_MS at the same
+ * bit period.
+ *
+ * @return true if the peer may light-sleep and nothing was sent for the hold time, so the word needs a wake
+ *         preamble.
+ */
+bool power_tx_wake_peer(void);
+
+/**
+ * @brief Waits for the next iteration of the RX task, sleeping until a start edge once the RX side is idle
+ * and in the mode of rx_loop_wait() otherwise.
+ *
+ * @param busy true to stay awake regardless of activity, e.g. during a calibration sweep.
+ */
+void power_rx_wait(bool busy);
+
+/**
+ * @brief Gives the RX pins back to the active backend if they are armed for wake-up. Called before the
+ * active backend changes.
+ */
+void power_rx_resume(void);
+
+/**
+ * @brief Reads the counters.
+ *
+ * @param stats Pointer to store the counters.
+ */
+void power_get_stats(power_stats_t* stats);
+
+/**
+ * @brief Estimates the energy used since power_init() from the time spent in each state.
+ *
+ * A model, not a measurement: the currents are the POWER_*_UA constants of config.h.
+ *
+ * @param stats Counters read by power_get_stats().
+ * @return The energy in microjoules.
+ */
+double power_energy_micro_joules(const power_stats_t* stats);
+
+/**
+ * @brief Measures how late timer wake-ups from light sleep are, with the link idle.
+ *
+ * @param runs Number of wake-ups.
+ * @param min_micros Pointer to store the smallest delay.
+ * @param max_micros Pointer to store the largest delay.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if a side of the link is active, or a timer error.
+ */
+esp_err_t power_measure_timer_wake(uint32_t runs, uint32_t* min_micros, uint32_t* max_micros);
+
+#endif /* POWER_H */
@@ -0,0 +1,165 @@
+/**
+ * @file profiler.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the cycle-budget profiler for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the cycle-budget profiler. Each core records into
+ * its own set of histograms, so TX key generation on one core and RX key generation on the other do not
+ * contend; the sets are merged when read. Each set still has a lock, as a sample is several words: tasks and
+ * ISRs of the same core may preempt each other mid-update, and the console reads and clears the sets from
+ * the other core.
+ */
+
+#include "profiler.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#endif
+
+/** @brief Tag for logging profiler messages */
+static const char *PROFILER_TAG = "PROFILER";
+
+/** @brief Number of cores with their own histograms. */
+#define PROFILER_CORES 2
+
+/** @brief Names of the profiled functions, indexed by profile_slot_t. */
+static const char *profile_slot_names[PROFILE_SLOT_COUNT] = {
+    "key_generator", "duffing_map", "logistic_map", "logistic2D_map", "msws32", "xor", "pack", "unpack", "mac",
+};
+
+/** @brief Histograms of each core. */
+static profile_histogram_t profile_histograms[PROFILER_CORES][PROFILE_SLOT_COUNT];
+
+volatile bool profiler_running = false;
+
+#ifdef ESP_PLATFORM
+/** @brief Locks of the histograms of each core. */
+static portMUX_TYPE profile_locks[PROFILER_CORES] = {portMUX_INITIALIZER_UNLOCKED, portMUX_INITIALIZER_UNLOCKED};
+#else
+/** @brief Locks of the histograms of each core, host threads all record into the first set. */
+static bool profile_locks[PROFILER_CORES];
+#endif
+
+/**
+ * @brief Takes the lock of the histograms of a core.
+ * @param core Core of the histograms.
+ */
+static inline void profiler_lock(int core) {
+#ifdef ESP_PLATFORM
+    portENTER_CRITICAL_SAFE(&profile_locks[core]);
+#else
+    while (__atomic_test_and_set(&profile_locks[core], __ATOMIC_ACQUIRE)) {
+    }
+#endif
+}
+
+/**
+ * @brief Releases the lock of the histograms of a core.
+ * @param core Core of the histograms.
+ */
+static inline void profiler_unlock(int core) {
+#ifdef ESP_PLATFORM
+    portEXIT_CRITICAL_SAFE(&profile_locks[core]);
+#else
+    __atomic_clear(&profile_locks[core], __ATOMIC_RELEASE);
+#endif
+}
+
+/**
+ * @brief Gets the core the caller runs on.
+ * @return int The core number.
+ */
+static inline int profiler_core(void) {
+#if defined(__XTENSA__)
+    return esp_cpu_get_core_id();
+#else
+    return 0;
+#endif
+}
+
+void profiler_record(profile_slot_t slot, uint32_t cycles, uint32_t bytes) {
+    int core = profiler_core();
+    profile_histogram_t* histogram = &profile_histograms[core][slot];
+    profiler_lock(core);
+    if (histogram->count == 0 || cycles < histogram->min) histogram->min = cycles;
+    if (cycles > histogram->max) histogram->max = cycles;
+    histogram->count++;
+    histogram->total += cycles;
+    histogram->bytes += bytes;
+    histogram->buckets[cycles ? 31 - __builtin_clz(cycles) : 0]++;
+    profiler_unlock(core);
+}
+
+void profiler_start(void) {
+    profiler_reset();
+    profiler_running = true;
+}
+
+void profiler_stop(void) {
+    profiler_running = false;
+}
+
+void profiler_reset(void) {
+    for (int core = 0; core < PROFILER_CORES; core++) {
+        profiler_lock(core);
+        memset(profile_histograms[core], 0, sizeof(profile_histograms[core]));
+        profiler_unlock(core);
+    }
+}
+
+void profiler_get(profile_slot_t slot, profile_histogram_t* histogram) {
+    memset(histogram, 0, sizeof(*histogram));
+    for (int core = 0; core < PROFILER_CORES; core++) {
+        profile_histogram_t snapshot;
+        const profile_histogram_t* source = &snapshot;
+        profiler_lock(core);
+        snapshot = profile_histograms[core][slot];
+        profiler_unlock(core);
+        if (source->count == 0) {
+            continue;
+        }
+        if (histogram->count == 0 || source->min < histogram->min) histogram->min = source->min;
+        if (source->max > histogram->max) histogram->max = source->max;
+        histogram->count += source->count;
+        histogram->total += source->total;
+        histogram->bytes += source->bytes;
+        for (int b = 0; b < PROFILER_BUCKETS; b++) {
+            histogram->buckets[b] += source->buckets[b];
+        }
+    }
+}
+
+const char* profiler_slot_name(profile_slot_t slot) {
+    return slot < PROFILE_SLOT_COUNT ? profile_slot_names[slot] : "unknown";
+}
+
+void profiler_dump(void) {
+    bool any = false;
+    for (int slot = 0; slot < PROFILE_SLOT_COUNT; slot++) {
+        profile_histogram_t histogram;
+        profiler_get((profile_slot_t)slot, &histogram);
+        if (histogram.count == 0) {
+            continue;
+        }
+        any = true;
+        ESP_LOGI(PROFILER_TAG, "%-15s n=%lu min=%lu avg=%.1f max=%lu cycles", profile_slot_names[slot],
+                 (unsigned long)histogram.count, (unsigned long)histogram.min,
+                 (double)histogram.total / histogram.count, (unsigned long)histogram.max);
+        if (histogram.bytes != 0) {
+            ESP_LOGI(PROFILER_TAG, "    %.2f cycles/byte", (double)histogram.total / histogram.bytes);
+        }
+        for (int b = 0; b < PROFILER_BUCKETS; b++) {
+            if (histogram.buckets[b] != 0) {
+                ESP_LOGI(PROFILER_TAG, "    [%lu, %lu): %lu", 1UL << b, (b < 31) ? (1UL << (b + 1)) : 0xFFFFFFFFUL,
+                         (unsigned long)histogram.buckets[b]);
+            }
+        }
+    }
+    if (!any) {
+        ESP_LOGI(PROFILER_TAG, "No samples recorded.");
+    }
+}
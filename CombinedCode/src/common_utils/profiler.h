@@ -0,0 +1,148 @@
+/**
+ * @file profiler.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the cycle-budget profiler for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the cycle-budget profiler, which accumulates
+ * per-function cycle histograms around the keystream and crypto hot path. Cycles are read from
+ * CCOUNT on the ESP32-S3 and from the time-stamp counter on x86 hosts, where the host build
+ * (CombinedCode/host) compiles it with the codecs.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#ifdef ESP_PLATFORM
+#include "esp_system.h"
+#endif
+
+#include "common_utils/config.h"
+#include "common_utils/host_compat.h"
+
+#if defined(__XTENSA__)
+#include "esp_cpu.h"
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/** @brief Number of power-of-two buckets of a cycle histogram. */
+#define PROFILER_BUCKETS 32
+
+/**
+ * @brief Profiled functions and steps.
+ */
+typedef enum {
+    PROFILE_KEY_GENERATOR,      /**< key_generator, including the steps below */
+    PROFILE_MAP_DUFFING,        /**< One Duffing map iteration */
+    PROFILE_MAP_LOGISTIC,       /**< One logistic map iteration */
+    PROFILE_MAP_2D_LOGISTIC,    /**< One 2D logistic map iteration */
+    PROFILE_MSWS32,             /**< One MSWS32 step */
+    PROFILE_XOR,                /**< XOR of a word with its key */
+    PROFILE_PACK,               /**< Packing four bytes into a word before transmission */
+    PROFILE_UNPACK,             /**< Splitting a received word and formatting it */
+    PROFILE_MAC,                /**< Computing or verifying a frame authentication tag */
+    PROFILE_SLOT_COUNT,
+} profile_slot_t;
+
+/**
+ * @brief Cycle histogram of one profiled function.
+ */
+typedef struct {
+    uint32_t count;                     /**< Number of samples */
+    uint32_t min;                       /**< Fewest cycles seen */
+    uint32_t max;                       /**< Most cycles seen */
+    uint64_t total;                     /**< Sum of all samples */
+    uint64_t bytes;                     /**< Bytes processed by all samples, 0 if not applicable */
+    uint32_t buckets[PROFILER_BUCKETS]; /**< Bucket n counts samples of [2^n, 2^(n+1)) cycles */
+} profile_histogram_t;
+
+/**
+ * @brief Flag to indicate if the probes are recording.
+ */
+extern volatile bool profiler_running;
+
+/**
+ * @brief Reads the cycle counter of the calling core.
+ * @return uint32_t The current cycle count.
+ */
+static inline uint32_t profiler_cycles(void) {
+#if defined(__XTENSA__)
+    return (uint32_t)esp_cpu_get_cycle_count();
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+#if PROFILER_ENABLE
+/**
+ * @brief Opens a probe, storing the start cycle count and whether the profiler was recording in local variables.
+ *
+ * The probe only records if the profiler was already running when it opened, so a profiler started in between
+ * never sees a start count of 0.
+ */
+#define PROFILE_BEGIN(var) const bool var##_on = profiler_running; uint32_t var = var##_on ? profiler_cycles() : 0
+/** @brief Closes a probe opened with PROFILE_BEGIN and records its cycles in a slot. */
+#define PROFILE_END(slot, var) do { if (var##_on) profiler_record((slot), profiler_cycles() - (var), 0); } while (0)
+/** @brief Closes a probe opened with PROFILE_BEGIN and records its cycles and the bytes it processed in a slot. */
+#define PROFILE_END_BYTES(slot, var, bytes) do { if (var##_on) profiler_record((slot), profiler_cycles() - (var), (bytes)); } while (0)
+#else
+#define PROFILE_BEGIN(var) do {} while (0)
+#define PROFILE_END(slot, var) do {} while (0)
+#define PROFILE_END_BYTES(slot, var, bytes) do {} while (0)
+#endif
+
+/**
+ * @brief Records one sample in the histogram of a slot for the calling core. Safe from tasks and ISRs of both cores.
+ *
+ * @param slot Profiled function.
+ * @param cycles Cycles spent.
+ * @param bytes Bytes processed, 0 if not applicable.
+ */
+void profiler_record(profile_slot_t slot, uint32_t cycles, uint32_t bytes);
+
+/**
+ * @brief Clears all histograms and starts recording.
+ */
+void profiler_start(void);
+
+/**
+ * @brief Stops recording, keeping the histograms.
+ */
+void profiler_stop(void);
+
+/**
+ * @brief Clears all histograms.
+ */
+void profiler_reset(void);
+
+/**
+ * @brief Gets the histogram of a slot, merged over both cores.
+ *
+ * @param slot Profiled function.
+ * @param histogram Pointer to store the histogram.
+ */
+void profiler_get(profile_slot_t slot, profile_histogram_t* histogram);
+
+/**
+ * @brief Gets the name of a slot.
+ *
+ * @param slot Profiled function.
+ * @return The name of the slot.
+ */
+const char* profiler_slot_name(profile_slot_t slot);
+
+/**
+ * @brief Logs the histograms of all slots that have samples.
+ */
+void profiler_dump(void);
+
+#endif /* PROFILER_H */
@@ -0,0 +1,111 @@
+/**
+ * @file rate_probe.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the bit rate budget of the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the bounds of the bit period from the costs of the hot paths and the modeled
+ * cost profile. Times are kept in nanoseconds until the period is rounded up to the 1 us timer resolution.
+ */
+
+#include "rate_probe.h"
+
+/** @brief Bit periods of one word on the line: start bit, data bits and stop bit. */
+#define RATE_PROBE_WORD_BITS (RX_DECODER_WORD_BITS + 2)
+
+/**
+ * @brief Converts cycles to nanoseconds.
+ *
+ * @param cycles Number of cycles.
+ * @param cpu_mhz CPU frequency.
+ * @return The time, in nanoseconds.
+ */
+static uint64_t probe_nanos(uint64_t cycles, uint32_t cpu_mhz) {
+    return cycles * 1000 / (cpu_mhz > 0 ? cpu_mhz : 1);
+}
+
+void rate_probe_compute(const rate_probe_costs_t* costs, rate_probe_result_t* result) {
+    uint64_t bounds[RATE_PROBE_LIMIT_COUNT];
+    bounds[RATE_PROBE_LIMIT_JITTER] = probe_nanos(costs->isr_entry_max_cycles, costs->cpu_mhz) * 100 / RATE_PROBE_JITTER_PERCENT;
+    bounds[RATE_PROBE_LIMIT_ISR_LOAD] = probe_nanos(2ULL * costs->isr_entry_cycles + RATE_PROBE_ISR_BODY_CYCLES, costs->cpu_mhz)
+                                        * 100 / RATE_PROBE_ISR_LOAD_PERCENT;
+    // The TX and RX sides of a word each take one key and one queue push and pop
+    bounds[RATE_PROBE_LIMIT_WORD_LOAD] = probe_nanos(2ULL * ((uint64_t)costs->keygen_cycles + costs->queue_cycles), costs->cpu_mhz)
+                                         * 100 / RATE_PROBE_TASK_LOAD_PERCENT / RATE_PROBE_WORD_BITS;
+    bounds[RATE_PROBE_LIMIT_FLOOR] = (uint64_t)RATE_PROBE_MIN_PERIOD_MICROS * 1000;
+
+    result->costs = *costs;
+    result->limit = RATE_PROBE_LIMIT_JITTER;
+    for (int l = 0; l < RATE_PROBE_LIMIT_COUNT; l++) {
+        result->bound_nanos[l] = bounds[l] > UINT32_MAX ? UINT32_MAX : (uint32_t)bounds[l];
+        if (l != RATE_PROBE_LIMIT_FLOOR && bounds[l] > bounds[result->limit]) {
+            result->limit = (rate_probe_limit_t)l;
+        }
+    }
+
+    uint64_t period_nanos = bounds[result->limit] * (100 + RATE_PROBE_MARGIN_PERCENT) / 100;
+    uint64_t period_micros = (period_nanos + 999) / 1000;
+    if (period_micros <= RATE_PROBE_MIN_PERIOD_MICROS) {
+        period_micros = RATE_PROBE_MIN_PERIOD_MICROS;
+        result->limit = RATE_PROBE_LIMIT_FLOOR;
+    }
+    static const uint32_t periods[] = RATE_PROBE_PERIODS_MICROS;
+    for (size_t p = 0; p < sizeof(periods) / sizeof(periods[0]); p++) {
+        if (periods[p] >= period_micros) {
+            period_micros = periods[p];
+            break;
+        }
+    }
+    result->bit_period_micros = period_micros > UINT32_MAX ? UINT32_MAX : (uint32_t)period_micros;
+}
+
+void rate_probe_model(map_type_t map, uint32_t cpu_mhz, rate_probe_costs_t* costs) {
+    static const uint32_t keygen_cycles[] = RATE_PROBE_MODEL_KEYGEN_CYCLES;
+    size_t index = (size_t)map < sizeof(keygen_cycles) / sizeof(keygen_cycles[0]) ? (size_t)map : 0;
+    costs->cpu_mhz = cpu_mhz;
+    costs->isr_entry_cycles = RATE_PROBE_MODEL_ISR_ENTRY_CYCLES;
+    costs->isr_entry_max_cycles = RATE_PROBE_MODEL_ISR_ENTRY_MAX_CYCLES;
+    costs->keygen_cycles = keygen_cycles[index];
+    costs->queue_cycles = RATE_PROBE_MODEL_QUEUE_CYCLES;
+    costs->map = map;
+}
+
+void rate_probe_print_model(FILE* out) {
+    static const map_type_t maps[] = {MAP_DUFFING, MAP_LOGISTIC, MAP_2D_LOGISTIC};
+    static const uint32_t cpu_mhz[] = {80, 160, POWER_CPU_MAX_MHZ};
+
+    fprintf(out, "map,cpu_mhz,isr_entry_cycles,isr_entry_max_cycles,keygen_cycles,queue_cycles,jitter_ns,isr_load_ns,word_load_ns,period_us,limit\n");
+    for (size_t m = 0; m < sizeof(maps) / sizeof(maps[0]); m++) {
+        for (size_t f = 0; f < sizeof(cpu_mhz) / sizeof(cpu_mhz[0]); f++) {
+            rate_probe_costs_t costs;
+            rate_probe_result_t result;
+            rate_probe_model(maps[m], cpu_mhz[f], &costs);
+            rate_probe_compute(&costs, &result);
+            fprintf(out, "%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%s\n", rate_probe_map_name(maps[m]), (unsigned long)cpu_mhz[f],
+                    (unsigned long)costs.isr_entry_cycles, (unsigned long)costs.isr_entry_max_cycles,
+                    (unsigned long)costs.keygen_cycles, (unsigned long)costs.queue_cycles,
+                    (unsigned long)result.bound_nanos[RATE_PROBE_LIMIT_JITTER],
+                    (unsigned long)result.bound_nanos[RATE_PROBE_LIMIT_ISR_LOAD],
+                    (unsigned long)result.bound_nanos[RATE_PROBE_LIMIT_WORD_LOAD],
+                    (unsigned long)result.bit_period_micros, rate_probe_limit_name(result.limit));
+        }
+    }
+    fflush(out);
+}
+
+const char* rate_probe_limit_name(rate_probe_limit_t limit) {
+    static const char* const names[RATE_PROBE_LIMIT_COUNT] = { "ISR jitter", "ISR load", "word load", "floor" };
+    return (limit < RATE_PROBE_LIMIT_COUNT) ? names[limit] : "?";
+}
+
+const char* rate_probe_map_name(map_type_t map) {
+    switch (map) {
+        case MAP_DUFFING: return "Duffing";
+        case MAP_LOGISTIC: return "Logistic";
+        case MAP_2D_LOGISTIC: return "2D-LOGISTIC";
+        default: return "Unknown";
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * @file rate_probe.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the bit rate budget of the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the computation of the shortest bit period the firmware sustains from the cost of
+ * its hot paths, and a modeled cost profile for the simulator. Three constraints bound the period:
+ * - Jitter: the longest ISR entry latency must stay under RATE_PROBE_JITTER_PERCENT of a bit, so a late sample
+ *   still falls in the middle half of its bit.
+ * - ISR load: the RX timer interrupt of each bit, entry, body and return, must stay under
+ *   RATE_PROBE_ISR_LOAD_PERCENT of a bit.
+ * - Word load: one key and one queue push and pop on each side of a word, which share the decode core, must
+ *   stay under RATE_PROBE_TASK_LOAD_PERCENT of the time of a word on the line.
+ *
+ * The binding constraint gets RATE_PROBE_MARGIN_PERCENT of margin, and the period is rounded up to one of
+ * RATE_PROBE_PERIODS_MICROS, so boards of the same build agree on it. The costs are measured on target by
+ * phy_probe.h; this file has no dependency on the ESP-IDF drivers, so the same budget runs on modeled costs, on
+ * target with the sweep -p command and on the host with sim_sweep_host -p.
+ */
+
+#ifndef RATE_PROBE_H
+#define RATE_PROBE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "common_utils/config.h"
+#include "common_utils/encryption.h"
+#include "reception/RX_decoder.h"
+
+/**
+ * @brief Constraints on the bit period.
+ */
+typedef enum {
+    RATE_PROBE_LIMIT_JITTER,        /**< ISR entry latency against the sampling margin */
+    RATE_PROBE_LIMIT_ISR_LOAD,      /**< One interrupt per bit on the RX core */
+    RATE_PROBE_LIMIT_WORD_LOAD,     /**< Key generation and queueing per word on the decode core */
+    RATE_PROBE_LIMIT_FLOOR,         /**< RATE_PROBE_MIN_PERIOD_MICROS */
+    RATE_PROBE_LIMIT_COUNT,
+} rate_probe_limit_t;
+
+/**
+ * @brief Costs of the hot paths of the link.
+ */
+typedef struct {
+    uint32_t cpu_mhz;               /**< CPU frequency of the cycle counts */
+    uint32_t isr_entry_cycles;      /**< Average time from a timer alarm to its callback */
+    uint32_t isr_entry_max_cycles;  /**< Longest time from a timer alarm to its callback */
+    uint32_t keygen_cycles;         /**< One key of the map */
+    uint32_t queue_cycles;          /**< One push and one pop of a ring buffer, lock included */
+    map_type_t map;                 /**< Map the keys were timed with */
+} rate_probe_costs_t;
+
+/**
+ * @brief Budget of the bit period.
+ */
+typedef struct {
+    rate_probe_costs_t costs;                       /**< Costs the budget was computed from */
+    uint32_t bound_nanos[RATE_PROBE_LIMIT_COUNT];   /**< Shortest bit period each constraint allows, without margin */
+    rate_probe_limit_t limit;                       /**< Binding constraint */
+    uint32_t bit_period_micros;                     /**< Shortest bit period with margin, rounded up to RATE_PROBE_PERIODS_MICROS */
+} rate_probe_result_t;
+
+/**
+ * @brief Computes the shortest sustainable bit period from the costs.
+ *
+ * @param costs Costs of the hot paths.
+ * @param result Pointer to store the budget.
+ */
+void rate_probe_compute(const rate_probe_costs_t* costs, rate_probe_result_t* result);
+
+/**
+ * @brief Fills the modeled costs of a map, the RATE_PROBE_MODEL_* cycle counts at a CPU frequency.
+ *
+ * @param map Chaotic map.
+ * @param cpu_mhz CPU frequency to model.
+ * @param costs Pointer to store the costs.
+ */
+void rate_probe_model(map_type_t map, uint32_t cpu_mhz, rate_probe_costs_t* costs);
+
+/**
+ * @brief Runs the budget on the modeled cost profile of every map and CPU frequency and prints it as CSV.
+ *
+ * @param out Stream to print the CSV to.
+ */
+void rate_probe_print_model(FILE* out);
+
+/**
+ * @brief Gets the name of a constraint.
+ *
+ * @param limit Constraint.
+ * @return The name.
+ */
+const char* rate_probe_limit_name(rate_probe_limit_t limit);
+
+/**
+ * @brief Gets the name of a map.
+ *
+ * @param map Chaotic map.
+ * @return The name, "Duffing", "Logistic" or "2D-LOGISTIC".
+ */
+const char* rate_probe_map_name(map_type_t map);
+
+#endif /* RATE_PROBE_H */
@@ -0,0 +1,37 @@
+/**
+ * @file spsc_queue.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the lock-free single-producer single-consumer queue for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the setup of the queue; pushing and popping are inline in the header.
+ */
+
+#include "spsc_queue.h"
+
+/**
+ * @brief External definitions of the inline functions, emitted in this translation unit in case
+ * the functions are not inlined at all call sites.
+ */
+extern inline bool spsc_queue_push(spsc_queue_t* queue, uint32_t value);
+extern inline bool spsc_queue_pop(spsc_queue_t* queue, uint32_t* value);
+extern inline bool spsc_queue_is_empty(const spsc_queue_t* queue);
+extern inline uint32_t spsc_queue_count(const spsc_queue_t* queue);
+
+bool spsc_queue_init(spsc_queue_t* queue, uint32_t* buffer, uint32_t capacity) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+    queue->buffer = buffer;
+    queue->mask = capacity - 1;
+    spsc_queue_reset(queue);
+    return true;
+}
+
+void spsc_queue_reset(spsc_queue_t* queue) {
+    queue->head = 0;
+    queue->tail = 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file spsc_queue.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the lock-free single-producer single-consumer queue for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains a queue of 32-bit values with one writer and one reader, e.g. an ISR and a task.
+ * Neither side takes a lock or disables interrupts: the writer only moves the head and the reader only the
+ * tail, each published with release ordering and read with acquire ordering, so the two may run on different
+ * cores. The indices run freely and the capacity is a power of two.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_attr.h"
+
+/**
+ * @brief Structure representing a single-producer single-consumer queue.
+ */
+typedef struct {
+    uint32_t* buffer;           /**< Storage of capacity values */
+    uint32_t mask;              /**< Capacity minus one */
+    volatile uint32_t head;     /**< Values pushed so far, written by the producer only */
+    volatile uint32_t tail;     /**< Values popped so far, written by the consumer only */
+} spsc_queue_t;
+
+/**
+ * @brief Initialises an empty queue on caller-owned storage.
+ *
+ * @param queue Pointer to the queue.
+ * @param buffer Storage of the values.
+ * @param capacity Number of values of the storage, a power of two.
+ * @return true on success, false if the capacity is not a power of two.
+ */
+bool spsc_queue_init(spsc_queue_t* queue, uint32_t* buffer, uint32_t capacity);
+
+/**
+ * @brief Empties a queue. Only safe while neither side uses it.
+ *
+ * @param queue Pointer to the queue.
+ */
+void spsc_queue_reset(spsc_queue_t* queue);
+
+/**
+ * @brief Pushes a value, from the producer only.
+ *
+ * @param queue Pointer to the queue.
+ * @param value Value to push.
+ * @return true on success, false if the queue is full.
+ * @note Inline where the compiler chooses to; the external definition in spsc_queue.c is in IRAM, so the function
+ *       can be used from ISRs either way.
+ */
+inline bool IRAM_ATTR spsc_queue_push(spsc_queue_t* queue, uint32_t value);
+
+/**
+ * @brief Pops a value, from the consumer only.
+ *
+ * @param queue Pointer to the queue.
+ * @param value Pointer to store the value.
+ * @return true on success, false if the queue is empty.
+ */
+inline bool spsc_queue_pop(spsc_queue_t* queue, uint32_t* value);
+
+/**
+ * @brief Checks whether a queue is empty, from the consumer.
+ *
+ * @param queue Pointer to the queue.
+ * @return true if nothing was pushed since the last pop.
+ */
+inline bool spsc_queue_is_empty(const spsc_queue_t* queue);
+
+/**
+ * @brief Counts the values in a queue, from either side.
+ *
+ * @param queue Pointer to the queue.
+ * @return Number of values pushed and not popped yet, a snapshot while the other side runs.
+ * @note Inline where the compiler chooses to; the external definition in spsc_queue.c is in IRAM, so the function
+ *       can be used from ISRs either way.
+ */
+inline uint32_t IRAM_ATTR spsc_queue_count(const spsc_queue_t* queue);
+
+inline bool spsc_queue_push(spsc_queue_t* queue, uint32_t value) {
+    uint32_t head = queue->head;
+    if (head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) > queue->mask) {
+        return false;
+    }
+    queue->buffer[head & queue->mask] = value;
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+inline bool spsc_queue_pop(spsc_queue_t* queue, uint32_t* value) {
+    uint32_t tail = queue->tail;
+    if (__atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) == tail) {
+        return false;
+    }
+    *value = queue->buffer[tail & queue->mask];
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+inline bool spsc_queue_is_empty(const spsc_queue_t* queue) {
+    return __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) == queue->tail;
+}
+
+inline uint32_t spsc_queue_count(const spsc_queue_t* queue) {
+    return __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+}
+
+#endif /* SPSC_QUEUE_H */
@@ -0,0 +1,238 @@
+/**
+ * @file trace.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the scheduling trace for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the scheduling trace. Each core owns its event buffer,
+ * and slots are claimed with an atomic increment, so an ISR preempting a task on the same core never
+ * shares a slot with it. Recording stops for a core once its buffer is full. The FreeRTOS trace macros run
+ * inside the scheduler and the queue functions, so their handlers stay in IRAM and only compare handles.
+ */
+
+#include "trace.h"
+
+/** @brief Tag for logging trace messages */
+static const char *TRACE_TAG = "TRACE";
+
+_Static_assert(portNUM_PROCESSORS == TRACE_CORES, "The trace dump holds one buffer per core");
+_Static_assert(TRACE_EVENT_RTOS_RECEIVE - TRACE_EVENT_RTOS_SEND == TRACE_HOOK_RECEIVE
+               && TRACE_EVENT_RTOS_BLOCK_RECEIVE - TRACE_EVENT_RTOS_SEND == TRACE_HOOK_BLOCK_RECEIVE,
+               "The hook operations follow the order of the queue events");
+
+/** @brief Event buffers, one per core. */
+static trace_event_t* trace_events[portNUM_PROCESSORS] = {NULL};
+
+/** @brief Index of the next free slot of each event buffer. */
+static uint32_t trace_heads[portNUM_PROCESSORS] = {0};
+
+/** @brief Number of events lost by each core. */
+static uint32_t trace_dropped[portNUM_PROCESSORS] = {0};
+
+/** @brief Task handles registered for each trace task identifier, the idle tasks of each core set by trace_start(). */
+static TaskHandle_t trace_tasks[TRACE_TASK_COUNT] = {NULL};
+
+/** @brief Idle task of each core. */
+static TaskHandle_t trace_idle_tasks[portNUM_PROCESSORS] = {NULL};
+
+/** @brief Queue handles registered for each trace queue identifier. */
+static QueueHandle_t trace_queues[TRACE_QUEUE_COUNT] = {NULL};
+
+/** @brief Flag to indicate if a trace is running. */
+static volatile bool trace_running = false;
+
+/** @brief Locks keeping the CPU at one frequency and awake while a trace runs, NULL without power management. */
+static esp_pm_lock_handle_t trace_cpu_lock = NULL;
+static esp_pm_lock_handle_t trace_awake_lock = NULL;
+
+/** @brief CPU frequency of the last trace, in MHz. */
+static uint32_t trace_cpu_freq_mhz = 0;
+
+void IRAM_ATTR trace_record(trace_event_type_t type, uint16_t arg) {
+    if (!trace_running) {
+        return;
+    }
+    uint32_t core = (uint32_t)esp_cpu_get_core_id();
+    uint32_t slot = __atomic_fetch_add(&trace_heads[core], 1, __ATOMIC_RELAXED);
+    if (slot >= TRACE_BUFFER_EVENTS) {
+        __atomic_fetch_add(&trace_dropped[core], 1, __ATOMIC_RELAXED);
+        return;
+    }
+    trace_events[core][slot] = (trace_event_t) {
+        .timestamp = esp_cpu_get_cycle_count(),
+        .type = (uint8_t)type,
+        .core = (uint8_t)core,
+        .arg = arg,
+    };
+}
+
+void IRAM_ATTR trace_task_switched(int in) {
+    if (!trace_running) {
+        return;
+    }
+    TaskHandle_t current = xTaskGetCurrentTaskHandle();
+    trace_task_t task = TRACE_TASK_OTHER;
+    for (int i = TRACE_TASK_CONSOLE; i < TRACE_TASK_COUNT; i++) {
+        if (trace_tasks[i] == current) {
+            task = (trace_task_t)i;
+            break;
+        }
+    }
+    if (task == TRACE_TASK_OTHER && current == trace_idle_tasks[esp_cpu_get_core_id()]) {
+        task = TRACE_TASK_IDLE;
+    }
+    trace_record(in ? TRACE_EVENT_TASK_IN : TRACE_EVENT_TASK_OUT, task);
+}
+
+void IRAM_ATTR trace_queue_hook(const void* queue, unsigned op) {
+    if (!trace_running) {
+        return;
+    }
+    for (int i = 0; i < TRACE_QUEUE_COUNT; i++) {
+        if (trace_queues[i] == queue) {
+            trace_record((trace_event_type_t)(TRACE_EVENT_RTOS_SEND + op), (uint16_t)i);
+            return;
+        }
+    }
+}
+
+void trace_register_task(trace_task_t task) {
+    if (task < TRACE_TASK_COUNT) {
+        trace_tasks[task] = xTaskGetCurrentTaskHandle();
+    }
+}
+
+void trace_register_queue(QueueHandle_t queue, trace_queue_t id) {
+    if (id < TRACE_QUEUE_COUNT) {
+        trace_queues[id] = queue;
+    }
+}
+
+esp_err_t trace_start(void) {
+    if (trace_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (trace_events[core] == NULL) {
+            // ISRs write the buffers, so they must stay in internal RAM
+            trace_events[core] = heap_caps_malloc(TRACE_BUFFER_EVENTS * sizeof(trace_event_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            if (trace_events[core] == NULL) {
+                ESP_LOGE(TRACE_TAG, "Failed to allocate trace buffer for core %d", core);
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        trace_heads[core] = 0;
+        trace_dropped[core] = 0;
+    }
+    if (trace_cpu_lock == NULL && esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "trace", &trace_cpu_lock) != ESP_OK) {
+        trace_cpu_lock = NULL;
+    }
+    if (trace_awake_lock == NULL && esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "trace_awake", &trace_awake_lock) != ESP_OK) {
+        trace_awake_lock = NULL;
+    }
+    if (trace_cpu_lock != NULL) {
+        esp_pm_lock_acquire(trace_cpu_lock);
+    }
+    if (trace_awake_lock != NULL) {
+        esp_pm_lock_acquire(trace_awake_lock);
+    }
+    // Read once the lock switched the CPU, the frequency then holds until trace_stop()
+    trace_cpu_freq_mhz = esp_rom_get_cpu_ticks_per_us();
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        trace_idle_tasks[core] = xTaskGetIdleTaskHandleForCore(core);
+    }
+    trace_running = true;
+    return ESP_OK;
+}
+
+void trace_stop(void) {
+    if (!trace_running) {
+        return;
+    }
+    trace_running = false;
+    if (trace_awake_lock != NULL) {
+        esp_pm_lock_release(trace_awake_lock);
+    }
+    if (trace_cpu_lock != NULL) {
+        esp_pm_lock_release(trace_cpu_lock);
+    }
+}
+
+bool trace_is_running(void) {
+    return trace_running;
+}
+
+/**
+ * @brief Gets the number of valid events of a core.
+ *
+ * @param core Core number.
+ * @return Number of valid events.
+ */
+static uint32_t trace_event_count(int core) {
+    return trace_heads[core] < TRACE_BUFFER_EVENTS ? trace_heads[core] : TRACE_BUFFER_EVENTS;
+}
+
+size_t trace_dump(FILE* out) {
+    if (trace_running || trace_events[0] == NULL) {
+        return 0;
+    }
+    trace_header_t header = {
+        .magic = TRACE_MAGIC,
+        .version = TRACE_VERSION,
+        .cpu_freq_mhz = (uint16_t)trace_cpu_freq_mhz,
+    };
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        header.event_count[core] = trace_event_count(core);
+        header.dropped[core] = trace_dropped[core];
+    }
+    return trace_file_write(out, &header, (const trace_event_t* const*)trace_events);
+}
+
+void trace_report(void) {
+    if (trace_running || trace_events[0] == NULL) {
+        ESP_LOGW(TRACE_TAG, "No finished trace to report.");
+        return;
+    }
+    // Too large for the stack of the console task
+    static trace_summary_t summary;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        trace_file_summarise(trace_events[core], trace_event_count(core), &summary);
+        if (summary.events == 0) {
+            ESP_LOGI(TRACE_TAG, "Core %d: no events.", core);
+            continue;
+        }
+        uint32_t window = summary.window_cycles;
+        ESP_LOGI(TRACE_TAG, "Core %d: %lu events, %lu dropped, %.3f ms window", core, (unsigned long)summary.events,
+                 (unsigned long)trace_dropped[core], window / (trace_cpu_freq_mhz * 1000.0));
+        for (int t = 0; t < TRACE_TASK_COUNT; t++) {
+            if (summary.task_switches[t] != 0) {
+                ESP_LOGI(TRACE_TAG, "  Task %-8s %5.1f%% CPU, %lu switches in", trace_file_task_name(t),
+                         window ? 100.0 * summary.task_cycles[t] / window : 0.0, (unsigned long)summary.task_switches[t]);
+            }
+        }
+        for (int isr = 0; isr < TRACE_ISR_COUNT; isr++) {
+            if (summary.isr_calls[isr] != 0) {
+                ESP_LOGI(TRACE_TAG, "  ISR %-14s %lu calls, %.1f cycles avg, %.2f%% CPU", trace_file_isr_name(isr),
+                         (unsigned long)summary.isr_calls[isr], (double)summary.isr_cycles[isr] / summary.isr_calls[isr],
+                         window ? 100.0 * summary.isr_cycles[isr] / window : 0.0);
+            }
+        }
+        if (summary.log_cycles != 0) {
+            ESP_LOGI(TRACE_TAG, "  Console output %.2f%% CPU", window ? 100.0 * summary.log_cycles / window : 0.0);
+        }
+        ESP_LOGI(TRACE_TAG, "  Ring buffer: %lu pushes, %lu pops, %lu rejected", (unsigned long)summary.ring_pushes,
+                 (unsigned long)summary.ring_pops, (unsigned long)summary.ring_full);
+        for (int q = 0; q < TRACE_QUEUE_COUNT; q++) {
+            const uint32_t* ops = summary.queue_ops[q];
+            if (ops[TRACE_HOOK_SEND] + ops[TRACE_HOOK_RECEIVE] + ops[TRACE_HOOK_SEND_FAILED] + ops[TRACE_HOOK_RECEIVE_FAILED] != 0) {
+                ESP_LOGI(TRACE_TAG, "  Queue %-14s %lu sent, %lu received, %lu failed, %lu blocked", trace_file_queue_name(q),
+                         (unsigned long)ops[TRACE_HOOK_SEND], (unsigned long)ops[TRACE_HOOK_RECEIVE],
+                         (unsigned long)(ops[TRACE_HOOK_SEND_FAILED] + ops[TRACE_HOOK_RECEIVE_FAILED]),
+                         (unsigned long)(ops[TRACE_HOOK_BLOCK_SEND] + ops[TRACE_HOOK_BLOCK_RECEIVE]));
+            }
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * @file trace.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the scheduling trace for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the scheduling trace, which records ISR entry and exit,
+ * task run and block points, ring buffer operations, console output, every context switch of the scheduler
+ * and the operations on the registered FreeRTOS queues into a per-core RAM buffer. The switches and queue
+ * operations come from the FreeRTOS trace macros of trace_hooks.h. The buffer can be summarised on target or
+ * dumped in binary, in the layout of trace_file.h, for host/tools/trace_decode.
+ * Timestamps are CCOUNT cycles: a running trace holds a max-CPU and a no-light-sleep lock, so the CPU
+ * frequency of power.h does not scale under it and cycles convert to time at the frequency of the header.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_pm.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#include "common_utils/config.h"
+#include "common_utils/trace_file.h"
+#include "common_utils/trace_hooks.h"
+
+#if TRACE_ENABLE
+/** @brief Records an ISR entry. */
+#define TRACE_ISR_ENTER(isr) trace_record(TRACE_EVENT_ISR_ENTER, (isr))
+/** @brief Records an ISR exit. */
+#define TRACE_ISR_EXIT(isr) trace_record(TRACE_EVENT_ISR_EXIT, (isr))
+/** @brief Records a task resuming after blocking. */
+#define TRACE_TASK_RUN(task) trace_record(TRACE_EVENT_TASK_RUN, (task))
+/** @brief Records a task about to block. */
+#define TRACE_TASK_BLOCK(task) trace_record(TRACE_EVENT_TASK_BLOCK, (task))
+/** @brief Records a ring buffer operation. */
+#define TRACE_QUEUE(type, level) trace_record((type), (uint16_t)(level))
+/** @brief Records console output. */
+#define TRACE_LOG(type) trace_record((type), 0)
+#else
+#define TRACE_ISR_ENTER(isr) do {} while (0)
+#define TRACE_ISR_EXIT(isr) do {} while (0)
+#define TRACE_TASK_RUN(task) do {} while (0)
+#define TRACE_TASK_BLOCK(task) do {} while (0)
+#define TRACE_QUEUE(type, level) do {} while (0)
+#define TRACE_LOG(type) do {} while (0)
+#endif
+
+/**
+ * @brief Records one event if a trace is running.
+ *
+ * Safe to call from tasks and ISRs on both cores.
+ *
+ * @param type Type of the event.
+ * @param arg Argument of the event.
+ */
+void trace_record(trace_event_type_t type, uint16_t arg);
+
+/**
+ * @brief Associates the calling task with a trace task identifier for the context switch events.
+ *
+ * @param task Identifier of the calling task.
+ */
+void trace_register_task(trace_task_t task);
+
+/**
+ * @brief Associates a FreeRTOS queue, semaphore or mutex with a trace queue identifier, so its operations are recorded.
+ *
+ * @param queue The queue.
+ * @param id Identifier of the queue.
+ */
+void trace_register_queue(QueueHandle_t queue, trace_queue_t id);
+
+/**
+ * @brief Starts a new trace, discarding the previous one.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if a trace is running, ESP_ERR_NO_MEM if the buffers could not be allocated.
+ */
+esp_err_t trace_start(void);
+
+/**
+ * @brief Stops the running trace.
+ */
+void trace_stop(void);
+
+/**
+ * @brief Checks if a trace is running.
+ * @return true if events are being recorded, false otherwise.
+ */
+bool trace_is_running(void);
+
+/**
+ * @brief Writes the last trace in binary form.
+ *
+ * @param out Stream to write to.
+ * @return Number of bytes written.
+ */
+size_t trace_dump(FILE* out);
+
+/**
+ * @brief Logs a per-core report of the last trace.
+ *
+ * Reports the share of time each task was switched in, the time spent in each ISR and in console output,
+ * the number of ring buffer operations and the operations on each registered queue.
+ */
+void trace_report(void);
+
+#endif /* TRACE_H */
@@ -0,0 +1,183 @@
+/**
+ * @file trace_file.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the binary layout of scheduling traces for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the writer and the reader of the trace dumps, the per-core summary used by the
+ * trace report on the board and by the host decoder, and the timeline printer of the host decoder.
+ */
+
+#include <string.h>
+
+#include "trace_file.h"
+
+/** @brief Names of the event types, indexed by trace_event_type_t. */
+static const char *trace_event_names[TRACE_EVENT_COUNT] = {
+    "isr_enter", "isr_exit", "task_run", "task_block", "task_in", "task_out", "ring_push", "ring_pop", "ring_full",
+    "log_begin", "log_end", "queue_send", "queue_receive", "queue_send_failed", "queue_receive_failed",
+    "queue_block_send", "queue_block_receive",
+};
+
+/** @brief Names of the traced ISRs, indexed by trace_isr_t. */
+static const char *trace_isr_names[TRACE_ISR_COUNT] = {"TX timer", "RX GPIO", "RX timer", "Capture timer",
+                                                         "Sync TX timer", "Sync RX timer", "Edge GPIO"};
+
+/** @brief Names of the traced tasks, indexed by trace_task_t. */
+static const char *trace_task_names[TRACE_TASK_COUNT] = {"Other", "Idle", "Console", "TX", "RX", "Control"};
+
+/** @brief Names of the traced queues, indexed by trace_queue_t. */
+static const char *trace_queue_names[TRACE_QUEUE_COUNT] = {"Jobs", "Control events", "RX keys", "TX keys", "Log batch"};
+
+const char* trace_file_event_name(uint8_t type) {
+    return type < TRACE_EVENT_COUNT ? trace_event_names[type] : "?";
+}
+
+const char* trace_file_isr_name(uint16_t isr) {
+    return isr < TRACE_ISR_COUNT ? trace_isr_names[isr] : "?";
+}
+
+const char* trace_file_task_name(uint16_t task) {
+    return task < TRACE_TASK_COUNT ? trace_task_names[task] : "?";
+}
+
+const char* trace_file_queue_name(uint16_t queue) {
+    return queue < TRACE_QUEUE_COUNT ? trace_queue_names[queue] : "?";
+}
+
+size_t trace_file_write(FILE* out, const trace_header_t* header, const trace_event_t* const events[TRACE_CORES]) {
+    size_t written = fwrite(header, 1, sizeof(*header), out);
+    for (int core = 0; core < TRACE_CORES; core++) {
+        if (header->event_count[core] != 0) {
+            written += fwrite(events[core], 1, header->event_count[core] * sizeof(trace_event_t), out);
+        }
+    }
+    fflush(out);
+    return written;
+}
+
+esp_err_t trace_file_parse(const void* data, size_t length, trace_view_t* view) {
+    if (length < sizeof(trace_header_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const trace_header_t* header = (const trace_header_t*)data;
+    if (header->magic != TRACE_MAGIC || header->version != TRACE_VERSION) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t events = 0;
+    for (int core = 0; core < TRACE_CORES; core++) {
+        events += header->event_count[core];
+    }
+    if (length < sizeof(*header) + events * sizeof(trace_event_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    view->header = header;
+    view->events[0] = (const trace_event_t*)(header + 1);
+    for (int core = 1; core < TRACE_CORES; core++) {
+        view->events[core] = view->events[core - 1] + header->event_count[core - 1];
+    }
+    return ESP_OK;
+}
+
+void trace_file_summarise(const trace_event_t* events, uint32_t count, trace_summary_t* summary) {
+    memset(summary, 0, sizeof(*summary));
+    summary->events = count;
+    if (count == 0) {
+        return;
+    }
+    uint32_t isr_entry[TRACE_ISR_COUNT] = {0};
+    bool in_isr[TRACE_ISR_COUNT] = {false};
+    uint32_t log_entry = 0, task_entry = 0;
+    bool in_log = false;
+    int task = -1;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const trace_event_t* event = &events[i];
+        switch (event->type) {
+            case TRACE_EVENT_ISR_ENTER:
+                if (event->arg < TRACE_ISR_COUNT) {
+                    isr_entry[event->arg] = event->timestamp;
+                    in_isr[event->arg] = true;
+                }
+                break;
+            case TRACE_EVENT_ISR_EXIT:
+                if (event->arg < TRACE_ISR_COUNT && in_isr[event->arg]) {
+                    summary->isr_cycles[event->arg] += event->timestamp - isr_entry[event->arg];
+                    summary->isr_calls[event->arg]++;
+                    in_isr[event->arg] = false;
+                }
+                break;
+            case TRACE_EVENT_TASK_IN:
+                if (event->arg < TRACE_TASK_COUNT) {
+                    task = event->arg;
+                    task_entry = event->timestamp;
+                    summary->task_switches[task]++;
+                }
+                break;
+            case TRACE_EVENT_TASK_OUT:
+                if (task >= 0) {
+                    summary->task_cycles[task] += event->timestamp - task_entry;
+                    task = -1;
+                }
+                break;
+            case TRACE_EVENT_QUEUE_PUSH: summary->ring_pushes++; break;
+            case TRACE_EVENT_QUEUE_POP: summary->ring_pops++; break;
+            case TRACE_EVENT_QUEUE_FULL: summary->ring_full++; break;
+            case TRACE_EVENT_LOG_BEGIN:
+                log_entry = event->timestamp;
+                in_log = true;
+                break;
+            case TRACE_EVENT_LOG_END:
+                if (in_log) {
+                    summary->log_cycles += event->timestamp - log_entry;
+                    in_log = false;
+                }
+                break;
+            default:
+                if (event->type >= TRACE_EVENT_RTOS_SEND && event->type < TRACE_EVENT_COUNT && event->arg < TRACE_QUEUE_COUNT) {
+                    summary->queue_ops[event->arg][event->type - TRACE_EVENT_RTOS_SEND]++;
+                }
+                break;
+        }
+    }
+    // The task still switched in at the end of the trace ran until its last event
+    if (task >= 0) {
+        summary->task_cycles[task] += events[count - 1].timestamp - task_entry;
+    }
+    summary->window_cycles = events[count - 1].timestamp - events[0].timestamp;
+}
+
+void trace_file_print_timeline(FILE* out, const trace_header_t* header, const trace_event_t* events, uint32_t count) {
+    double cycles_per_us = header->cpu_freq_mhz ? header->cpu_freq_mhz : 1;
+    for (uint32_t i = 0; i < count; i++) {
+        const trace_event_t* event = &events[i];
+        const char* arg_name = NULL;
+        switch (event->type) {
+            case TRACE_EVENT_ISR_ENTER:
+            case TRACE_EVENT_ISR_EXIT:
+                arg_name = trace_file_isr_name(event->arg);
+                break;
+            case TRACE_EVENT_TASK_RUN:
+            case TRACE_EVENT_TASK_BLOCK:
+            case TRACE_EVENT_TASK_IN:
+            case TRACE_EVENT_TASK_OUT:
+                arg_name = trace_file_task_name(event->arg);
+                break;
+            default:
+                if (event->type >= TRACE_EVENT_RTOS_SEND) {
+                    arg_name = trace_file_queue_name(event->arg);
+                }
+                break;
+        }
+        fprintf(out, "%u %12.3f %-20s ", event->core, (uint32_t)(event->timestamp - events[0].timestamp) / cycles_per_us,
+                trace_file_event_name(event->type));
+        if (arg_name != NULL) {
+            fprintf(out, "%s\n", arg_name);
+        } else {
+            fprintf(out, "%u\n", event->arg);
+        }
+    }
+}
@@ -0,0 +1,226 @@
+/**
+ * @file trace_file.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the binary layout of scheduling traces for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the layout of the dumps written by trace_dump() and the functions shared by the
+ * board and the host tools (CombinedCode/host) to read and summarise them. The dump is laid out as follows
+ * (little endian):
+ * - one trace_header_t;
+ * - event_count[0] trace_event_t of core 0, then event_count[1] trace_event_t of core 1.
+ *
+ * Timestamps are the CCOUNT of the recording core. The cores do not share a cycle counter, so the events of
+ * different cores are only ordered within their core. Nothing here depends on ESP-IDF.
+ */
+
+#ifndef TRACE_FILE_H
+#define TRACE_FILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "common_utils/host_compat.h"
+
+/** @brief Magic number at the start of every trace dump ("VLCT"). */
+#define TRACE_MAGIC 0x54434C56
+
+/** @brief Version of the trace dump layout. */
+#define TRACE_VERSION 2
+
+/** @brief Number of cores in a dump, portNUM_PROCESSORS on the ESP32-S3. */
+#define TRACE_CORES 2
+
+/**
+ * @brief Types of trace events.
+ */
+typedef enum {
+    TRACE_EVENT_ISR_ENTER,          /**< ISR entry, arg is a trace_isr_t */
+    TRACE_EVENT_ISR_EXIT,           /**< ISR exit, arg is a trace_isr_t */
+    TRACE_EVENT_TASK_RUN,           /**< Task resumed after blocking, arg is a trace_task_t */
+    TRACE_EVENT_TASK_BLOCK,         /**< Task about to block, arg is a trace_task_t */
+    TRACE_EVENT_TASK_IN,            /**< Scheduler switched a task in, arg is a trace_task_t */
+    TRACE_EVENT_TASK_OUT,           /**< Scheduler switched a task out, arg is a trace_task_t */
+    TRACE_EVENT_QUEUE_PUSH,         /**< Ring buffer push, arg is the new fill level */
+    TRACE_EVENT_QUEUE_POP,          /**< Ring buffer pop, arg is the new fill level */
+    TRACE_EVENT_QUEUE_FULL,         /**< Ring buffer push rejected */
+    TRACE_EVENT_LOG_BEGIN,          /**< Console output started */
+    TRACE_EVENT_LOG_END,            /**< Console output finished */
+    TRACE_EVENT_RTOS_SEND,          /**< Item sent to or semaphore given to a FreeRTOS queue, arg is a trace_queue_t */
+    TRACE_EVENT_RTOS_RECEIVE,       /**< Item received from or semaphore taken from a FreeRTOS queue */
+    TRACE_EVENT_RTOS_SEND_FAILED,   /**< Send or give failed, the queue was full */
+    TRACE_EVENT_RTOS_RECEIVE_FAILED,/**< Receive or take failed, the queue was empty */
+    TRACE_EVENT_RTOS_BLOCK_SEND,    /**< Task about to block sending to a full queue */
+    TRACE_EVENT_RTOS_BLOCK_RECEIVE, /**< Task about to block receiving from an empty queue */
+    TRACE_EVENT_COUNT,
+} trace_event_type_t;
+
+/** @brief Number of FreeRTOS queue operations traced, from TRACE_EVENT_RTOS_SEND on. */
+#define TRACE_RTOS_OPS (TRACE_EVENT_COUNT - TRACE_EVENT_RTOS_SEND)
+
+/**
+ * @brief ISRs identified in the trace.
+ */
+typedef enum {
+    TRACE_ISR_TX_TIMER,
+    TRACE_ISR_RX_GPIO,
+    TRACE_ISR_RX_TIMER,
+    TRACE_ISR_CAPTURE_TIMER,
+    TRACE_ISR_SYNC_TX_TIMER,
+    TRACE_ISR_SYNC_RX_TIMER,
+    TRACE_ISR_EDGE_GPIO,
+    TRACE_ISR_COUNT,
+} trace_isr_t;
+
+/**
+ * @brief Tasks identified in the trace.
+ */
+typedef enum {
+    TRACE_TASK_OTHER,
+    TRACE_TASK_IDLE,
+    TRACE_TASK_CONSOLE,
+    TRACE_TASK_TX,
+    TRACE_TASK_RX,
+    TRACE_TASK_CTRL,
+    TRACE_TASK_COUNT,
+} trace_task_t;
+
+/**
+ * @brief FreeRTOS queues and semaphores identified in the trace; the others are not recorded.
+ */
+typedef enum {
+    TRACE_QUEUE_JOBS,           /**< Console job queue */
+    TRACE_QUEUE_CTRL_NOTIFY,    /**< Events of the control channel */
+    TRACE_QUEUE_RX_KEYS,        /**< Mutex of the RX keystream */
+    TRACE_QUEUE_TX_KEYS,        /**< Mutex of the TX keystream */
+    TRACE_QUEUE_LOG_BATCH,      /**< Mutex of the console batch */
+    TRACE_QUEUE_COUNT,
+} trace_queue_t;
+
+/**
+ * @brief One trace event.
+ */
+typedef struct {
+    uint32_t timestamp; /**< CCOUNT of the recording core */
+    uint8_t type;       /**< A trace_event_type_t */
+    uint8_t core;       /**< Core that recorded the event */
+    uint16_t arg;       /**< Event argument, see trace_event_type_t */
+} trace_event_t;
+
+/**
+ * @brief Header of a trace dump.
+ */
+typedef struct {
+    uint32_t magic;                     /**< Always TRACE_MAGIC */
+    uint16_t version;                   /**< Layout version, TRACE_VERSION */
+    uint16_t cpu_freq_mhz;              /**< CCOUNT frequency while the trace ran */
+    uint32_t event_count[TRACE_CORES];  /**< Valid events per core */
+    uint32_t dropped[TRACE_CORES];      /**< Events lost per core because the buffer was full */
+} trace_header_t;
+
+/**
+ * @brief Trace read from a dump, pointing into the dump.
+ */
+typedef struct {
+    const trace_header_t* header;               /**< Header */
+    const trace_event_t* events[TRACE_CORES];   /**< Events of each core */
+} trace_view_t;
+
+/**
+ * @brief Summary of the events of one core.
+ *
+ * Task time runs from a switch-in to the next switch-out of the core and includes the ISRs that preempted the
+ * task, which are also counted on their own.
+ */
+typedef struct {
+    uint32_t events;                                        /**< Valid events */
+    uint32_t window_cycles;                                 /**< From the first to the last event */
+    uint64_t task_cycles[TRACE_TASK_COUNT];                 /**< Time each task was switched in */
+    uint32_t task_switches[TRACE_TASK_COUNT];               /**< Times each task was switched in */
+    uint64_t isr_cycles[TRACE_ISR_COUNT];                   /**< Time in each ISR */
+    uint32_t isr_calls[TRACE_ISR_COUNT];                    /**< Calls of each ISR */
+    uint64_t log_cycles;                                    /**< Time in console output */
+    uint32_t ring_pushes;                                   /**< Ring buffer pushes */
+    uint32_t ring_pops;                                     /**< Ring buffer pops */
+    uint32_t ring_full;                                     /**< Ring buffer pushes rejected */
+    uint32_t queue_ops[TRACE_QUEUE_COUNT][TRACE_RTOS_OPS];  /**< FreeRTOS queue operations, by queue and type */
+} trace_summary_t;
+
+/**
+ * @brief Writes a trace in binary form.
+ *
+ * @param out Stream to write to.
+ * @param header Header of the trace.
+ * @param events Events of each core.
+ * @return Number of bytes written.
+ */
+size_t trace_file_write(FILE* out, const trace_header_t* header, const trace_event_t* const events[TRACE_CORES]);
+
+/**
+ * @brief Reads a dump held in memory.
+ *
+ * @param data Dump, aligned on 4 bytes.
+ * @param length Number of bytes of the dump.
+ * @param view Pointer to store the trace, pointing into data.
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the dump is shorter than its header says,
+ *         ESP_ERR_INVALID_ARG for a wrong magic number or version.
+ */
+esp_err_t trace_file_parse(const void* data, size_t length, trace_view_t* view);
+
+/**
+ * @brief Summarises the events of one core.
+ *
+ * @param events Events of the core, in recording order.
+ * @param count Number of events.
+ * @param summary Pointer to store the summary.
+ */
+void trace_file_summarise(const trace_event_t* events, uint32_t count, trace_summary_t* summary);
+
+/**
+ * @brief Prints the events of one core, one per line, in microseconds from the first one.
+ *
+ * @param out Stream to write to.
+ * @param header Header of the trace.
+ * @param events Events of the core.
+ * @param count Number of events.
+ */
+void trace_file_print_timeline(FILE* out, const trace_header_t* header, const trace_event_t* events, uint32_t count);
+
+/**
+ * @brief Gets the name of a trace_event_type_t.
+ *
+ * @param type The event type.
+ * @return Its name, "?" if unknown.
+ */
+const char* trace_file_event_name(uint8_t type);
+
+/**
+ * @brief Gets the name of a trace_isr_t.
+ *
+ * @param isr The ISR.
+ * @return Its name, "?" if unknown.
+ */
+const char* trace_file_isr_name(uint16_t isr);
+
+/**
+ * @brief Gets the name of a trace_task_t.
+ *
+ * @param task The task.
+ * @return Its name, "?" if unknown.
+ */
+const char* trace_file_task_name(uint16_t task);
+
+/**
+ * @brief Gets the name of a trace_queue_t.
+ *
+ * @param queue The queue.
+ * @return Its name, "?" if unknown.
+ */
+const char* trace_file_queue_name(uint16_t queue);
+
+#endif /* TRACE_FILE_H */
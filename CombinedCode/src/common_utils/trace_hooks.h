@@ -0,0 +1,60 @@
+/**
+ * @file trace_hooks.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief FreeRTOS trace macros of the scheduling trace for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details FreeRTOS expands its trace macros inside the kernel, so they must be defined before FreeRTOS.h is
+ * read by every C file of the build, the kernel included. ../CMakeLists.txt force-includes this file for that:
+ * it must stay free of any include. The scheduler calls trace_task_switched() around every context switch and
+ * the queue functions call trace_queue_hook() for every send, receive, failure and block; both return at once
+ * while no trace runs, and queues not registered with trace_register_queue() are not recorded.
+ */
+
+#ifndef TRACE_HOOKS_H
+#define TRACE_HOOKS_H
+
+#ifndef __ASSEMBLER__
+
+/** @brief Operations passed to trace_queue_hook(), in the order of the TRACE_EVENT_RTOS_* events. */
+#define TRACE_HOOK_SEND 0
+#define TRACE_HOOK_RECEIVE 1
+#define TRACE_HOOK_SEND_FAILED 2
+#define TRACE_HOOK_RECEIVE_FAILED 3
+#define TRACE_HOOK_BLOCK_SEND 4
+#define TRACE_HOOK_BLOCK_RECEIVE 5
+
+/**
+ * @brief Records the task the scheduler switches in or out on the calling core.
+ *
+ * @param in 1 when called after the switch, 0 before it.
+ */
+void trace_task_switched(int in);
+
+/**
+ * @brief Records an operation on a registered FreeRTOS queue.
+ *
+ * @param queue The queue, semaphore or mutex.
+ * @param op One of the TRACE_HOOK_* operations.
+ */
+void trace_queue_hook(const void* queue, unsigned op);
+
+#define traceTASK_SWITCHED_IN() trace_task_switched(1)
+#define traceTASK_SWITCHED_OUT() trace_task_switched(0)
+#define traceQUEUE_SEND(pxQueue) trace_queue_hook((pxQueue), TRACE_HOOK_SEND)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) trace_queue_hook((pxQueue), TRACE_HOOK_SEND)
+#define traceQUEUE_SEND_FAILED(pxQueue) trace_queue_hook((pxQueue), TRACE_HOOK_SEND_FAILED)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue) trace_queue_hook((pxQueue), TRACE_HOOK_SEND_FAILED)
+#define traceQUEUE_RECEIVE(pxQueue) trace_queue_hook((pxQueue), TRACE_HOOK_RECEIVE)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue) trace_queue_hook((pxQueue), TRACE_HOOK_RECEIVE)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue) trace_queue_hook((pxQueue), TRACE_HOOK_RECEIVE_FAILED)
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED(pxQueue) trace_queue_hook((pxQueue), TRACE_HOOK_RECEIVE_FAILED)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue) trace_queue_hook((pxQueue), TRACE_HOOK_BLOCK_SEND)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) trace_queue_hook((pxQueue), TRACE_HOOK_BLOCK_RECEIVE)
+
+#endif /* __ASSEMBLER__ */
+
+#endif /* TRACE_HOOKS_H */
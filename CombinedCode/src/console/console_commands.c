@@ -1,604 +1,2596 @@
-/**
- * @file console_commands.c
- * @author Ricardo Jorge Dias Sampaio
- * @brief Implementation of console commands for the Secure VLC Project.
- * @version 1.0
- * @date 2024-09-03
- *
- * \par License:
- *   \ref mit_license "MIT License".
- * @details This file contains the implementation of various console commands used for
- * configuring and controlling the Secure VLC Project, including encryption settings,
- * data transmission, and system information.
- */
-
-#include "console_commands.h"
-
-
-/** @brief Tag for logging messages related to console operations */
-static const char *CONSOLE_TAG = "CONSOLE";
-
-/** @brief Flag to indicate if TX encryption variables are set */
-bool tx_encryption_set = false;
-
-/** @brief Flag to indicate if RX encryption variables are set */
-bool rx_encryption_set = false;
-
-/** @brief Flag to indicate if a new line is needed in the custom vprintf function */
-static bool is_new_line = true;
-
-/** @brief Structure for setting encryption arguments */
-static struct set_encryption_args_t {
-    struct arg_lit *TX;
-    struct arg_lit *RX;
-    struct arg_str *map_type;
-    struct arg_dbl *x1;
-    struct arg_dbl *y1;
-    struct arg_int *iterations1;
-    struct arg_dbl *x2;
-    struct arg_dbl *y2;
-    struct arg_int *iterations2;
-    struct arg_end *end;
-} set_encryption_args;
-
-/** @brief Structure for getting encryption arguments */
-static struct get_encryption_args_t{
-    struct arg_lit *TX;
-    struct arg_lit *RX;
-    struct arg_end *end;
-} get_encryption_args;
-
-/**
- * @brief Custom printf function for the console.
- *
- * This function formats and prints messages to the console, handling new lines and prompts.
- *
- * @param format Format string.
- * @param args Variable argument list.
- * @return int Number of characters printed.
- */
-static int custom_vprintf(const char *format, va_list args) {
-    char print_buf[MAX_CMDLINE_LENGTH];
-    int ret = vsnprintf(print_buf, sizeof(print_buf), format, args);
-    if (ret >= 0) {
-        char *line = print_buf;
-        char *next_line;
-        while ((next_line = strchr(line, '\n')) != NULL) {
-            *next_line = '\0';
-            if (!is_new_line) {
-                printf("\n");
-            }
-            printf("%s\n", line);
-            line = next_line + 1;
-            is_new_line = true;
-        }
-        if (*line != '\0') {
-            if (is_new_line) {
-                printf("%s", PROMPT_STR);
-            }
-            printf("%s", line);
-            is_new_line = false;
-        }
-    }
-    return ret;
-}
-
-/**
- * @brief Initializes the NVS (Non-Volatile Storage).
- */
-static void initialize_nvs(void) {
-    esp_err_t err = nvs_flash_init();
-    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        err = nvs_flash_init();
-    }
-    ESP_ERROR_CHECK(err);
-}
-
-/**
- * @brief Registers a console command.
- *
- * @param command The command string.
- * @param short_command The short command string.
- * @param help The help string.
- * @param hint The hint string.
- * @param func The function to execute the command.
- * @param argtable The argument table.
- */
-static void register_command(const char *command, const char *short_command, const char *help, const char *hint, esp_console_cmd_func_t func, void *argtable) {
-    const esp_console_cmd_t cmd = {
-        .command = command,
-        .help = help,
-        .hint = hint,
-        .func = func,
-        .argtable = argtable,
-    };
-    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
-    if (short_command != NULL) {
-        const esp_console_cmd_t short_cmd = {
-            .command = short_command,
-            .help = NULL, // Hide short command from help
-            .hint = hint,
-            .func = func,
-            .argtable = argtable,
-        };
-        ESP_ERROR_CHECK(esp_console_cmd_register(&short_cmd));
-    }
-}
-
-/**
- * @brief Check if encryption settings are set.
- *
- * @param check_tx Check TX encryption.
- * @param check_rx Check RX encryption.
- * @return bool True if the required encryption settings are set, false otherwise.
- */
-static bool check_encryption_settings(bool check_tx, bool check_rx) {
-    if (tx_encryption_set && rx_encryption_set) {
-        ESP_LOGI(CONSOLE_TAG, "Both TX and RX encryption values are set.");
-        return true;
-    }
-    if (check_tx && check_rx) {
-        if (!tx_encryption_set && !rx_encryption_set) {
-            ESP_LOGW(CONSOLE_TAG, "Both TX and RX encryption values are not set.");
-        } else if (!tx_encryption_set) {
-            ESP_LOGW(CONSOLE_TAG, "TX encryption values are not set.");
-        } else {
-            ESP_LOGW(CONSOLE_TAG, "RX encryption values are not set.");
-        }
-        return false;
-    }
-    if (check_tx && !tx_encryption_set) {
-        ESP_LOGW(CONSOLE_TAG, "TX encryption values are not set.");
-        return false; // Return true if we're only checking TX
-    }
-    if (check_rx && !rx_encryption_set) {
-        ESP_LOGW(CONSOLE_TAG, "RX encryption values are not set.");
-        return false; // Return true if we're only checking RX
-    }
-    return true;
-}
-
-/**
- * @brief Checks if a double value is within the valid range for the given map type.
- *
- * @param value The double value to check.
- * @param name The name of the value (for logging).
- * @param map_type The type of map being used.
- * @return bool True if the value is within range, false otherwise.
- */
-static bool check_double_range(double value, const char* name, map_type_t map_type) {
-    double min_value, max_value;
-
-    switch (map_type) {
-        case MAP_DUFFING:
-            min_value = -1.2;
-            max_value = 1.2;
-            break;
-        case MAP_LOGISTIC:
-            min_value = 0.0;
-            max_value = 1.0;
-            break;
-        case MAP_2D_LOGISTIC:
-            min_value = -1.0;
-            max_value = 1.0;
-            break;
-        default:
-            ESP_LOGE(CONSOLE_TAG, "Error: Unknown map type for range checking.");
-            return false;
-    }
-
-    if (value < min_value || value > max_value) {
-        ESP_LOGE(CONSOLE_TAG, "Error: %s value %.6f is out of range [%.6f, %.6f] for %s map. Please try again.", 
-                name, value, min_value, max_value, 
-                map_type == MAP_DUFFING ? "Duffing" : 
-                map_type == MAP_LOGISTIC ? "Logistic" : "2D-MCCM");
-        return false;
-    }
-    return true;
-}
-
-/**
- * @brief Checks if the number of iterations is within the valid range for the given map type.
- *
- * @param value The number of iterations to check.
- * @param name The name of the value (for logging).
- * @param map_type The type of map being used.
- * @return int The valid number of iterations.
- */
-static int check_iterations(int value, const char* name, map_type_t map_type) {
-    int min_iterations = 200;
-    int max_iterations = 1000000;
-
-    // You can add map-specific iteration limits here in the future
-    switch (map_type) {
-        case MAP_DUFFING:
-        case MAP_LOGISTIC:
-        case MAP_2D_LOGISTIC:
-            // Currently using the same limits for all maps
-            break;
-        default:
-            ESP_LOGE(CONSOLE_TAG, "Error: Unknown map type for iteration checking.");
-            return min_iterations;
-    }
-
-    if (value < min_iterations) {
-        ESP_LOGW(CONSOLE_TAG, "Warning: %s must be at least %d for %s map. Setting to %d.", 
-                name, min_iterations, 
-                map_type == MAP_DUFFING ? "Duffing" : 
-                map_type == MAP_LOGISTIC ? "Logistic" : "2D-MCCM", 
-                min_iterations);
-        return min_iterations;
-    }
-    if (value > max_iterations) {
-        ESP_LOGW(CONSOLE_TAG, "Warning: %s exceeds %d for %s map. Setting to %d.", 
-                name, max_iterations, 
-                map_type == MAP_DUFFING ? "Duffing" : 
-                map_type == MAP_LOGISTIC ? "Logistic" : "2D-MCCM", 
-                max_iterations);
-        return max_iterations;
-    }
-    return value;
-}
-
-/**
- * @brief Command to set encryption variables.
- *
- * @param argc Argument count.
- * @param argv Argument vector.
- * @return int 0 on success, 1 on failure.
- */
-static int cmd_set_encryption(int argc, char **argv) {
-    int nerrors = arg_parse(argc, argv, (void **)&set_encryption_args);
-    if (nerrors != 0) {
-        arg_print_errors(stderr, set_encryption_args.end, argv[0]);
-        return 1;
-    }
-
-    // Check for mutual exclusivity of TX and RX flags
-    if (set_encryption_args.TX->count + set_encryption_args.RX->count != 1) {
-        ESP_LOGE(CONSOLE_TAG, "Error: You must specify either -TX or -RX, but not both.");
-        return 1;
-    }
-
-    // Check if map type is provided
-    if (set_encryption_args.map_type->count == 0) {
-        ESP_LOGE(CONSOLE_TAG, "Error: You must specify a map type (duffing, logistic, or mccm).");
-        return 1;
-    }
-
-    map_type_t map_type;
-    if ((strcmp(set_encryption_args.map_type->sval[0], "duffing") == 0) || (strcmp(set_encryption_args.map_type->sval[0], "d") == 0)) {
-        map_type = MAP_DUFFING;
-    } else if ((strcmp(set_encryption_args.map_type->sval[0], "logistic") == 0) || (strcmp(set_encryption_args.map_type->sval[0], "l") == 0)) {
-        map_type = MAP_LOGISTIC;
-    } else if ((strcmp(set_encryption_args.map_type->sval[0], "mccm") == 0) || (strcmp(set_encryption_args.map_type->sval[0], "m") == 0)) {
-        map_type = MAP_2D_LOGISTIC;
-    } else {
-        ESP_LOGE(CONSOLE_TAG, "Error: Invalid map type. Must be duffing, logistic, or mccm.");
-        return 1;
-    }
-
-    // Check all double values
-    if (!check_double_range(set_encryption_args.x1->dval[0], "Map 1 x", map_type) ||
-        !check_double_range(set_encryption_args.y1->dval[0], "Map 1 y", map_type) ||
-        !check_double_range(set_encryption_args.x2->dval[0], "Map 2 x", map_type) ||
-        !check_double_range(set_encryption_args.y2->dval[0], "Map 2 y", map_type)) {
-        return 1; // Return if any double value is out of range
-    }
-
-    encryption_vars_t *vars_to_set;
-    if (set_encryption_args.RX->count > 0) {
-        ESP_LOGI(CONSOLE_TAG, "RX mode selected");
-        vars_to_set = &RX_encryption_vars;
-        rx_encryption_set = true;
-    } else {
-        ESP_LOGI(CONSOLE_TAG, "TX mode selected");
-        vars_to_set = &TX_encryption_vars;
-        tx_encryption_set = true;
-    }
-
-    // Log the input values
-    ESP_LOGI(CONSOLE_TAG, "Input values:");
-    ESP_LOGI(CONSOLE_TAG, "Map 1: x=%.6f, y=%.6f, iterations=%d", 
-             set_encryption_args.x1->dval[0], set_encryption_args.y1->dval[0], set_encryption_args.iterations1->ival[0]);
-    ESP_LOGI(CONSOLE_TAG, "Map 2: x=%.6f, y=%.6f, iterations=%d", 
-             set_encryption_args.x2->dval[0], set_encryption_args.y2->dval[0], set_encryption_args.iterations2->ival[0]);
-
-    // Set the encryption variables
-    vars_to_set->type = map_type;
-    vars_to_set->chaotic_map1.x = set_encryption_args.x1->dval[0];
-    vars_to_set->chaotic_map1.y = set_encryption_args.y1->dval[0];
-    vars_to_set->chaotic_map1.iterations = set_encryption_args.iterations1->ival[0];
-    vars_to_set->chaotic_map2.x = set_encryption_args.x2->dval[0];
-    vars_to_set->chaotic_map2.y = set_encryption_args.y2->dval[0];
-    vars_to_set->chaotic_map2.iterations = set_encryption_args.iterations2->ival[0];
-
-    // Now call check_iterations and check_double_range
-    if (!check_double_range(vars_to_set->chaotic_map1.x, "Map 1 x", map_type) ||
-        !check_double_range(vars_to_set->chaotic_map1.y, "Map 1 y", map_type) ||
-        !check_double_range(vars_to_set->chaotic_map2.x, "Map 2 x", map_type) ||
-        !check_double_range(vars_to_set->chaotic_map2.y, "Map 2 y", map_type)) {
-        return 1; // Return if any double value is out of range
-    }
-
-    vars_to_set->chaotic_map1.iterations = check_iterations(vars_to_set->chaotic_map1.iterations, "Iterations Map 1", map_type);
-    vars_to_set->chaotic_map2.iterations = check_iterations(vars_to_set->chaotic_map2.iterations, "Iterations Map 2", map_type);
-
-    // Log the values after check_iterations and check_double_range
-    ESP_LOGI(CONSOLE_TAG, "Values set after range checks:");
-    ESP_LOGI(CONSOLE_TAG, "Map 1: x=%.6f, y=%.6f, iterations=%d", 
-             vars_to_set->chaotic_map1.x, vars_to_set->chaotic_map1.y, vars_to_set->chaotic_map1.iterations);
-    ESP_LOGI(CONSOLE_TAG, "Map 2: x=%.6f, y=%.6f, iterations=%d", 
-             vars_to_set->chaotic_map2.x, vars_to_set->chaotic_map2.y, vars_to_set->chaotic_map2.iterations);
-
-    // Allocate and initialize msws32_variables
-    if (vars_to_set->msws32_variables != NULL) {
-        free(vars_to_set->msws32_variables);
-    }
-    vars_to_set->msws32_variables = malloc(sizeof(msws32_var_t));
-    if (vars_to_set->msws32_variables == NULL) {
-        ESP_LOGE(CONSOLE_TAG, "Failed to allocate memory for MSWS32 variables");
-        return 1;
-    }
-    memset(vars_to_set->msws32_variables, 0, sizeof(msws32_var_t));
-
-    key_generator_setup(vars_to_set);
-
-    return 0;
-}
-/**
- * @brief Command to get encryption variables.
- *
- * @param argc Argument count.
- * @param argv Argument vector.
- * @return int 0 on success, 1 on failure.
- */
-static int cmd_get_encryption(int argc, char **argv) {
-    int nerrors = arg_parse(argc, argv, (void **)&get_encryption_args);
-    if (nerrors != 0) {
-        arg_print_errors(stderr, get_encryption_args.end, argv[0]);
-        return 1;
-    }
-
-    // Check for mutual exclusivity of TX and RX flags
-    if (get_encryption_args.TX->count + get_encryption_args.RX->count != 1) {
-        ESP_LOGE(CONSOLE_TAG, "Error: You must specify either -TX or -RX, but not both.");
-        return 1;
-    }
-
-    bool is_tx = (get_encryption_args.TX->count > 0);
-    if (!check_encryption_settings(is_tx, !is_tx)) {
-        return 1; // Exit if requested encryption settings are not set
-    }
-
-    encryption_vars_t *vars;
-    const char *mode;
-    if (is_tx) {
-        vars = &TX_encryption_vars;
-        mode = "TX";
-    } else {
-        vars = &RX_encryption_vars;
-        mode = "RX";
-    }
-
-    const char *map_name;
-    switch (vars->type) {
-        case MAP_DUFFING:
-            map_name = "Duffing";
-            break;
-        case MAP_LOGISTIC:
-            map_name = "Logistic";
-            break;
-        case MAP_2D_LOGISTIC:
-            map_name = "2D-LOGISTIC";
-            break;
-        default:
-            map_name = "Unknown";
-    }
-
-    ESP_LOGI(CONSOLE_TAG, "Current %s encryption variables:", mode);
-    ESP_LOGI(CONSOLE_TAG, "Current Map: %s", map_name);
-    ESP_LOGI(CONSOLE_TAG, "Map 1: x=%.6f, y=%.6f, iterations=%d", 
-            vars->chaotic_map1.x, vars->chaotic_map1.y, vars->chaotic_map1.iterations);
-    ESP_LOGI(CONSOLE_TAG, "Map 2: x=%.6f, y=%.6f, iterations=%d", 
-            vars->chaotic_map2.x, vars->chaotic_map2.y, vars->chaotic_map2.iterations);
-    ESP_LOGI(CONSOLE_TAG, "MSWS32: x=%llu, w=%llu, s=%llu", 
-            vars->msws32_variables->x, vars->msws32_variables->w, vars->msws32_variables->s);
-    return 0;
-}
-
-
-/**
- * @brief Registers the set encryption command.
- */
-static void register_set_encryption_command(void) {
-    set_encryption_args.TX = arg_litn("T", "TX", 0 , 1, "TX mode");
-    set_encryption_args.RX = arg_litn("R", "RX", 0 , 1, "RX mode");
-    set_encryption_args.map_type = arg_str1(NULL, NULL, "<map_type>", "Map type (duffing, logistic, or mccm)");
-    set_encryption_args.x1 = arg_dbl1(NULL, NULL, "<x1>", "Map 1 x value");
-    set_encryption_args.y1 = arg_dbl1(NULL, NULL, "<y1>", "Map 1 y value");
-    set_encryption_args.iterations1 = arg_int1(NULL, NULL, "<iterations1>", "Map 1 number of iterations");
-    set_encryption_args.x2 = arg_dbl1(NULL, NULL, "<x2>", "Map 2 x value");
-    set_encryption_args.y2 = arg_dbl1(NULL, NULL, "<y2>", "Map 2 y value");
-    set_encryption_args.iterations2 = arg_int1(NULL, NULL, "<iterations2>", "Map 2 number of iterations");
-    set_encryption_args.end = arg_end(10);
-    
-    const char *syntax = "[-TX | -RX] <map_type> <x1> <y1> <iterations1> <x2> <y2> <iterations2>";
-    const char *description = "Set encryption variables for specified map type in TX or RX mode";
-    register_command("set_encryption", "se", description, syntax, &cmd_set_encryption, &set_encryption_args);
-}
-
-/**
- * @brief Registers the get encryption command.
- */
-static void register_get_encryption_command(void) {
-    get_encryption_args.TX = arg_litn("T", "TX", 0 , 1, "Get TX encryption variables");
-    get_encryption_args.RX = arg_litn("R", "RX", 0 , 1, "Get RX encryption variables");
-    get_encryption_args.end = arg_end(3);
-    register_command("get_encryption", "ge", "Get current encryption variables for TX or RX", "[-TX | -RX]", &cmd_get_encryption, &get_encryption_args);
-}
-
-/**
- * @brief Processes data to be transmitted.
- *
- * @param data The data to be processed.
- */
-static void process_data_to_transmit(const char *data) {
-    ESP_LOGI(CONSOLE_TAG, "Processing data: %s", data);
-    add_str_to_buffer(data);
-}
-
-/**
- * @brief Command to transmit data.
- *
- * @param argc Argument count.
- * @param argv Argument vector.
- * @return int 0 on success, 1 on failure.
- */
-static int cmd_transmit(int argc, char **argv) {
-    if (argc < 2) {
-        ESP_LOGE(CONSOLE_TAG, "No data provided");
-        return 1;
-    }
-
-    // Check if both TX and RX encryption are set
-    if (!check_encryption_settings(true, true)) {
-        ESP_LOGE(CONSOLE_TAG, "Cannot transmit: Both TX and RX encryption values must be set.");
-        return 1;
-    }
-
-    // Combine all arguments into a single string
-    char buffer[MAX_DATA_LENGTH] = {0};
-    int buffer_index = 0;
-    for (int i = 1; i < argc; i++) {
-        int len = strlen(argv[i]);
-        if (buffer_index + len < MAX_DATA_LENGTH - 1) {
-            strncpy(buffer + buffer_index, argv[i], len);
-            buffer_index += len;
-            // Add space between arguments, except for the last one
-            if (i < argc - 1 && buffer_index < MAX_DATA_LENGTH - 1) {
-                buffer[buffer_index++] = ' ';
-            }
-        } else {
-            ESP_LOGW(CONSOLE_TAG, "Buffer full, truncating data");
-            break;
-        }
-    }
-    buffer[buffer_index] = '\0';
-    process_data_to_transmit(buffer);
-    return 0;
-}
-
-/**
- * @brief Registers the transmit command.
- */
-static void register_transmit_command(void) {
-    register_command("transmit", "t", "Send data for transmission", " ", &cmd_transmit, NULL);
-}
-
-/**
- * @brief Command to clear the console.
- *
- * @param argc Argument count.
- * @param argv Argument vector.
- * @return int 0 on success.
- */
-static int cmd_clear(int argc, char **argv) {
-    // ANSI escape sequence to clear the screen
-    printf("\033[H\033[J");
-    return 0;
-}
-
-/**
- * @brief Registers the clear command.
- */
-static void register_clear_command(void) {
-    register_command("clear", "c", "Clear the console output", NULL, &cmd_clear, NULL);
-}
-
-/**
- * @brief Command to print the frequency of communication.
- *
- * @param argc Argument count.
- * @param argv Argument vector.
- * @return int 0 on success.
- */
-static int cmd_frequency(int argc, char **argv) {
-    double frequency = (double)TIMER_RESOLUTION_HZ / TX_PERIOD_MICROS;
-    ESP_LOGI(CONSOLE_TAG, "Frequency of communication: %.2f Hz", frequency);
-    return 0;
-}
-
-/**
- * @brief Registers the frequency command.
- */
-static void register_frequency_command(void) {
-    register_command("freq", "f", "Print the frequency of communication", NULL, &cmd_frequency, NULL);
-}
-
-/**
- * @brief Initializes the console for the Secure VLC Project.
- *
- * This function sets up the console, configures the REPL (Read-Eval-Print Loop),
- * and registers all available commands. It performs the following tasks:
- * 1. Creates and configures a new REPL instance.
- * 2. Sets up the UART for console communication (if configured).
- * 3. Registers all available commands, including:
- *    - Help command
- *    - Set encryption command
- *    - Get encryption command
- *    - Transmit command
- *    - Clear console command
- *    - Frequency command
- *
- * @return esp_console_repl_t* Pointer to the initialized REPL instance.
- *         Returns NULL if initialization fails.
- */
-static esp_console_repl_t* initialize_console(void) {
-    esp_console_repl_t *repl = NULL;
-    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
-    repl_config.prompt = PROMPT_STR;
-    repl_config.max_cmdline_length = MAX_CMDLINE_LENGTH;
-
-    #if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
-    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_console_new_repl_uart(&hw_config, &repl_config, &repl));
-    #endif
-
-    /* Register commands */
-    esp_console_register_help_command();
-    register_set_encryption_command();
-    register_get_encryption_command();
-    register_transmit_command();
-    register_clear_command();
-    register_frequency_command();
-
-    return repl;
-}
-
-/**
- * @brief Task for initializing and managing the REPL console and logging.
- *
- * This task initializes NVS, sets up custom logging, initializes the console,
- * and starts the REPL.
- *
- * @param pvParameters Pointer to task parameters (not used in this case)
- */
-void console_and_logging_task(void *pvParameters) {
-    // Initialize NVS
-    initialize_nvs();
-    
-    // Set custom logging function
-    esp_log_set_vprintf(custom_vprintf);
-
-    // Initialize and start REPL console
-    esp_console_repl_t *repl = initialize_console();
-    ESP_ERROR_CHECK(esp_console_start_repl(repl));
-    ESP_LOGI(CONSOLE_TAG, "Console initialized");
-    
-    // This task should not return, so add an infinite loop
-    while(1) {
-        vTaskDelay(pdMS_TO_TICKS(1000)); // Delay to prevent tight loop
-    }
+/**
+ * @file console_commands.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of console commands for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ *
+ * \par License:
+ *   \ref mit_license "MIT License".
+ * @details This file contains the implementation of various console commands used for
+ * configuring and controlling the Secure VLC Project, including encryption settings,
+ * data transmission, and system information.
+ */
+
+#include "console_commands.h"
+
+
+/** @brief Tag for logging messages related to console operations */
+static const char *CONSOLE_TAG = "CONSOLE";
+
+/** @brief Flag to indicate if TX encryption variables are set, by the end of the key warm-up job */
+volatile bool tx_encryption_set = false;
+
+/** @brief Flag to indicate if RX encryption variables are set, by the end of the key warm-up job */
+volatile bool rx_encryption_set = false;
+
+/** @brief Flag to indicate if a TX key warm-up job was submitted; link jobs queued after it run once it ended */
+static bool tx_encryption_queued = false;
+
+/** @brief Flag to indicate if an RX key warm-up job was submitted; link jobs queued after it run once it ended */
+static bool rx_encryption_queued = false;
+
+/** @brief Flag to indicate if a new line is needed in the custom vprintf function */
+static bool is_new_line = true;
+
+/** @brief Structure for setting encryption arguments */
+static struct set_encryption_args_t {
+    struct arg_lit *TX;
+    struct arg_lit *RX;
+    struct arg_str *map_type;
+    struct arg_dbl *x1;
+    struct arg_dbl *y1;
+    struct arg_int *iterations1;
+    struct arg_dbl *x2;
+    struct arg_dbl *y2;
+    struct arg_int *iterations2;
+    struct arg_end *end;
+} set_encryption_args;
+
+/** @brief Structure for getting encryption arguments */
+static struct get_encryption_args_t{
+    struct arg_lit *TX;
+    struct arg_lit *RX;
+    struct arg_end *end;
+} get_encryption_args;
+
+/** @brief Structure for capture arguments */
+static struct capture_args_t {
+    struct arg_lit *start;
+    struct arg_lit *stop;
+    struct arg_lit *dump;
+    struct arg_lit *eye;
+    struct arg_int *samples;
+    struct arg_end *end;
+} capture_args;
+
+/** @brief Structure for replay arguments */
+static struct replay_args_t {
+    struct arg_lit *synthetic;
+    struct arg_lit *edges;
+    struct arg_int *repeat;
+    struct arg_str *expected;
+    struct arg_end *end;
+} replay_args;
+
+/** @brief Structure for sweep arguments */
+static struct sweep_args_t {
+    struct arg_int *seeds;
+    struct arg_int *words;
+    struct arg_int *base_seed;
+    struct arg_lit *rate;
+    struct arg_end *end;
+} sweep_args;
+
+/** @brief Structure for trace arguments */
+static struct trace_args_t {
+    struct arg_lit *start;
+    struct arg_lit *stop;
+    struct arg_lit *dump;
+    struct arg_end *end;
+} trace_args;
+
+/** @brief Structure for profile arguments */
+static struct profile_args_t {
+    struct arg_lit *start;
+    struct arg_lit *stop;
+    struct arg_lit *reset;
+    struct arg_end *end;
+} profile_args;
+
+/** @brief Structure for frequency arguments */
+static struct freq_args_t {
+    struct arg_lit *probe;
+    struct arg_end *end;
+} freq_args;
+
+/** @brief Structure for PHY arguments */
+static struct phy_args_t {
+    struct arg_str *use;
+    struct arg_int *rate;
+    struct arg_int *bench;
+    struct arg_end *end;
+} phy_args;
+
+/** @brief Structure for diversity arguments */
+static struct diversity_args_t {
+    struct arg_str *mode;
+    struct arg_end *end;
+} diversity_args;
+
+/** @brief Structure for shaping arguments */
+static struct shaping_args_t {
+    struct arg_str *mode;
+    struct arg_end *end;
+} shaping_args;
+
+/** @brief Structure for calibration arguments */
+static struct calibration_args_t {
+    struct arg_lit *train;
+    struct arg_int *words;
+    struct arg_lit *run;
+    struct arg_str *peer;
+    struct arg_end *end;
+} calibration_args;
+
+/** @brief Structure for power arguments */
+static struct power_args_t {
+    struct arg_str *sleep;
+    struct arg_str *peer_sleep;
+    struct arg_int *wake_test;
+    struct arg_end *end;
+} power_args;
+
+/** @brief Structure for run-length arguments */
+static struct runlength_args_t {
+    struct arg_int *words;
+    struct arg_end *end;
+} runlength_args;
+
+/** @brief Structure for RX loop arguments */
+static struct rxloop_args_t {
+    struct arg_str *mode;
+    struct arg_lit *reset;
+    struct arg_int *compare;
+    struct arg_end *end;
+} rxloop_args;
+
+/** @brief Structure for flash stress arguments */
+static struct flashstress_args_t {
+    struct arg_int *frames;
+    struct arg_end *end;
+} flashstress_args;
+
+/** @brief Structure for console output arguments */
+static struct log_args_t {
+    struct arg_str *mode;
+    struct arg_lit *bench;
+    struct arg_int *lines;
+    struct arg_int *words;
+    struct arg_end *end;
+} log_args;
+
+/** @brief Structure for wait arguments */
+static struct wait_args_t {
+    struct arg_int *id;
+    struct arg_int *timeout;
+    struct arg_end *end;
+} wait_args;
+
+/** @brief Structure for link arguments */
+static struct link_args_t {
+    struct arg_int *bench;
+    struct arg_lit *sim;
+    struct arg_int *links;
+    struct arg_int *rounds;
+    struct arg_end *end;
+} link_args;
+
+/**
+ * @brief Custom printf function for the console.
+ *
+ * This function formats messages and hands them to the console output layer, handling new lines and prompts.
+ *
+ * @param format Format string.
+ * @param args Variable argument list.
+ * @return int Number of characters printed.
+ */
+static int custom_vprintf(const char *format, va_list args) {
+    char print_buf[MAX_CMDLINE_LENGTH];
+    TRACE_LOG(TRACE_EVENT_LOG_BEGIN);
+    int ret = vsnprintf(print_buf, sizeof(print_buf), format, args);
+    if (ret >= 0) {
+        char *line = print_buf;
+        char *next_line;
+        while ((next_line = strchr(line, '\n')) != NULL) {
+            if (!is_new_line) {
+                log_batch_write("\n", 1);
+            }
+            log_batch_write(line, (size_t)(next_line + 1 - line));
+            line = next_line + 1;
+            is_new_line = true;
+        }
+        if (*line != '\0') {
+            if (is_new_line) {
+                log_batch_write(PROMPT_STR, strlen(PROMPT_STR));
+            }
+            log_batch_write(line, strlen(line));
+            is_new_line = false;
+        }
+    }
+    TRACE_LOG(TRACE_EVENT_LOG_END);
+    return ret;
+}
+
+/**
+ * @brief Registers a console command.
+ *
+ * @param command The command string.
+ * @param short_command The short command string.
+ * @param help The help string.
+ * @param hint The hint string.
+ * @param func The function to execute the command.
+ * @param argtable The argument table.
+ */
+static void register_command(const char *command, const char *short_command, const char *help, const char *hint, esp_console_cmd_func_t func, void *argtable) {
+    const esp_console_cmd_t cmd = {
+        .command = command,
+        .help = help,
+        .hint = hint,
+        .func = func,
+        .argtable = argtable,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+    if (short_command != NULL) {
+        const esp_console_cmd_t short_cmd = {
+            .command = short_command,
+            .help = NULL, // Hide short command from help
+            .hint = hint,
+            .func = func,
+            .argtable = argtable,
+        };
+        ESP_ERROR_CHECK(esp_console_cmd_register(&short_cmd));
+    }
+}
+
+/**
+ * @brief Check if encryption settings are set, or queued to be set before the next link job runs.
+ *
+ * Commands that submit a link job use it: the job runs after the key warm-up jobs submitted before it.
+ *
+ * @param check_tx Check TX encryption.
+ * @param check_rx Check RX encryption.
+ * @return bool True if the required encryption settings are set, false otherwise.
+ */
+static bool check_encryption_settings(bool check_tx, bool check_rx) {
+    if (tx_encryption_queued && rx_encryption_queued) {
+        ESP_LOGI(CONSOLE_TAG, "Both TX and RX encryption values are set.");
+        return true;
+    }
+    if (check_tx && check_rx) {
+        if (!tx_encryption_queued && !rx_encryption_queued) {
+            ESP_LOGW(CONSOLE_TAG, "Both TX and RX encryption values are not set.");
+        } else if (!tx_encryption_queued) {
+            ESP_LOGW(CONSOLE_TAG, "TX encryption values are not set.");
+        } else {
+            ESP_LOGW(CONSOLE_TAG, "RX encryption values are not set.");
+        }
+        return false;
+    }
+    if (check_tx && !tx_encryption_queued) {
+        ESP_LOGW(CONSOLE_TAG, "TX encryption values are not set.");
+        return false; // Return true if we're only checking TX
+    }
+    if (check_rx && !rx_encryption_queued) {
+        ESP_LOGW(CONSOLE_TAG, "RX encryption values are not set.");
+        return false; // Return true if we're only checking RX
+    }
+    return true;
+}
+
+/**
+ * @brief Check if encryption settings are set and their key warm-up job ended.
+ *
+ * Commands that read the keystream at once use it, as it is only valid once the job ended.
+ *
+ * @param check_tx Check TX encryption.
+ * @param check_rx Check RX encryption.
+ * @return bool True if the required keystreams are ready, false otherwise.
+ */
+static bool check_encryption_ready(bool check_tx, bool check_rx) {
+    if (!check_encryption_settings(check_tx, check_rx)) {
+        return false;
+    }
+    if ((check_tx && !tx_encryption_set) || (check_rx && !rx_encryption_set)) {
+        ESP_LOGW(CONSOLE_TAG, "The key generator is still warming up, wait for the keys job to end.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks if a double value is within the valid range for the given map type.
+ *
+ * @param value The double value to check.
+ * @param name The name of the value (for logging).
+ * @param map_type The type of map being used.
+ * @return bool True if the value is within range, false otherwise.
+ */
+static bool check_double_range(double value, const char* name, map_type_t map_type) {
+    double min_value, max_value;
+
+    switch (map_type) {
+        case MAP_DUFFING:
+            min_value = -1.2;
+            max_value = 1.2;
+            break;
+        case MAP_LOGISTIC:
+            min_value = 0.0;
+            max_value = 1.0;
+            break;
+        case MAP_2D_LOGISTIC:
+            min_value = -1.0;
+            max_value = 1.0;
+            break;
+        default:
+            ESP_LOGE(CONSOLE_TAG, "Error: Unknown map type for range checking.");
+            return false;
+    }
+
+    if (value < min_value || value > max_value) {
+        ESP_LOGE(CONSOLE_TAG, "Error: %s value %.6f is out of range [%.6f, %.6f] for %s map. Please try again.", 
+                name, value, min_value, max_value, 
+                map_type == MAP_DUFFING ? "Duffing" : 
+                map_type == MAP_LOGISTIC ? "Logistic" : "2D-MCCM");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks if the number of iterations is within the valid range for the given map type.
+ *
+ * @param value The number of iterations to check.
+ * @param name The name of the value (for logging).
+ * @param map_type The type of map being used.
+ * @return int The valid number of iterations.
+ */
+static int check_iterations(int value, const char* name, map_type_t map_type) {
+    int min_iterations = 200;
+    int max_iterations = 1000000;
+
+    // You can add map-specific iteration limits here in the future
+    switch (map_type) {
+        case MAP_DUFFING:
+        case MAP_LOGISTIC:
+        case MAP_2D_LOGISTIC:
+            // Currently using the same limits for all maps
+            break;
+        default:
+            ESP_LOGE(CONSOLE_TAG, "Error: Unknown map type for iteration checking.");
+            return min_iterations;
+    }
+
+    if (value < min_iterations) {
+        ESP_LOGW(CONSOLE_TAG, "Warning: %s must be at least %d for %s map. Setting to %d.", 
+                name, min_iterations, 
+                map_type == MAP_DUFFING ? "Duffing" : 
+                map_type == MAP_LOGISTIC ? "Logistic" : "2D-MCCM", 
+                min_iterations);
+        return min_iterations;
+    }
+    if (value > max_iterations) {
+        ESP_LOGW(CONSOLE_TAG, "Warning: %s exceeds %d for %s map. Setting to %d.", 
+                name, max_iterations, 
+                map_type == MAP_DUFFING ? "Duffing" : 
+                map_type == MAP_LOGISTIC ? "Logistic" : "2D-MCCM", 
+                max_iterations);
+        return max_iterations;
+    }
+    return value;
+}
+
+/**
+ * @brief Submits a console job and prints its ID.
+ *
+ * @param name Name of the job.
+ * @param fn Function of the job.
+ * @param arg Arguments, copied into the job, or NULL.
+ * @param arg_size Size of the arguments.
+ * @param link true if the job drives the link.
+ * @return int 0 on success, 1 on failure.
+ */
+static int submit_job(const char *name, console_job_fn_t fn, const void *arg, size_t arg_size, bool link) {
+    uint32_t id;
+    esp_err_t err = console_job_submit(name, fn, arg, arg_size, link, &id);
+    if (err == ESP_ERR_NO_MEM) {
+        ESP_LOGE(CONSOLE_TAG, "Error: %d jobs are already queued or running, wait for one to end.", JOB_MAX);
+        return 1;
+    } else if (err != ESP_OK) {
+        ESP_LOGE(CONSOLE_TAG, "Error: Could not submit the job (%s).", esp_err_to_name(err));
+        return 1;
+    }
+    ESP_LOGI(CONSOLE_TAG, "Job %lu: %s", (unsigned long)id, name);
+    return 0;
+}
+
+/**
+ * @brief Arguments of the key warm-up job.
+ */
+typedef struct {
+    bool rx;                    /**< Set the RX encryption variables, otherwise the TX ones */
+    map_type_t type;            /**< Map type */
+    chaotic_map_t map1;         /**< Initial state of map 1 */
+    chaotic_map_t map2;         /**< Initial state of map 2 */
+} set_encryption_job_t;
+
+/**
+ * @brief Job setting encryption variables and warming up their key generator.
+ *
+ * @param job The job.
+ * @param arg Pointer to a set_encryption_job_t.
+ * @return int 0 on success, 1 on failure.
+ */
+static int set_encryption_job(console_job_t *job, void *arg) {
+    const set_encryption_job_t *params = (const set_encryption_job_t *)arg;
+
+    // The new keystream is warmed up aside, so the one in use stays valid until it is swapped in
+    encryption_vars_t fresh = {
+        .type = params->type,
+        .chaotic_map1 = params->map1,
+        .chaotic_map2 = params->map2,
+    };
+    fresh.msws32_variables = calloc(1, sizeof(msws32_var_t));
+    if (fresh.msws32_variables == NULL) {
+        ESP_LOGE(CONSOLE_TAG, "Failed to allocate memory for MSWS32 variables");
+        return 1;
+    }
+
+    // The map iterations are the longest key generation burst
+    console_job_progress(job, 0, 1);
+    power_burst_begin();
+    key_generator_setup(&fresh);
+    power_burst_end();
+    console_job_progress(job, 1, 1);
+
+    msws32_var_t *stale;
+    if (params->rx) {
+        rx_keys_lock();
+        stale = RX_encryption_vars.msws32_variables;
+        RX_encryption_vars = fresh;
+        rx_encryption_set = true;
+        rx_keys_unlock();
+    } else {
+        tx_keys_lock();
+        stale = TX_encryption_vars.msws32_variables;
+        TX_encryption_vars = fresh;
+        tx_encryption_set = true;
+        tx_keys_unlock();
+    }
+    free(stale);
+
+    // Wakes the tasks waiting for the keys
+    boot_signal(params->rx ? BOOT_BIT_RX_KEYS : BOOT_BIT_TX_KEYS);
+    return 0;
+}
+
+esp_err_t console_set_encryption(bool rx, map_type_t map_type, const chaotic_map_t *map1, const chaotic_map_t *map2, uint32_t *job_id) {
+    // Check all double values
+    if (!check_double_range(map1->x, "Map 1 x", map_type) ||
+        !check_double_range(map1->y, "Map 1 y", map_type) ||
+        !check_double_range(map2->x, "Map 2 x", map_type) ||
+        !check_double_range(map2->y, "Map 2 y", map_type)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    set_encryption_job_t params = {
+        .rx = rx,
+        .type = map_type,
+        .map1 = *map1,
+        .map2 = *map2,
+    };
+    params.map1.iterations = check_iterations(map1->iterations, "Iterations Map 1", map_type);
+    params.map2.iterations = check_iterations(map2->iterations, "Iterations Map 2", map_type);
+
+    // Log the values after check_iterations
+    ESP_LOGI(CONSOLE_TAG, "Values set after range checks:");
+    ESP_LOGI(CONSOLE_TAG, "Map 1: x=%.6f, y=%.6f, iterations=%d", params.map1.x, params.map1.y, params.map1.iterations);
+    ESP_LOGI(CONSOLE_TAG, "Map 2: x=%.6f, y=%.6f, iterations=%d", params.map2.x, params.map2.y, params.map2.iterations);
+
+    // The warm-up runs as a job; link jobs queued from now on run after it
+    esp_err_t err = console_job_submit(rx ? "keys RX" : "keys TX", &set_encryption_job, &params, sizeof(params), true, job_id);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (rx) {
+        rx_encryption_queued = true;
+    } else {
+        tx_encryption_queued = true;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Command to set encryption variables.
+ *
+ * The arguments are checked at once and the key generator is warmed up by a job.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_set_encryption(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&set_encryption_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, set_encryption_args.end, argv[0]);
+        return 1;
+    }
+
+    // Check for mutual exclusivity of TX and RX flags
+    if (set_encryption_args.TX->count + set_encryption_args.RX->count != 1) {
+        ESP_LOGE(CONSOLE_TAG, "Error: You must specify either -TX or -RX, but not both.");
+        return 1;
+    }
+
+    // Check if map type is provided
+    if (set_encryption_args.map_type->count == 0) {
+        ESP_LOGE(CONSOLE_TAG, "Error: You must specify a map type (duffing, logistic, or mccm).");
+        return 1;
+    }
+
+    map_type_t map_type;
+    if ((strcmp(set_encryption_args.map_type->sval[0], "duffing") == 0) || (strcmp(set_encryption_args.map_type->sval[0], "d") == 0)) {
+        map_type = MAP_DUFFING;
+    } else if ((strcmp(set_encryption_args.map_type->sval[0], "logistic") == 0) || (strcmp(set_encryption_args.map_type->sval[0], "l") == 0)) {
+        map_type = MAP_LOGISTIC;
+    } else if ((strcmp(set_encryption_args.map_type->sval[0], "mccm") == 0) || (strcmp(set_encryption_args.map_type->sval[0], "m") == 0)) {
+        map_type = MAP_2D_LOGISTIC;
+    } else {
+        ESP_LOGE(CONSOLE_TAG, "Error: Invalid map type. Must be duffing, logistic, or mccm.");
+        return 1;
+    }
+
+    bool rx = set_encryption_args.RX->count > 0;
+    ESP_LOGI(CONSOLE_TAG, "%s mode selected", rx ? "RX" : "TX");
+
+    // Log the input values
+    ESP_LOGI(CONSOLE_TAG, "Input values:");
+    ESP_LOGI(CONSOLE_TAG, "Map 1: x=%.6f, y=%.6f, iterations=%d", 
+             set_encryption_args.x1->dval[0], set_encryption_args.y1->dval[0], set_encryption_args.iterations1->ival[0]);
+    ESP_LOGI(CONSOLE_TAG, "Map 2: x=%.6f, y=%.6f, iterations=%d", 
+             set_encryption_args.x2->dval[0], set_encryption_args.y2->dval[0], set_encryption_args.iterations2->ival[0]);
+
+    chaotic_map_t map1 = { set_encryption_args.x1->dval[0], set_encryption_args.y1->dval[0], set_encryption_args.iterations1->ival[0] };
+    chaotic_map_t map2 = { set_encryption_args.x2->dval[0], set_encryption_args.y2->dval[0], set_encryption_args.iterations2->ival[0] };
+    uint32_t id;
+    esp_err_t err = console_set_encryption(rx, map_type, &map1, &map2, &id);
+    if (err == ESP_ERR_INVALID_ARG) {
+        return 1; // Return if any double value is out of range
+    } else if (err == ESP_ERR_NO_MEM) {
+        ESP_LOGE(CONSOLE_TAG, "Error: %d jobs are already queued or running, wait for one to end.", JOB_MAX);
+        return 1;
+    } else if (err != ESP_OK) {
+        ESP_LOGE(CONSOLE_TAG, "Error: Could not submit the job (%s).", esp_err_to_name(err));
+        return 1;
+    }
+    ESP_LOGI(CONSOLE_TAG, "Job %lu: keys %s", (unsigned long)id, rx ? "RX" : "TX");
+    return 0;
+}
+/**
+ * @brief Command to get encryption variables.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_get_encryption(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&get_encryption_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, get_encryption_args.end, argv[0]);
+        return 1;
+    }
+
+    // Check for mutual exclusivity of TX and RX flags
+    if (get_encryption_args.TX->count + get_encryption_args.RX->count != 1) {
+        ESP_LOGE(CONSOLE_TAG, "Error: You must specify either -TX or -RX, but not both.");
+        return 1;
+    }
+
+    bool is_tx = (get_encryption_args.TX->count > 0);
+    if (!check_encryption_ready(is_tx, !is_tx)) {
+        return 1; // Exit if requested encryption settings are not set
+    }
+
+    // The keystreams are read from a snapshot, as the RX decode task and the transmitting jobs advance them
+    encryption_vars_t snapshot;
+    msws32_var_t snapshot_msws32;
+    encryption_vars_t *vars = &snapshot;
+    const char *mode;
+    if (is_tx) {
+        tx_keys_clone(&snapshot, &snapshot_msws32);
+        mode = "TX";
+    } else {
+        rx_keys_clone(&snapshot, &snapshot_msws32);
+        mode = "RX";
+    }
+
+    const char *map_name;
+    switch (vars->type) {
+        case MAP_DUFFING:
+            map_name = "Duffing";
+            break;
+        case MAP_LOGISTIC:
+            map_name = "Logistic";
+            break;
+        case MAP_2D_LOGISTIC:
+            map_name = "2D-LOGISTIC";
+            break;
+        default:
+            map_name = "Unknown";
+    }
+
+    ESP_LOGI(CONSOLE_TAG, "Current %s encryption variables:", mode);
+    ESP_LOGI(CONSOLE_TAG, "Current Map: %s", map_name);
+    ESP_LOGI(CONSOLE_TAG, "Map 1: x=%.6f, y=%.6f, iterations=%d", 
+            vars->chaotic_map1.x, vars->chaotic_map1.y, vars->chaotic_map1.iterations);
+    ESP_LOGI(CONSOLE_TAG, "Map 2: x=%.6f, y=%.6f, iterations=%d", 
+            vars->chaotic_map2.x, vars->chaotic_map2.y, vars->chaotic_map2.iterations);
+    ESP_LOGI(CONSOLE_TAG, "MSWS32: x=%llu, w=%llu, s=%llu", 
+            vars->msws32_variables->x, vars->msws32_variables->w, vars->msws32_variables->s);
+    return 0;
+}
+
+
+/**
+ * @brief Registers the set encryption command.
+ */
+static void register_set_encryption_command(void) {
+    set_encryption_args.TX = arg_litn("T", "TX", 0 , 1, "TX mode");
+    set_encryption_args.RX = arg_litn("R", "RX", 0 , 1, "RX mode");
+    set_encryption_args.map_type = arg_str1(NULL, NULL, "<map_type>", "Map type (duffing, logistic, or mccm)");
+    set_encryption_args.x1 = arg_dbl1(NULL, NULL, "<x1>", "Map 1 x value");
+    set_encryption_args.y1 = arg_dbl1(NULL, NULL, "<y1>", "Map 1 y value");
+    set_encryption_args.iterations1 = arg_int1(NULL, NULL, "<iterations1>", "Map 1 number of iterations");
+    set_encryption_args.x2 = arg_dbl1(NULL, NULL, "<x2>", "Map 2 x value");
+    set_encryption_args.y2 = arg_dbl1(NULL, NULL, "<y2>", "Map 2 y value");
+    set_encryption_args.iterations2 = arg_int1(NULL, NULL, "<iterations2>", "Map 2 number of iterations");
+    set_encryption_args.end = arg_end(10);
+    
+    const char *syntax = "[-TX | -RX] <map_type> <x1> <y1> <iterations1> <x2> <y2> <iterations2>";
+    const char *description = "Set encryption variables for specified map type in TX or RX mode";
+    register_command("set_encryption", "se", description, syntax, &cmd_set_encryption, &set_encryption_args);
+}
+
+/**
+ * @brief Registers the get encryption command.
+ */
+static void register_get_encryption_command(void) {
+    get_encryption_args.TX = arg_litn("T", "TX", 0 , 1, "Get TX encryption variables");
+    get_encryption_args.RX = arg_litn("R", "RX", 0 , 1, "Get RX encryption variables");
+    get_encryption_args.end = arg_end(3);
+    register_command("get_encryption", "ge", "Get current encryption variables for TX or RX", "[-TX | -RX]", &cmd_get_encryption, &get_encryption_args);
+}
+
+/**
+ * @brief Job transmitting data, one frame per FRAME_MAX_PAYLOAD_WORDS words, waiting while the PHY queue is full.
+ *
+ * @param job The job.
+ * @param arg The data, as a string.
+ * @return int 0 on success, 1 if a frame was refused.
+ */
+static int transmit_job(console_job_t *job, void *arg) {
+    const char *data = (const char *)arg;
+    char chunk[FRAME_MAX_PAYLOAD_WORDS * 4 + 1];
+    size_t length = strlen(data);
+    uint32_t frames = (uint32_t)((length + sizeof(chunk) - 2) / (sizeof(chunk) - 1));
+    ESP_LOGI(CONSOLE_TAG, "Processing data: %s", data);
+    for (uint32_t i = 0; i < frames; i++) {
+        snprintf(chunk, sizeof(chunk), "%s", data + i * (sizeof(chunk) - 1));
+        esp_err_t err;
+        while ((err = submit_str_frame(chunk)) == ESP_ERR_NO_MEM) {
+            vTaskDelay(1);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGE(CONSOLE_TAG, "Frame %lu refused: %s", (unsigned long)i, esp_err_to_name(err));
+            return 1;
+        }
+        console_job_progress(job, i + 1, frames);
+    }
+    return 0;
+}
+
+esp_err_t console_transmit(const char *data, size_t length, uint32_t *job_id) {
+    if (length >= MAX_DATA_LENGTH || memchr(data, '\0', length) != NULL) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (!check_encryption_settings(true, true)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    char buffer[MAX_DATA_LENGTH];
+    memcpy(buffer, data, length);
+    buffer[length] = '\0';
+    return console_job_submit("transmit", &transmit_job, buffer, length + 1, true, job_id);
+}
+
+/**
+ * @brief Command to transmit data.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_transmit(int argc, char **argv) {
+    if (argc < 2) {
+        ESP_LOGE(CONSOLE_TAG, "No data provided");
+        return 1;
+    }
+
+    // Check if both TX and RX encryption are set
+    if (!check_encryption_settings(true, true)) {
+        ESP_LOGE(CONSOLE_TAG, "Cannot transmit: Both TX and RX encryption values must be set.");
+        return 1;
+    }
+
+    // Combine all arguments into a single string
+    char buffer[MAX_DATA_LENGTH] = {0};
+    int buffer_index = 0;
+    for (int i = 1; i < argc; i++) {
+        int len = strlen(argv[i]);
+        if (buffer_index + len < MAX_DATA_LENGTH - 1) {
+            strncpy(buffer + buffer_index, argv[i], len);
+            buffer_index += len;
+            // Add space between arguments, except for the last one
+            if (i < argc - 1 && buffer_index < MAX_DATA_LENGTH - 1) {
+                buffer[buffer_index++] = ' ';
+            }
+        } else {
+            ESP_LOGW(CONSOLE_TAG, "Buffer full, truncating data");
+            break;
+        }
+    }
+    buffer[buffer_index] = '\0';
+    return submit_job("transmit", &transmit_job, buffer, (size_t)buffer_index + 1, true);
+}
+
+/**
+ * @brief Registers the transmit command.
+ */
+static void register_transmit_command(void) {
+    register_command("transmit", "t", "Send data for transmission", " ", &cmd_transmit, NULL);
+}
+
+/**
+ * @brief Command to clear the console.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success.
+ */
+static int cmd_clear(int argc, char **argv) {
+    // ANSI escape sequence to clear the screen
+    printf("\033[H\033[J");
+    return 0;
+}
+
+/**
+ * @brief Registers the clear command.
+ */
+static void register_clear_command(void) {
+    register_command("clear", "c", "Clear the console output", NULL, &cmd_clear, NULL);
+}
+
+/**
+ * @brief Command to print the frequency of communication of the active PHY and the budget of the last rate probe.
+ *
+ * With -p, probes again, for the map of the TX keys once they are set, and applies the new bit period, one of
+ * RATE_PROBE_PERIODS_MICROS; run it on both boards of the link.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_frequency(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&freq_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, freq_args.end, argv[0]);
+        return 1;
+    }
+
+    if (freq_args.probe->count > 0) {
+        rate_probe_result_t probe;
+        encryption_vars_t keys;
+        msws32_var_t keys_msws32;
+        bool keys_ready = tx_encryption_set;
+        if (keys_ready) {
+            tx_keys_clone(&keys, &keys_msws32);
+        }
+        esp_err_t err = phy_probe_run(keys_ready ? &keys : NULL, &probe);
+        if (err == ESP_OK) {
+            err = phy_probe_apply(probe.bit_period_micros);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Rate probe failed: %s", esp_err_to_name(err));
+            return 1;
+        }
+    }
+
+    vlc_phy_stats_t stats;
+    phy_active()->get_stats(&stats);
+    double frequency = (double)TIMER_RESOLUTION_HZ / stats.bit_period_micros;
+    ESP_LOGI(CONSOLE_TAG, "Frequency of communication: %.2f Hz (%s PHY)", frequency, phy_active()->name);
+
+    const rate_probe_result_t *last = phy_probe_last();
+    if (last == NULL) {
+        ESP_LOGI(CONSOLE_TAG, "No rate probe run yet.");
+        return 0;
+    }
+    ESP_LOGI(CONSOLE_TAG, "Probed: %lu us/bit sustainable, bound by %s", (unsigned long)last->bit_period_micros,
+             rate_probe_limit_name(last->limit));
+    ESP_LOGI(CONSOLE_TAG, "  ISR entry %lu cycles (max %lu), %s key %lu cycles, queue %lu cycles at %lu MHz",
+             (unsigned long)last->costs.isr_entry_cycles, (unsigned long)last->costs.isr_entry_max_cycles,
+             rate_probe_map_name(last->costs.map), (unsigned long)last->costs.keygen_cycles,
+             (unsigned long)last->costs.queue_cycles, (unsigned long)last->costs.cpu_mhz);
+    for (int l = 0; l < RATE_PROBE_LIMIT_COUNT; l++) {
+        ESP_LOGI(CONSOLE_TAG, "  %-10s >= %lu ns", rate_probe_limit_name((rate_probe_limit_t)l), (unsigned long)last->bound_nanos[l]);
+    }
+    return 0;
+}
+
+/**
+ * @brief Registers the frequency command.
+ */
+static void register_frequency_command(void) {
+    freq_args.probe = arg_lit0("p", "probe", "Probe the sustainable bit rate again, for the TX map if set, and apply it");
+    freq_args.end = arg_end(2);
+    register_command("freq", "f", "Print the frequency of communication and the probed bit rate budget", "[-p]", &cmd_frequency, &freq_args);
+}
+
+/**
+ * @brief Command to capture raw RX samples.
+ *
+ * Without options, prints the state of the last capture.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_capture(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&capture_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, capture_args.end, argv[0]);
+        return 1;
+    }
+
+    if (capture_args.start->count > 0) {
+        uint32_t samples = capture_args.samples->count > 0 ? (uint32_t)capture_args.samples->ival[0] : RX_CAPTURE_MAX_SAMPLES;
+        if (RX_capture_start(samples) != ESP_OK) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Could not start capture.");
+            return 1;
+        }
+        return 0;
+    }
+    if (capture_args.stop->count > 0) {
+        RX_capture_stop();
+    }
+
+    const rx_capture_header_t *header = RX_capture_get(NULL, NULL);
+    if (header == NULL) {
+        ESP_LOGW(CONSOLE_TAG, "No capture available.");
+        return 1;
+    }
+    if (RX_capture_is_running()) {
+        ESP_LOGI(CONSOLE_TAG, "Capture running: %lu samples so far.", (unsigned long)header->sample_count);
+        return 0;
+    }
+    RX_capture_release();
+
+    if (capture_args.dump->count > 0) {
+        size_t written = RX_capture_dump(stdout);
+        ESP_LOGI(CONSOLE_TAG, "Capture dumped: %u bytes.", (unsigned)written);
+    } else if (capture_args.eye->count > 0) {
+        uint32_t bins[RX_CAPTURE_OVERSAMPLING];
+        RX_capture_edge_histogram(bins);
+        for (int i = 0; i < RX_CAPTURE_OVERSAMPLING; i++) {
+            ESP_LOGI(CONSOLE_TAG, "Edge phase %d/%d: %lu", i, RX_CAPTURE_OVERSAMPLING, (unsigned long)bins[i]);
+        }
+    } else {
+        ESP_LOGI(CONSOLE_TAG, "Capture: %lu samples at %lu ns, %lu edges, %lu dropped edges.",
+                 (unsigned long)header->sample_count, (unsigned long)header->sample_period_ns,
+                 (unsigned long)header->edge_count, (unsigned long)header->dropped_edges);
+    }
+    return 0;
+}
+
+/**
+ * @brief Registers the capture command.
+ */
+static void register_capture_command(void) {
+    capture_args.start = arg_litn("s", "start", 0, 1, "Start a new capture");
+    capture_args.stop = arg_litn("x", "stop", 0, 1, "Stop the running capture");
+    capture_args.dump = arg_litn("d", "dump", 0, 1, "Dump the last capture in binary");
+    capture_args.eye = arg_litn("e", "eye", 0, 1, "Print the edge phase histogram of the last capture");
+    capture_args.samples = arg_int0("n", "samples", "<n>", "Number of samples to capture");
+    capture_args.end = arg_end(5);
+    register_command("capture", "cap", "Capture raw RX samples for offline analysis", "[-s [-n <n>] | -x | -d | -e]", &cmd_capture, &capture_args);
+}
+
+/**
+ * @brief Packs a string into 32-bit words the way the transmitter does.
+ *
+ * @param str The string to pack.
+ * @param words Array to store the words.
+ * @param max_words Size of the words array.
+ * @return Number of words written.
+ */
+static size_t pack_str_to_words(const char *str, uint32_t *words, size_t max_words) {
+    size_t len = strlen(str);
+    size_t count = 0;
+    for (size_t i = 0; i < len && count < max_words; i += 4) {
+        uint32_t word = 0;
+        for (size_t b = 0; b < 4 && i + b < len; b++) {
+            word |= (uint32_t)(unsigned char)str[i + b] << (8 * b);
+        }
+        words[count++] = word;
+    }
+    return count;
+}
+
+/**
+ * @brief Command to replay a trace through the RX decoder.
+ *
+ * Decodes either the last capture or a synthetic frame of the expected text, with the mid-bit
+ * sampling decoder or the edge decoder, as many times as requested, checks the decoded frame against the expected text when one is given,
+ * and reports the decoding speed in bits per second of CPU time. The live RX keystream is
+ * not advanced.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_replay(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&replay_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, replay_args.end, argv[0]);
+        return 1;
+    }
+
+    bool synthetic = replay_args.synthetic->count > 0;
+    bool edges = replay_args.edges->count > 0;
+    bool has_expected = replay_args.expected->count > 0;
+    int repeat = replay_args.repeat->count > 0 ? replay_args.repeat->ival[0] : 1;
+    if (repeat < 1) {
+        repeat = 1;
+    }
+    if ((synthetic || has_expected) && !check_encryption_ready(false, true)) {
+        return 1;
+    }
+    if (synthetic && !has_expected) {
+        ESP_LOGE(CONSOLE_TAG, "Error: A synthetic trace needs the expected text.");
+        return 1;
+    }
+
+    uint32_t expected[FRAME_MAX_PAYLOAD_WORDS];
+    size_t expected_count = has_expected ? pack_str_to_words(replay_args.expected->sval[0], expected, FRAME_MAX_PAYLOAD_WORDS) : 0;
+
+    // Snapshots of the RX keystream, so the live receiver stays in sync
+    encryption_vars_t keystream;
+    msws32_var_t keystream_msws32;
+
+    const uint32_t *samples = NULL;
+    uint32_t *synthetic_samples = NULL;
+    uint32_t sample_count;
+    uint16_t oversampling;
+    if (synthetic) {
+        uint32_t frame[FRAME_MAX_WORDS];
+        rx_keys_clone(&keystream, &keystream_msws32);
+        size_t frame_count = frame_build(&keystream, replay_args.expected->sval[0], FRAME_AUTH_ENABLE, frame);
+        if (frame_count == 0) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Text too long for one frame.");
+            return 1;
+        }
+        uint32_t max_samples = (uint32_t)(frame_count * (RX_DECODER_SYNTH_IDLE_BITS + 1 + RX_DECODER_WORD_BITS)
+                                          + RX_DECODER_SYNTH_IDLE_BITS) * RX_CAPTURE_OVERSAMPLING;
+        synthetic_samples = calloc((max_samples + 31) / 32, sizeof(uint32_t));
+        if (synthetic_samples == NULL) {
+            ESP_LOGE(CONSOLE_TAG, "Failed to allocate memory for the synthetic trace");
+            return 1;
+        }
+        oversampling = RX_CAPTURE_OVERSAMPLING;
+        sample_count = rx_decoder_synthesize(frame, frame_count, oversampling, synthetic_samples, max_samples);
+        samples = synthetic_samples;
+    } else {
+        const rx_capture_header_t *header = RX_capture_get(&samples, NULL);
+        if (header == NULL || RX_capture_is_running()) {
+            ESP_LOGE(CONSOLE_TAG, "Error: No finished capture to replay.");
+            return 1;
+        }
+        RX_capture_release();
+        sample_count = header->sample_count;
+        oversampling = header->oversampling;
+    }
+
+    uint32_t words[BUFFER_MAX_SIZE];
+    size_t word_count = 0;
+    double seconds = 0;
+    rx_decoder_stats_t rejected;
+    for (int r = 0; r < repeat; r++) {
+        rejected = (rx_decoder_stats_t){0};
+        // Cycles to seconds at the frequency of this run, which power management may have lowered
+        uint32_t ticks_per_us = esp_rom_get_cpu_ticks_per_us();
+        esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+        word_count = edges ? rx_edges_replay(samples, sample_count, oversampling, words, BUFFER_MAX_SIZE, &rejected)
+                           : rx_decoder_replay(samples, sample_count, oversampling, words, BUFFER_MAX_SIZE, &rejected);
+        esp_cpu_cycle_count_t cycles = esp_cpu_get_cycle_count() - start;
+        seconds += (double)cycles / (ticks_per_us * 1000000.0);
+    }
+    free(synthetic_samples);
+
+    uint64_t bits = (uint64_t)word_count * RX_DECODER_WORD_BITS * repeat;
+    ESP_LOGI(CONSOLE_TAG, "Replay (%s): %u words from %lu samples, %d run(s), %.0f bits/s of CPU time (%.1fx real time).",
+             edges ? "edges" : "mid-bit", (unsigned)word_count, (unsigned long)sample_count, repeat,
+             seconds > 0 ? bits / seconds : 0.0,
+             seconds > 0 ? ((double)bits * RX_PERIOD_MICROS / 1000000.0) / seconds : 0.0);
+    ESP_LOGI(CONSOLE_TAG, "Rejected per run: %lu false starts, %lu framing errors.",
+             (unsigned long)rejected.false_starts, (unsigned long)rejected.framing_errors);
+
+    if (!has_expected) {
+        return 0;
+    }
+    rx_keys_clone(&keystream, &keystream_msws32);
+    static frame_assembler_t assembler;
+    uint32_t payload[FRAME_MAX_PAYLOAD_WORDS];
+    frame_assembler_reset(&assembler);
+    size_t w = 0;
+    while (w < word_count && frame_assembler_push(&assembler, &keystream, words[w++]) != FRAME_ASSEMBLER_COMPLETE) {
+    }
+    if (assembler.expected == 0 || assembler.received != assembler.expected) {
+        ESP_LOGE(CONSOLE_TAG, "Replay mismatch: no valid frame decoded.");
+        return 1;
+    }
+    if (!frame_open(&assembler, &keystream, payload)) {
+        ESP_LOGE(CONSOLE_TAG, "Replay mismatch: authentication tag rejected.");
+        return 1;
+    }
+    uint16_t payload_words = assembler.payload_words;
+    size_t errors = (payload_words == expected_count) ? 0 : 1;
+    for (size_t i = 0; i < payload_words && i < expected_count; i++) {
+        if (payload[i] != expected[i]) {
+            errors++;
+        }
+    }
+    if (errors != 0) {
+        ESP_LOGE(CONSOLE_TAG, "Replay mismatch: %u word(s) differ, %u decoded, %u expected.",
+                 (unsigned)errors, (unsigned)payload_words, (unsigned)expected_count);
+        return 1;
+    }
+    ESP_LOGI(CONSOLE_TAG, "Replay matches the expected text.");
+    return 0;
+}
+
+/**
+ * @brief Registers the replay command.
+ */
+static void register_replay_command(void) {
+    replay_args.synthetic = arg_litn("s", "synthetic", 0, 1, "Replay a synthetic trace of the expected text instead of the last capture");
+    replay_args.edges = arg_litn("e", "edges", 0, 1, "Decode the edges of the trace with the edge decoder");
+    replay_args.repeat = arg_int0("n", "repeat", "<n>", "Number of decoding runs used for timing");
+    replay_args.expected = arg_str0(NULL, NULL, "<text>", "Expected plaintext");
+    replay_args.end = arg_end(4);
+    register_command("replay", "rp", "Replay a trace through the RX decoder and time it", "[-s] [-e] [-n <n>] [<text>]", &cmd_replay, &replay_args);
+}
+
+/**
+ * @brief Arguments of the sweep job.
+ */
+typedef struct {
+    uint32_t seeds;     /**< Seeds per parameter combination */
+    uint32_t words;     /**< Words per simulated link */
+    uint32_t base_seed; /**< Seed of the first simulation */
+} sweep_job_t;
+
+/**
+ * @brief Job running the link simulator parameter sweep.
+ *
+ * @param job The job.
+ * @param arg Pointer to a sweep_job_t.
+ * @return int 0 on success, 1 on failure.
+ */
+static int sweep_job(console_job_t *job, void *arg) {
+    const sweep_job_t *params = (const sweep_job_t *)arg;
+    return sim_sweep_run(params->seeds, params->words, params->base_seed, stdout) == ESP_OK ? 0 : 1;
+}
+
+/**
+ * @brief Command to run the link simulator parameter sweep as a job.
+ *
+ * With -p, prints the budget of the rate probe on the modeled cost profile instead, at once.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_sweep(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&sweep_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, sweep_args.end, argv[0]);
+        return 1;
+    }
+
+    if (sweep_args.rate->count > 0) {
+        rate_probe_print_model(stdout);
+        return 0;
+    }
+
+    int seeds = sweep_args.seeds->count > 0 ? sweep_args.seeds->ival[0] : 1;
+    int words = sweep_args.words->count > 0 ? sweep_args.words->ival[0] : 16;
+    uint32_t base_seed = sweep_args.base_seed->count > 0 ? (uint32_t)sweep_args.base_seed->ival[0] : 1;
+    if (seeds < 1 || words < 1 || words > LINK_SIM_MAX_WORDS) {
+        ESP_LOGE(CONSOLE_TAG, "Error: Seeds must be at least 1 and words between 1 and %d.", LINK_SIM_MAX_WORDS);
+        return 1;
+    }
+    sweep_job_t params = { .seeds = (uint32_t)seeds, .words = (uint32_t)words, .base_seed = base_seed };
+    return submit_job("sweep", &sweep_job, &params, sizeof(params), false);
+}
+
+/**
+ * @brief Registers the sweep command.
+ */
+static void register_sweep_command(void) {
+    sweep_args.seeds = arg_int0("n", "seeds", "<n>", "Number of seeds per parameter combination");
+    sweep_args.words = arg_int0("w", "words", "<n>", "Number of words per simulated link");
+    sweep_args.base_seed = arg_int0("s", "seed", "<seed>", "Seed of the first simulation");
+    sweep_args.rate = arg_lit0("p", "probe", "Print the rate probe budget of the modeled cost profile instead");
+    sweep_args.end = arg_end(4);
+    register_command("sweep", NULL, "Run the link simulator parameter sweep and print CSV", "[-n <seeds>] [-w <words>] [-s <seed>] [-p]", &cmd_sweep, &sweep_args);
+}
+
+/**
+ * @brief Command to record and report a scheduling trace.
+ *
+ * Without options, prints the per-core report of the last trace.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_trace(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&trace_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, trace_args.end, argv[0]);
+        return 1;
+    }
+
+    if (trace_args.start->count > 0) {
+        if (trace_start() != ESP_OK) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Could not start trace.");
+            return 1;
+        }
+        ESP_LOGI(CONSOLE_TAG, "Trace started.");
+        return 0;
+    }
+    trace_stop();
+    if (trace_args.dump->count > 0) {
+        size_t written = trace_dump(stdout);
+        ESP_LOGI(CONSOLE_TAG, "Trace dumped: %u bytes.", (unsigned)written);
+    } else if (trace_args.stop->count == 0) {
+        trace_report();
+    }
+    return 0;
+}
+
+/**
+ * @brief Registers the trace command.
+ */
+static void register_trace_command(void) {
+    trace_args.start = arg_litn("s", "start", 0, 1, "Start a new trace");
+    trace_args.stop = arg_litn("x", "stop", 0, 1, "Stop the running trace");
+    trace_args.dump = arg_litn("d", "dump", 0, 1, "Stop and dump the trace in binary");
+    trace_args.end = arg_end(4);
+    register_command("trace", "tr", "Record task, ISR and queue events and report CPU use per core", "[-s | -x | -d]", &cmd_trace, &trace_args);
+}
+
+/**
+ * @brief Command to control the cycle-budget profiler.
+ *
+ * Without options, prints the cycle histograms recorded so far.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_profile(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&profile_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, profile_args.end, argv[0]);
+        return 1;
+    }
+#if !PROFILER_ENABLE
+    ESP_LOGW(CONSOLE_TAG, "Profiler disabled at build time (PROFILER_ENABLE).");
+    return 1;
+#endif
+
+    if (profile_args.start->count > 0) {
+        profiler_start();
+        ESP_LOGI(CONSOLE_TAG, "Profiler started.");
+    } else if (profile_args.stop->count > 0) {
+        profiler_stop();
+        ESP_LOGI(CONSOLE_TAG, "Profiler stopped.");
+    } else if (profile_args.reset->count > 0) {
+        profiler_reset();
+        ESP_LOGI(CONSOLE_TAG, "Profiler histograms cleared.");
+    } else {
+        profiler_dump();
+    }
+    return 0;
+}
+
+/**
+ * @brief Registers the profile command.
+ */
+static void register_profile_command(void) {
+    profile_args.start = arg_litn("s", "start", 0, 1, "Clear the histograms and start profiling");
+    profile_args.stop = arg_litn("x", "stop", 0, 1, "Stop profiling");
+    profile_args.reset = arg_litn("r", "reset", 0, 1, "Clear the histograms");
+    profile_args.end = arg_end(4);
+    register_command("profile", "pf", "Profile cycles spent in the keystream and crypto hot path", "[-s | -x | -r]", &cmd_profile, &profile_args);
+}
+
+/**
+ * @brief Sends frames through the active PHY and times their delivery.
+ *
+ * Frames are submitted as fast as the PHY accepts them, and the run ends when the
+ * RX side has received every word or after PHY_BENCH_TIMEOUT_MS.
+ *
+ * @param job The job running the benchmark.
+ * @param frames Number of frames to send.
+ * @return int 0 on success, 1 on failure.
+ */
+static int phy_benchmark(console_job_t *job, int frames) {
+    static const char *payload = "PHY benchmark 0123456789abcdef!";
+    const vlc_phy_ops_t *phy = phy_active();
+    size_t frame_words = frame_total_words((uint16_t)((strlen(payload) + 3) / 4), FRAME_AUTH_ENABLE ? FRAME_FLAG_AUTH : 0);
+    vlc_phy_stats_t before, after;
+    phy->get_stats(&before);
+
+    TickType_t start = xTaskGetTickCount();
+    TickType_t deadline = start + pdMS_TO_TICKS(PHY_BENCH_TIMEOUT_MS);
+    int sent = 0;
+    while (sent < frames && xTaskGetTickCount() < deadline) {
+        esp_err_t err = submit_str_frame(payload);
+        if (err == ESP_OK) {
+            sent++;
+            console_job_progress(job, (uint32_t)sent, (uint32_t)frames);
+        } else if (err == ESP_ERR_NO_MEM) {
+            vTaskDelay(1);
+        } else {
+            ESP_LOGE(CONSOLE_TAG, "Error: Benchmark frame refused: %s", esp_err_to_name(err));
+            return 1;
+        }
+    }
+    uint32_t expected = (uint32_t)(sent * frame_words);
+    do {
+        vTaskDelay(1);
+        phy->get_stats(&after);
+    } while (after.rx_words - before.rx_words < expected && xTaskGetTickCount() < deadline);
+
+    double seconds = (double)(xTaskGetTickCount() - start) * portTICK_PERIOD_MS / 1000.0;
+    uint32_t received = after.rx_words - before.rx_words;
+    uint32_t words_sent = after.tx_words - before.tx_words;
+    ESP_LOGI(CONSOLE_TAG, "%s: %d/%d frames sent, %lu/%lu words received in %.3f s, %.0f payload bits/s.",
+             phy->name, sent, frames, (unsigned long)received, (unsigned long)expected, seconds,
+             seconds > 0 ? (double)received / frame_words * strlen(payload) * 8 / seconds : 0.0);
+    ESP_LOGI(CONSOLE_TAG, "%s: %.1f TX and %.1f RX interrupts per word.", phy->name,
+             words_sent > 0 ? (double)(after.tx_interrupts - before.tx_interrupts) / words_sent : 0.0,
+             received > 0 ? (double)(after.rx_interrupts - before.rx_interrupts) / received : 0.0);
+    return received >= expected ? 0 : 1;
+}
+
+/**
+ * @brief Job running phy_benchmark().
+ *
+ * @param job The job.
+ * @param arg Pointer to the number of frames.
+ * @return int 0 on success, 1 on failure.
+ */
+static int phy_benchmark_job(console_job_t *job, void *arg) {
+    return phy_benchmark(job, *(const int *)arg);
+}
+
+/**
+ * @brief Command to select, configure and benchmark the PHY backends.
+ *
+ * Without options, lists the backends with their counters.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_phy(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&phy_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, phy_args.end, argv[0]);
+        return 1;
+    }
+
+    if (phy_args.use->count > 0 && phy_select(phy_args.use->sval[0]) != ESP_OK) {
+        ESP_LOGE(CONSOLE_TAG, "Error: Unknown PHY '%s'.", phy_args.use->sval[0]);
+        return 1;
+    }
+    if (phy_args.rate->count > 0) {
+        esp_err_t err = phy_active()->set_rate((uint32_t)phy_args.rate->ival[0]);
+        if (err != ESP_OK) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Could not set the bit period: %s", esp_err_to_name(err));
+            return 1;
+        }
+    }
+    if (phy_args.bench->count > 0) {
+        if (!check_encryption_settings(true, true)) {
+            return 1;
+        }
+        int frames = phy_args.bench->ival[0] > 0 ? phy_args.bench->ival[0] : 1;
+        return submit_job("phy bench", &phy_benchmark_job, &frames, sizeof(frames), true);
+    }
+
+    for (size_t i = 0; phy_get(i) != NULL; i++) {
+        const vlc_phy_ops_t *phy = phy_get(i);
+        vlc_phy_stats_t stats;
+        phy->get_stats(&stats);
+        ESP_LOGI(CONSOLE_TAG, "%c %-10s %lu us/bit, TX %lu words (%lu rejected), RX %lu words (%lu dropped)",
+                 phy == phy_active() ? '*' : ' ', phy->name, (unsigned long)stats.bit_period_micros,
+                 (unsigned long)stats.tx_words, (unsigned long)stats.tx_rejected,
+                 (unsigned long)stats.rx_words, (unsigned long)stats.rx_dropped);
+        ESP_LOGI(CONSOLE_TAG, "             %lu false starts, %lu framing errors, %lu syncs, %lu TX / %lu RX interrupts",
+                 (unsigned long)stats.rx_false_starts, (unsigned long)stats.rx_framing_errors,
+                 (unsigned long)stats.rx_syncs, (unsigned long)stats.tx_interrupts, (unsigned long)stats.rx_interrupts);
+    }
+    return 0;
+}
+
+/**
+ * @brief Registers the PHY command.
+ */
+static void register_phy_command(void) {
+    phy_args.use = arg_str0("u", "use", "<name>", "Select the active PHY");
+    phy_args.rate = arg_int0("r", "rate", "<us>", "Set the bit period of the active PHY, in microseconds");
+    phy_args.bench = arg_int0("b", "bench", "<frames>", "Send frames through the active PHY and time their delivery");
+    phy_args.end = arg_end(4);
+    register_command("phy", NULL, "List, select, configure and benchmark the PHY backends", "[-u <name>] [-r <us>] [-b <frames>]", &cmd_phy, &phy_args);
+}
+
+/**
+ * @brief Command to configure receive diversity and print the quality of each branch.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_diversity(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&diversity_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, diversity_args.end, argv[0]);
+        return 1;
+    }
+
+    rx_diversity_t *diversity = phy_pins_diversity();
+    if (diversity_args.mode->count > 0) {
+        const char *name = diversity_args.mode->sval[0];
+        rx_diversity_mode_t mode;
+        if (strcmp(name, "off") == 0) {
+            mode = RX_DIVERSITY_OFF;
+        } else if (strcmp(name, "majority") == 0) {
+            mode = RX_DIVERSITY_MAJORITY;
+        } else if (strcmp(name, "select") == 0) {
+            mode = RX_DIVERSITY_SELECT;
+        } else {
+            ESP_LOGE(CONSOLE_TAG, "Error: Unknown diversity mode '%s'.", name);
+            return 1;
+        }
+        rx_diversity_set_mode(diversity, mode);
+    }
+
+    ESP_LOGI(CONSOLE_TAG, "Diversity: %u branch(es), %s%s, branch %u selected", (unsigned)diversity->branches,
+             rx_diversity_mode_name(rx_diversity_get_mode(diversity)),
+             diversity->requested != 0 ? " from the next sample" : "", (unsigned)diversity->selected);
+    for (uint8_t b = 0; b < diversity->branches; b++) {
+        const volatile rx_diversity_branch_stats_t *stats = &diversity->stats[b];
+        ESP_LOGI(CONSOLE_TAG, "  Branch %u (GPIO %d): %lu samples, %lu transitions, %lu disagreements, selected %lu times",
+                 (unsigned)b, phy_pins_rx_gpios[b], (unsigned long)stats->samples, (unsigned long)stats->transitions,
+                 (unsigned long)stats->disagreements, (unsigned long)stats->selections);
+    }
+    return 0;
+}
+
+/**
+ * @brief Registers the diversity command.
+ */
+static void register_diversity_command(void) {
+    diversity_args.mode = arg_str0("m", "mode", "<off|majority|select>", "Set the combining mode and clear the counters");
+    diversity_args.end = arg_end(2);
+    register_command("div", NULL, "Configure receive diversity and print the quality of each branch", "[-m <off|majority|select>]", &cmd_diversity, &diversity_args);
+}
+
+/**
+ * @brief Command to turn TX pre-emphasis on or off and print the pre-emphasis table.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_shaping(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&shaping_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, shaping_args.end, argv[0]);
+        return 1;
+    }
+
+    if (shaping_args.mode->count > 0) {
+        const char *name = shaping_args.mode->sval[0];
+        if (strcmp(name, "on") == 0) {
+            phy_rmt_set_shaping(true);
+        } else if (strcmp(name, "off") == 0) {
+            phy_rmt_set_shaping(false);
+        } else {
+            ESP_LOGE(CONSOLE_TAG, "Error: Unknown pre-emphasis mode '%s'.", name);
+            return 1;
+        }
+    }
+
+    tx_shaping_t shaping;
+    phy_rmt_get_shaping(&shaping);
+    ESP_LOGI(CONSOLE_TAG, "Pre-emphasis: %s, %lu ticks per bit (LED rise %d ns, fall %d ns)", shaping.enabled ? "on" : "off",
+             (unsigned long)shaping.bit_ticks, TX_SHAPING_LED_RISE_NS, TX_SHAPING_LED_FALL_NS);
+    for (uint32_t context = 0; context < TX_SHAPING_CONTEXTS; context++) {
+        uint32_t prev = (context >> 1) & 0x1, cur = context & 0x1;
+        if (prev != cur) {
+            ESP_LOGI(CONSOLE_TAG, "  %lu%lu|%lu: %+ld ticks", (unsigned long)((context >> 2) & 0x1), (unsigned long)prev,
+                     (unsigned long)cur, (long)shaping.offsets[context]);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Registers the shaping command.
+ */
+static void register_shaping_command(void) {
+    shaping_args.mode = arg_str0("m", "mode", "<on|off>", "Turn pre-emphasis of the rmt backend on or off");
+    shaping_args.end = arg_end(2);
+    register_command("shape", NULL, "Configure TX pre-emphasis and print its table per bit context", "[-m <on|off>]", &cmd_shaping, &shaping_args);
+}
+
+/**
+ * @brief Prints a calibration with the headroom it leaves on the bit rate.
+ *
+ * @param calibration Pointer to the calibration.
+ */
+static void print_calibration(const rx_calibration_t* calibration) {
+    ESP_LOGI(CONSOLE_TAG, "Sampling offset: %lu us of %lu us", (unsigned long)calibration->offset_micros,
+             (unsigned long)calibration->bit_period_micros);
+    if (calibration->eye_width_micros == 0) {
+        ESP_LOGW(CONSOLE_TAG, "Eye closed, sampling in the middle of the bit");
+        return;
+    }
+    uint32_t min_period = rx_calibration_min_period(calibration);
+    ESP_LOGI(CONSOLE_TAG, "Eye: %lu..%lu us, width %lu us (%lu%% of the bit)", (unsigned long)calibration->eye_start_micros,
+             (unsigned long)(calibration->eye_start_micros + calibration->eye_width_micros - 1), (unsigned long)calibration->eye_width_micros,
+             (unsigned long)(100 * calibration->eye_width_micros / calibration->bit_period_micros));
+    ESP_LOGI(CONSOLE_TAG, "Rate headroom: down to about %lu us per bit (+%lu%% bit rate)", (unsigned long)min_period,
+             (unsigned long)(100 * calibration->bit_period_micros / min_period - 100));
+}
+
+/**
+ * @brief Command to calibrate the sampling phase of the receiver against a peer.
+ *
+ * With -t the device sends training words; with -r it sweeps its sampling offset while the peer sends them,
+ * and with -p the result is stored for that peer. -p alone applies the stored calibration of the peer.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_calibration(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&calibration_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, calibration_args.end, argv[0]);
+        return 1;
+    }
+    const char *peer = calibration_args.peer->count > 0 ? calibration_args.peer->sval[0] : NULL;
+    rx_calibration_t calibration;
+    esp_err_t err;
+
+    if (calibration_args.train->count > 0) {
+        vlc_phy_stats_t stats;
+        phy_active()->get_stats(&stats);
+        // Enough words for every step of a sweep with some margin
+        uint32_t steps = stats.bit_period_micros < RX_CAL_MAX_STEPS ? stats.bit_period_micros : RX_CAL_MAX_STEPS;
+        uint32_t words = steps * RX_CAL_WORDS_PER_STEP * 3 / 2;
+        if (calibration_args.words->count > 0) {
+            if (calibration_args.words->ival[0] <= 0) {
+                ESP_LOGE(CONSOLE_TAG, "Error: Invalid number of training words.");
+                return 1;
+            }
+            words = (uint32_t)calibration_args.words->ival[0];
+        }
+        ESP_LOGI(CONSOLE_TAG, "Sending %lu training words...", (unsigned long)words);
+        err = rx_calibration_send_training(words);
+        if (err != ESP_OK) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Could not send training words (%s).", esp_err_to_name(err));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (calibration_args.run->count > 0) {
+        ESP_LOGI(CONSOLE_TAG, "Sweeping the sampling offset, the peer must be sending training words...");
+        err = rx_calibration_run(&calibration);
+        if (err == ESP_ERR_NOT_SUPPORTED) {
+            ESP_LOGE(CONSOLE_TAG, "Error: The %s backend has no adjustable sampling offset.", phy_active()->name);
+            return 1;
+        }
+        print_calibration(&calibration);
+        if (err != ESP_OK) {
+            return 1;
+        }
+        if (peer != NULL) {
+            err = rx_calibration_save(peer, &calibration);
+            if (err != ESP_OK) {
+                ESP_LOGE(CONSOLE_TAG, "Error: Could not store the calibration of '%s' (%s).", peer, esp_err_to_name(err));
+                return 1;
+            }
+            ESP_LOGI(CONSOLE_TAG, "Calibration stored for '%s'", peer);
+        }
+        return 0;
+    }
+
+    if (peer == NULL) {
+        ESP_LOGE(CONSOLE_TAG, "Error: Nothing to do, use -t, -r or -p.");
+        return 1;
+    }
+    err = rx_calibration_load(peer, &calibration);
+    if (err == ESP_OK) {
+        err = rx_calibration_apply(&calibration);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(CONSOLE_TAG, "Error: Could not apply the calibration of '%s' (%s).", peer, esp_err_to_name(err));
+        return 1;
+    }
+    print_calibration(&calibration);
+    return 0;
+}
+
+/**
+ * @brief Registers the calibration command.
+ */
+static void register_calibration_command(void) {
+    calibration_args.train = arg_lit0("t", "train", "Send training words to a calibrating peer");
+    calibration_args.words = arg_int0("n", "words", "<words>", "Number of training words to send");
+    calibration_args.run = arg_lit0("r", "run", "Sweep the sampling offset while the peer sends training words");
+    calibration_args.peer = arg_str0("p", "peer", "<name>", "Peer to store the result for, or whose stored calibration to apply");
+    calibration_args.end = arg_end(4);
+    register_command("cal", NULL, "Calibrate the sampling phase of the receiver against a peer", "[-t [-n <words>]] [-r] [-p <name>]", &cmd_calibration, &calibration_args);
+}
+
+/**
+ * @brief Command to configure light sleep and print the power report of the link.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_power(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&power_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, power_args.end, argv[0]);
+        return 1;
+    }
+
+    if (power_args.sleep->count > 0) {
+        const char *mode = power_args.sleep->sval[0];
+        if (strcmp(mode, "on") != 0 && strcmp(mode, "off") != 0) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Unknown light sleep mode '%s'.", mode);
+            return 1;
+        }
+        esp_err_t err = power_set_light_sleep(strcmp(mode, "on") == 0);
+        if (err != ESP_OK) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Could not configure light sleep (%s).", esp_err_to_name(err));
+            return 1;
+        }
+    }
+
+    if (power_args.peer_sleep->count > 0) {
+        const char *mode = power_args.peer_sleep->sval[0];
+        if (strcmp(mode, "on") != 0 && strcmp(mode, "off") != 0) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Unknown peer light sleep mode '%s'.", mode);
+            return 1;
+        }
+        power_set_peer_light_sleep(strcmp(mode, "on") == 0);
+    }
+
+    if (power_args.wake_test->count > 0) {
+        uint32_t min_micros, max_micros;
+        int runs = power_args.wake_test->ival[0];
+        if (runs <= 0) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Invalid number of wake-ups.");
+            return 1;
+        }
+        esp_err_t err = power_measure_timer_wake((uint32_t)runs, &min_micros, &max_micros);
+        if (err == ESP_ERR_INVALID_STATE) {
+            ESP_LOGE(CONSOLE_TAG, "Error: The link is active, the device cannot sleep.");
+            return 1;
+        } else if (err != ESP_OK) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Wake-up test failed (%s).", esp_err_to_name(err));
+            return 1;
+        }
+        ESP_LOGI(CONSOLE_TAG, "Timer wake-up latency over %d run(s): %lu..%lu us", runs, (unsigned long)min_micros, (unsigned long)max_micros);
+    }
+
+    power_stats_t stats;
+    power_get_stats(&stats);
+    uint64_t bytes = 0;
+    for (size_t i = 0; phy_get(i) != NULL; i++) {
+        vlc_phy_stats_t phy_stats;
+        phy_get(i)->get_stats(&phy_stats);
+        bytes += 4ULL * (phy_stats.tx_words + phy_stats.rx_words);
+    }
+    double energy = power_energy_micro_joules(&stats);
+    ESP_LOGI(CONSOLE_TAG, "CPU %d-%d MHz, light sleep %s, peer light sleep %s", POWER_CPU_MIN_MHZ, POWER_CPU_MAX_MHZ,
+             stats.light_sleep ? "on" : "off", stats.peer_light_sleep ? "on" : "off");
+    ESP_LOGI(CONSOLE_TAG, "Uptime %llu ms: active %llu ms, light sleep allowed %llu ms", (unsigned long long)(stats.elapsed_micros / 1000),
+             (unsigned long long)(stats.active_micros / 1000), (unsigned long long)(stats.sleep_micros / 1000));
+    if (stats.wakes > 0) {
+        ESP_LOGI(CONSOLE_TAG, "RX wake-ups: %lu, interrupt to listening %lu/%lu/%lu us (min/avg/max), preamble %d us",
+                 (unsigned long)stats.wakes, (unsigned long)stats.wake_min_micros,
+                 (unsigned long)(stats.wake_total_micros / stats.wakes), (unsigned long)stats.wake_max_micros, POWER_WAKE_PREAMBLE_MICROS);
+        ESP_LOGI(CONSOLE_TAG, "  Estimate: the interrupt runs once awake, the wake-up from the preamble edge is not included");
+    } else {
+        ESP_LOGI(CONSOLE_TAG, "RX wake-ups: 0");
+    }
+    ESP_LOGI(CONSOLE_TAG, "Model energy estimate %.1f mJ, %llu bytes sent and received", energy / 1000.0, (unsigned long long)bytes);
+    if (bytes > 0) {
+        ESP_LOGI(CONSOLE_TAG, "Model energy estimate per byte: %.2f uJ", energy / (double)bytes);
+    }
+    ESP_LOGI(CONSOLE_TAG, "  Model: time in each state x %d/%d/%d uA (active/idle/sleep) at %d mV from config.h, not measured",
+             POWER_ACTIVE_UA, POWER_IDLE_UA, POWER_SLEEP_UA, POWER_SUPPLY_MV);
+    return 0;
+}
+
+/**
+ * @brief Registers the power command.
+ */
+static void register_power_command(void) {
+    power_args.sleep = arg_str0("s", "sleep", "<on|off>", "Allow light sleep while the link is idle");
+    power_args.peer_sleep = arg_str0("p", "peer-sleep", "<on|off>", "Whether the peer may light-sleep, so idle frames start with a wake preamble");
+    power_args.wake_test = arg_int0("w", "wake", "<runs>", "Measure the latency of timer wake-ups from light sleep");
+    power_args.end = arg_end(3);
+    register_command("power", NULL, "Configure light sleep and print the wake-up latency and the modelled energy per byte", "[-s <on|off>] [-p <on|off>] [-w <runs>]", &cmd_power, &power_args);
+}
+
+/**
+ * @brief Reads the CPU cycle counter for the run-length benchmark.
+ *
+ * @return The cycle count.
+ */
+static uint32_t runlength_read_cycles(void) {
+    return (uint32_t)esp_cpu_get_cycle_count();
+}
+
+/**
+ * @brief Command to time the TX run-length encoder and check it against its decoder.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_runlength(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&runlength_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, runlength_args.end, argv[0]);
+        return 1;
+    }
+
+    int words = runlength_args.words->count > 0 ? runlength_args.words->ival[0] : 10000;
+    // The 32-bit cycle counter must not wrap during the timed loop
+    if (words < 2 || words > 1000000) {
+        ESP_LOGE(CONSOLE_TAG, "Error: Words must be between 2 and 1000000.");
+        return 1;
+    }
+    tx_runlength_bench_t result;
+    tx_runlength_benchmark((uint32_t)words, 1, runlength_read_cycles, &result);
+    ESP_LOGI(CONSOLE_TAG, "Run-length: %lu words, %.1f cycles/word, %.2f runs/word against %d bits, %lu mismatches.",
+             (unsigned long)result.words, (double)result.cycles / result.words,
+             (double)result.runs / result.words, TX_RUNLENGTH_WORD_BITS, (unsigned long)result.mismatches);
+    return result.mismatches == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Registers the run-length command.
+ */
+static void register_runlength_command(void) {
+    runlength_args.words = arg_int0("n", "words", "<n>", "Number of pseudo-random words to encode");
+    runlength_args.end = arg_end(4);
+    register_command("runlength", "rl", "Time the TX run-length encoder and check it round-trips", "[-n <words>]", &cmd_runlength, &runlength_args);
+}
+
+/**
+ * @brief Logs the counters of one mode of the RX loop.
+ *
+ * @param label Name of the mode or policy.
+ * @param mode Counters of the mode.
+ */
+static void rxloop_log_mode(const char *label, const rx_loop_mode_stats_t *mode) {
+    uint32_t latency_avg = mode->latency_count > 0 ? (uint32_t)(mode->latency_total_micros / mode->latency_count) : 0;
+    double cpu = mode->elapsed_micros > 0 ? 100.0 * (double)mode->busy_micros / (double)mode->elapsed_micros : 0.0;
+    ESP_LOGI(CONSOLE_TAG, "  %-6s %llu ms: %lu words, %lu polls (%lu empty), %lu wake-ups, latency %lu/%lu us (avg/max), CPU %.1f%%",
+             label, (unsigned long long)(mode->elapsed_micros / 1000),
+             (unsigned long)mode->words, (unsigned long)mode->polls, (unsigned long)mode->empty_polls,
+             (unsigned long)mode->wakeups, (unsigned long)latency_avg, (unsigned long)mode->latency_max_micros, cpu);
+}
+
+/**
+ * @brief Runs the RX loop in the notify mode, then in the poll mode, and logs the latency and wake-ups of each.
+ *
+ * The words come from whatever the peer sends meanwhile. The policy in force before is restored.
+ *
+ * @param seconds Time spent in each mode.
+ */
+static void rxloop_compare(int seconds) {
+    static const rx_loop_policy_t policies[RX_LOOP_MODE_COUNT] = { RX_LOOP_POLICY_NOTIFY, RX_LOOP_POLICY_POLL };
+    rx_loop_stats_t stats;
+    rx_loop_get_stats(&stats);
+    rx_loop_policy_t previous = stats.policy;
+
+    ESP_LOGI(CONSOLE_TAG, "Comparing the RX loop modes for %d s each, send frames from the peer meanwhile", seconds);
+    for (int m = 0; m < RX_LOOP_MODE_COUNT; m++) {
+        rx_loop_set_policy(policies[m]);
+        // Let the RX task switch before the counters are cleared
+        vTaskDelay(pdMS_TO_TICKS(RX_LOOP_WAIT_MS));
+        rx_loop_reset_stats();
+        vTaskDelay(pdMS_TO_TICKS(seconds * 1000));
+        rx_loop_get_stats(&stats);
+        const rx_loop_mode_stats_t *mode = &stats.modes[m];
+        rxloop_log_mode(rx_loop_mode_name((rx_loop_mode_t)m), mode);
+        if (mode->words > 0) {
+            ESP_LOGI(CONSOLE_TAG, "         %.2f wake-ups per word", (double)mode->wakeups / mode->words);
+        } else {
+            ESP_LOGW(CONSOLE_TAG, "         No word received in the %s mode.", rx_loop_mode_name((rx_loop_mode_t)m));
+        }
+    }
+    rx_loop_set_policy(previous);
+}
+
+/**
+ * @brief Command to choose the mode of the RX loop and print the latency and CPU time of each mode.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_rxloop(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&rxloop_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, rxloop_args.end, argv[0]);
+        return 1;
+    }
+
+    if (rxloop_args.mode->count > 0) {
+        const char *mode = rxloop_args.mode->sval[0];
+        if (strcmp(mode, "auto") == 0) {
+            rx_loop_set_policy(RX_LOOP_POLICY_AUTO);
+        } else if (strcmp(mode, "notify") == 0) {
+            rx_loop_set_policy(RX_LOOP_POLICY_NOTIFY);
+        } else if (strcmp(mode, "poll") == 0) {
+            rx_loop_set_policy(RX_LOOP_POLICY_POLL);
+        } else {
+            ESP_LOGE(CONSOLE_TAG, "Error: Unknown RX loop mode '%s'.", mode);
+            return 1;
+        }
+    }
+    if (rxloop_args.reset->count > 0) {
+        rx_loop_reset_stats();
+    }
+    if (rxloop_args.compare->count > 0) {
+        int seconds = rxloop_args.compare->ival[0];
+        if (seconds <= 0 || seconds > 600) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Comparison time must be between 1 and 600 s.");
+            return 1;
+        }
+        rxloop_compare(seconds);
+        return 0;
+    }
+
+    rx_loop_stats_t stats;
+    rx_loop_get_stats(&stats);
+    static const char* const policies[] = { "auto", "notify", "poll" };
+    ESP_LOGI(CONSOLE_TAG, "RX loop: %s mode, policy %s, %lu switch(es), polling from %d words/s",
+             rx_loop_mode_name(stats.mode), policies[stats.policy], (unsigned long)stats.switches, RX_LOOP_POLL_ENTER_WPS);
+    for (int m = 0; m < RX_LOOP_MODE_COUNT; m++) {
+        rxloop_log_mode(rx_loop_mode_name((rx_loop_mode_t)m), &stats.modes[m]);
+    }
+    return 0;
+}
+
+/**
+ * @brief Registers the RX loop command.
+ */
+static void register_rxloop_command(void) {
+    rxloop_args.mode = arg_str0("m", "mode", "<auto|notify|poll>", "Switch modes on the word rate, or stay in one");
+    rxloop_args.reset = arg_lit0("r", "reset", "Clear the counters");
+    rxloop_args.compare = arg_int0("c", "compare", "<seconds>", "Run each mode in turn and print its latency and wake-ups per word");
+    rxloop_args.end = arg_end(3);
+    register_command("rxloop", NULL, "Choose the RX loop mode and print its latency and CPU time", "[-m <auto|notify|poll>] [-r] [-c <seconds>]", &cmd_rxloop, &rxloop_args);
+}
+
+/**
+ * @brief Command to print the queue depth and the utilization of both stages of the RX pipeline.
+ *
+ * The utilization covers the time since the previous call, or since boot. The ISR cycles are converted at
+ * POWER_CPU_MAX_MHZ, the frequency the RX side holds while it receives.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success.
+ */
+static int cmd_pipeline(int argc, char **argv) {
+    static int64_t last_micros = 0;
+    static uint32_t last_isr_cycles = 0;
+    static uint64_t last_busy_micros = 0;
+
+    const vlc_phy_ops_t* phy = phy_active();
+    vlc_phy_stats_t stats;
+    rx_loop_stats_t loop;
+    phy->get_stats(&stats);
+    rx_loop_get_stats(&loop);
+    int64_t now = esp_timer_get_time();
+    uint64_t busy_micros = 0;
+    for (int m = 0; m < RX_LOOP_MODE_COUNT; m++) {
+        busy_micros += loop.modes[m].busy_micros;
+    }
+
+    double elapsed = (double)(now - last_micros);
+    double isr_load = 100.0 * (double)(uint32_t)(stats.rx_isr_cycles - last_isr_cycles) / (elapsed * POWER_CPU_MAX_MHZ);
+    double decode_load = 100.0 * (double)(busy_micros - last_busy_micros) / elapsed;
+    ESP_LOGI(CONSOLE_TAG, "RX pipeline of %s, batches of %d words", phy->name, RX_PIPELINE_BATCH_WORDS);
+    ESP_LOGI(CONSOLE_TAG, "  Queue: %lu waiting, peak %lu of %d, %lu dropped", (unsigned long)stats.rx_queued,
+             (unsigned long)stats.rx_queue_peak, RX_PIPELINE_QUEUE_SIZE, (unsigned long)stats.rx_dropped);
+    ESP_LOGI(CONSOLE_TAG, "  ISR stage (core %d): %.1f%% over %lu interrupts", RX_TASK_CORE, isr_load, (unsigned long)stats.rx_interrupts);
+    ESP_LOGI(CONSOLE_TAG, "  Decode stage (core %d): %.1f%% over the last %lld ms", RX_DECODE_TASK_CORE, decode_load, (long long)((now - last_micros) / 1000));
+
+    last_micros = now;
+    last_isr_cycles = stats.rx_isr_cycles;
+    last_busy_micros = busy_micros;
+    return 0;
+}
+
+/**
+ * @brief Registers the pipeline command.
+ */
+static void register_pipeline_command(void) {
+    register_command("pipeline", NULL, "Print the queue depth and the load of both stages of the RX pipeline", NULL, &cmd_pipeline, NULL);
+}
+
+/**
+ * @brief Counters of the NVS writer of the flash stress test.
+ */
+typedef struct {
+    uint32_t writes;            /**< Blobs written and committed */
+    uint32_t errors;            /**< Opens, writes or commits that failed */
+    uint32_t max_micros;        /**< Longest write and commit */
+    uint64_t total_micros;      /**< Time spent writing and committing */
+} flash_stress_nvs_t;
+
+/** @brief Counters of the NVS writer, read once it has stopped. */
+static flash_stress_nvs_t flash_stress_nvs;
+
+/** @brief The NVS writer keeps writing while set. */
+static volatile bool flash_stress_writing = false;
+
+/** @brief Task notified when the NVS writer has stopped. */
+static TaskHandle_t flash_stress_waiter = NULL;
+
+/**
+ * @brief Task committing a new blob to NVS over and over until flash_stress_writing is cleared, then erasing
+ * its namespace.
+ *
+ * Each commit disables the flash cache on both cores while the flash is written or erased.
+ *
+ * @param pvParameters Pointer to task parameters (unused).
+ */
+static void flash_stress_writer_task(void *pvParameters) {
+    static uint8_t blob[PHY_FLASH_STRESS_BLOB_BYTES];
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(PHY_FLASH_STRESS_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        flash_stress_nvs.errors++;
+    } else {
+        while (flash_stress_writing) {
+            // NVS skips a blob equal to the stored one
+            memset(blob, (int)(flash_stress_nvs.writes + flash_stress_nvs.errors + 1), sizeof(blob));
+            int64_t start = esp_timer_get_time();
+            err = nvs_set_blob(handle, "blob", blob, sizeof(blob));
+            if (err == ESP_OK) {
+                err = nvs_commit(handle);
+            }
+            uint32_t micros = (uint32_t)(esp_timer_get_time() - start);
+            if (err == ESP_OK) {
+                flash_stress_nvs.writes++;
+            } else {
+                flash_stress_nvs.errors++;
+            }
+            flash_stress_nvs.total_micros += micros;
+            if (micros > flash_stress_nvs.max_micros) {
+                flash_stress_nvs.max_micros = micros;
+            }
+            vTaskDelay(1); // Lets the idle task of the RX core feed the watchdog
+        }
+        nvs_erase_all(handle);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+    xTaskNotifyGive(flash_stress_waiter);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Streams frames through the active PHY, optionally while the NVS writer runs, and prints the errors
+ * counted at the PHY and at the frame level.
+ *
+ * @param job The job running the test, the NVS writes run coming second in its progress.
+ * @param label Name of the run.
+ * @param frames Number of frames to send.
+ * @param flash true to write to NVS during the run.
+ * @param lost Pointer to store the number of frames not delivered.
+ * @return true if the run completed, false if a frame was refused.
+ */
+static bool flash_stress_run(console_job_t* job, const char* label, int frames, bool flash, uint32_t* lost) {
+    static const char *payload = "Flash stress 0123456789abcdef!!";
+    const vlc_phy_ops_t *phy = phy_active();
+    size_t frame_words = frame_total_words((uint16_t)((strlen(payload) + 3) / 4), FRAME_AUTH_ENABLE ? FRAME_FLAG_AUTH : 0);
+    vlc_phy_stats_t before, after;
+    rx_frame_stats_t frames_before, frames_after;
+    phy->get_stats(&before);
+    rx_get_frame_stats(&frames_before);
+
+    if (flash) {
+        flash_stress_nvs = (flash_stress_nvs_t){0};
+        flash_stress_waiter = xTaskGetCurrentTaskHandle();
+        flash_stress_writing = true;
+        // Next to the RX ISRs, so the console task keeps streaming on its own core
+        xTaskCreatePinnedToCore(flash_stress_writer_task, "Flash Stress Task", RX_STACK_SIZE, NULL, 1, NULL, RX_TASK_CORE);
+    }
+
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(PHY_BENCH_TIMEOUT_MS);
+    int sent = 0;
+    bool refused = false;
+    while (sent < frames && xTaskGetTickCount() < deadline) {
+        esp_err_t err = submit_str_frame(payload);
+        if (err == ESP_OK) {
+            sent++;
+            console_job_progress(job, (uint32_t)((flash ? frames : 0) + sent), (uint32_t)(2 * frames));
+        } else if (err == ESP_ERR_NO_MEM) {
+            vTaskDelay(1);
+        } else {
+            ESP_LOGE(CONSOLE_TAG, "Error: Stress frame refused: %s", esp_err_to_name(err));
+            refused = true;
+            break;
+        }
+    }
+    uint32_t expected = (uint32_t)(sent * frame_words);
+    do {
+        vTaskDelay(1);
+        phy->get_stats(&after);
+        rx_get_frame_stats(&frames_after);
+    } while ((after.rx_words - before.rx_words < expected ||
+              frames_after.frames + frames_after.rejected - frames_before.frames - frames_before.rejected < (uint32_t)sent) &&
+             xTaskGetTickCount() < deadline);
+
+    if (flash) {
+        flash_stress_writing = false;
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    uint32_t delivered = frames_after.frames - frames_before.frames;
+    *lost = (uint32_t)sent > delivered ? (uint32_t)sent - delivered : 0;
+    ESP_LOGI(CONSOLE_TAG, "%s: %d frames sent, %lu/%lu words received, %lu dropped, %lu false starts, %lu framing errors",
+             label, sent, (unsigned long)(after.rx_words - before.rx_words), (unsigned long)expected,
+             (unsigned long)(after.rx_dropped - before.rx_dropped),
+             (unsigned long)(after.rx_false_starts - before.rx_false_starts),
+             (unsigned long)(after.rx_framing_errors - before.rx_framing_errors));
+    ESP_LOGI(CONSOLE_TAG, "%s: %lu frames delivered, %lu rejected, %lu invalid headers, %lu lost",
+             label, (unsigned long)delivered, (unsigned long)(frames_after.rejected - frames_before.rejected),
+             (unsigned long)(frames_after.invalid_headers - frames_before.invalid_headers), (unsigned long)*lost);
+    if (flash) {
+        ESP_LOGI(CONSOLE_TAG, "%s: %lu NVS commits of %d bytes (%lu failed), %.2f ms average, %.2f ms longest",
+                 label, (unsigned long)flash_stress_nvs.writes, PHY_FLASH_STRESS_BLOB_BYTES, (unsigned long)flash_stress_nvs.errors,
+                 flash_stress_nvs.writes > 0 ? (double)flash_stress_nvs.total_micros / flash_stress_nvs.writes / 1000.0 : 0.0,
+                 flash_stress_nvs.max_micros / 1000.0);
+    }
+    return !refused;
+}
+
+/**
+ * @brief Job running the baseline and the NVS writes runs of the flash stress test.
+ *
+ * @param job The job.
+ * @param arg Pointer to the number of frames of each run.
+ * @return int 0 if no frame was lost to the flash writes, 1 otherwise.
+ */
+static int flash_stress_job(console_job_t *job, void *arg) {
+    int frames = *(const int *)arg;
+    uint32_t baseline_lost, stress_lost;
+    if (!flash_stress_run(job, "Baseline", frames, false, &baseline_lost) ||
+        !flash_stress_run(job, "NVS writes", frames, true, &stress_lost)) {
+        return 1;
+    }
+    ESP_LOGI(CONSOLE_TAG, "%s: %ld frame(s) lost to the flash writes", phy_active()->name, (long)stress_lost - (long)baseline_lost);
+    return stress_lost > baseline_lost ? 1 : 0;
+}
+
+/**
+ * @brief Command to measure the effect of flash writes on the link.
+ *
+ * Streams frames through the active PHY twice, first alone and then while a task commits blobs to NVS back
+ * to back, and compares the frames lost by both runs.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 if the test was submitted, 1 otherwise.
+ */
+static int cmd_flashstress(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&flashstress_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, flashstress_args.end, argv[0]);
+        return 1;
+    }
+    if (!check_encryption_settings(true, true)) {
+        return 1;
+    }
+    if (boot_wait(BOOT_STAGE_BIT(BOOT_STAGE_NVS), pdMS_TO_TICKS(BOOT_NVS_WAIT_MS)) != ESP_OK) {
+        ESP_LOGE(CONSOLE_TAG, "Error: NVS is not initialised.");
+        return 1;
+    }
+    int frames = flashstress_args.frames->count > 0 ? flashstress_args.frames->ival[0] : PHY_FLASH_STRESS_FRAMES;
+    if (frames <= 0) {
+        ESP_LOGE(CONSOLE_TAG, "Error: The number of frames must be positive.");
+        return 1;
+    }
+    return submit_job("flashstress", &flash_stress_job, &frames, sizeof(frames), true);
+}
+
+/**
+ * @brief Registers the flash stress command.
+ */
+static void register_flashstress_command(void) {
+    flashstress_args.frames = arg_int0("n", "frames", "<frames>", "Frames sent by each run");
+    flashstress_args.end = arg_end(2);
+    register_command("flashstress", NULL, "Stream frames while writing to NVS and count the errors", "[-n <frames>]", &cmd_flashstress, &flashstress_args);
+}
+
+/**
+ * @brief Logs RX-style hex dump lines with batching on or off, and measures the drain of the console output.
+ *
+ * @param batched Batch the output.
+ * @param lines Number of lines to log.
+ * @param words Number of words in each line.
+ * @param stats Pointer to store the counters of the run.
+ * @param log_micros Pointer to store the time spent in the logging calls.
+ * @param elapsed_micros Pointer to store the time until the transport took every line.
+ */
+static void log_bench_run(bool batched, int lines, int words, log_batch_stats_t *stats, int64_t *log_micros, int64_t *elapsed_micros) {
+    char hex_str[MAX_CMDLINE_LENGTH];
+    uint32_t word = 0x9E3779B9;
+
+    log_batch_set_enabled(batched);
+    log_batch_flush(pdMS_TO_TICKS(1000));
+    log_batch_reset_stats();
+    *log_micros = 0;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < lines; i++) {
+        size_t length = 0;
+        for (int w = 0; w < words; w++) {
+            word ^= word << 13;
+            word ^= word >> 17;
+            word ^= word << 5;
+            length += snprintf(hex_str + length, sizeof(hex_str) - length, "%08lX ", (unsigned long)word);
+        }
+        int64_t begin = esp_timer_get_time();
+        ESP_LOGI(CONSOLE_TAG, "Received (HEX): %s", hex_str);
+        *log_micros += esp_timer_get_time() - begin;
+    }
+    log_batch_flush(pdMS_TO_TICKS(10000));
+    *elapsed_micros = esp_timer_get_time() - start;
+    log_batch_get_stats(stats);
+}
+
+/**
+ * @brief Prints the result of one run of the console output benchmark, against the line rate of a UART console.
+ *
+ * @param name Name of the run.
+ * @param lines Number of lines logged.
+ * @param stats Counters of the run.
+ * @param log_micros Time spent in the logging calls.
+ * @param elapsed_micros Time until the transport took every line.
+ */
+static void print_log_bench(const char *name, int lines, const log_batch_stats_t *stats, int64_t log_micros, int64_t elapsed_micros) {
+    double seconds = (double)elapsed_micros / 1e6;
+    ESP_LOGI(CONSOLE_TAG, "  %-8s %llu bytes in %.1f ms: %.1f KB/s, %.1f us per line in the logging task",
+             name, (unsigned long long)stats->bytes_out, (double)elapsed_micros / 1000.0,
+             seconds > 0 ? (double)stats->bytes_out / seconds / 1024.0 : 0.0, (double)log_micros / lines);
+    ESP_LOGI(CONSOLE_TAG, "  %-8s %lu write(s), largest %lu bytes, %lu bytes dropped", "",
+             (unsigned long)stats->writes, (unsigned long)stats->largest_write, (unsigned long)stats->dropped_bytes);
+    #if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+    // 10 bits per byte on the line with 8N1
+    double line_bytes_per_second = (double)CONFIG_ESP_CONSOLE_UART_BAUDRATE / 10.0;
+    ESP_LOGI(CONSOLE_TAG, "  %-8s %.0f%% of the UART line rate", "",
+             seconds > 0 ? (double)stats->bytes_out / seconds / line_bytes_per_second * 100.0 : 0.0);
+    #endif
+}
+
+/**
+ * @brief Command to turn console output batching on or off, print its counters, and compare the throughput of
+ * direct and batched output for sustained RX logging.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_log(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&log_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, log_args.end, argv[0]);
+        return 1;
+    }
+
+    log_batch_stats_t stats;
+    log_batch_get_stats(&stats);
+    bool enabled = stats.enabled;
+    if (log_args.mode->count > 0) {
+        const char *name = log_args.mode->sval[0];
+        if (strcmp(name, "on") == 0) {
+            enabled = true;
+        } else if (strcmp(name, "off") == 0) {
+            enabled = false;
+        } else {
+            ESP_LOGE(CONSOLE_TAG, "Error: Unknown batching mode '%s'.", name);
+            return 1;
+        }
+    }
+
+    if (log_args.bench->count > 0) {
+        int lines = log_args.lines->count > 0 ? log_args.lines->ival[0] : LOG_BENCH_LINES;
+        int words = log_args.words->count > 0 ? log_args.words->ival[0] : LOG_BENCH_WORDS;
+        // Each word takes 9 characters, and the line its tag and header
+        int max_words = (MAX_CMDLINE_LENGTH - 64) / 9;
+        if (lines < 1 || words < 1 || words > max_words) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Lines must be at least 1 and words between 1 and %d.", max_words);
+            return 1;
+        }
+        log_batch_stats_t direct, batched;
+        int64_t direct_log, direct_elapsed, batched_log, batched_elapsed;
+        log_bench_run(false, lines, words, &direct, &direct_log, &direct_elapsed);
+        log_bench_run(true, lines, words, &batched, &batched_log, &batched_elapsed);
+        log_batch_set_enabled(enabled);
+
+        ESP_LOGI(CONSOLE_TAG, "Console over %s, %d lines of %d words:", log_batch_transport(), lines, words);
+        #if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+        ESP_LOGI(CONSOLE_TAG, "  UART line limit: %.1f KB/s at %d baud", (double)CONFIG_ESP_CONSOLE_UART_BAUDRATE / 10.0 / 1024.0,
+                 CONFIG_ESP_CONSOLE_UART_BAUDRATE);
+        #endif
+        print_log_bench("Direct", lines, &direct, direct_log, direct_elapsed);
+        print_log_bench("Batched", lines, &batched, batched_log, batched_elapsed);
+        return 0;
+    }
+
+    log_batch_set_enabled(enabled);
+    log_batch_get_stats(&stats);
+    ESP_LOGI(CONSOLE_TAG, "Console over %s, batching %s (%d-byte buffers, flushed at %d bytes or %d ms)", log_batch_transport(),
+             stats.enabled ? "on" : "off", LOG_BATCH_BUFFER_BYTES, LOG_BATCH_FLUSH_BYTES, LOG_BATCH_FLUSH_MS);
+    ESP_LOGI(CONSOLE_TAG, "  %llu bytes out in %lu write(s), largest %lu bytes, %.1f ms writing, %lu bytes dropped",
+             (unsigned long long)stats.bytes_out, (unsigned long)stats.writes, (unsigned long)stats.largest_write,
+             (double)stats.write_micros / 1000.0, (unsigned long)stats.dropped_bytes);
+    return 0;
+}
+
+/**
+ * @brief Registers the console output command.
+ */
+static void register_log_command(void) {
+    log_args.mode = arg_str0("m", "mode", "<on|off>", "Batch the console output");
+    log_args.bench = arg_lit0("b", "bench", "Compare direct and batched output for sustained RX hex dumps");
+    log_args.lines = arg_int0("n", "lines", "<n>", "Lines logged by each run");
+    log_args.words = arg_int0("w", "words", "<n>", "Words in each line");
+    log_args.end = arg_end(4);
+    register_command("log", NULL, "Configure console output batching and benchmark it against direct output", "[-m <on|off>] [-b [-n <n>] [-w <n>]]", &cmd_log, &log_args);
+}
+
+/**
+ * @brief Prints a time since boot in milliseconds, or a dash if it is not known yet.
+ *
+ * @param label Label of the time.
+ * @param micros Time since boot in microseconds, 0 if not known.
+ */
+static void print_boot_time(const char *label, int64_t micros) {
+    if (micros == 0) {
+        ESP_LOGI(CONSOLE_TAG, "  %-12s        -", label);
+    } else {
+        ESP_LOGI(CONSOLE_TAG, "  %-12s %8.1f ms", label, (double)micros / 1000.0);
+    }
+}
+
+/**
+ * @brief Command to print the time of each boot stage and the time to link-ready.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success.
+ */
+static int cmd_boot(int argc, char **argv) {
+    boot_times_t times;
+    boot_get_times(&times);
+    int64_t serial_micros = 0;
+
+    ESP_LOGI(CONSOLE_TAG, "Boot stages (ms since boot):");
+    ESP_LOGI(CONSOLE_TAG, "  %-12s %4s %8s %8s %8s", "Stage", "Core", "Start", "End", "Length");
+    for (int s = 0; s < BOOT_STAGE_COUNT; s++) {
+        const boot_stage_times_t* stage = &times.stages[s];
+        if (stage->skipped) {
+            ESP_LOGI(CONSOLE_TAG, "  %-12s    - disabled", boot_stage_name((boot_stage_t)s));
+        } else if (stage->end_micros == 0) {
+            ESP_LOGI(CONSOLE_TAG, "  %-12s %4d %8.1f  running", boot_stage_name((boot_stage_t)s), stage->core,
+                     (double)stage->start_micros / 1000.0);
+        } else {
+            int64_t length = stage->end_micros - stage->start_micros;
+            serial_micros += length;
+            ESP_LOGI(CONSOLE_TAG, "  %-12s %4d %8.1f %8.1f %8.1f", boot_stage_name((boot_stage_t)s), stage->core,
+                     (double)stage->start_micros / 1000.0, (double)stage->end_micros / 1000.0, (double)length / 1000.0);
+        }
+    }
+    print_boot_time("Initialised", times.init_micros);
+    if (times.init_micros != 0) {
+        ESP_LOGI(CONSOLE_TAG, "  %-12s %8.1f ms if the stages ran one after the other", "Serial", (double)serial_micros / 1000.0);
+    }
+    print_boot_time("TX keys", times.tx_keys_micros);
+    print_boot_time("RX keys", times.rx_keys_micros);
+    print_boot_time("Link ready", times.link_ready_micros);
+    return 0;
+}
+
+/**
+ * @brief Registers the boot command.
+ */
+static void register_boot_command(void) {
+    register_command("boot", NULL, "Print the time of each boot stage and the time to link-ready", NULL, &cmd_boot, NULL);
+}
+
+/**
+ * @brief Arguments of the link benchmark job.
+ */
+typedef struct {
+    uint32_t links;     /**< Largest number of extra links */
+    uint32_t seconds;   /**< Length of each step */
+} link_job_t;
+
+/**
+ * @brief Job running the on-target link benchmark.
+ *
+ * @param job The job.
+ * @param arg Pointer to a link_job_t.
+ * @return int 0 on success, 1 on failure.
+ */
+static int link_benchmark_job(console_job_t *job, void *arg) {
+    const link_job_t *params = (const link_job_t *)arg;
+    encryption_vars_t keys;
+    msws32_var_t keys_msws32;
+    tx_keys_clone(&keys, &keys_msws32);
+    esp_err_t err = vlc_link_benchmark(params->links, params->seconds, &keys, stdout);
+    if (err == ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(CONSOLE_TAG, "No more links could start: every link takes two of the four timers.");
+    } else if (err != ESP_OK) {
+        ESP_LOGE(CONSOLE_TAG, "Error: Benchmark failed (%s).", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Command to benchmark the aggregate throughput of several links, on target or in the simulator.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success, 1 on failure.
+ */
+static int cmd_link(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&link_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, link_args.end, argv[0]);
+        return 1;
+    }
+
+    if (link_args.sim->count > 0) {
+        int links = link_args.links->count > 0 ? link_args.links->ival[0] : 2 * portNUM_PROCESSORS;
+        int rounds = link_args.rounds->count > 0 ? link_args.rounds->ival[0] : 8;
+        if (links < 1 || links > SIM_SWEEP_MAX_LINKS || rounds < 1) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Links must be between 1 and %d and rounds at least 1.", SIM_SWEEP_MAX_LINKS);
+            return 1;
+        }
+        return sim_sweep_links((uint32_t)links, (uint32_t)rounds, LINK_SIM_MAX_WORDS, 1, stdout) == ESP_OK ? 0 : 1;
+    }
+
+    if (link_args.bench->count > 0) {
+        int seconds = link_args.bench->ival[0];
+        int links = link_args.links->count > 0 ? link_args.links->ival[0] : VLC_LINK_MAX - 1;
+        if (seconds < 1 || links < 1 || links >= VLC_LINK_MAX) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Seconds must be at least 1 and links between 1 and %d.", VLC_LINK_MAX - 1);
+            return 1;
+        }
+        if (!tx_encryption_queued) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Set the encryption values first, the links use a copy of the TX keystream.");
+            return 1;
+        }
+        link_job_t params = { .links = (uint32_t)links, .seconds = (uint32_t)seconds };
+        return submit_job("link bench", &link_benchmark_job, &params, sizeof(params), true);
+    }
+
+    ESP_LOGE(CONSOLE_TAG, "Error: Choose -b <seconds> or -s.");
+    return 1;
+}
+
+/**
+ * @brief Registers the link command.
+ */
+static void register_link_command(void) {
+    link_args.bench = arg_int0("b", "bench", "<seconds>", "Run self-looped extra links on target, TX pin of each wired to its RX pin");
+    link_args.sim = arg_litn("s", "sim", 0, 1, "Run simulated links instead");
+    link_args.links = arg_int0("n", "links", "<n>", "Largest number of links");
+    link_args.rounds = arg_int0("r", "rounds", "<n>", "Transfers per simulated link");
+    link_args.end = arg_end(4);
+    register_command("link", NULL, "Benchmark the aggregate throughput as links are added", "-b <seconds> | -s [-r <rounds>] [-n <links>]", &cmd_link, &link_args);
+}
+
+/**
+ * @brief Command to list the console jobs with their progress and result.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success.
+ */
+static int cmd_jobs(int argc, char **argv) {
+    console_job_info_t jobs[JOB_MAX];
+    size_t count = console_job_list(jobs, JOB_MAX);
+    int64_t now = esp_timer_get_time();
+    if (count == 0) {
+        ESP_LOGI(CONSOLE_TAG, "No jobs");
+        return 0;
+    }
+    ESP_LOGI(CONSOLE_TAG, "%d workers on core %d", JOB_WORKERS, JOB_WORKER_CORE);
+    ESP_LOGI(CONSOLE_TAG, "  %4s %-15s %-8s %-18s %8s %s", "ID", "Name", "State", "Progress", "Time (s)", "Result");
+    for (size_t i = 0; i < count; i++) {
+        const console_job_info_t *job = &jobs[i];
+        char progress[24] = "-";
+        if (job->total > 0) {
+            snprintf(progress, sizeof(progress), "%lu/%lu (%lu%%)", (unsigned long)job->done, (unsigned long)job->total,
+                     (unsigned long)((uint64_t)job->done * 100 / job->total));
+        }
+        // Waiting time while queued, then running time
+        int64_t since = (job->state == JOB_STATE_QUEUED) ? job->queued_micros : job->start_micros;
+        int64_t until = (job->end_micros != 0) ? job->end_micros : now;
+        char result[12] = "";
+        if (job->state == JOB_STATE_DONE || job->state == JOB_STATE_FAILED) {
+            snprintf(result, sizeof(result), "%d", job->result);
+        }
+        ESP_LOGI(CONSOLE_TAG, "  %4lu %-15s %-8s %-18s %8.1f %s", (unsigned long)job->id, job->name,
+                 console_job_state_name(job->state), progress, (double)(until - since) / 1e6, result);
+    }
+    return 0;
+}
+
+/**
+ * @brief Registers the jobs command.
+ */
+static void register_jobs_command(void) {
+    register_command("jobs", NULL, "List the console jobs with their progress and result", NULL, &cmd_jobs, NULL);
+}
+
+/**
+ * @brief Command to wait for one console job, or for all of them.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int The result of the job, 0 once all jobs ended, 1 on timeout or for an unknown job.
+ */
+static int cmd_wait(int argc, char **argv) {
+    int nerrors = arg_parse(argc, argv, (void **)&wait_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, wait_args.end, argv[0]);
+        return 1;
+    }
+    TickType_t timeout = portMAX_DELAY;
+    if (wait_args.timeout->count > 0) {
+        if (wait_args.timeout->ival[0] < 0) {
+            ESP_LOGE(CONSOLE_TAG, "Error: The timeout must not be negative.");
+            return 1;
+        }
+        timeout = pdMS_TO_TICKS((uint32_t)wait_args.timeout->ival[0] * 1000);
+    }
+
+    if (wait_args.id->count == 0) {
+        if (console_job_wait_all(timeout) != ESP_OK) {
+            ESP_LOGE(CONSOLE_TAG, "Error: Jobs still running after %d s.", wait_args.timeout->ival[0]);
+            return 1;
+        }
+        ESP_LOGI(CONSOLE_TAG, "All jobs ended");
+        return 0;
+    }
+
+    uint32_t id = (uint32_t)wait_args.id->ival[0];
+    console_job_info_t job;
+    esp_err_t err = console_job_wait(id, timeout, &job);
+    if (err == ESP_ERR_NOT_FOUND) {
+        ESP_LOGE(CONSOLE_TAG, "Error: No job %lu in the job table.", (unsigned long)id);
+        return 1;
+    } else if (err != ESP_OK) {
+        ESP_LOGE(CONSOLE_TAG, "Error: Job %lu still running after %d s.", (unsigned long)id, wait_args.timeout->ival[0]);
+        return 1;
+    }
+    ESP_LOGI(CONSOLE_TAG, "Job %lu (%s) %s with %d after %.1f s", (unsigned long)job.id, job.name, console_job_state_name(job.state),
+             job.result, (double)(job.end_micros - job.start_micros) / 1e6);
+    return job.result;
+}
+
+/**
+ * @brief Registers the wait command.
+ */
+static void register_wait_command(void) {
+    wait_args.id = arg_int0(NULL, NULL, "<id>", "Job to wait for, all jobs if omitted");
+    wait_args.timeout = arg_int0("t", "timeout", "<s>", "Maximum time to wait, in seconds");
+    wait_args.end = arg_end(2);
+    register_command("wait", NULL, "Wait for a console job to end and print its result", "[<id>] [-t <s>]", &cmd_wait, &wait_args);
+}
+
+/**
+ * @brief Command to print the control channel counters.
+ *
+ * The channel is benchmarked against the text console from the host, by ctrl_bench in CombinedCode/host.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return int 0 on success.
+ */
+static int cmd_ctrl(int argc, char **argv) {
+    ctrl_stats_t stats;
+    ctrl_get_stats(&stats);
+    ESP_LOGI(CONSOLE_TAG, "Control channel %s on UART%d (TX GPIO %d, RX GPIO %d) at %d baud, notifications %s",
+             CTRL_ENABLE ? "enabled" : "disabled", (int)CTRL_UART_NUM, (int)CTRL_UART_TX_GPIO, (int)CTRL_UART_RX_GPIO,
+             CTRL_UART_BAUD, stats.subscribed ? "on" : "off");
+    ESP_LOGI(CONSOLE_TAG, "  %lu packets in, %lu out, %lu COBS errors, %lu length errors, %lu CRC errors",
+             (unsigned long)stats.rx_packets, (unsigned long)stats.tx_packets, (unsigned long)stats.cobs_errors,
+             (unsigned long)stats.length_errors, (unsigned long)stats.crc_errors);
+    ESP_LOGI(CONSOLE_TAG, "  %lu frames notified, %lu dropped", (unsigned long)stats.notifications,
+             (unsigned long)stats.notify_dropped);
+    return 0;
+}
+
+/**
+ * @brief Registers the control channel command.
+ */
+static void register_ctrl_command(void) {
+    register_command("ctrl", NULL, "Print the binary control channel counters", NULL, &cmd_ctrl, NULL);
+}
+
+/**
+ * @brief Initializes the console for the Secure VLC Project.
+ *
+ * This function sets up the console, configures the REPL (Read-Eval-Print Loop),
+ * and registers all available commands. It performs the following tasks:
+ * 1. Creates and configures a new REPL instance.
+ * 2. Sets up the UART, USB Serial/JTAG or USB CDC for console communication, as configured.
+ * 3. Registers all available commands, including:
+ *    - Help command
+ *    - Set encryption command
+ *    - Get encryption command
+ *    - Transmit command
+ *    - Clear console command
+ *    - Frequency command
+ *    - Capture command
+ *    - Replay command
+ *    - Sweep command
+ *    - Trace command
+ *    - Profile command
+ *    - PHY command
+ *    - Diversity command
+ *    - Shaping command
+ *    - Calibration command
+ *    - Power command
+ *    - Link command
+ *    - Run-length command
+ *    - RX loop command
+ *    - Pipeline command
+ *    - Flash stress command
+ *    - Boot command
+ *    - Log command
+ *    - Jobs command
+ *    - Wait command
+ *    - Control channel command
+ *
+ * @return esp_console_repl_t* Pointer to the initialized REPL instance.
+ *         Returns NULL if initialization fails.
+ */
+static esp_console_repl_t* initialize_console(void) {
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = PROMPT_STR;
+    repl_config.max_cmdline_length = MAX_CMDLINE_LENGTH;
+
+    #if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_uart(&hw_config, &repl_config, &repl));
+    #elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl));
+    #elif defined(CONFIG_ESP_CONSOLE_USB_CDC)
+    esp_console_dev_usb_cdc_config_t hw_config = ESP_CONSOLE_DEV_CDC_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_usb_cdc(&hw_config, &repl_config, &repl));
+    #endif
+
+    /* Register commands */
+    esp_console_register_help_command();
+    register_set_encryption_command();
+    register_get_encryption_command();
+    register_transmit_command();
+    register_clear_command();
+    register_frequency_command();
+    register_capture_command();
+    register_replay_command();
+    register_sweep_command();
+    register_trace_command();
+    register_profile_command();
+    register_phy_command();
+    register_diversity_command();
+    register_shaping_command();
+    register_calibration_command();
+    register_power_command();
+    register_link_command();
+    register_runlength_command();
+    register_rxloop_command();
+    register_pipeline_command();
+    register_flashstress_command();
+    register_boot_command();
+    register_log_command();
+    register_jobs_command();
+    register_wait_command();
+    register_ctrl_command();
+
+    return repl;
+}
+
+/**
+ * @brief Task for initializing and managing the REPL console and logging.
+ *
+ * This task sets up custom logging, initializes the console, and starts the REPL.
+ * NVS is initialized by app_main() meanwhile.
+ *
+ * @param pvParameters Pointer to task parameters (not used in this case)
+ */
+void console_and_logging_task(void *pvParameters) {
+    trace_register_task(TRACE_TASK_CONSOLE);
+    boot_stage_begin(BOOT_STAGE_CONSOLE);
+
+    // Set custom logging function, batching its output
+    if (log_batch_init() != ESP_OK) {
+        ESP_LOGW(CONSOLE_TAG, "Console output is not batched: the writer task could not start");
+    }
+    esp_log_set_vprintf(custom_vprintf);
+
+    // Workers of the long-running commands
+    ESP_ERROR_CHECK(console_jobs_init());
+
+    // Initialize and start REPL console
+    esp_console_repl_t *repl = initialize_console();
+    ESP_ERROR_CHECK(esp_console_start_repl(repl));
+    boot_stage_end(BOOT_STAGE_CONSOLE);
+    ESP_LOGI(CONSOLE_TAG, "Console initialized");
+    
+    // This task should not return, so add an infinite loop
+    while(1) {
+        vTaskDelay(pdMS_TO_TICKS(1000)); // Delay to prevent tight loop
+    }
 }
\ No newline at end of file
@@ -1,48 +1,95 @@
-/**
- * @file console_commands.h
- * @author Ricardo Jorge Dias Sampaio
- * @brief Header file for console commands in the Secure VLC Project.
- * @version 1.0
- * @date 2024-09-03
- *
- * \par License:
- *   \ref mit_license "MIT License".
- * @details This file contains declarations for public functions and variables related to
- * the console command system in the Secure VLC Project.
- */
-
-#ifndef CONSOLE_COMMANDS_H
-#define CONSOLE_COMMANDS_H
-
-#include <stdarg.h>
-#include "argtable3/argtable3.h"
-#include "esp_console.h"
-#include "esp_log.h"
-#include "nvs_flash.h"
-
-#include "common_utils/config.h"
-#include "common_utils/encryption.h"
-#include "reception/RX_functions.h"
-#include "transmission/TX_functions.h"
-
-/**
- * @brief Global flag to track if TX encryption values have been set.
- */
-extern bool tx_encryption_set;
-
-/**
- * @brief Global flag to track if RX encryption values have been set.
- */
-extern bool rx_encryption_set;
-
-/**
- * @brief Task for initializing and managing the REPL console and logging.
- *
- * This task initializes NVS, sets up custom logging, initializes the console,
- * and starts the REPL.
- *
- * @param pvParameters Pointer to task parameters (not used in this case)
- */
-void console_and_logging_task(void *pvParameters);
-
-#endif // CONSOLE_COMMANDS_H
+/**
+ * @file console_commands.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for console commands in the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ *
+ * \par License:
+ *   \ref mit_license "MIT License".
+ * @details This file contains declarations for public functions and variables related to
+ * the console command system in the Secure VLC Project.
+ */
+
+#ifndef CONSOLE_COMMANDS_H
+#define CONSOLE_COMMANDS_H
+
+#include <stdarg.h>
+#include "argtable3/argtable3.h"
+#include "esp_console.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "nvs_flash.h"
+
+#include "common_utils/boot.h"
+#include "common_utils/config.h"
+#include "common_utils/encryption.h"
+#include "common_utils/frame.h"
+#include "common_utils/power.h"
+#include "common_utils/trace.h"
+#include "console/console_jobs.h"
+#include "control/ctrl_server.h"
+#include "console/log_batch.h"
+#include "link/vlc_link.h"
+#include "reception/RX_functions.h"
+#include "reception/RX_calibration.h"
+#include "reception/RX_capture.h"
+#include "reception/RX_decoder.h"
+#include "reception/RX_diversity.h"
+#include "reception/RX_edges.h"
+#include "reception/RX_loop.h"
+#include "phy/phy_pins.h"
+#include "phy/phy_probe.h"
+#include "phy/phy_rmt.h"
+#include "transmission/TX_functions.h"
+#include "transmission/TX_runlength.h"
+#include "simulation/sim_sweep.h"
+
+/**
+ * @brief Global flag to track if TX encryption values have been set, set once their key warm-up job ended.
+ */
+extern volatile bool tx_encryption_set;
+
+/**
+ * @brief Global flag to track if RX encryption values have been set, set once their key warm-up job ended.
+ */
+extern volatile bool rx_encryption_set;
+
+/**
+ * @brief Sets the encryption values of one side, as the set_encryption command does.
+ *
+ * The values are range-checked and the iterations clamped at once; the key generator is warmed up by a console
+ * job, which link jobs submitted later wait for.
+ *
+ * @param rx true for the RX values, false for the TX values.
+ * @param map_type Map type of both maps.
+ * @param map1 Initial state and warm-up iterations of map 1.
+ * @param map2 Initial state and warm-up iterations of map 2.
+ * @param job_id Pointer to store the ID of the warm-up job.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a value out of range, or the error of console_job_submit().
+ */
+esp_err_t console_set_encryption(bool rx, map_type_t map_type, const chaotic_map_t *map1, const chaotic_map_t *map2, uint32_t *job_id);
+
+/**
+ * @brief Transmits data, as the transmit command does, split into frames by a console job.
+ *
+ * @param data Bytes to send, without a NUL byte.
+ * @param length Number of bytes, less than MAX_DATA_LENGTH.
+ * @param job_id Pointer to store the ID of the job.
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE for data too long or holding a NUL byte, ESP_ERR_INVALID_STATE
+ *         if the TX or RX encryption values are not set, or the error of console_job_submit().
+ */
+esp_err_t console_transmit(const char *data, size_t length, uint32_t *job_id);
+
+/**
+ * @brief Task for initializing and managing the REPL console and logging.
+ *
+ * This task sets up custom logging, initializes the console, and starts the REPL.
+ * NVS is initialized by app_main() meanwhile.
+ *
+ * @param pvParameters Pointer to task parameters (not used in this case)
+ */
+void console_and_logging_task(void *pvParameters);
+
+#endif // CONSOLE_COMMANDS_H
@@ -0,0 +1,250 @@
+/**
+ * @file console_jobs.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the asynchronous console jobs for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the job table, the queue of the workers, the lock serialising the jobs that drive
+ * the link and the waits on the end of a job. Each slot of the table has a bit in an event group, set while it
+ * holds no queued or running job.
+ */
+
+#include "console_jobs.h"
+#include "esp_cpu.h"
+#include "common_utils/trace.h"
+
+/** @brief Tag for logging job messages */
+static const char *JOBS_TAG = "JOBS";
+
+/**
+ * @brief Slot of the job table.
+ */
+struct console_job {
+    console_job_info_t info;                    /**< State, progress and result */
+    console_job_fn_t fn;                        /**< Function of the job */
+    uint64_t arg[(JOB_ARG_BYTES + 7) / 8];      /**< Copy of the arguments, aligned for any type */
+};
+
+/** @brief Job table. */
+static console_job_t job_table[JOB_MAX];
+
+/** @brief ID of the next job. */
+static uint32_t job_next_id = 1;
+
+/** @brief Protects the job table. */
+static portMUX_TYPE job_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/** @brief Slots of the queued jobs, in submission order. */
+static QueueHandle_t job_queue = NULL;
+
+/** @brief Held by the job driving the link. */
+static SemaphoreHandle_t job_link_mutex = NULL;
+
+/** @brief One bit per slot, set while the slot holds no queued or running job. */
+static EventGroupHandle_t job_events = NULL;
+
+/**
+ * @brief Checks whether a job has ended.
+ *
+ * @param state State of the job.
+ * @return true if the job is done or failed.
+ */
+static bool job_ended(job_state_t state) {
+    return state == JOB_STATE_DONE || state == JOB_STATE_FAILED;
+}
+
+/**
+ * @brief Gets the time left of a wait.
+ *
+ * @param start Tick count at the start of the wait.
+ * @param timeout Maximum time to wait.
+ * @return The time left, 0 once the wait timed out.
+ */
+static TickType_t job_remaining(TickType_t start, TickType_t timeout) {
+    if (timeout == portMAX_DELAY) {
+        return portMAX_DELAY;
+    }
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    return elapsed >= timeout ? 0 : timeout - elapsed;
+}
+
+/**
+ * @brief Worker task, running the queued jobs one after the other.
+ *
+ * @param pvParameters Pointer to task parameters (unused).
+ */
+static void job_worker_task(void *pvParameters) {
+    uint8_t slot;
+    while (1) {
+        xQueueReceive(job_queue, &slot, portMAX_DELAY);
+        console_job_t* job = &job_table[slot];
+        if (job->info.link) {
+            xSemaphoreTake(job_link_mutex, portMAX_DELAY);
+        }
+
+        portENTER_CRITICAL(&job_lock);
+        job->info.state = JOB_STATE_RUNNING;
+        job->info.core = (int8_t)esp_cpu_get_core_id();
+        job->info.start_micros = esp_timer_get_time();
+        portEXIT_CRITICAL(&job_lock);
+
+        int result = job->fn(job, job->arg);
+
+        if (job->info.link) {
+            xSemaphoreGive(job_link_mutex);
+        }
+        portENTER_CRITICAL(&job_lock);
+        job->info.result = result;
+        job->info.state = (result == 0) ? JOB_STATE_DONE : JOB_STATE_FAILED;
+        job->info.end_micros = esp_timer_get_time();
+        console_job_info_t info = job->info;
+        portEXIT_CRITICAL(&job_lock);
+        xEventGroupSetBits(job_events, (EventBits_t)1 << slot);
+
+        ESP_LOGI(JOBS_TAG, "Job %lu (%s) %s in %.1f s", (unsigned long)info.id, info.name,
+                 console_job_state_name(info.state), (double)(info.end_micros - info.start_micros) / 1e6);
+    }
+}
+
+esp_err_t console_jobs_init(void) {
+    job_queue = xQueueCreate(JOB_MAX, sizeof(uint8_t));
+    job_link_mutex = xSemaphoreCreateMutex();
+    job_events = xEventGroupCreate();
+    if (job_queue == NULL || job_link_mutex == NULL || job_events == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    trace_register_queue(job_queue, TRACE_QUEUE_JOBS);
+    xEventGroupSetBits(job_events, ((EventBits_t)1 << JOB_MAX) - 1);
+    for (int w = 0; w < JOB_WORKERS; w++) {
+        if (xTaskCreatePinnedToCore(job_worker_task, "Job Worker Task", JOB_STACK_SIZE, NULL, 1, NULL, JOB_WORKER_CORE) != pdPASS) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t console_job_submit(const char* name, console_job_fn_t fn, const void* arg, size_t arg_size, bool link, uint32_t* id) {
+    if (arg_size > JOB_ARG_BYTES) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // A free slot, otherwise the one of the oldest ended job
+    int slot = -1;
+    portENTER_CRITICAL(&job_lock);
+    for (int s = 0; s < JOB_MAX; s++) {
+        job_state_t state = job_table[s].info.state;
+        if (state == JOB_STATE_FREE) {
+            slot = s;
+            break;
+        }
+        if (job_ended(state) && (slot == -1 || job_table[s].info.id < job_table[slot].info.id)) {
+            slot = s;
+        }
+    }
+    if (slot == -1) {
+        portEXIT_CRITICAL(&job_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    console_job_t* job = &job_table[slot];
+    job->info = (console_job_info_t){
+        .id = job_next_id++,
+        .state = JOB_STATE_QUEUED,
+        .link = link,
+        .core = -1,
+        .queued_micros = esp_timer_get_time(),
+    };
+    snprintf(job->info.name, sizeof(job->info.name), "%s", name);
+    job->fn = fn;
+    if (arg != NULL) {
+        memcpy(job->arg, arg, arg_size);
+    }
+    *id = job->info.id;
+    portEXIT_CRITICAL(&job_lock);
+
+    uint8_t index = (uint8_t)slot;
+    xEventGroupClearBits(job_events, (EventBits_t)1 << slot);
+    // Never full: the queue holds one entry per slot
+    xQueueSend(job_queue, &index, portMAX_DELAY);
+    return ESP_OK;
+}
+
+void console_job_progress(console_job_t* job, uint32_t done, uint32_t total) {
+    if (job == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&job_lock);
+    job->info.done = done;
+    job->info.total = total;
+    portEXIT_CRITICAL(&job_lock);
+}
+
+esp_err_t console_job_wait(uint32_t id, TickType_t timeout, console_job_info_t* info) {
+    TickType_t start = xTaskGetTickCount();
+    while (1) {
+        int slot = -1;
+        console_job_info_t current;
+        portENTER_CRITICAL(&job_lock);
+        for (int s = 0; s < JOB_MAX; s++) {
+            if (job_table[s].info.id == id && job_table[s].info.state != JOB_STATE_FREE) {
+                slot = s;
+                current = job_table[s].info;
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&job_lock);
+        if (slot == -1) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        if (job_ended(current.state)) {
+            if (info != NULL) {
+                *info = current;
+            }
+            return ESP_OK;
+        }
+        TickType_t remaining = job_remaining(start, timeout);
+        if (remaining == 0) {
+            return ESP_ERR_TIMEOUT;
+        }
+        xEventGroupWaitBits(job_events, (EventBits_t)1 << slot, pdFALSE, pdTRUE, remaining);
+    }
+}
+
+esp_err_t console_job_wait_all(TickType_t timeout) {
+    TickType_t start = xTaskGetTickCount();
+    const EventBits_t all = ((EventBits_t)1 << JOB_MAX) - 1;
+    while ((xEventGroupGetBits(job_events) & all) != all) {
+        TickType_t remaining = job_remaining(start, timeout);
+        if (remaining == 0) {
+            return ESP_ERR_TIMEOUT;
+        }
+        xEventGroupWaitBits(job_events, all, pdFALSE, pdTRUE, remaining);
+    }
+    return ESP_OK;
+}
+
+size_t console_job_list(console_job_info_t* infos, size_t max_jobs) {
+    size_t count = 0;
+    portENTER_CRITICAL(&job_lock);
+    for (int s = 0; s < JOB_MAX && count < max_jobs; s++) {
+        if (job_table[s].info.state == JOB_STATE_FREE) {
+            continue;
+        }
+        // Insertion by ID
+        size_t i = count++;
+        while (i > 0 && infos[i - 1].id > job_table[s].info.id) {
+            infos[i] = infos[i - 1];
+            i--;
+        }
+        infos[i] = job_table[s].info;
+    }
+    portEXIT_CRITICAL(&job_lock);
+    return count;
+}
+
+const char* console_job_state_name(job_state_t state) {
+    static const char* const names[JOB_STATE_COUNT] = { "free", "queued", "running", "done", "failed" };
+    return (state < JOB_STATE_COUNT) ? names[state] : "?";
+}
@@ -0,0 +1,145 @@
+/**
+ * @file console_jobs.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the asynchronous console jobs for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the executor of long-running console commands. A command checks its arguments,
+ * copies them into a job and returns its ID at once; the job runs on one of JOB_WORKERS worker tasks pinned to
+ * JOB_WORKER_CORE, so the REPL stays responsive and more work can be queued.
+ *
+ * Jobs start in submission order. Jobs that drive the link (key warm-up, transmission, link benchmarks) also run one
+ * at a time, in submission order, so a transmission queued after new keys uses them. The job table keeps the last
+ * JOB_MAX jobs with their progress and result.
+ */
+
+#ifndef CONSOLE_JOBS_H
+#define CONSOLE_JOBS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+#include "common_utils/config.h"
+
+/**
+ * @brief States of a job.
+ */
+typedef enum {
+    JOB_STATE_FREE,         /**< Slot unused */
+    JOB_STATE_QUEUED,       /**< Waiting for a worker or for the link */
+    JOB_STATE_RUNNING,      /**< Running on a worker */
+    JOB_STATE_DONE,         /**< Returned 0 */
+    JOB_STATE_FAILED,       /**< Returned non-zero */
+    JOB_STATE_COUNT,
+} job_state_t;
+
+/**
+ * @brief Job, as seen by its function.
+ */
+typedef struct console_job console_job_t;
+
+/**
+ * @brief Function of a job.
+ *
+ * @param job The job, for console_job_progress().
+ * @param arg Copy of the arguments given at submission.
+ * @return 0 on success, non-zero on failure, as a console command.
+ */
+typedef int (*console_job_fn_t)(console_job_t* job, void* arg);
+
+/**
+ * @brief Snapshot of a job.
+ */
+typedef struct {
+    uint32_t id;                /**< Job ID, 0 for a free slot */
+    char name[JOB_NAME_LENGTH]; /**< Name of the job */
+    job_state_t state;          /**< State of the job */
+    bool link;                  /**< The job drives the link */
+    uint32_t done;              /**< Progress, in units of the job */
+    uint32_t total;             /**< Total of the progress, 0 if unknown */
+    int result;                 /**< Return value once done */
+    int8_t core;                /**< Core the job ran on, -1 until it starts */
+    int64_t queued_micros;      /**< Time of the submission */
+    int64_t start_micros;       /**< Time the job started, 0 until it does */
+    int64_t end_micros;         /**< Time the job ended, 0 until it does */
+} console_job_info_t;
+
+/**
+ * @brief Creates the job table and the worker tasks. Called by the console task before commands are registered.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM otherwise.
+ */
+esp_err_t console_jobs_init(void);
+
+/**
+ * @brief Submits a job.
+ *
+ * @param name Name of the job, truncated to JOB_NAME_LENGTH - 1 characters.
+ * @param fn Function of the job.
+ * @param arg Arguments, copied into the job, or NULL.
+ * @param arg_size Size of the arguments, at most JOB_ARG_BYTES.
+ * @param link true if the job drives the link.
+ * @param id Pointer to store the ID of the job.
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the arguments are too large, ESP_ERR_NO_MEM if every slot
+ *         holds a queued or running job.
+ */
+esp_err_t console_job_submit(const char* name, console_job_fn_t fn, const void* arg, size_t arg_size, bool link, uint32_t* id);
+
+/**
+ * @brief Reports the progress of a job. Called by the job function.
+ *
+ * @param job The job.
+ * @param done Units done.
+ * @param total Total units, 0 if unknown.
+ */
+void console_job_progress(console_job_t* job, uint32_t done, uint32_t total);
+
+/**
+ * @brief Waits for a job to end.
+ *
+ * @param id ID of the job.
+ * @param timeout Maximum time to wait.
+ * @param info Pointer to store the job once it ended, or NULL.
+ * @return ESP_OK once the job ended, ESP_ERR_NOT_FOUND if no such job is in the table, ESP_ERR_TIMEOUT otherwise.
+ */
+esp_err_t console_job_wait(uint32_t id, TickType_t timeout, console_job_info_t* info);
+
+/**
+ * @brief Waits for every queued and running job to end.
+ *
+ * @param timeout Maximum time to wait.
+ * @return ESP_OK once they ended, ESP_ERR_TIMEOUT otherwise.
+ */
+esp_err_t console_job_wait_all(TickType_t timeout);
+
+/**
+ * @brief Reads the job table, oldest job first.
+ *
+ * @param infos Array to store the jobs.
+ * @param max_jobs Size of the array.
+ * @return Number of jobs stored.
+ */
+size_t console_job_list(console_job_info_t* infos, size_t max_jobs);
+
+/**
+ * @brief Gets the name of a job state.
+ *
+ * @param state State of a job.
+ * @return The name.
+ */
+const char* console_job_state_name(job_state_t state);
+
+#endif /* CONSOLE_JOBS_H */
@@ -0,0 +1,231 @@
+/**
+ * @file log_batch.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the batched console output for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the double buffer of console output, the writer task sending full buffers to
+ * stdout and the counters behind the throughput of the console transport.
+ */
+
+#include "log_batch.h"
+#include "sdkconfig.h"
+#include "common_utils/trace.h"
+
+/** @brief Output buffers, one filling while the writer sends the other. */
+static char log_batch_buffers[2][LOG_BATCH_BUFFER_BYTES];
+
+/** @brief Bytes in each buffer. */
+static size_t log_batch_fill[2];
+
+/** @brief Buffer being filled. */
+static int log_batch_active = 0;
+
+/** @brief Buffer handed to the writer, -1 if none. */
+static int log_batch_pending = -1;
+
+/** @brief Time the first line entered the buffer being filled. */
+static int64_t log_batch_first_micros = 0;
+
+/** @brief Protects the buffers and the counters. */
+static SemaphoreHandle_t log_batch_mutex = NULL;
+
+/** @brief Writer task. */
+static TaskHandle_t log_batch_task = NULL;
+
+/** @brief Output is batched. */
+static volatile bool log_batch_enabled = LOG_BATCH_ENABLE_DEFAULT;
+
+/** @brief Counters. */
+static log_batch_stats_t log_batch_stats;
+
+/**
+ * @brief Hands the buffer being filled to the writer if it holds anything and the writer is free. Must be
+ * called with log_batch_mutex held.
+ */
+static void log_batch_swap(void) {
+    if (log_batch_pending != -1 || log_batch_fill[log_batch_active] == 0) {
+        return;
+    }
+    log_batch_pending = log_batch_active;
+    log_batch_active ^= 1;
+    log_batch_fill[log_batch_active] = 0;
+    xTaskNotifyGive(log_batch_task);
+}
+
+/**
+ * @brief Writes bytes to the transport and accounts the write.
+ *
+ * @param data Bytes to write.
+ * @param length Number of bytes.
+ */
+static void log_batch_output(const char* data, size_t length) {
+    int64_t start = esp_timer_get_time();
+    fwrite(data, 1, length, stdout);
+    fflush(stdout);
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    xSemaphoreTake(log_batch_mutex, portMAX_DELAY);
+    log_batch_stats.bytes_out += length;
+    log_batch_stats.writes++;
+    log_batch_stats.write_micros += (uint64_t)elapsed;
+    if (length > log_batch_stats.largest_write) {
+        log_batch_stats.largest_write = (uint32_t)length;
+    }
+    xSemaphoreGive(log_batch_mutex);
+}
+
+/**
+ * @brief Writer task, sending each buffer handed to it, and the buffer being filled once its first line is
+ * LOG_BATCH_FLUSH_MS old.
+ *
+ * @param pvParameters Pointer to task parameters (unused).
+ */
+static void log_batch_writer_task(void *pvParameters) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_BATCH_FLUSH_MS));
+
+        xSemaphoreTake(log_batch_mutex, portMAX_DELAY);
+        if (esp_timer_get_time() - log_batch_first_micros >= (int64_t)LOG_BATCH_FLUSH_MS * 1000) {
+            log_batch_swap();
+        }
+        int buffer = log_batch_pending;
+        xSemaphoreGive(log_batch_mutex);
+        if (buffer == -1) {
+            continue;
+        }
+
+        log_batch_output(log_batch_buffers[buffer], log_batch_fill[buffer]);
+
+        xSemaphoreTake(log_batch_mutex, portMAX_DELAY);
+        log_batch_fill[buffer] = 0;
+        log_batch_pending = -1;
+        if (log_batch_fill[log_batch_active] >= LOG_BATCH_FLUSH_BYTES) {
+            log_batch_swap();
+        }
+        xSemaphoreGive(log_batch_mutex);
+    }
+}
+
+/**
+ * @brief Shutdown handler of esp_restart(): writes the batched lines out, then writes every later piece directly.
+ */
+static void log_batch_shutdown(void) {
+    log_batch_flush(pdMS_TO_TICKS(LOG_BATCH_SHUTDOWN_MS));
+    log_batch_enabled = false;
+}
+
+esp_err_t log_batch_init(void) {
+    log_batch_mutex = xSemaphoreCreateMutex();
+    if (log_batch_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    trace_register_queue(log_batch_mutex, TRACE_QUEUE_LOG_BATCH);
+    if (xTaskCreatePinnedToCore(log_batch_writer_task, "Log Batch Task", LOG_BATCH_STACK_SIZE, NULL, 1,
+                                &log_batch_task, CONSOLE_TASK_CORE) != pdPASS) {
+        vSemaphoreDelete(log_batch_mutex);
+        log_batch_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = esp_register_shutdown_handler(log_batch_shutdown);
+    if (err != ESP_OK) {
+        // Output still works, only a restart may lose the last lines
+        log_batch_enabled = false;
+    }
+    return ESP_OK;
+}
+
+void log_batch_set_enabled(bool enable) {
+    if (!enable && log_batch_enabled) {
+        log_batch_flush(pdMS_TO_TICKS(1000));
+    }
+    log_batch_enabled = enable;
+}
+
+void log_batch_write(const char* data, size_t length) {
+    if (!log_batch_enabled || log_batch_mutex == NULL) {
+        if (log_batch_mutex == NULL) {
+            fwrite(data, 1, length, stdout);
+            fflush(stdout);
+        } else {
+            xSemaphoreTake(log_batch_mutex, portMAX_DELAY);
+            log_batch_stats.bytes_in += length;
+            xSemaphoreGive(log_batch_mutex);
+            log_batch_output(data, length);
+        }
+        return;
+    }
+
+    xSemaphoreTake(log_batch_mutex, portMAX_DELAY);
+    log_batch_stats.bytes_in += length;
+    if (log_batch_fill[log_batch_active] + length > LOG_BATCH_BUFFER_BYTES) {
+        log_batch_swap();
+    }
+    if (log_batch_fill[log_batch_active] + length > LOG_BATCH_BUFFER_BYTES) {
+        // Both buffers are full: the caller must not wait for the transport
+        log_batch_stats.dropped_bytes += length;
+    } else {
+        if (log_batch_fill[log_batch_active] == 0) {
+            log_batch_first_micros = esp_timer_get_time();
+        }
+        memcpy(&log_batch_buffers[log_batch_active][log_batch_fill[log_batch_active]], data, length);
+        log_batch_fill[log_batch_active] += length;
+        if (log_batch_fill[log_batch_active] >= LOG_BATCH_FLUSH_BYTES) {
+            log_batch_swap();
+        }
+    }
+    xSemaphoreGive(log_batch_mutex);
+}
+
+esp_err_t log_batch_flush(TickType_t timeout) {
+    TickType_t start = xTaskGetTickCount();
+    if (log_batch_mutex == NULL) {
+        return ESP_OK;
+    }
+    while (1) {
+        xSemaphoreTake(log_batch_mutex, portMAX_DELAY);
+        bool empty = (log_batch_pending == -1 && log_batch_fill[log_batch_active] == 0);
+        log_batch_swap();
+        xSemaphoreGive(log_batch_mutex);
+        if (empty) {
+            return ESP_OK;
+        }
+        if (xTaskGetTickCount() - start >= timeout) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+}
+
+void log_batch_get_stats(log_batch_stats_t* stats) {
+    if (log_batch_mutex == NULL) {
+        *stats = (log_batch_stats_t){0};
+        return;
+    }
+    xSemaphoreTake(log_batch_mutex, portMAX_DELAY);
+    *stats = log_batch_stats;
+    xSemaphoreGive(log_batch_mutex);
+    stats->enabled = log_batch_enabled;
+}
+
+void log_batch_reset_stats(void) {
+    if (log_batch_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(log_batch_mutex, portMAX_DELAY);
+    log_batch_stats = (log_batch_stats_t){0};
+    xSemaphoreGive(log_batch_mutex);
+}
+
+const char* log_batch_transport(void) {
+#if defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+    return "USB Serial/JTAG";
+#elif defined(CONFIG_ESP_CONSOLE_USB_CDC)
+    return "USB CDC";
+#else
+    return "UART";
+#endif
+}
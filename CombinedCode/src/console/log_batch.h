@@ -0,0 +1,101 @@
+/**
+ * @file log_batch.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the batched console output for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the layer between the log formatting and the console transport (UART, USB
+ * Serial/JTAG or USB CDC). Log lines are appended to one of two LOG_BATCH_BUFFER_BYTES buffers instead of being
+ * written one by one; a writer task on CONSOLE_TASK_CORE sends a buffer in a single write once it holds
+ * LOG_BATCH_FLUSH_BYTES, or LOG_BATCH_FLUSH_MS after its first line, while the other one fills.
+ *
+ * A task logging, the RX task among them, only copies its line and never waits for the transport. When both
+ * buffers are full the line is dropped and counted rather than stalling the caller. A restart through
+ * esp_restart() writes the batched lines out first, but they are lost on a panic, so batching is off unless
+ * LOG_BATCH_ENABLE_DEFAULT or the log command turns it on.
+ */
+
+#ifndef LOG_BATCH_H
+#define LOG_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "common_utils/config.h"
+
+/**
+ * @brief Counters of the console output.
+ */
+typedef struct {
+    bool enabled;               /**< Output is batched */
+    uint64_t bytes_in;          /**< Bytes handed to the layer */
+    uint64_t bytes_out;         /**< Bytes written to the transport */
+    uint32_t writes;            /**< Writes to the transport */
+    uint32_t largest_write;     /**< Bytes of the largest write */
+    uint32_t dropped_bytes;     /**< Bytes dropped with both buffers full */
+    uint64_t write_micros;      /**< Time spent writing to the transport */
+} log_batch_stats_t;
+
+/**
+ * @brief Creates the buffers and the writer task, and registers the shutdown handler flushing them. Called by
+ * the console task before logging is redirected.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the writer task could not be created.
+ */
+esp_err_t log_batch_init(void);
+
+/**
+ * @brief Turns batching on or off. Turning it off flushes the batched lines first.
+ *
+ * @param enable true to batch the output, false to write every piece directly.
+ */
+void log_batch_set_enabled(bool enable);
+
+/**
+ * @brief Hands output to the console, batched or written directly.
+ *
+ * @param data Bytes to write.
+ * @param length Number of bytes.
+ */
+void log_batch_write(const char* data, size_t length);
+
+/**
+ * @brief Writes out every batched line and waits until the transport has taken them.
+ *
+ * @param timeout Maximum time to wait.
+ * @return ESP_OK once everything is written, ESP_ERR_TIMEOUT otherwise.
+ */
+esp_err_t log_batch_flush(TickType_t timeout);
+
+/**
+ * @brief Reads the counters.
+ *
+ * @param stats Pointer to store the counters.
+ */
+void log_batch_get_stats(log_batch_stats_t* stats);
+
+/**
+ * @brief Clears the counters.
+ */
+void log_batch_reset_stats(void);
+
+/**
+ * @brief Gets the name of the console transport of this build.
+ *
+ * @return The name.
+ */
+const char* log_batch_transport(void);
+
+#endif /* LOG_BATCH_H */
@@ -0,0 +1,183 @@
+/**
+ * @file ctrl_proto.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the framing of the binary host-control protocol for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the CRC, the COBS codec and the packing of the packets and their payloads.
+ */
+
+#include "ctrl_proto.h"
+
+uint16_t ctrl_crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t ctrl_cobs_encode(const uint8_t* in, size_t length, uint8_t* out) {
+    size_t code_index = 0;
+    size_t written = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < length; i++) {
+        if (in[i] != 0) {
+            out[written++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF) {
+            out[code_index] = code;
+            code_index = written++;
+            code = 1;
+        }
+    }
+    out[code_index] = code;
+    return written;
+}
+
+bool ctrl_cobs_decode(const uint8_t* in, size_t length, uint8_t* out, size_t max, size_t* decoded) {
+    size_t read = 0;
+    size_t written = 0;
+    while (read < length) {
+        uint8_t code = in[read++];
+        if (code == 0 || read + code - 1 > length) {
+            return false;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (in[read] == 0 || written >= max) {
+                return false;
+            }
+            out[written++] = in[read++];
+        }
+        // A group shorter than 254 bytes stood for a zero, except at the end
+        if (code != 0xFF && read < length) {
+            if (written >= max) {
+                return false;
+            }
+            out[written++] = 0;
+        }
+    }
+    *decoded = written;
+    return true;
+}
+
+size_t ctrl_frame_build(const ctrl_packet_t* packet, uint8_t* frame) {
+    uint8_t raw[CTRL_PACKET_MAX];
+    if (packet->length > CTRL_MAX_PAYLOAD) {
+        return 0;
+    }
+    raw[0] = packet->type;
+    raw[1] = packet->seq;
+    raw[2] = (uint8_t)(packet->length & 0xFF);
+    raw[3] = (uint8_t)(packet->length >> 8);
+    if (packet->length > 0) {
+        memcpy(&raw[CTRL_HEADER_BYTES], packet->payload, packet->length);
+    }
+    size_t length = CTRL_HEADER_BYTES + packet->length;
+    uint16_t crc = ctrl_crc16(raw, length);
+    raw[length++] = (uint8_t)(crc & 0xFF);
+    raw[length++] = (uint8_t)(crc >> 8);
+
+    size_t encoded = ctrl_cobs_encode(raw, length, frame);
+    frame[encoded++] = 0;
+    return encoded;
+}
+
+int ctrl_frame_parse(uint8_t* frame, size_t length, ctrl_packet_t* packet) {
+    size_t decoded;
+    // Decoding never writes ahead of what it reads, so it works in place
+    if (!ctrl_cobs_decode(frame, length, frame, length, &decoded)) {
+        return -1;
+    }
+    if (decoded < CTRL_HEADER_BYTES + CTRL_CRC_BYTES) {
+        return -2;
+    }
+    uint16_t payload_length = (uint16_t)(frame[2] | (frame[3] << 8));
+    if ((size_t)payload_length + CTRL_HEADER_BYTES + CTRL_CRC_BYTES != decoded) {
+        return -2;
+    }
+    size_t checked = decoded - CTRL_CRC_BYTES;
+    uint16_t crc = (uint16_t)(frame[checked] | (frame[checked + 1] << 8));
+    if (ctrl_crc16(frame, checked) != crc) {
+        return -3;
+    }
+    packet->type = frame[0];
+    packet->seq = frame[1];
+    packet->length = payload_length;
+    packet->payload = &frame[CTRL_HEADER_BYTES];
+    return 0;
+}
+
+size_t ctrl_put_u32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return 4;
+}
+
+uint32_t ctrl_get_u32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+/**
+ * @brief Writes a double as its little-endian IEEE 754 bits.
+ *
+ * @param out Buffer of at least 8 bytes.
+ * @param value Value to write.
+ * @return 8.
+ */
+static size_t ctrl_put_f64(uint8_t* out, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    ctrl_put_u32(out, (uint32_t)bits);
+    ctrl_put_u32(out + 4, (uint32_t)(bits >> 32));
+    return 8;
+}
+
+/**
+ * @brief Reads a double from its little-endian IEEE 754 bits.
+ *
+ * @param in Buffer of at least 8 bytes.
+ * @return The value.
+ */
+static double ctrl_get_f64(const uint8_t* in) {
+    uint64_t bits = (uint64_t)ctrl_get_u32(in) | ((uint64_t)ctrl_get_u32(in + 4) << 32);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool ctrl_configure_read(const uint8_t* payload, size_t length, ctrl_configure_t* configure) {
+    if (length != CTRL_CONFIGURE_BYTES) {
+        return false;
+    }
+    configure->rx = payload[0];
+    configure->map = payload[1];
+    configure->x1 = ctrl_get_f64(&payload[2]);
+    configure->y1 = ctrl_get_f64(&payload[10]);
+    configure->iterations1 = (int32_t)ctrl_get_u32(&payload[18]);
+    configure->x2 = ctrl_get_f64(&payload[22]);
+    configure->y2 = ctrl_get_f64(&payload[30]);
+    configure->iterations2 = (int32_t)ctrl_get_u32(&payload[38]);
+    return true;
+}
+
+size_t ctrl_configure_write(const ctrl_configure_t* configure, uint8_t* payload) {
+    payload[0] = configure->rx;
+    payload[1] = configure->map;
+    ctrl_put_f64(&payload[2], configure->x1);
+    ctrl_put_f64(&payload[10], configure->y1);
+    ctrl_put_u32(&payload[18], (uint32_t)configure->iterations1);
+    ctrl_put_f64(&payload[22], configure->x2);
+    ctrl_put_f64(&payload[30], configure->y2);
+    ctrl_put_u32(&payload[38], (uint32_t)configure->iterations2);
+    return CTRL_CONFIGURE_BYTES;
+}
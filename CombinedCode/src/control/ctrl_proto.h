@@ -0,0 +1,197 @@
+/**
+ * @file ctrl_proto.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the framing of the binary host-control protocol for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the packet format and the framing of the binary control channel. A packet is
+ *
+ * | Bytes | Field                                                         |
+ * |-------|---------------------------------------------------------------|
+ * | 1     | Type: a request, its response (CTRL_RESPONSE set) or an event |
+ * | 1     | Sequence number, copied from a request to its response        |
+ * | 2     | Payload length                                                |
+ * | n     | Payload                                                       |
+ * | 2     | CRC-16/CCITT-FALSE of everything before it                    |
+ *
+ * all integers little-endian. On the wire each packet is COBS-encoded, so it holds no zero byte, and followed
+ * by a zero byte; a receiver resynchronises at the next zero after any error. Every response payload starts
+ * with the int32 esp_err_t of the request.
+ *
+ * CONFIGURE and TRANSMIT are answered as soon as their job is queued, with the job ID; a CTRL_MSG_JOB_DONE
+ * event follows once the job ended.
+ *
+ * The framing depends on neither the ESP-IDF nor the firmware configuration, so the host client
+ * (CombinedCode/host/client) builds it as is.
+ */
+
+#ifndef CTRL_PROTO_H
+#define CTRL_PROTO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief Maximum payload length in bytes of a control packet.
+ *
+ * Large enough for a TRANSMIT request of MAX_DATA_LENGTH - 1 bytes and for the plaintext of a received frame;
+ * ctrl_server.c checks it against MAX_DATA_LENGTH.
+ */
+#define CTRL_MAX_PAYLOAD 512
+
+/** @brief Bytes of the packet header. */
+#define CTRL_HEADER_BYTES 4
+
+/** @brief Bytes of the packet CRC. */
+#define CTRL_CRC_BYTES 2
+
+/** @brief Largest packet before framing. */
+#define CTRL_PACKET_MAX (CTRL_HEADER_BYTES + CTRL_MAX_PAYLOAD + CTRL_CRC_BYTES)
+
+/** @brief Largest COBS encoding of a packet of n bytes, without the delimiter. */
+#define CTRL_COBS_MAX(n) ((n) + (n) / 254 + 1)
+
+/** @brief Largest frame on the wire, delimiter included. */
+#define CTRL_FRAME_MAX (CTRL_COBS_MAX(CTRL_PACKET_MAX) + 1)
+
+/** @brief Bit set in the type of a response. */
+#define CTRL_RESPONSE 0x80
+
+/**
+ * @brief Packet types.
+ */
+typedef enum {
+    CTRL_MSG_PING = 0x01,           /**< Echoes its payload */
+    CTRL_MSG_CONFIGURE = 0x02,      /**< Queues the key warm-up of one side; answered with the u32 job ID */
+    CTRL_MSG_TRANSMIT = 0x03,       /**< Queues its payload, one frame per FRAME_MAX_PAYLOAD_WORDS words; answered with the u32 job ID */
+    CTRL_MSG_STATS = 0x04,          /**< Reads the link and channel counters */
+    CTRL_MSG_SUBSCRIBE = 0x05,      /**< Turns the receive notifications on (payload 1) or off (payload 0) */
+    CTRL_MSG_RX_NOTIFY = 0x40,      /**< Event: plaintext of a received frame, sequence number counting events */
+    CTRL_MSG_JOB_DONE = 0x41,       /**< Event: a CONFIGURE or TRANSMIT job ended, CTRL_JOB_DONE_BYTES of payload */
+} ctrl_msg_type_t;
+
+/**
+ * @brief Bytes of a CTRL_MSG_JOB_DONE payload: the u32 job ID, then the int32 esp_err_t result, ESP_OK if the job
+ * succeeded, ESP_FAIL if it failed, or ESP_ERR_NOT_FOUND if it left the job table before the server saw it end.
+ */
+#define CTRL_JOB_DONE_BYTES 8
+
+/**
+ * @brief Payload of CTRL_MSG_CONFIGURE, CTRL_CONFIGURE_BYTES on the wire in this order, doubles as IEEE 754.
+ */
+typedef struct {
+    uint8_t rx;                     /**< 1 for the RX keys, 0 for the TX keys */
+    uint8_t map;                    /**< map_type_t of both maps */
+    double x1;                      /**< Map 1 x */
+    double y1;                      /**< Map 1 y */
+    int32_t iterations1;            /**< Map 1 warm-up iterations */
+    double x2;                      /**< Map 2 x */
+    double y2;                      /**< Map 2 y */
+    int32_t iterations2;            /**< Map 2 warm-up iterations */
+} ctrl_configure_t;
+
+/** @brief Bytes of a CTRL_MSG_CONFIGURE payload. */
+#define CTRL_CONFIGURE_BYTES 42
+
+/**
+ * @brief Packet, its payload pointing into the buffer it was parsed from.
+ */
+typedef struct {
+    uint8_t type;                   /**< Packet type */
+    uint8_t seq;                    /**< Sequence number */
+    uint16_t length;                /**< Payload length */
+    const uint8_t* payload;         /**< Payload */
+} ctrl_packet_t;
+
+/**
+ * @brief Computes the CRC-16/CCITT-FALSE of a buffer.
+ *
+ * @param data Bytes to check.
+ * @param length Number of bytes.
+ * @return The CRC.
+ */
+uint16_t ctrl_crc16(const uint8_t* data, size_t length);
+
+/**
+ * @brief COBS-encodes a buffer.
+ *
+ * @param in Bytes to encode.
+ * @param length Number of bytes.
+ * @param out Buffer of at least CTRL_COBS_MAX(length) bytes.
+ * @return Number of encoded bytes, none of them zero.
+ */
+size_t ctrl_cobs_encode(const uint8_t* in, size_t length, uint8_t* out);
+
+/**
+ * @brief Decodes a COBS-encoded buffer, without its delimiter.
+ *
+ * @param in Encoded bytes.
+ * @param length Number of encoded bytes.
+ * @param out Buffer for the decoded bytes, which may be in.
+ * @param max Size of the out buffer.
+ * @param decoded Pointer to store the number of decoded bytes.
+ * @return true on success, false for a zero byte, a code past the end or an overflow.
+ */
+bool ctrl_cobs_decode(const uint8_t* in, size_t length, uint8_t* out, size_t max, size_t* decoded);
+
+/**
+ * @brief Builds a frame: header, payload and CRC, COBS-encoded and delimited.
+ *
+ * @param packet Packet to send.
+ * @param frame Buffer of at least CTRL_FRAME_MAX bytes.
+ * @return Number of bytes of the frame, 0 if the payload is longer than CTRL_MAX_PAYLOAD.
+ */
+size_t ctrl_frame_build(const ctrl_packet_t* packet, uint8_t* frame);
+
+/**
+ * @brief Decodes a frame in place and checks its length and CRC.
+ *
+ * @param frame Frame without its delimiter; holds the decoded packet on return.
+ * @param length Number of bytes of the frame.
+ * @param packet Pointer to store the packet, its payload pointing into frame.
+ * @return 0 on success, -1 for a COBS error, -2 for a length mismatch, -3 for a CRC mismatch.
+ */
+int ctrl_frame_parse(uint8_t* frame, size_t length, ctrl_packet_t* packet);
+
+/**
+ * @brief Reads a CTRL_MSG_CONFIGURE payload.
+ *
+ * @param payload Payload bytes.
+ * @param length Payload length.
+ * @param configure Pointer to store the fields.
+ * @return true if the payload has the right length.
+ */
+bool ctrl_configure_read(const uint8_t* payload, size_t length, ctrl_configure_t* configure);
+
+/**
+ * @brief Writes a CTRL_MSG_CONFIGURE payload.
+ *
+ * @param configure Fields to write.
+ * @param payload Buffer of at least CTRL_CONFIGURE_BYTES bytes.
+ * @return CTRL_CONFIGURE_BYTES.
+ */
+size_t ctrl_configure_write(const ctrl_configure_t* configure, uint8_t* payload);
+
+/**
+ * @brief Writes a little-endian 32-bit integer.
+ *
+ * @param out Buffer of at least 4 bytes.
+ * @param value Value to write.
+ * @return 4.
+ */
+size_t ctrl_put_u32(uint8_t* out, uint32_t value);
+
+/**
+ * @brief Reads a little-endian 32-bit integer.
+ *
+ * @param in Buffer of at least 4 bytes.
+ * @return The value.
+ */
+uint32_t ctrl_get_u32(const uint8_t* in);
+
+#endif /* CTRL_PROTO_H */
@@ -0,0 +1,352 @@
+/**
+ * @file ctrl_server.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the binary host-control channel for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the UART set-up, the reassembly of the frames from the received bytes, the
+ * handlers of the requests, the jobs waiting for their CTRL_MSG_JOB_DONE event and the queue of the receive
+ * notifications. Only the control task touches the UART.
+ */
+
+#include "ctrl_server.h"
+#include "ctrl_proto.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "common_utils/trace.h"
+
+#include "console/console_commands.h"
+#include "phy/phy.h"
+#include "reception/RX_functions.h"
+
+/** @brief Tag for logging control channel messages */
+static const char *CTRL_TAG = "CTRL";
+
+_Static_assert(CTRL_MAX_PAYLOAD >= MAX_DATA_LENGTH, "CTRL_MAX_PAYLOAD must hold a TRANSMIT request of MAX_DATA_LENGTH - 1 bytes");
+
+/**
+ * @brief Received frame waiting to be sent as an event.
+ */
+typedef struct {
+    uint16_t length;                    /**< Number of bytes */
+    uint8_t data[CTRL_MAX_PAYLOAD];     /**< Plaintext of the frame */
+} ctrl_notify_t;
+
+/** @brief Received frames waiting to be sent, created by the control task. */
+static QueueHandle_t ctrl_notify_queue = NULL;
+
+/** @brief Counters; each one has a single writer. */
+static volatile ctrl_stats_t ctrl_stats;
+
+/** @brief Sequence number of the next event. */
+static uint8_t ctrl_event_seq = 0;
+
+/** @brief Frame being reassembled from the UART, without its delimiter. */
+static uint8_t ctrl_rx_frame[CTRL_FRAME_MAX];
+
+/** @brief Frame being sent. */
+static uint8_t ctrl_tx_frame[CTRL_FRAME_MAX];
+
+/** @brief Payload of the response or event being built. */
+static uint8_t ctrl_tx_payload[CTRL_MAX_PAYLOAD];
+
+/** @brief Notification being sent. */
+static ctrl_notify_t ctrl_notify;
+
+/** @brief IDs of the jobs submitted by the host that have not been reported ended yet, 0 for a free entry. */
+static uint32_t ctrl_pending_jobs[JOB_MAX];
+
+/**
+ * @brief Frames and sends a packet.
+ *
+ * @param type Packet type.
+ * @param seq Sequence number.
+ * @param payload Payload.
+ * @param length Payload length, at most CTRL_MAX_PAYLOAD.
+ */
+static void ctrl_send(uint8_t type, uint8_t seq, const uint8_t* payload, size_t length) {
+    ctrl_packet_t packet = { .type = type, .seq = seq, .length = (uint16_t)length, .payload = payload };
+    size_t bytes = ctrl_frame_build(&packet, ctrl_tx_frame);
+    if (bytes == 0) {
+        return;
+    }
+    uart_write_bytes(CTRL_UART_NUM, ctrl_tx_frame, bytes);
+    ctrl_stats.tx_packets++;
+}
+
+/**
+ * @brief Sends the response of a request: its status, then the bytes already in ctrl_tx_payload after it.
+ *
+ * @param request The request.
+ * @param err Status of the request.
+ * @param length Bytes of ctrl_tx_payload after the status.
+ */
+static void ctrl_respond(const ctrl_packet_t* request, esp_err_t err, size_t length) {
+    ctrl_put_u32(ctrl_tx_payload, (uint32_t)err);
+    ctrl_send(request->type | CTRL_RESPONSE, request->seq, ctrl_tx_payload, 4 + length);
+}
+
+/**
+ * @brief Sends a CTRL_MSG_JOB_DONE event for every pending job that ended, and forgets it.
+ */
+static void ctrl_poll_jobs(void) {
+    uint8_t payload[CTRL_JOB_DONE_BYTES];
+    for (int i = 0; i < JOB_MAX; i++) {
+        if (ctrl_pending_jobs[i] == 0) {
+            continue;
+        }
+        console_job_info_t info;
+        esp_err_t err = console_job_wait(ctrl_pending_jobs[i], 0, &info);
+        if (err == ESP_ERR_TIMEOUT) {
+            continue;
+        }
+        if (err == ESP_OK) {
+            err = (info.result == 0) ? ESP_OK : ESP_FAIL;
+        }
+        ctrl_put_u32(payload, ctrl_pending_jobs[i]);
+        ctrl_put_u32(&payload[4], (uint32_t)err);
+        ctrl_send(CTRL_MSG_JOB_DONE, ctrl_event_seq++, payload, sizeof(payload));
+        ctrl_pending_jobs[i] = 0;
+    }
+}
+
+/**
+ * @brief Adds a job submitted by the host to the pending jobs.
+ *
+ * At most JOB_MAX jobs are queued or running, so once the ended ones are reported there is always a free entry.
+ *
+ * @param err Status of the submission; nothing is added if it failed.
+ * @param id ID of the job.
+ */
+static void ctrl_track_job(esp_err_t err, uint32_t id) {
+    if (err != ESP_OK) {
+        return;
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < JOB_MAX; i++) {
+            if (ctrl_pending_jobs[i] == 0) {
+                ctrl_pending_jobs[i] = id;
+                return;
+            }
+        }
+        ctrl_poll_jobs();
+    }
+    ESP_LOGW(CTRL_TAG, "Job %lu not tracked, no CTRL_MSG_JOB_DONE will follow", (unsigned long)id);
+}
+
+/**
+ * @brief Handles CTRL_MSG_CONFIGURE. The response holds the status and the u32 ID of the warm-up job, sent as
+ * soon as the job is queued.
+ *
+ * @param request The request.
+ */
+static void ctrl_handle_configure(const ctrl_packet_t* request) {
+    ctrl_configure_t configure;
+    uint32_t id = 0;
+    esp_err_t err;
+    if (!ctrl_configure_read(request->payload, request->length, &configure)) {
+        err = ESP_ERR_INVALID_SIZE;
+    } else if (configure.map > MAP_2D_LOGISTIC) {
+        err = ESP_ERR_INVALID_ARG;
+    } else {
+        chaotic_map_t map1 = { configure.x1, configure.y1, configure.iterations1 };
+        chaotic_map_t map2 = { configure.x2, configure.y2, configure.iterations2 };
+        err = console_set_encryption(configure.rx != 0, (map_type_t)configure.map, &map1, &map2, &id);
+    }
+    ctrl_respond(request, err, ctrl_put_u32(&ctrl_tx_payload[4], id));
+    ctrl_track_job(err, id);
+}
+
+/**
+ * @brief Handles CTRL_MSG_TRANSMIT. The response holds the status and the u32 ID of the transmit job, sent as
+ * soon as the job is queued.
+ *
+ * @param request The request.
+ */
+static void ctrl_handle_transmit(const ctrl_packet_t* request) {
+    uint32_t id = 0;
+    esp_err_t err = console_transmit((const char*)request->payload, request->length, &id);
+    ctrl_respond(request, err, ctrl_put_u32(&ctrl_tx_payload[4], id));
+    ctrl_track_job(err, id);
+}
+
+/**
+ * @brief Handles CTRL_MSG_STATS. After the status, the response holds as u32: the tx_words, tx_rejected,
+ * rx_words, rx_dropped, rx_false_starts, rx_framing_errors and bit_period_micros of the active PHY; the frames,
+ * rejected and invalid_headers of the RX frame counters; and the rx_packets, tx_packets, cobs_errors,
+ * length_errors, crc_errors, notifications and notify_dropped of the channel.
+ *
+ * @param request The request.
+ */
+static void ctrl_handle_stats(const ctrl_packet_t* request) {
+    vlc_phy_stats_t phy_stats;
+    rx_frame_stats_t frame_stats;
+    ctrl_stats_t stats;
+    phy_active()->get_stats(&phy_stats);
+    rx_get_frame_stats(&frame_stats);
+    ctrl_get_stats(&stats);
+
+    const uint32_t values[] = {
+        phy_stats.tx_words, phy_stats.tx_rejected, phy_stats.rx_words, phy_stats.rx_dropped,
+        phy_stats.rx_false_starts, phy_stats.rx_framing_errors, phy_stats.bit_period_micros,
+        frame_stats.frames, frame_stats.rejected, frame_stats.invalid_headers,
+        stats.rx_packets, stats.tx_packets, stats.cobs_errors, stats.length_errors, stats.crc_errors,
+        stats.notifications, stats.notify_dropped,
+    };
+    size_t length = 0;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        length += ctrl_put_u32(&ctrl_tx_payload[4 + length], values[i]);
+    }
+    ctrl_respond(request, ESP_OK, length);
+}
+
+/**
+ * @brief Handles a valid request.
+ *
+ * @param request The request.
+ */
+static void ctrl_dispatch(const ctrl_packet_t* request) {
+    switch (request->type) {
+        case CTRL_MSG_PING:
+            if (request->length > CTRL_MAX_PAYLOAD - 4) {
+                ctrl_respond(request, ESP_ERR_INVALID_SIZE, 0);
+            } else {
+                memcpy(&ctrl_tx_payload[4], request->payload, request->length);
+                ctrl_respond(request, ESP_OK, request->length);
+            }
+            break;
+        case CTRL_MSG_CONFIGURE:
+            ctrl_handle_configure(request);
+            break;
+        case CTRL_MSG_TRANSMIT:
+            ctrl_handle_transmit(request);
+            break;
+        case CTRL_MSG_STATS:
+            ctrl_handle_stats(request);
+            break;
+        case CTRL_MSG_SUBSCRIBE:
+            if (request->length != 1) {
+                ctrl_respond(request, ESP_ERR_INVALID_SIZE, 0);
+            } else {
+                ctrl_stats.subscribed = request->payload[0] != 0;
+                ctrl_respond(request, ESP_OK, 0);
+            }
+            break;
+        default:
+            // Responses and events are never requests, so they get no answer
+            if (!(request->type & CTRL_RESPONSE) && request->type != CTRL_MSG_RX_NOTIFY && request->type != CTRL_MSG_JOB_DONE) {
+                ctrl_respond(request, ESP_ERR_NOT_SUPPORTED, 0);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Checks a complete frame and handles its packet.
+ *
+ * @param length Bytes of ctrl_rx_frame.
+ */
+static void ctrl_process_frame(size_t length) {
+    ctrl_packet_t packet;
+    switch (ctrl_frame_parse(ctrl_rx_frame, length, &packet)) {
+        case 0:
+            ctrl_stats.rx_packets++;
+            ctrl_dispatch(&packet);
+            break;
+        case -1:
+            ctrl_stats.cobs_errors++;
+            break;
+        case -2:
+            ctrl_stats.length_errors++;
+            break;
+        default:
+            ctrl_stats.crc_errors++;
+            break;
+    }
+}
+
+/**
+ * @brief Sends the queued receive notifications.
+ */
+static void ctrl_send_notifications(void) {
+    while (xQueueReceive(ctrl_notify_queue, &ctrl_notify, 0) == pdTRUE) {
+        if (ctrl_stats.subscribed) {
+            ctrl_send(CTRL_MSG_RX_NOTIFY, ctrl_event_seq++, ctrl_notify.data, ctrl_notify.length);
+            ctrl_stats.notifications++;
+        }
+    }
+}
+
+void ctrl_task(void *pvParameters) {
+    trace_register_task(TRACE_TASK_CTRL);
+    const uart_config_t uart_config = {
+        .baud_rate = CTRL_UART_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    ctrl_notify_queue = xQueueCreate(CTRL_NOTIFY_QUEUE_SIZE, sizeof(ctrl_notify_t));
+    if (ctrl_notify_queue == NULL ||
+        uart_driver_install(CTRL_UART_NUM, CTRL_UART_BUFFER_BYTES, CTRL_UART_BUFFER_BYTES, 0, NULL, 0) != ESP_OK ||
+        uart_param_config(CTRL_UART_NUM, &uart_config) != ESP_OK ||
+        uart_set_pin(CTRL_UART_NUM, CTRL_UART_TX_GPIO, CTRL_UART_RX_GPIO, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+        ESP_LOGE(CTRL_TAG, "Could not start the control channel on UART%d", (int)CTRL_UART_NUM);
+        vTaskDelete(NULL);
+        return;
+    }
+    trace_register_queue(ctrl_notify_queue, TRACE_QUEUE_CTRL_NOTIFY);
+    ESP_LOGI(CTRL_TAG, "Control channel on UART%d (TX GPIO %d, RX GPIO %d) at %d baud",
+             (int)CTRL_UART_NUM, (int)CTRL_UART_TX_GPIO, (int)CTRL_UART_RX_GPIO, CTRL_UART_BAUD);
+
+    uint8_t bytes[128];
+    size_t length = 0;
+    bool overflow = false;
+    while (1) {
+        int count = uart_read_bytes(CTRL_UART_NUM, bytes, sizeof(bytes), pdMS_TO_TICKS(CTRL_POLL_MS));
+        for (int i = 0; i < count; i++) {
+            if (bytes[i] != 0) {
+                if (length < sizeof(ctrl_rx_frame)) {
+                    ctrl_rx_frame[length++] = bytes[i];
+                } else {
+                    overflow = true;
+                }
+                continue;
+            }
+            // Delimiter: an overlong frame is dropped whole, empty frames are ignored
+            if (overflow) {
+                ctrl_stats.cobs_errors++;
+            } else if (length > 0) {
+                ctrl_process_frame(length);
+            }
+            length = 0;
+            overflow = false;
+        }
+        ctrl_poll_jobs();
+        ctrl_send_notifications();
+    }
+}
+
+void ctrl_notify_received(const char* data, size_t length) {
+    // Only the RX decode task calls this, so one staging entry off its stack is enough
+    static ctrl_notify_t entry;
+    if (ctrl_notify_queue == NULL || !ctrl_stats.subscribed) {
+        return;
+    }
+    entry.length = (uint16_t)(length < CTRL_MAX_PAYLOAD ? length : CTRL_MAX_PAYLOAD);
+    memcpy(entry.data, data, entry.length);
+    if (xQueueSend(ctrl_notify_queue, &entry, 0) != pdTRUE) {
+        ctrl_stats.notify_dropped++;
+    }
+}
+
+void ctrl_get_stats(ctrl_stats_t* stats) {
+    *stats = ctrl_stats;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file ctrl_server.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the binary host-control channel for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the server of the binary control channel, which runs on its own UART
+ * (CTRL_UART_NUM) so a host program can drive the link without parsing the console: the REPL owns the input of
+ * the console port, so the two cannot share it. The packets are described in ctrl_proto.h.
+ *
+ * CONFIGURE and TRANSMIT go through the same console jobs as the set_encryption and transmit commands, so
+ * requests from both sides are serialised on the link. Their response is sent as soon as the job is queued,
+ * with its ID, so the channel keeps serving requests while it runs; the control task checks the jobs on every
+ * pass of its loop and sends a CTRL_MSG_JOB_DONE event with the result of each one that ended. Received
+ * frames are queued by the RX decode task without blocking and sent as CTRL_MSG_RX_NOTIFY events while the
+ * host is subscribed.
+ */
+
+#ifndef CTRL_SERVER_H
+#define CTRL_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#include "common_utils/config.h"
+
+/**
+ * @brief Counters of the control channel.
+ */
+typedef struct {
+    uint32_t rx_packets;        /**< Valid packets received */
+    uint32_t tx_packets;        /**< Packets sent, responses and events */
+    uint32_t cobs_errors;       /**< Frames dropped for a COBS error or an overflow */
+    uint32_t length_errors;     /**< Frames dropped for a length mismatch */
+    uint32_t crc_errors;        /**< Frames dropped for a CRC mismatch */
+    uint32_t notifications;     /**< Received frames sent as events */
+    uint32_t notify_dropped;    /**< Received frames dropped with the notification queue full */
+    bool subscribed;            /**< The host receives the received frames */
+} ctrl_stats_t;
+
+/**
+ * @brief Control task: installs the UART driver, then parses the requests and sends the responses and events.
+ *
+ * @param pvParameters Pointer to task parameters (unused).
+ */
+void ctrl_task(void *pvParameters);
+
+/**
+ * @brief Queues a received frame for the host. Called by the RX decode task; never blocks.
+ *
+ * @param data Plaintext of the frame.
+ * @param length Number of bytes, truncated to CTRL_MAX_PAYLOAD.
+ */
+void ctrl_notify_received(const char* data, size_t length);
+
+/**
+ * @brief Reads the counters.
+ *
+ * @param stats Pointer to store the counters.
+ */
+void ctrl_get_stats(ctrl_stats_t* stats);
+
+#endif /* CTRL_SERVER_H */
@@ -0,0 +1,324 @@
+/**
+ * @file vlc_link.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of independent link instances for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the extra links. The hardware of a link is set up and
+ * freed by its own task, so the dedicated GPIO bundles and the timer interrupts end up on the core of the link.
+ */
+
+#include "vlc_link.h"
+
+/** @brief Tag for logging link messages */
+static const char *LINK_TAG = "LINK";
+
+/** @brief TX pins of the links, the console link first. */
+static const int link_tx_gpios[VLC_LINK_MAX] = VLC_LINK_TX_GPIO_PINS;
+
+/** @brief RX pins of the links, the console link first. */
+static const int link_rx_gpios[VLC_LINK_MAX] = VLC_LINK_RX_GPIO_PINS;
+
+esp_err_t vlc_link_default_config(uint8_t id, vlc_link_config_t* config) {
+    if (id == 0 || id >= VLC_LINK_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    config->tx_gpio = link_tx_gpios[id];
+    config->rx_gpio = link_rx_gpios[id];
+    config->core = id % portNUM_PROCESSORS;
+    config->bit_period_micros = TX_PERIOD_MICROS;
+    return ESP_OK;
+}
+
+/**
+ * @brief Frees the hardware of a link. Called by the task of the link.
+ *
+ * @param link Pointer to the link state.
+ */
+static void vlc_link_teardown(vlc_link_t* link) {
+    phy_gptimer_ctx_deinit(&link->phy);
+    phy_pins_release_link(&link->pins);
+}
+
+/**
+ * @brief Sets up the hardware of a link. Called by the task of the link.
+ *
+ * @param link Pointer to the link state.
+ * @return ESP_OK on success, or the first error met.
+ */
+static esp_err_t vlc_link_setup(vlc_link_t* link) {
+    esp_err_t err = phy_pins_setup_link(&link->pins);
+    if (err != ESP_OK) {
+        return err;
+    }
+    link->phy.tx_mask = link->pins.tx_mask;
+    link->phy.rx_shift = link->pins.rx_shift;
+    err = phy_gptimer_ctx_init(&link->phy, PHY_ROLE_TX);
+    if (err == ESP_OK) {
+        err = phy_gptimer_ctx_init(&link->phy, PHY_ROLE_RX);
+    }
+    if (err != ESP_OK) {
+        vlc_link_teardown(link);
+        return err;
+    }
+    phy_gptimer_ctx_enable(&link->phy, true);
+    return ESP_OK;
+}
+
+/**
+ * @brief Assembles a received word and opens every complete frame.
+ *
+ * @param link Pointer to the link state.
+ * @param word The received word.
+ * @param payload Array of FRAME_MAX_PAYLOAD_WORDS words for the plaintext.
+ */
+static void vlc_link_receive(vlc_link_t* link, uint32_t word, uint32_t* payload) {
+    frame_assembler_status_t status = frame_assembler_push(&link->assembler, &link->rx_vars, word);
+    if (status == FRAME_ASSEMBLER_INVALID_HEADER) {
+        link->stats.frames_rejected++;
+    } else if (status == FRAME_ASSEMBLER_COMPLETE) {
+        if (frame_open(&link->assembler, &link->rx_vars, payload)) {
+            link->stats.frames_received++;
+            link->stats.bytes_received += link->assembler.payload_words * sizeof(uint32_t);
+        } else {
+            link->stats.frames_rejected++;
+        }
+    }
+}
+
+/**
+ * @brief Task of a link.
+ *
+ * Sets up the hardware on its core, reports the result, then keeps the TX side busy and drains the RX side
+ * until the link is stopped.
+ *
+ * @param pvParameters Pointer to the vlc_link_t.
+ */
+static void vlc_link_task(void *pvParameters) {
+    vlc_link_t* link = (vlc_link_t*)pvParameters;
+    uint32_t words[BUFFER_MAX_SIZE];
+    uint32_t payload[FRAME_MAX_PAYLOAD_WORDS];
+
+    link->start_error = vlc_link_setup(link);
+    xSemaphoreGive(link->done);
+    if (link->start_error != ESP_OK) {
+        vTaskDelete(NULL);
+        return;
+    }
+
+    while (link->running) {
+        phy_gptimer_ctx_service(&link->phy);
+        size_t count = phy_gptimer_ctx_poll(&link->phy, words, BUFFER_MAX_SIZE);
+        for (size_t i = 0; i < count; i++) {
+            vlc_link_receive(link, words[i], payload);
+        }
+        if (count == 0) {
+            vTaskDelay(1);
+        }
+    }
+
+    vlc_link_teardown(link);
+    xSemaphoreGive(link->done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t vlc_link_start(vlc_link_t* link, uint8_t id, const vlc_link_config_t* config,
+                         const encryption_vars_t* tx_keys, const encryption_vars_t* rx_keys) {
+    memset(link, 0, sizeof(*link));
+    link->id = id;
+    link->config = *config;
+    link->pins.tx_gpio = config->tx_gpio;
+    link->pins.rx_gpio = config->rx_gpio;
+
+    portMUX_INITIALIZE(&link->phy.lock);
+    link->phy.rx_gpios = &link->pins.rx_gpio;
+    link->phy.rx_branches = 1;
+    link->phy.chain_words = true;
+    link->phy.bit_period_micros = config->bit_period_micros;
+    link->phy.sample_offset_micros = config->bit_period_micros / 2;
+    link->phy.stats.bit_period_micros = config->bit_period_micros;
+    rx_diversity_init(&link->diversity, 1, RX_DIVERSITY_OFF);
+    link->phy.diversity = &link->diversity;
+
+    key_generator_clone(&link->tx_vars, &link->tx_msws32, tx_keys);
+    key_generator_clone(&link->rx_vars, &link->rx_msws32, rx_keys);
+    frame_assembler_reset(&link->assembler);
+
+    link->done = xSemaphoreCreateBinary();
+    if (link->done == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    // Without power management there is nothing to hold
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "vlc_link", &link->pm_lock) != ESP_OK) {
+        link->pm_lock = NULL;
+    }
+    if (link->pm_lock != NULL) {
+        esp_pm_lock_acquire(link->pm_lock);
+    }
+
+    link->running = true;
+    esp_err_t err = ESP_OK;
+    if (xTaskCreatePinnedToCore(vlc_link_task, "VLC Link", VLC_LINK_STACK_SIZE, link, 1, &link->task, config->core) != pdPASS) {
+        err = ESP_ERR_NO_MEM;
+    } else {
+        xSemaphoreTake(link->done, portMAX_DELAY);
+        err = link->start_error;
+    }
+    if (err != ESP_OK) {
+        link->running = false;
+        if (link->pm_lock != NULL) {
+            esp_pm_lock_release(link->pm_lock);
+            esp_pm_lock_delete(link->pm_lock);
+            link->pm_lock = NULL;
+        }
+        vSemaphoreDelete(link->done);
+        link->done = NULL;
+        ESP_LOGE(LINK_TAG, "Link %u failed to start: %s", (unsigned)id, esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(LINK_TAG, "Link %u started on core %d, TX %d, RX %d, %lu us", (unsigned)id, (int)config->core,
+             config->tx_gpio, config->rx_gpio, (unsigned long)config->bit_period_micros);
+    return ESP_OK;
+}
+
+void vlc_link_stop(vlc_link_t* link) {
+    if (!link->running) {
+        return;
+    }
+    link->running = false;
+    xSemaphoreTake(link->done, portMAX_DELAY);
+    vSemaphoreDelete(link->done);
+    link->done = NULL;
+    if (link->pm_lock != NULL) {
+        esp_pm_lock_release(link->pm_lock);
+        esp_pm_lock_delete(link->pm_lock);
+        link->pm_lock = NULL;
+    }
+    ESP_LOGI(LINK_TAG, "Link %u stopped", (unsigned)link->id);
+}
+
+esp_err_t vlc_link_send(vlc_link_t* link, const char* str) {
+    uint32_t frame[FRAME_MAX_WORDS];
+    if (!link->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (strlen(str) > FRAME_MAX_PAYLOAD_WORDS * 4) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    encryption_vars_t snapshot;
+    msws32_var_t snapshot_msws32;
+    key_generator_clone(&snapshot, &snapshot_msws32, &link->tx_vars);
+
+    size_t count = frame_build(&link->tx_vars, str, FRAME_AUTH_ENABLE, frame);
+    esp_err_t err = (count == 0) ? ESP_FAIL : phy_gptimer_ctx_submit(&link->phy, frame, count);
+    if (err != ESP_OK) {
+        key_generator_clone(&link->tx_vars, &link->tx_msws32, &snapshot);
+        if (err == ESP_ERR_NO_MEM) {
+            link->stats.frames_dropped++;
+        }
+        return err;
+    }
+    link->stats.frames_sent++;
+    return ESP_OK;
+}
+
+bool vlc_link_tx_idle(const vlc_link_t* link) {
+    return !link->phy.in_transmission && (link->phy.ring_tx == NULL || ringBufferIsEmpty(link->phy.ring_tx));
+}
+
+void vlc_link_get_stats(const vlc_link_t* link, vlc_link_stats_t* stats) {
+    *stats = *(const vlc_link_stats_t*)&link->stats;
+    stats->phy = *(const vlc_phy_stats_t*)&link->phy.stats;
+    stats->phy.rx_queued = spsc_queue_count(&link->phy.rx_queue);
+}
+
+/**
+ * @brief Runs a number of extra links for a while and prints one CSV row.
+ *
+ * @param links Array of at least count link states.
+ * @param count Number of links.
+ * @param seconds Duration of the run.
+ * @param keys Keystream of the links.
+ * @param out Stream to print the CSV to.
+ * @return ESP_OK on success, or the error of the first link that could not start.
+ */
+static esp_err_t vlc_link_benchmark_run(vlc_link_t* links, uint32_t count, uint32_t seconds,
+                                        const encryption_vars_t* keys, FILE* out) {
+    char payload[FRAME_MAX_PAYLOAD_WORDS * 4 + 1];
+    esp_err_t err = ESP_OK;
+    uint32_t started = 0;
+    for (uint32_t k = 0; k < count && err == ESP_OK; k++) {
+        vlc_link_config_t config;
+        vlc_link_default_config(k + 1, &config);
+        err = vlc_link_start(&links[k], k + 1, &config, keys, keys);
+        if (err == ESP_OK) {
+            started++;
+        }
+    }
+
+    if (err == ESP_OK) {
+        int64_t start = esp_timer_get_time();
+        int64_t end = start + (int64_t)seconds * 1000000;
+        while (esp_timer_get_time() < end) {
+            bool queued = false;
+            for (uint32_t k = 0; k < count; k++) {
+                memset(payload, 'A' + k, sizeof(payload) - 1);
+                payload[sizeof(payload) - 1] = '\0';
+                queued |= (vlc_link_send(&links[k], payload) == ESP_OK);
+            }
+            if (!queued) {
+                vTaskDelay(1);
+            }
+        }
+        // Let the frames in flight arrive
+        for (uint32_t k = 0; k < count; k++) {
+            while (!vlc_link_tx_idle(&links[k]) && esp_timer_get_time() < end + 1000000) {
+                vTaskDelay(1);
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+        int64_t elapsed = esp_timer_get_time() - start;
+
+        uint32_t sent = 0, received = 0, rejected = 0, words = 0;
+        uint64_t bytes = 0;
+        for (uint32_t k = 0; k < count; k++) {
+            vlc_link_stats_t stats;
+            vlc_link_get_stats(&links[k], &stats);
+            sent += stats.frames_sent;
+            received += stats.frames_received;
+            rejected += stats.frames_rejected;
+            bytes += stats.bytes_received;
+            words += stats.phy.rx_words;
+        }
+        double goodput = bytes * 8e6 / (double)elapsed;
+        fprintf(out, "%lu,%lu,%lu,%lu,%lu,%lu,%llu,%.1f,%.1f\n", (unsigned long)count, (unsigned long)seconds,
+                (unsigned long)sent, (unsigned long)received, (unsigned long)rejected, (unsigned long)words,
+                (unsigned long long)bytes, goodput, goodput / count);
+        fflush(out);
+    }
+
+    for (uint32_t k = 0; k < started; k++) {
+        vlc_link_stop(&links[k]);
+    }
+    return err;
+}
+
+esp_err_t vlc_link_benchmark(uint32_t max_links, uint32_t seconds, const encryption_vars_t* keys, FILE* out) {
+    if (max_links == 0 || max_links >= VLC_LINK_MAX || seconds == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    vlc_link_t* links = calloc(max_links, sizeof(vlc_link_t));
+    if (links == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = ESP_OK;
+    fprintf(out, "links,seconds,frames_sent,frames_received,frames_rejected,rx_words,bytes,goodput_bps,per_link_bps\n");
+    for (uint32_t n = 1; n <= max_links && err == ESP_OK; n++) {
+        err = vlc_link_benchmark_run(links, n, seconds, keys, out);
+    }
+    free(links);
+    return err;
+}
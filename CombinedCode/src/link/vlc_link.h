@@ -0,0 +1,168 @@
+/**
+ * @file vlc_link.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for independent link instances for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the extra links of the board. A vlc_link_t owns everything
+ * a link needs: its TX and RX pins and their dedicated GPIO bundles, an instance of the gptimer backend with its
+ * two timers and ring buffers, the keystreams of both directions, its frame assembler and a task pinned to its
+ * core, which sends the queued words back to back and assembles, authenticates and decrypts what it receives.
+ * Nothing is shared between links, so they run next to each other; as each takes two of the four general-purpose
+ * timers, VLC_LINK_MAX allows one extra link next to the console link.
+ *
+ * The console link, driven by the TX and RX tasks through the active PHY, is link 0 and is not a vlc_link_t.
+ * The extra links are numbered from 1 and use the pins of VLC_LINK_TX_GPIO_PINS and VLC_LINK_RX_GPIO_PINS.
+ * A running link holds a power management lock, so the board does not light-sleep under it.
+ */
+
+#ifndef VLC_LINK_H
+#define VLC_LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "common_utils/config.h"
+#include "common_utils/encryption.h"
+#include "common_utils/frame.h"
+#include "phy/phy.h"
+#include "phy/phy_gptimer.h"
+#include "phy/phy_pins.h"
+#include "reception/RX_diversity.h"
+
+/**
+ * @brief Settings of a link.
+ */
+typedef struct {
+    int tx_gpio;                    /**< TX pin */
+    int rx_gpio;                    /**< RX pin */
+    BaseType_t core;                /**< Core running the task, the ISRs and the dedicated GPIO bundles of the link */
+    uint32_t bit_period_micros;     /**< Bit period of both directions */
+} vlc_link_config_t;
+
+/**
+ * @brief Counters of a link.
+ */
+typedef struct {
+    uint32_t frames_sent;           /**< Frames queued for transmission */
+    uint32_t frames_dropped;        /**< Frames refused because the TX queue was full */
+    uint32_t frames_received;       /**< Frames received, authenticated and decrypted */
+    uint32_t frames_rejected;       /**< Frames with an invalid header or tag */
+    uint64_t bytes_received;        /**< Payload bytes of the frames received */
+    vlc_phy_stats_t phy;            /**< Counters of the gptimer instance */
+} vlc_link_stats_t;
+
+/**
+ * @brief State of a link.
+ */
+typedef struct {
+    uint8_t id;                                 /**< Number of the link, from 1 */
+    vlc_link_config_t config;                   /**< Settings */
+    phy_pins_link_t pins;                       /**< Pins and dedicated GPIO bundles */
+    phy_gptimer_ctx_t phy;                      /**< Instance of the gptimer backend */
+    rx_diversity_t diversity;                   /**< Single-branch combiner of the RX pin */
+    encryption_vars_t tx_vars;                  /**< Keystream of the frames sent */
+    msws32_var_t tx_msws32;                     /**< Generator state of tx_vars */
+    encryption_vars_t rx_vars;                  /**< Keystream of the frames received */
+    msws32_var_t rx_msws32;                     /**< Generator state of rx_vars */
+    frame_assembler_t assembler;                /**< Frame being received */
+    esp_pm_lock_handle_t pm_lock;               /**< Keeps the board awake while the link runs */
+    TaskHandle_t task;                          /**< Task of the link */
+    SemaphoreHandle_t done;                     /**< Given by the task once started and once stopped */
+    esp_err_t start_error;                      /**< Result of the setup made by the task */
+    volatile bool running;                      /**< Cleared to stop the task */
+    volatile vlc_link_stats_t stats;            /**< Counters, the PHY counters excepted */
+} vlc_link_t;
+
+/**
+ * @brief Fills the default settings of an extra link: the pins of its index and a core of its own.
+ *
+ * @param id Number of the link, from 1 to VLC_LINK_MAX - 1.
+ * @param config Pointer to store the settings.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an invalid number.
+ */
+esp_err_t vlc_link_default_config(uint8_t id, vlc_link_config_t* config);
+
+/**
+ * @brief Starts a link, blocking until its task has set up the hardware.
+ *
+ * The keystreams are copies, so the link does not advance the ones passed in.
+ *
+ * @param link Pointer to the link state, owned by the caller until vlc_link_stop().
+ * @param id Number of the link.
+ * @param config Settings of the link.
+ * @param tx_keys Keystream the frames sent are encrypted with.
+ * @param rx_keys Keystream the frames received are decrypted with.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task or its resources could not be created,
+ *         ESP_ERR_NOT_FOUND if no timer or dedicated GPIO channel is free.
+ */
+esp_err_t vlc_link_start(vlc_link_t* link, uint8_t id, const vlc_link_config_t* config,
+                         const encryption_vars_t* tx_keys, const encryption_vars_t* rx_keys);
+
+/**
+ * @brief Stops a link and frees its hardware, blocking until its task has exited.
+ *
+ * Words still queued are dropped.
+ *
+ * @param link Pointer to the link state.
+ */
+void vlc_link_stop(vlc_link_t* link);
+
+/**
+ * @brief Encrypts a string into one frame and queues it on a link.
+ *
+ * Not safe against other senders of the same link. The keystream is left untouched if the frame is not queued.
+ *
+ * @param link Pointer to the link state.
+ * @param str The string to send.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the link is not running, ESP_ERR_INVALID_SIZE if the
+ *         string does not fit in one frame, ESP_ERR_NO_MEM if the TX queue is full.
+ */
+esp_err_t vlc_link_send(vlc_link_t* link, const char* str);
+
+/**
+ * @brief Checks whether the words sent on a link have all left.
+ *
+ * @param link Pointer to the link state.
+ * @return true if the TX queue is empty and no word is being sent.
+ */
+bool vlc_link_tx_idle(const vlc_link_t* link);
+
+/**
+ * @brief Reads the counters of a link.
+ *
+ * @param link Pointer to the link state.
+ * @param stats Pointer to store the counters.
+ */
+void vlc_link_get_stats(const vlc_link_t* link, vlc_link_stats_t* stats);
+
+/**
+ * @brief Runs 1 to max_links extra links at once and prints their aggregate goodput for each count as CSV.
+ *
+ * Each link sends frames of the longest payload as fast as its TX queue takes them, and must have its TX pin
+ * wired to its own RX pin. Both directions use copies of the same keystream. The sweep ends early at the first
+ * link that cannot start, e.g. for want of a timer.
+ *
+ * @param max_links Largest number of extra links, at most VLC_LINK_MAX - 1.
+ * @param seconds Duration of each run.
+ * @param keys Keystream of the links.
+ * @param out Stream to print the CSV to.
+ * @return ESP_OK if every count was run, or the error of the first link that could not start.
+ */
+esp_err_t vlc_link_benchmark(uint32_t max_links, uint32_t seconds, const encryption_vars_t* keys, FILE* out);
+
+#endif /* VLC_LINK_H */
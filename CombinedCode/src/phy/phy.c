@@ -0,0 +1,107 @@
+/**
+ * @file phy.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the PHY driver registry for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the table of PHY backends, the selection of the active one and the loop
+ * running their rx_service operation in the RX task.
+ */
+
+#include "phy.h"
+#include "common_utils/power.h"
+#include "reception/RX_loop.h"
+#include "phy_gptimer.h"
+#include "phy_edge.h"
+#include "phy_loopback.h"
+#include "phy_sync.h"
+#include "phy_adc.h"
+#include "phy_rmt.h"
+
+/** @brief Tag for logging PHY messages */
+static const char *PHY_TAG = "PHY";
+
+/** @brief Registered backends, the first one is active at boot. */
+static const vlc_phy_ops_t* const phy_backends[] = {
+    &phy_gptimer_ops,
+    &phy_edge_ops,
+    &phy_sync_ops,
+    &phy_adc_ops,
+    &phy_rmt_ops,
+    &phy_loopback_ops,
+};
+
+/** @brief Number of registered backends. */
+#define PHY_BACKEND_COUNT (sizeof(phy_backends) / sizeof(phy_backends[0]))
+
+/** @brief Active backend. */
+static const vlc_phy_ops_t* volatile phy_current = NULL;
+
+/** @brief Task running phy_rx_service_loop(). */
+static TaskHandle_t phy_rx_service_task = NULL;
+
+const vlc_phy_ops_t* phy_active(void) {
+    return phy_current != NULL ? phy_current : phy_backends[0];
+}
+
+esp_err_t phy_select(const char* name) {
+    for (size_t i = 0; i < PHY_BACKEND_COUNT; i++) {
+        if (strcmp(phy_backends[i]->name, name) == 0) {
+            const vlc_phy_ops_t* previous = phy_active();
+            if (previous != phy_backends[i]) {
+                power_rx_resume();
+                if (previous->enable != NULL) previous->enable(false);
+                if (phy_backends[i]->enable != NULL) phy_backends[i]->enable(true);
+            }
+            phy_current = phy_backends[i];
+            phy_rx_service_request();
+            // The RX task may be blocked on the previous backend until its next word
+            rx_loop_wake();
+            ESP_LOGI(PHY_TAG, "Active PHY: %s", name);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+const vlc_phy_ops_t* phy_get(size_t index) {
+    return index < PHY_BACKEND_COUNT ? phy_backends[index] : NULL;
+}
+
+esp_err_t phy_init_all(phy_role_t role) {
+    esp_err_t first_err = ESP_OK;
+    for (size_t i = 0; i < PHY_BACKEND_COUNT; i++) {
+        esp_err_t err = phy_backends[i]->init(role);
+        if (err != ESP_OK) {
+            ESP_LOGE(PHY_TAG, "Failed to initialise %s %s side: %s", phy_backends[i]->name,
+                     role == PHY_ROLE_TX ? "TX" : "RX", esp_err_to_name(err));
+            if (first_err == ESP_OK) {
+                first_err = err;
+            }
+        }
+    }
+    if (role == PHY_ROLE_RX && phy_active()->enable != NULL) {
+        phy_active()->enable(true);
+    }
+    return first_err;
+}
+
+void phy_rx_service_loop(void) {
+    phy_rx_service_task = xTaskGetCurrentTaskHandle();
+    while (1) {
+        const vlc_phy_ops_t* phy = phy_active();
+        if (phy->rx_service != NULL) {
+            phy->rx_service();
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void phy_rx_service_request(void) {
+    if (phy_rx_service_task != NULL) {
+        xTaskNotifyGive(phy_rx_service_task);
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ * @file phy.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the PHY driver interface for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the PHY driver interface. A PHY moves encrypted
+ * words between the framing layer and the medium; framing, encryption and authentication stay above it.
+ * Backends are registered in a static table and one of them is active at a time, selectable at runtime.
+ *
+ * Available backends:
+ * - "gptimer": OOK on the TX and RX pins, timed by gptimer ISRs (the original implementation);
+ * - "sync": sync-word frames sent as a continuous bit stream on the same pins, see RX_sync.h;
+ * - "adc": the same sync-word frames received from the analog photodiode output through the ADC, see phy_adc.h;
+ * - "rmt": the same sync-word frames sent by the RMT peripheral with pre-emphasis, see phy_rmt.h;
+ * - "loopback": words submitted for transmission are received back without touching the pins.
+ *
+ * Backends sharing the pins only listen while they are active.
+ *
+ * The RX side is a pipeline across both cores: the RX ISRs run on RX_TASK_CORE and queue the words, and the RX
+ * decode task polls them from the other core, RX_DECODE_TASK_CORE. Hardware a backend only starts once active is started by the RX task, through
+ * rx_service, so its interrupts stay on RX_TASK_CORE too.
+ */
+
+#ifndef PHY_H
+#define PHY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+#include "common_utils/config.h"
+
+/**
+ * @brief Side of the link a PHY is initialised for.
+ *
+ * Each side is initialised from the task that uses it, so hardware bound to a core
+ * (dedicated GPIO bundles, GPIO ISRs) ends up on the right one.
+ */
+typedef enum {
+    PHY_ROLE_TX,
+    PHY_ROLE_RX,
+} phy_role_t;
+
+/**
+ * @brief Counters kept by every PHY backend.
+ */
+typedef struct {
+    uint32_t tx_words;          /**< Words handed to the medium */
+    uint32_t tx_rejected;       /**< Words refused because the TX queue was full */
+    uint32_t tx_interrupts;     /**< TX timer interrupts, 0 for backends without a TX timer */
+    uint32_t rx_interrupts;     /**< RX pin and RX timer interrupts, 0 for backends receiving without interrupts */
+    uint32_t rx_words;          /**< Words received from the medium */
+    uint32_t rx_dropped;        /**< Words lost because the RX queue was full */
+    uint32_t rx_queued;         /**< Entries waiting in the RX queue when read: words, or edges for the edge backend */
+    uint32_t rx_queue_peak;     /**< Most entries seen waiting in the RX queue */
+    uint32_t rx_isr_cycles;     /**< CPU cycles spent in the RX interrupts, wrapping; 0 for backends receiving without interrupts */
+    uint32_t rx_false_starts;   /**< Start edges rejected as noise */
+    uint32_t rx_framing_errors; /**< Words rejected because of an invalid stop bit, or frames because of an invalid length */
+    uint32_t rx_syncs;          /**< Sync patterns detected */
+    uint32_t bit_period_micros; /**< Current bit period */
+} vlc_phy_stats_t;
+
+/**
+ * @brief Operations implemented by a PHY backend.
+ *
+ * Every operation except tx_service, rx_service, enable and set_sample_offset is mandatory.
+ */
+typedef struct {
+    const char* name;                                                    /**< Name used to select the backend */
+    bool rx_wake_on_edge;                                                /**< RX needs the CPU only from a falling edge on the RX pins on, so the device may light-sleep between frames */
+    bool rx_notifies;                                                    /**< Every received word wakes the RX task through rx_loop_notify(), so it may block until then */
+    esp_err_t (*init)(phy_role_t role);                                  /**< Initialises one side of the backend */
+    esp_err_t (*tx_submit_frame)(const uint32_t* words, size_t count);   /**< Queues a whole frame, or nothing */
+    void (*tx_service)(void);                                            /**< Drives queued transmissions, called periodically by the TX task */
+    void (*rx_service)(void);                                            /**< Starts RX hardware whose interrupts must run on RX_TASK_CORE, called by the RX task on request */
+    size_t (*rx_poll_frames)(uint32_t* words, size_t max_words);         /**< Pops received words, returns how many */
+    esp_err_t (*set_rate)(uint32_t bit_period_micros);                   /**< Changes the bit period while idle */
+    void (*enable)(bool enable);                                         /**< Starts or stops listening when the backend becomes active or inactive */
+    esp_err_t (*set_sample_offset)(uint32_t offset_micros);              /**< Moves the sampling instant relative to the start edge, for backends sampling from it */
+    void (*get_stats)(vlc_phy_stats_t* stats);                           /**< Reads the counters */
+} vlc_phy_ops_t;
+
+/**
+ * @brief Gets the active PHY backend.
+ * @return Pointer to the operations of the active backend.
+ */
+const vlc_phy_ops_t* phy_active(void);
+
+/**
+ * @brief Selects the active PHY backend.
+ *
+ * The previous backend stops listening and the new one starts.
+ *
+ * @param name Name of the backend.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no backend has that name.
+ */
+esp_err_t phy_select(const char* name);
+
+/**
+ * @brief Gets a registered PHY backend by index.
+ *
+ * @param index Index of the backend.
+ * @return Pointer to the operations of the backend, or NULL past the last one.
+ */
+const vlc_phy_ops_t* phy_get(size_t index);
+
+/**
+ * @brief Initialises one side of every registered backend.
+ *
+ * A backend that fails is logged and left unusable; the others are still initialised. After the RX side,
+ * the active backend starts listening.
+ *
+ * @param role Side to initialise.
+ * @return ESP_OK if every backend is ready, otherwise the error of the first one that failed, e.g.
+ * ESP_ERR_NOT_FOUND when no hardware timer was free.
+ */
+esp_err_t phy_init_all(phy_role_t role);
+
+/**
+ * @brief Runs the rx_service operation of the active backend whenever it is requested. Never returns.
+ *
+ * Called by the RX task once the RX side is initialised, so the interrupts of the hardware started there are
+ * allocated on RX_TASK_CORE.
+ */
+void phy_rx_service_loop(void);
+
+/**
+ * @brief Wakes phy_rx_service_loop() to run the rx_service operation of the active backend.
+ */
+void phy_rx_service_request(void);
+
+#endif /* PHY_H */
@@ -0,0 +1,318 @@
+/**
+ * @file phy_adc.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the analog ADC PHY backend for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the adc backend. No ISR of this backend touches the samples:
+ * the driver fills its pool from the DMA, and all the signal processing runs in the RX task when it polls.
+ */
+
+#include "phy_adc.h"
+
+/** @brief Tag for logging ADC PHY messages */
+static const char *ADC_PHY_TAG = "PHY_ADC";
+
+/** @brief State of the backend. */
+static phy_adc_ctx_t adc_ctx = {
+    .bit_period_micros = PHY_ADC_PERIOD_MICROS,
+    .stats = { .bit_period_micros = PHY_ADC_PERIOD_MICROS },
+};
+
+/**
+ * @brief Gets the number of conversions per bit for a bit period.
+ *
+ * @param bit_period_micros Bit period, in microseconds.
+ * @return Conversions per bit, or 0 if the period does not give a usable whole number.
+ */
+static uint8_t adc_oversampling(uint32_t bit_period_micros) {
+    uint64_t product = (uint64_t)PHY_ADC_SAMPLE_FREQ_HZ * bit_period_micros;
+    uint64_t oversampling = product / 1000000;
+    if (product % 1000000 != 0 || oversampling < 3 || oversampling > RX_SYNC_MAX_OVERSAMPLING) {
+        return 0;
+    }
+    return (uint8_t)oversampling;
+}
+
+/**
+ * @brief Callback of the ADC driver when its pool is full.
+ *
+ * @param handle ADC handle.
+ * @param edata Event data (unused).
+ * @param user_data Pointer to the backend state.
+ * @return false, no task is woken.
+ */
+static bool IRAM_ATTR adc_pool_overflow(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data) {
+    ((phy_adc_ctx_t*)user_data)->overflows++;
+    return false;
+}
+
+/**
+ * @brief Initialises one side of the backend.
+ *
+ * The TX side is the one of the sync backend, so only the RX side has work to do. The ADC only converts once enabled.
+ *
+ * @param role Side to initialise.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the ring buffer or the mutex could not be created, or an ADC driver error.
+ */
+static esp_err_t adc_init(phy_role_t role) {
+    phy_adc_ctx_t* ctx = &adc_ctx;
+    if (role == PHY_ROLE_TX) {
+        return ESP_OK;
+    }
+    ctx->ring_rx = createRingBuffer();
+    ctx->mutex = xSemaphoreCreateMutex();
+    if (ctx->ring_rx == NULL || ctx->mutex == NULL) {
+        freeRingBuffer(ctx->ring_rx);
+        if (ctx->mutex != NULL) {
+            vSemaphoreDelete(ctx->mutex);
+        }
+        ctx->ring_rx = NULL;
+        ctx->mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    adc_continuous_handle_cfg_t handle_config = {
+        .max_store_buf_size = PHY_ADC_BUFFER_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES,
+        .conv_frame_size = PHY_ADC_FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES,
+    };
+    esp_err_t err = adc_continuous_new_handle(&handle_config, &ctx->handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    adc_digi_pattern_config_t pattern = {
+        .atten = PHY_ADC_ATTEN,
+        .channel = PHY_ADC_CHANNEL,
+        .unit = PHY_ADC_UNIT,
+        .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH,
+    };
+    adc_continuous_config_t adc_config = {
+        .pattern_num = 1,
+        .adc_pattern = &pattern,
+        .sample_freq_hz = PHY_ADC_SAMPLE_FREQ_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ESP_ERROR_CHECK(adc_continuous_config(ctx->handle, &adc_config));
+
+    adc_continuous_evt_cbs_t callbacks = {
+        .on_pool_ovf = adc_pool_overflow,
+    };
+    ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(ctx->handle, &callbacks, ctx));
+
+    rx_sync_default_config(&ctx->sync_config);
+    rx_sync_init(&ctx->sync_rx, &ctx->sync_config, adc_oversampling(ctx->bit_period_micros));
+    rx_slicer_init(&ctx->slicer);
+    ESP_LOGI(ADC_PHY_TAG, "ADC Setup Complete, %d conversions per bit", adc_oversampling(ctx->bit_period_micros));
+    return ESP_OK;
+}
+
+/**
+ * @brief Queues a frame on the sync backend.
+ *
+ * @param words Words of the frame.
+ * @param count Number of words.
+ * @return The result of the sync backend.
+ */
+static esp_err_t adc_tx_submit_frame(const uint32_t* words, size_t count) {
+    return phy_sync_ops.tx_submit_frame(words, count);
+}
+
+/**
+ * @brief Drives the transmissions of the sync backend.
+ */
+static void adc_tx_service(void) {
+    phy_sync_ops.tx_service();
+}
+
+/**
+ * @brief Extracts the conversions of the backend channel from a DMA buffer.
+ *
+ * @param raw DMA buffer.
+ * @param length Number of bytes in the buffer.
+ * @param samples Array to store the conversions.
+ * @return Number of conversions stored.
+ */
+static size_t adc_parse(const uint8_t* raw, uint32_t length, uint16_t* samples) {
+    size_t count = 0;
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t* result = (const adc_digi_output_data_t*)&raw[i];
+        if (result->type2.channel == PHY_ADC_CHANNEL) {
+            samples[count++] = (uint16_t)result->type2.data;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Slices every DMA buffer ready, then pops received words.
+ *
+ * @param words Array to store the words.
+ * @param max_words Size of the array.
+ * @return Number of words popped.
+ */
+static size_t adc_rx_poll_frames(uint32_t* words, size_t max_words) {
+    phy_adc_ctx_t* ctx = &adc_ctx;
+    size_t count = 0;
+    if (ctx->ring_rx == NULL) {
+        return 0;
+    }
+
+    xSemaphoreTake(ctx->mutex, portMAX_DELAY);
+    if (ctx->running) {
+        uint8_t oversampling = ctx->pending_oversampling;
+        if (oversampling != 0) {
+            ctx->pending_oversampling = 0;
+            rx_sync_init(&ctx->sync_rx, &ctx->sync_config, oversampling);
+        }
+
+        uint32_t length = 0;
+        while (adc_continuous_read(ctx->handle, ctx->raw, sizeof(ctx->raw), &length, 0) == ESP_OK) {
+            size_t samples = adc_parse(ctx->raw, length, ctx->samples);
+            rx_slicer_process(&ctx->slicer, ctx->samples, samples, ctx->levels);
+            for (size_t i = 0; i < samples; i++) {
+                rx_sync_status_t status = rx_sync_sample(&ctx->sync_rx, ctx->levels[i]);
+                if (__builtin_expect(status == RX_SYNC_BUSY, 1)) {
+                    continue;
+                }
+                if (status == RX_SYNC_WORD || status == RX_SYNC_FRAME_END) {
+                    if (ringBufferPush(ctx->ring_rx, ctx->sync_rx.word)) {
+                        ctx->stats.rx_words++;
+                    } else {
+                        ctx->stats.rx_dropped++;
+                    }
+                } else if (status == RX_SYNC_LOCKED) {
+                    ctx->stats.rx_syncs++;
+                } else {
+                    ctx->stats.rx_framing_errors++;
+                }
+            }
+        }
+
+        uint32_t overflows = ctx->overflows;
+        if (overflows != ctx->overflows_reported) {
+            ESP_LOGW(ADC_PHY_TAG, "%lu ADC buffer(s) lost", (unsigned long)(overflows - ctx->overflows_reported));
+            ctx->overflows_reported = overflows;
+        }
+    }
+    xSemaphoreGive(ctx->mutex);
+
+    while (count < max_words && ringBufferPop(ctx->ring_rx, &words[count])) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Sets the bit period of the sync backend, which transmits for this one, and logs the change.
+ *
+ * @param bit_period_micros New bit period, in microseconds.
+ * @return The result of the sync backend.
+ */
+static esp_err_t adc_set_tx_rate(uint32_t bit_period_micros) {
+    vlc_phy_stats_t tx_stats;
+    phy_sync_ops.get_stats(&tx_stats);
+    if (tx_stats.bit_period_micros == bit_period_micros) {
+        return ESP_OK;
+    }
+    esp_err_t err = phy_sync_ops.set_rate(bit_period_micros);
+    if (err != ESP_OK) {
+        ESP_LOGW(ADC_PHY_TAG, "Could not set the TX bit period to %lu us: %s", (unsigned long)bit_period_micros, esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(ADC_PHY_TAG, "TX bit period of the sync backend: %lu us -> %lu us",
+             (unsigned long)tx_stats.bit_period_micros, (unsigned long)bit_period_micros);
+    return ESP_OK;
+}
+
+/**
+ * @brief Changes the bit period of the backend, and of the sync backend while this one is active.
+ *
+ * The synchronizer picks up the new number of conversions per bit at the next poll.
+ *
+ * @param bit_period_micros New bit period, in microseconds.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the period does not give a whole number of 3 to
+ *         RX_SYNC_MAX_OVERSAMPLING conversions per bit, or the error of the sync backend.
+ */
+static esp_err_t adc_set_rate(uint32_t bit_period_micros) {
+    phy_adc_ctx_t* ctx = &adc_ctx;
+    uint8_t oversampling = adc_oversampling(bit_period_micros);
+    if (oversampling == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ctx->mutex != NULL) {
+        xSemaphoreTake(ctx->mutex, portMAX_DELAY);
+    }
+    esp_err_t err = ctx->running ? adc_set_tx_rate(bit_period_micros) : ESP_OK;
+    if (err == ESP_OK) {
+        ctx->pending_oversampling = oversampling;
+        ctx->bit_period_micros = bit_period_micros;
+        ctx->stats.bit_period_micros = bit_period_micros;
+    }
+    if (ctx->mutex != NULL) {
+        xSemaphoreGive(ctx->mutex);
+    }
+    return err;
+}
+
+/**
+ * @brief Starts or stops the conversions.
+ *
+ * Called by the console when the backend is selected, so the mutex keeps the RX task out of the driver and the
+ * synchronizer meanwhile. Starting moves the sync backend to the bit period of this one, so both boards agree
+ * once they select it; stopping gives the sync backend its previous bit period back.
+ *
+ * @param enable true to convert, false to stop the ADC.
+ */
+static void adc_enable(bool enable) {
+    phy_adc_ctx_t* ctx = &adc_ctx;
+    if (ctx->handle == NULL) {
+        return;
+    }
+    xSemaphoreTake(ctx->mutex, portMAX_DELAY);
+    if (ctx->running != enable) {
+        if (enable) {
+            vlc_phy_stats_t tx_stats;
+            phy_sync_ops.get_stats(&tx_stats);
+            ctx->sync_period_micros = tx_stats.bit_period_micros;
+            adc_set_tx_rate(ctx->bit_period_micros);
+            rx_slicer_init(&ctx->slicer);
+            rx_sync_reset(&ctx->sync_rx);
+            ESP_ERROR_CHECK(adc_continuous_start(ctx->handle));
+        } else {
+            ESP_ERROR_CHECK(adc_continuous_stop(ctx->handle));
+            adc_set_tx_rate(ctx->sync_period_micros);
+        }
+        ctx->running = enable;
+    }
+    xSemaphoreGive(ctx->mutex);
+}
+
+/**
+ * @brief Reads the counters, the TX ones being those of the sync backend.
+ *
+ * @param stats Pointer to store the counters.
+ */
+static void adc_get_stats(vlc_phy_stats_t* stats) {
+    vlc_phy_stats_t tx_stats;
+    phy_sync_ops.get_stats(&tx_stats);
+    *stats = adc_ctx.stats;
+    stats->tx_words = tx_stats.tx_words;
+    stats->tx_rejected = tx_stats.tx_rejected;
+    stats->tx_interrupts = tx_stats.tx_interrupts;
+}
+
+const vlc_phy_ops_t phy_adc_ops = {
+    .name = "adc",
+    .init = adc_init,
+    .tx_submit_frame = adc_tx_submit_frame,
+    .tx_service = adc_tx_service,
+    .rx_poll_frames = adc_rx_poll_frames,
+    .set_rate = adc_set_rate,
+    .enable = adc_enable,
+    .get_stats = adc_get_stats,
+};
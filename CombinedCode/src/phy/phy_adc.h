@@ -0,0 +1,63 @@
+/**
+ * @file phy_adc.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the analog ADC PHY backend for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the adc PHY backend, which receives sync-word frames from the
+ * analog photodiode output instead of the digital RX pin. The ADC converts continuously into DMA buffers, and
+ * the RX task slices the buffers in bulk with the adaptive slicer of RX_slicer.h before feeding the levels to
+ * the synchronizer of RX_sync.h, so the decision threshold follows the ambient light.
+ *
+ * Transmission uses the sync backend, which sends the same line format. While this backend is active, the sync
+ * backend transmits at its bit period, which must give a whole number of conversions per bit; the previous bit
+ * period of the sync backend is restored when another backend is selected. Both changes are logged.
+ */
+
+#ifndef PHY_ADC_H
+#define PHY_ADC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_adc/adc_continuous.h"
+
+#include "common_utils/config.h"
+#include "common_utils/ring_buffer.h"
+#include "phy/phy.h"
+#include "phy/phy_sync.h"
+#include "reception/RX_slicer.h"
+#include "reception/RX_sync.h"
+
+/**
+ * @brief State of the adc backend.
+ */
+typedef struct {
+    adc_continuous_handle_t handle;                                 /**< Continuous-mode ADC driver */
+    RingBuffer* ring_rx;                                            /**< Words received */
+    SemaphoreHandle_t mutex;                                        /**< Protects the driver and the RX state, used by the RX task and the console */
+    bool running;                                                   /**< The ADC converts */
+    uint32_t sync_period_micros;                                    /**< Bit period of the sync backend before this one became active */
+    volatile uint8_t pending_oversampling;                          /**< Conversions per bit to apply at the next poll, 0 if none */
+    volatile uint32_t overflows;                                    /**< DMA buffers lost because the RX task polled too late */
+    uint32_t overflows_reported;                                    /**< Value of overflows at the last warning */
+    uint8_t raw[PHY_ADC_FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES]; /**< DMA buffer being processed */
+    uint16_t samples[PHY_ADC_FRAME_SAMPLES];                        /**< Conversions of the buffer */
+    uint8_t levels[PHY_ADC_FRAME_SAMPLES];                          /**< Sliced levels of the buffer */
+    rx_slicer_t slicer;                                             /**< Adaptive slicer */
+    rx_sync_config_t sync_config;                                   /**< Sync pattern and tolerance */
+    rx_sync_decoder_t sync_rx;                                      /**< Synchronizer */
+    uint32_t bit_period_micros;                                     /**< Current bit period */
+    vlc_phy_stats_t stats;                                          /**< RX counters */
+} phy_adc_ctx_t;
+
+/** @brief Operations of the adc backend. */
+extern const vlc_phy_ops_t phy_adc_ops;
+
+#endif /* PHY_ADC_H */
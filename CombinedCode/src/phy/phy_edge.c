@@ -0,0 +1,227 @@
+/**
+ * @file phy_edge.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the edge-timestamp PHY backend for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the edge ISR and the decoding of the queued edges in the RX task. Edges are
+ * timestamped in microseconds with esp_timer, which keeps counting through light sleep.
+ */
+
+#include "phy_edge.h"
+
+/** @brief Tag for logging edge PHY messages */
+static const char *EDGE_PHY_TAG = "PHY_EDGE";
+
+/** @brief State of the backend. */
+static phy_edge_ctx_t edge_ctx = {
+    .bit_period_micros = RX_PERIOD_MICROS,
+    .stats = { .bit_period_micros = RX_PERIOD_MICROS },
+};
+
+/**
+ * @brief ISR for any edge of the RX pin.
+ *
+ * Queues the time of the edge and the level after it. Nothing is decoded here.
+ *
+ * @param arg Pointer to the backend state.
+ */
+static void IRAM_ATTR edge_gpio_ISR(void* arg) {
+    phy_edge_ctx_t* ctx = (phy_edge_ctx_t*)arg;
+    uint32_t start = esp_cpu_get_cycle_count();
+    TRACE_ISR_ENTER(TRACE_ISR_EDGE_GPIO);
+    uint32_t now = (uint32_t)esp_timer_get_time() & RX_EDGES_TIME_MASK;
+    uint32_t level = (REG_READ(GPIO_IN_REG) >> ctx->rx_gpio) & 0x1;
+    ctx->stats.rx_interrupts++;
+    if (spsc_queue_push(&ctx->events, RX_EDGES_EVENT(now, level))) {
+        uint32_t queued = spsc_queue_count(&ctx->events);
+        if (queued > ctx->stats.rx_queue_peak) {
+            ctx->stats.rx_queue_peak = queued;
+        }
+    } else {
+        ctx->overflows++;
+    }
+    TRACE_ISR_EXIT(TRACE_ISR_EDGE_GPIO);
+    ctx->stats.rx_isr_cycles += esp_cpu_get_cycle_count() - start;
+}
+
+/**
+ * @brief Initialises one side of the backend.
+ *
+ * The TX side is the one of the gptimer backend, which also configures the RX pin, so only the queue and
+ * the decoder are set up. The backend listens once enabled.
+ *
+ * @param role Side to initialise.
+ * @return ESP_OK.
+ */
+static esp_err_t edge_init(phy_role_t role) {
+    phy_edge_ctx_t* ctx = &edge_ctx;
+    if (role == PHY_ROLE_TX) {
+        return ESP_OK;
+    }
+    spsc_queue_init(&ctx->events, ctx->event_buffer, RX_EDGES_QUEUE_SIZE);
+    rx_edges_init(&ctx->decoder, ctx->bit_period_micros);
+    ctx->rx_gpio = phy_pins_rx_gpios[0];
+    ctx->initialised = true;
+    ESP_LOGI(EDGE_PHY_TAG, "Edge Setup Complete, %d edges queued at most", RX_EDGES_QUEUE_SIZE);
+    return ESP_OK;
+}
+
+/**
+ * @brief Queues a frame on the gptimer backend.
+ *
+ * @param words Words of the frame.
+ * @param count Number of words.
+ * @return The result of the gptimer backend.
+ */
+static esp_err_t edge_tx_submit_frame(const uint32_t* words, size_t count) {
+    return phy_gptimer_ops.tx_submit_frame(words, count);
+}
+
+/**
+ * @brief Drives the transmissions of the gptimer backend.
+ */
+static void edge_tx_service(void) {
+    phy_gptimer_ops.tx_service();
+}
+
+/**
+ * @brief Counts the outcome of a word and stores it if it is complete.
+ *
+ * @param ctx Backend state.
+ * @param status Outcome returned by the decoder.
+ * @param word Word returned by the decoder.
+ * @param words Array to store the words.
+ * @param count Pointer to the number of words stored.
+ */
+static void edge_account(phy_edge_ctx_t* ctx, rx_decoder_status_t status, uint32_t word, uint32_t* words, size_t* count) {
+    if (__builtin_expect(status == RX_DECODER_BUSY, 1)) {
+        return;
+    }
+    if (status == RX_DECODER_DONE) {
+        words[(*count)++] = word;
+        ctx->stats.rx_words++;
+    } else if (status == RX_DECODER_FALSE_START) {
+        ctx->stats.rx_false_starts++;
+    } else {
+        ctx->stats.rx_framing_errors++;
+    }
+}
+
+/**
+ * @brief Decodes the queued edges, then ends the last word if the line has been idle since its stop bit.
+ *
+ * Edges stay queued once the words array is full.
+ *
+ * @param words Array to store the words.
+ * @param max_words Size of the array.
+ * @return Number of words decoded.
+ */
+static size_t edge_rx_poll_frames(uint32_t* words, size_t max_words) {
+    phy_edge_ctx_t* ctx = &edge_ctx;
+    size_t count = 0;
+    uint32_t event;
+    uint32_t word = 0;
+    if (!ctx->initialised) {
+        return 0;
+    }
+
+    uint32_t period = ctx->pending_period_micros;
+    if (period != 0) {
+        ctx->pending_period_micros = 0;
+        rx_edges_init(&ctx->decoder, period);
+    }
+
+    while (count < max_words && spsc_queue_pop(&ctx->events, &event)) {
+        rx_decoder_status_t status = rx_edges_push(&ctx->decoder, RX_EDGES_EVENT_TIME(event), RX_EDGES_EVENT_LEVEL(event), &word);
+        edge_account(ctx, status, word, words, &count);
+    }
+    if (count < max_words) {
+        // Edges timestamped before now are all queued, so an empty queue means the line has not moved since
+        uint32_t now = (uint32_t)esp_timer_get_time() & RX_EDGES_TIME_MASK;
+        if (spsc_queue_is_empty(&ctx->events)) {
+            edge_account(ctx, rx_edges_flush(&ctx->decoder, now, &word), word, words, &count);
+        }
+    }
+
+    uint32_t overflows = ctx->overflows;
+    if (overflows != ctx->overflows_reported) {
+        ESP_LOGW(EDGE_PHY_TAG, "%lu edge(s) lost", (unsigned long)(overflows - ctx->overflows_reported));
+        ctx->stats.rx_dropped += overflows - ctx->overflows_reported;
+        ctx->overflows_reported = overflows;
+    }
+    return count;
+}
+
+/**
+ * @brief Changes the bit period of the backend and of the gptimer backend.
+ *
+ * The decoder restarts with the new period at the next poll.
+ *
+ * @param bit_period_micros New bit period, in microseconds.
+ * @return ESP_OK on success, or the error of the gptimer backend.
+ */
+static esp_err_t edge_set_rate(uint32_t bit_period_micros) {
+    phy_edge_ctx_t* ctx = &edge_ctx;
+    esp_err_t err = phy_gptimer_ops.set_rate(bit_period_micros);
+    if (err != ESP_OK) {
+        return err;
+    }
+    ctx->bit_period_micros = bit_period_micros;
+    ctx->pending_period_micros = bit_period_micros;
+    ctx->stats.bit_period_micros = bit_period_micros;
+    return ESP_OK;
+}
+
+/**
+ * @brief Starts or stops listening for edges.
+ *
+ * The RX pin goes back to falling-edge interrupts when the backend stops, as the gptimer backend expects.
+ *
+ * @param enable true to listen, false to release the RX pin.
+ */
+static void edge_enable(bool enable) {
+    phy_edge_ctx_t* ctx = &edge_ctx;
+    if (!ctx->initialised || ctx->running == enable) {
+        return;
+    }
+    if (enable) {
+        ctx->pending_period_micros = ctx->bit_period_micros;
+        gpio_set_intr_type(ctx->rx_gpio, GPIO_INTR_ANYEDGE);
+        ESP_ERROR_CHECK(gpio_isr_handler_add(ctx->rx_gpio, edge_gpio_ISR, ctx));
+    } else {
+        gpio_isr_handler_remove(ctx->rx_gpio);
+        gpio_set_intr_type(ctx->rx_gpio, GPIO_INTR_NEGEDGE);
+    }
+    ctx->running = enable;
+}
+
+/**
+ * @brief Reads the counters, the TX ones being those of the gptimer backend.
+ *
+ * @param stats Pointer to store the counters.
+ */
+static void edge_get_stats(vlc_phy_stats_t* stats) {
+    vlc_phy_stats_t tx_stats;
+    phy_gptimer_ops.get_stats(&tx_stats);
+    *stats = *(const vlc_phy_stats_t*)&edge_ctx.stats;
+    stats->rx_queued = spsc_queue_count(&edge_ctx.events);
+    stats->tx_words = tx_stats.tx_words;
+    stats->tx_rejected = tx_stats.tx_rejected;
+    stats->tx_interrupts = tx_stats.tx_interrupts;
+}
+
+const vlc_phy_ops_t phy_edge_ops = {
+    .name = "edge",
+    .rx_wake_on_edge = true,
+    .init = edge_init,
+    .tx_submit_frame = edge_tx_submit_frame,
+    .tx_service = edge_tx_service,
+    .rx_poll_frames = edge_rx_poll_frames,
+    .set_rate = edge_set_rate,
+    .enable = edge_enable,
+    .get_stats = edge_get_stats,
+};
@@ -0,0 +1,61 @@
+/**
+ * @file phy_edge.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the edge-timestamp PHY backend for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the edge PHY backend, which receives the line format of the
+ * gptimer backend without a sampling timer. An any-edge interrupt on the first RX pin only timestamps the edge
+ * and queues it, with the level after it, in a lock-free queue; the RX task turns the queued edges into words
+ * with the run-length decoder of RX_edges.h. A word takes one interrupt per edge instead of one per bit, and the
+ * decoder tracks the bit period of the transmitter.
+ *
+ * Transmission uses the gptimer backend, whose RX pin setup this backend also relies on. Receive diversity is
+ * not applied: only the first RX pin is listened to.
+ */
+
+#ifndef PHY_EDGE_H
+#define PHY_EDGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+
+#include "common_utils/config.h"
+#include "common_utils/spsc_queue.h"
+#include "common_utils/trace.h"
+#include "phy/phy.h"
+#include "phy/phy_gptimer.h"
+#include "phy/phy_pins.h"
+#include "reception/RX_edges.h"
+
+/**
+ * @brief State of the edge backend.
+ */
+typedef struct {
+    spsc_queue_t events;                        /**< Edges queued by the ISR for the RX task */
+    uint32_t event_buffer[RX_EDGES_QUEUE_SIZE]; /**< Storage of the queue */
+    rx_edges_t decoder;                         /**< Run-length decoder, used by the RX task only */
+    int rx_gpio;                                /**< RX pin listened to */
+    bool initialised;                           /**< The RX side is set up */
+    bool running;                               /**< The edge interrupt is armed */
+    volatile uint32_t pending_period_micros;    /**< Bit period to restart the decoder with at the next poll, 0 if none */
+    volatile uint32_t overflows;                /**< Edges lost because the RX task polled too late */
+    uint32_t overflows_reported;                /**< Value of overflows at the last warning */
+    uint32_t bit_period_micros;                 /**< Current bit period */
+    volatile vlc_phy_stats_t stats;             /**< RX counters */
+} phy_edge_ctx_t;
+
+/** @brief Operations of the edge backend. */
+extern const vlc_phy_ops_t phy_edge_ops;
+
+#endif /* PHY_EDGE_H */
@@ -0,0 +1,567 @@
+/**
+ * @file phy_gptimer.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the gptimer OOK PHY backend for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the timer and GPIO code formerly in TX_functions.c and RX_functions.c.
+ * All state lives in one phy_gptimer_ctx_t handed to the ISRs as their argument, so the same code drives the
+ * backend and every extra link.
+ */
+
+#include "phy_gptimer.h"
+
+/** @brief Tag for logging gptimer PHY messages */
+static const char *GPTIMER_PHY_TAG = "PHY_GPTIMER";
+
+/** @brief State of the backend. */
+static phy_gptimer_ctx_t gptimer_ctx = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+    .tx_mask = 0x1,
+    .rx_shift = 0,
+    .rx_gpios = phy_pins_rx_gpios,
+    .rx_branches = RX_DIVERSITY_BRANCHES,
+    .chain_words = true,
+    .notify_rx_loop = true,
+    .bit_period_micros = TX_PERIOD_MICROS,
+    .sample_offset_micros = TX_PERIOD_MICROS / 2,
+    .stats = { .bit_period_micros = TX_PERIOD_MICROS },
+};
+
+/**
+ * @brief Cached function pointer for gptimer_start.
+ *
+ * This function pointer is used to start the general-purpose timer.
+ */
+static esp_err_t (*cached_gptimer_start)(gptimer_handle_t timer) = gptimer_start;
+
+/**
+ * @brief Cached function pointer for gptimer_stop.
+ *
+ * This function pointer is used to stop the general-purpose timer.
+ */
+static esp_err_t (*cached_gptimer_stop)(gptimer_handle_t timer) = gptimer_stop;
+
+/**
+ * @brief Cached function pointer for gptimer_set_raw_count.
+ *
+ * This function pointer is used to align the reception timer on the start edge.
+ */
+static esp_err_t (*cached_gptimer_set_raw_count)(gptimer_handle_t timer, uint64_t value) = gptimer_set_raw_count;
+
+/**
+ * @brief Cached function pointer for gptimer_set_alarm_action.
+ *
+ * This function pointer is used to move the transmission alarm to the next level transition.
+ */
+static esp_err_t (*cached_gptimer_set_alarm_action)(gptimer_handle_t timer, const gptimer_alarm_config_t *config) = gptimer_set_alarm_action;
+
+/**
+ * @brief Cached function pointer for gpio_intr_disable.
+ *
+ * This function pointer is used to mask the start edge interrupt while a word is sampled. Unlike
+ * gpio_isr_handler_remove, it is placed in IRAM (CONFIG_GPIO_CTRL_FUNC_IN_IRAM), so the ISRs keep running
+ * while the flash cache is disabled.
+ */
+static esp_err_t (*cached_gpio_intr_disable)(gpio_num_t) = gpio_intr_disable;
+
+/**
+ * @brief Cached function pointer for gpio_intr_enable.
+ *
+ * This function pointer is used to unmask the start edge interrupt once a word is sampled.
+ */
+static esp_err_t (*cached_gpio_intr_enable)(gpio_num_t) = gpio_intr_enable;
+
+/**
+ * @brief Drives the TX pin of an instance.
+ *
+ * @param ctx Instance state.
+ * @param level Level to drive, 0 or 1.
+ */
+static inline void IRAM_ATTR gptimer_write_tx(const phy_gptimer_ctx_t* ctx, uint32_t level) {
+    dedic_gpio_cpu_ll_write_mask(ctx->tx_mask, level ? ctx->tx_mask : 0);
+}
+
+/**
+ * @brief Moves the transmission alarm to the end of the run on the line.
+ *
+ * @param ctx Instance state.
+ * @param from Count at which the run started.
+ */
+static inline void IRAM_ATTR gptimer_tx_schedule(phy_gptimer_ctx_t* ctx, uint64_t from) {
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = from + (uint64_t)ctx->runs_tx[ctx->run_index_tx] * ctx->bit_period_micros,
+    };
+    cached_gptimer_set_alarm_action(ctx->timer_tx, &alarm_config);
+}
+
+/**
+ * @brief Splits value_tx into runs and drives its start bit.
+ *
+ * @param ctx Instance state.
+ */
+static inline void IRAM_ATTR gptimer_tx_load(phy_gptimer_ctx_t* ctx) {
+    ctx->run_count_tx = tx_runlength_encode(ctx->value_tx, ctx->runs_tx);
+    ctx->run_index_tx = 0;
+    gptimer_write_tx(ctx, 0);
+    ctx->stats.tx_words++;
+}
+
+/**
+ * @brief Interrupt Service Routine for the transmission timer.
+ * 
+ * This function is called at the end of each run of the current value. It drives the level of the next run
+ * and moves the alarm to its end, so consecutive equal bits take no interrupt. After the stop bit, the timer
+ * stops, or with chain_words set the start bit of the next queued word follows at once. Ahead of a word, it also
+ * ends the wake preamble, then the idle gap that follows it, with the start bit of the word.
+ * 
+ * @param timer Timer handle
+ * @param edata Pointer to alarm event data
+ * @param arg Pointer to the backend state
+ * @return true if the ISR should yield, false otherwise
+ */
+static bool IRAM_ATTR timer_TX_ISR(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    phy_gptimer_ctx_t* ctx = (phy_gptimer_ctx_t*)arg;
+    TRACE_ISR_ENTER(TRACE_ISR_TX_TIMER);
+    ctx->stats.tx_interrupts++;
+    if (__builtin_expect(ctx->preamble_tx != 0, 0)) {
+        if (ctx->preamble_tx == GPTIMER_PREAMBLE_LOW) {
+            // End of the wake preamble: idle high for as long before the start bit
+            gptimer_write_tx(ctx, 1);
+            ctx->preamble_tx = GPTIMER_PREAMBLE_GAP;
+            gptimer_alarm_config_t alarm_config = {
+                .alarm_count = edata->alarm_value + POWER_WAKE_PREAMBLE_MICROS,
+            };
+            cached_gptimer_set_alarm_action(ctx->timer_tx, &alarm_config);
+        } else {
+            ctx->preamble_tx = 0;
+            portENTER_CRITICAL_ISR(&ctx->lock);
+            ringBufferPop(ctx->ring_tx, &ctx->value_tx);
+            portEXIT_CRITICAL_ISR(&ctx->lock);
+            gptimer_tx_load(ctx);
+            gptimer_tx_schedule(ctx, edata->alarm_value);
+        }
+        TRACE_ISR_EXIT(TRACE_ISR_TX_TIMER);
+        return true;
+    }
+    uint8_t run = ctx->run_index_tx + 1;
+    if (__builtin_expect(run < ctx->run_count_tx, 1)) {
+        gptimer_write_tx(ctx, run & 0x1);
+        ctx->run_index_tx = run;
+        gptimer_tx_schedule(ctx, edata->alarm_value);
+        TRACE_ISR_EXIT(TRACE_ISR_TX_TIMER);
+        return true;
+    }
+    if (ctx->chain_words) {
+        portENTER_CRITICAL_ISR(&ctx->lock);
+        bool next = ringBufferPop(ctx->ring_tx, &ctx->value_tx);
+        portEXIT_CRITICAL_ISR(&ctx->lock);
+        if (next) {
+            gptimer_tx_load(ctx);
+            gptimer_tx_schedule(ctx, edata->alarm_value);
+            TRACE_ISR_EXIT(TRACE_ISR_TX_TIMER);
+            return true;
+        }
+    }
+    cached_gptimer_stop(ctx->timer_tx);
+    ctx->in_transmission = false;
+    ctx->run_count_tx = 0;
+    ctx->run_index_tx = 0;
+    TRACE_ISR_EXIT(TRACE_ISR_TX_TIMER);
+    return true;
+}
+
+/**
+ * @brief ISR for the GPIO used in reception.
+ * 
+ * This ISR starts the reception timer so that its first alarm comes sample_offset_micros after the edge,
+ * the middle of the start bit unless calibrated otherwise, and resets the reception value and bit counter.
+ * A falling edge on any diversity branch starts a reception.
+ * 
+ * @param arg Pointer to the backend state.
+ */
+static void IRAM_ATTR RX_gpio_ISR(void* arg) {
+    phy_gptimer_ctx_t* ctx = (phy_gptimer_ctx_t*)arg;
+    uint32_t start = esp_cpu_get_cycle_count();
+    TRACE_ISR_ENTER(TRACE_ISR_RX_GPIO);
+    ctx->stats.rx_interrupts++;
+    rx_decoder_start(&ctx->decoder_rx); // Reset the decoder for the next reception
+    cached_gptimer_set_raw_count(ctx->timer_rx, ctx->bit_period_micros - ctx->sample_offset_micros);
+    cached_gptimer_start(ctx->timer_rx);
+    for (int b = 0; b < ctx->rx_branches; b++) {
+        cached_gpio_intr_disable(ctx->rx_gpios[b]);
+    }
+    TRACE_ISR_EXIT(TRACE_ISR_RX_GPIO);
+    ctx->stats.rx_isr_cycles += esp_cpu_get_cycle_count() - start;
+}
+
+/**
+ * @brief ISR for the reception timer.
+ * 
+ * This ISR reads the GPIO state and updates the reception value and bit counter.
+ * When the word is complete or rejected, the timer stops and the edge interrupt is unmasked at once,
+ * unless the backend was disabled meanwhile. The GPIO ISR handlers themselves are only added and removed
+ * by phy_gptimer_ctx_enable(), from a task.
+ * 
+ * @param timer Timer handle.
+ * @param edata Pointer to alarm event data.
+ * @param arg Pointer to the backend state.
+ * @return true if the ISR should yield, false otherwise.
+ */
+static bool IRAM_ATTR timer_RX_ISR(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    phy_gptimer_ctx_t* ctx = (phy_gptimer_ctx_t*)arg;
+    uint32_t start = esp_cpu_get_cycle_count();
+    TRACE_ISR_ENTER(TRACE_ISR_RX_TIMER);
+    ctx->stats.rx_interrupts++;
+    rx_decoder_status_t status = rx_decoder_sample(&ctx->decoder_rx, rx_diversity_combine(ctx->diversity, gpioDirectRead() >> ctx->rx_shift));
+    if (__builtin_expect(status != RX_DECODER_BUSY, 0)) {
+        // Less common case: word complete or rejected
+        cached_gptimer_stop(ctx->timer_rx);
+        if (ctx->rx_enabled) {
+            for (int b = 0; b < ctx->rx_branches; b++) {
+                cached_gpio_intr_enable(ctx->rx_gpios[b]);
+            }
+        }
+        if (status == RX_DECODER_DONE) {
+            if (spsc_queue_push(&ctx->rx_queue, ctx->decoder_rx.value)) {
+                uint32_t queued = spsc_queue_count(&ctx->rx_queue);
+                ctx->stats.rx_words++;
+                if (queued > ctx->stats.rx_queue_peak) {
+                    ctx->stats.rx_queue_peak = queued;
+                }
+                if (ctx->notify_rx_loop) {
+                    rx_loop_notify_from_isr();
+                }
+            } else {
+                ctx->stats.rx_dropped++;
+            }
+        } else if (status == RX_DECODER_FALSE_START) {
+            ctx->stats.rx_false_starts++;
+        } else {
+            ctx->stats.rx_framing_errors++;
+        }
+    }
+    TRACE_ISR_EXIT(TRACE_ISR_RX_TIMER);
+    ctx->stats.rx_isr_cycles += esp_cpu_get_cycle_count() - start;
+    return true;
+}
+
+/**
+ * @brief Creates a timer with an alarm one bit period after its start.
+ *
+ * @param timer Pointer to store the timer handle.
+ * @param on_alarm Alarm callback.
+ * @param ctx Backend state passed to the callback.
+ * @param auto_reload true for an alarm every bit period, false for one the callback moves itself.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if all timers are in use.
+ */
+static esp_err_t setup_timer(gptimer_handle_t* timer, gptimer_alarm_cb_t on_alarm, phy_gptimer_ctx_t* ctx, bool auto_reload) {
+    gptimer_config_t timer_config = {
+        .clk_src = TIMER_CLOCK_SOURCE,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = TIMER_RESOLUTION_HZ, // 1MHz, 1 tick = 1us
+        .intr_priority = TIMER_INTERRUPTION_PRIORITY,
+    };
+    esp_err_t err = gptimer_new_timer(&timer_config, timer);
+    if (err != ESP_OK) {
+        *timer = NULL;
+        return err;
+    }
+
+    gptimer_alarm_config_t alarm_config = {
+        .reload_count = 0, // counter will reload with 0 on alarm event
+        .alarm_count = ctx->bit_period_micros, // period
+        .flags.auto_reload_on_alarm = auto_reload,
+    };
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(*timer, &alarm_config));
+
+    gptimer_event_callbacks_t call_back_timer = {
+        .on_alarm = on_alarm, // register user callback
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(*timer, &call_back_timer, ctx));
+
+    ESP_ERROR_CHECK(gptimer_enable(*timer));
+    return ESP_OK;
+}
+
+esp_err_t phy_gptimer_ctx_init(phy_gptimer_ctx_t* ctx, phy_role_t role) {
+    if (role == PHY_ROLE_RX) {
+        spsc_queue_init(&ctx->rx_queue, ctx->rx_queue_buffer, RX_PIPELINE_QUEUE_SIZE);
+        return setup_timer(&ctx->timer_rx, timer_RX_ISR, ctx, true);
+    }
+    ctx->ring_tx = createRingBuffer();
+    if (ctx->ring_tx == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = setup_timer(&ctx->timer_tx, timer_TX_ISR, ctx, false);
+    if (err != ESP_OK) {
+        freeRingBuffer(ctx->ring_tx);
+        ctx->ring_tx = NULL;
+        return err;
+    }
+    gptimer_write_tx(ctx, 1);
+    return ESP_OK;
+}
+
+/**
+ * @brief Stops and frees a timer.
+ *
+ * @param timer Pointer to the timer handle, cleared.
+ */
+static void release_timer(gptimer_handle_t* timer) {
+    if (*timer == NULL) {
+        return;
+    }
+    gptimer_stop(*timer);
+    gptimer_disable(*timer);
+    gptimer_del_timer(*timer);
+    *timer = NULL;
+}
+
+void phy_gptimer_ctx_deinit(phy_gptimer_ctx_t* ctx) {
+    phy_gptimer_ctx_enable(ctx, false);
+    release_timer(&ctx->timer_tx);
+    release_timer(&ctx->timer_rx);
+    freeRingBuffer(ctx->ring_tx);
+    ctx->ring_tx = NULL;
+    spsc_queue_reset(&ctx->rx_queue);
+    ctx->in_transmission = false;
+    ctx->preamble_tx = 0;
+    ctx->run_count_tx = 0;
+    ctx->run_index_tx = 0;
+}
+
+esp_err_t phy_gptimer_ctx_submit(phy_gptimer_ctx_t* ctx, const uint32_t* words, size_t count) {
+    esp_err_t err = ESP_OK;
+    if (ctx->ring_tx == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    portENTER_CRITICAL(&ctx->lock);
+    if (ringBufferFreeSpace(ctx->ring_tx) < count) {
+        ctx->stats.tx_rejected += count;
+        err = ESP_ERR_NO_MEM;
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            ringBufferPush(ctx->ring_tx, words[i]);
+        }
+    }
+    portEXIT_CRITICAL(&ctx->lock);
+    return err;
+}
+
+/**
+ * @brief Pops the next word, sends its start bit and sets the alarm at the end of its first run.
+ * The caller has set in_transmission.
+ *
+ * @param ctx Instance state.
+ */
+static void gptimer_tx_start(phy_gptimer_ctx_t* ctx) {
+    portENTER_CRITICAL(&ctx->lock);
+    ringBufferPop(ctx->ring_tx, &ctx->value_tx);
+    portEXIT_CRITICAL(&ctx->lock);
+    gptimer_set_raw_count(ctx->timer_tx, 0);
+    gptimer_tx_load(ctx);
+    gptimer_tx_schedule(ctx, 0);
+    gptimer_start(ctx->timer_tx);
+}
+
+void phy_gptimer_ctx_service(phy_gptimer_ctx_t* ctx) {
+    if (ctx->ring_tx != NULL && !ctx->in_transmission && !ringBufferIsEmpty(ctx->ring_tx)) {
+        ctx->in_transmission = true;
+        gptimer_tx_start(ctx);
+    }
+}
+
+size_t phy_gptimer_ctx_poll(phy_gptimer_ctx_t* ctx, uint32_t* words, size_t max_words) {
+    size_t count = 0;
+    if (ctx->rx_queue.buffer == NULL) {
+        return 0;
+    }
+    while (count < max_words && spsc_queue_pop(&ctx->rx_queue, &words[count])) {
+        count++;
+    }
+    return count;
+}
+
+void phy_gptimer_ctx_enable(phy_gptimer_ctx_t* ctx, bool enable) {
+    if (ctx->timer_rx == NULL || ctx->rx_enabled == enable) {
+        return;
+    }
+    ctx->rx_enabled = enable;
+    for (int b = 0; b < ctx->rx_branches; b++) {
+        if (enable) {
+            ESP_ERROR_CHECK(gpio_isr_handler_add(ctx->rx_gpios[b], RX_gpio_ISR, ctx));
+        } else {
+            gpio_isr_handler_remove(ctx->rx_gpios[b]);
+        }
+    }
+}
+
+/**
+ * @brief Initialises one side of the backend.
+ *
+ * The RX side listens once enabled; words are queued until they are polled.
+ *
+ * @param role Side to initialise.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the TX ring buffer could not be created,
+ *         ESP_ERR_NOT_FOUND if all timers are in use.
+ */
+static esp_err_t gptimer_init(phy_role_t role) {
+    phy_gptimer_ctx_t* ctx = &gptimer_ctx;
+    if (role == PHY_ROLE_TX) {
+        phy_pins_setup_tx();
+    } else {
+        phy_pins_setup_rx();
+        ctx->diversity = phy_pins_diversity();
+    }
+    esp_err_t err = phy_gptimer_ctx_init(ctx, role);
+    if (err == ESP_OK) {
+        ESP_LOGI(GPTIMER_PHY_TAG, "%s Timer Setup Complete", role == PHY_ROLE_TX ? "Transmission" : "Reception");
+    }
+    return err;
+}
+
+/**
+ * @brief Queues a frame for transmission.
+ *
+ * @param words Words of the frame.
+ * @param count Number of words.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE before TX init, ESP_ERR_NO_MEM if the frame does not fit.
+ */
+static esp_err_t gptimer_tx_submit_frame(const uint32_t* words, size_t count) {
+    return phy_gptimer_ctx_submit(&gptimer_ctx, words, count);
+}
+
+/**
+ * @brief Drives the wake preamble and starts the TX timer, whose ISR sends the next queued word once the
+ * preamble and the idle gap after it have elapsed. The caller has set in_transmission.
+ *
+ * @param ctx Instance state.
+ */
+static void gptimer_tx_start_preamble(phy_gptimer_ctx_t* ctx) {
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = POWER_WAKE_PREAMBLE_MICROS,
+    };
+    ctx->preamble_tx = GPTIMER_PREAMBLE_LOW;
+    gptimer_set_raw_count(ctx->timer_tx, 0);
+    gptimer_set_alarm_action(ctx->timer_tx, &alarm_config);
+    gptimer_write_tx(ctx, 0);
+    gptimer_start(ctx->timer_tx);
+}
+
+/**
+ * @brief Checks the transmission buffer and starts transmission if possible.
+ * 
+ * This function checks if the buffer is not empty and no transmission is currently
+ * in progress. If both conditions are met, it pops a value, sets the GPIO low
+ * and starts the transmission timer, whose ISR then sends the other queued words
+ * back to back (chain_words). When the peer may be asleep, the TX timer
+ * first holds the line low for POWER_WAKE_PREAMBLE_MICROS, so the task does not
+ * busy-wait through the preamble.
+ */
+static void gptimer_tx_service(void) {
+    phy_gptimer_ctx_t* ctx = &gptimer_ctx;
+    if ((!ringBufferIsEmpty(ctx->ring_tx)) & (!ctx->in_transmission)) {
+        ctx->in_transmission = true;
+        if (power_tx_wake_peer()) {
+            gptimer_tx_start_preamble(ctx);
+            return;
+        }
+        gptimer_tx_start(ctx);
+    }
+}
+
+/**
+ * @brief Pops received words.
+ *
+ * @param words Array to store the words.
+ * @param max_words Size of the array.
+ * @return Number of words popped.
+ */
+static size_t gptimer_rx_poll_frames(uint32_t* words, size_t max_words) {
+    return phy_gptimer_ctx_poll(&gptimer_ctx, words, max_words);
+}
+
+/**
+ * @brief Changes the bit period of both timers.
+ *
+ * The TX alarm follows from the next word on, as it is set per run. A word being received while the rate changes
+ * is lost. The sampling instant goes back to the middle of the bit.
+ *
+ * @param bit_period_micros New bit period, in microseconds.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a zero period, ESP_ERR_INVALID_STATE while transmitting.
+ */
+static esp_err_t gptimer_set_rate(uint32_t bit_period_micros) {
+    phy_gptimer_ctx_t* ctx = &gptimer_ctx;
+    if (bit_period_micros == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ctx->in_transmission || (ctx->ring_tx != NULL && !ringBufferIsEmpty(ctx->ring_tx))) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gptimer_alarm_config_t alarm_config = {
+        .reload_count = 0,
+        .alarm_count = bit_period_micros,
+        .flags.auto_reload_on_alarm = true,
+    };
+    if (ctx->timer_rx != NULL) {
+        ESP_ERROR_CHECK(gptimer_set_alarm_action(ctx->timer_rx, &alarm_config));
+    }
+    ctx->bit_period_micros = bit_period_micros;
+    ctx->sample_offset_micros = bit_period_micros / 2;
+    ctx->stats.bit_period_micros = bit_period_micros;
+    return ESP_OK;
+}
+
+/**
+ * @brief Moves the sampling instant, taking effect from the next start edge.
+ *
+ * @param offset_micros Time from the start edge to the first sample, in microseconds.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the offset is not within the bit period.
+ */
+static esp_err_t gptimer_set_sample_offset(uint32_t offset_micros) {
+    phy_gptimer_ctx_t* ctx = &gptimer_ctx;
+    if (offset_micros == 0 || offset_micros >= ctx->bit_period_micros) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ctx->sample_offset_micros = offset_micros;
+    return ESP_OK;
+}
+
+/**
+ * @brief Starts or stops listening for start edges.
+ *
+ * A word being received when the backend is disabled completes, but the edge interrupt is not re-armed.
+ *
+ * @param enable true to listen, false to release the RX pin.
+ */
+static void gptimer_rx_enable(bool enable) {
+    phy_gptimer_ctx_enable(&gptimer_ctx, enable);
+}
+
+/**
+ * @brief Reads the counters.
+ *
+ * @param stats Pointer to store the counters.
+ */
+static void gptimer_get_stats(vlc_phy_stats_t* stats) {
+    *stats = *(const vlc_phy_stats_t*)&gptimer_ctx.stats;
+    stats->rx_queued = spsc_queue_count(&gptimer_ctx.rx_queue);
+}
+
+const vlc_phy_ops_t phy_gptimer_ops = {
+    .name = "gptimer",
+    .rx_wake_on_edge = true,
+    .rx_notifies = true,
+    .init = gptimer_init,
+    .tx_submit_frame = gptimer_tx_submit_frame,
+    .tx_service = gptimer_tx_service,
+    .rx_poll_frames = gptimer_rx_poll_frames,
+    .set_rate = gptimer_set_rate,
+    .enable = gptimer_rx_enable,
+    .set_sample_offset = gptimer_set_sample_offset,
+    .get_stats = gptimer_get_stats,
+};
@@ -0,0 +1,150 @@
+/**
+ * @file phy_gptimer.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the gptimer OOK PHY backend for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the gptimer PHY backend, which sends every word as a
+ * start bit, 32 data bits (least significant first) and a stop bit on the TX pin, and receives words on the
+ * RX pin with a falling-edge interrupt that starts a mid-bit sampling timer. Edges whose start bit is not
+ * low at mid-bit and words whose stop bit is not high are counted and dropped. The pins are driven and read through
+ * dedicated GPIO bundles, so the TX side must be initialised on the TX core and the RX side on the RX core.
+ *
+ * The TX timer is edge-driven: each word is split into runs of constant level by tx_runlength_encode(), and the
+ * alarm is moved to the end of the current run, so the TX ISR runs once per level transition instead of once per bit.
+ *
+ * Received words go through a lock-free queue, as the RX decode task polls them from RX_DECODE_TASK_CORE, the
+ * other core than the RX ISRs.
+ *
+ * The ISRs and everything they call are in IRAM, and only mask and unmask the edge interrupt with
+ * gpio_intr_disable() / gpio_intr_enable(), so with CONFIG_GPTIMER_ISR_IRAM_SAFE and CONFIG_GPIO_CTRL_FUNC_IN_IRAM
+ * the link keeps its timing while NVS writes disable the flash cache.
+ *
+ * The backend is one instance of the functions taking a phy_gptimer_ctx_t, which also drive the extra links
+ * of vlc_link.h. Each instance takes two of the four general-purpose timers of the ESP32-S3.
+ */
+
+#ifndef PHY_GPTIMER_H
+#define PHY_GPTIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "driver/gptimer.h"
+#include "driver/gpio.h"
+#include "hal/dedic_gpio_cpu_ll.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "common_utils/config.h"
+#include "common_utils/gpio_direct_RW.h"
+#include "common_utils/power.h"
+#include "common_utils/ring_buffer.h"
+#include "common_utils/spsc_queue.h"
+#include "common_utils/trace.h"
+#include "phy/phy.h"
+#include "phy/phy_pins.h"
+#include "reception/RX_decoder.h"
+#include "reception/RX_loop.h"
+#include "transmission/TX_runlength.h"
+
+/** @brief The wake preamble holds the TX line low. */
+#define GPTIMER_PREAMBLE_LOW 1
+/** @brief The TX line idles high between the wake preamble and the start bit. */
+#define GPTIMER_PREAMBLE_GAP 2
+
+/**
+ * @brief State of an instance of the gptimer backend, passed to its ISRs.
+ */
+typedef struct {
+    gptimer_handle_t timer_tx;              /**< Timer clocking the TX bits */
+    gptimer_handle_t timer_rx;              /**< Timer sampling the RX bits */
+    RingBuffer* ring_tx;                    /**< Words waiting to be sent */
+    spsc_queue_t rx_queue;                  /**< Words received, pushed by the RX timer ISR without a lock */
+    portMUX_TYPE lock;                      /**< Protects the TX ring, shared by the TX ISR and the tasks of the same core */
+    uint32_t tx_mask;                       /**< Dedicated GPIO output channel of the TX pin, as a mask */
+    uint32_t rx_shift;                      /**< Dedicated GPIO input channel of the first RX pin */
+    const int* rx_gpios;                    /**< RX pins, one per diversity branch */
+    uint8_t rx_branches;                    /**< Number of RX pins */
+    bool chain_words;                       /**< The TX ISR sends queued words back to back instead of one per service call */
+    bool notify_rx_loop;                    /**< Received words wake the RX task through rx_loop_notify_from_isr() */
+    volatile uint32_t value_tx;             /**< Word being sent */
+    uint8_t runs_tx[TX_RUNLENGTH_MAX_RUNS]; /**< Runs of value_tx, in bit periods */
+    volatile uint8_t run_count_tx;          /**< Number of runs of value_tx */
+    volatile uint8_t run_index_tx;          /**< Run of value_tx on the line */
+    volatile bool in_transmission;          /**< A word is being sent */
+    volatile uint8_t preamble_tx;           /**< Part of the wake preamble on the line, GPTIMER_PREAMBLE_LOW or GPTIMER_PREAMBLE_GAP, 0 if none */
+    volatile bool rx_enabled;               /**< The edge interrupt may be re-armed */
+    rx_decoder_t decoder_rx;                /**< Bit decoder of the word being received */
+    rx_diversity_t* diversity;              /**< Combiner of the RX branches */
+    uint32_t bit_period_micros;             /**< Current bit period */
+    uint32_t sample_offset_micros;          /**< Time from the start edge to the first sample */
+    volatile vlc_phy_stats_t stats;         /**< Counters */
+    uint32_t rx_queue_buffer[RX_PIPELINE_QUEUE_SIZE]; /**< Storage of rx_queue */
+} phy_gptimer_ctx_t;
+
+/** @brief Operations of the gptimer backend. */
+extern const vlc_phy_ops_t phy_gptimer_ops;
+
+/**
+ * @brief Creates the queue and timer of one side of an instance.
+ *
+ * The pins, channels, diversity combiner and bit period of the context must be set first, and the call must be
+ * made from the core the side runs on. The TX pin is driven high.
+ *
+ * @param ctx Instance state.
+ * @param role Side to initialise.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the TX ring buffer could not be created,
+ *         ESP_ERR_NOT_FOUND if all timers are in use.
+ */
+esp_err_t phy_gptimer_ctx_init(phy_gptimer_ctx_t* ctx, phy_role_t role);
+
+/**
+ * @brief Stops an instance, frees its timers and TX ring buffer and empties its RX queue.
+ *
+ * @param ctx Instance state.
+ */
+void phy_gptimer_ctx_deinit(phy_gptimer_ctx_t* ctx);
+
+/**
+ * @brief Queues a frame on an instance.
+ *
+ * @param ctx Instance state.
+ * @param words Words of the frame.
+ * @param count Number of words.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE before TX init, ESP_ERR_NO_MEM if the frame does not fit.
+ */
+esp_err_t phy_gptimer_ctx_submit(phy_gptimer_ctx_t* ctx, const uint32_t* words, size_t count);
+
+/**
+ * @brief Starts sending the next queued word of an instance when its line is idle.
+ *
+ * @param ctx Instance state.
+ */
+void phy_gptimer_ctx_service(phy_gptimer_ctx_t* ctx);
+
+/**
+ * @brief Pops the words received by an instance.
+ *
+ * @param ctx Instance state.
+ * @param words Array to store the words.
+ * @param max_words Size of the array.
+ * @return Number of words popped.
+ */
+size_t phy_gptimer_ctx_poll(phy_gptimer_ctx_t* ctx, uint32_t* words, size_t max_words);
+
+/**
+ * @brief Starts or stops listening for start edges on the RX pins of an instance.
+ *
+ * @param ctx Instance state.
+ * @param enable true to listen.
+ */
+void phy_gptimer_ctx_enable(phy_gptimer_ctx_t* ctx, bool enable);
+
+#endif /* PHY_GPTIMER_H */
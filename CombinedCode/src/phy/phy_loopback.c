@@ -0,0 +1,132 @@
+/**
+ * @file phy_loopback.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the loopback PHY backend for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the loopback PHY backend. Submitted words are
+ * pushed into one ring buffer, shared by both sides, and popped when the RX side polls.
+ */
+
+#include "phy_loopback.h"
+
+/** @brief State of the backend. */
+static phy_loopback_ctx_t loopback_ctx = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+    .bit_period_micros = TX_PERIOD_MICROS,
+    .stats = { .bit_period_micros = TX_PERIOD_MICROS },
+};
+
+/**
+ * @brief Initialises the backend.
+ *
+ * Both sides share one ring buffer, created by whichever side starts first.
+ *
+ * @param role Side to initialise.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the ring buffer could not be created.
+ */
+static esp_err_t loopback_init(phy_role_t role) {
+    RingBuffer* ring = createRingBuffer();
+    if (ring == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    portENTER_CRITICAL(&loopback_ctx.lock);
+    if (loopback_ctx.ring == NULL) {
+        loopback_ctx.ring = ring;
+        ring = NULL;
+    }
+    portEXIT_CRITICAL(&loopback_ctx.lock);
+    freeRingBuffer(ring);
+    return ESP_OK;
+}
+
+/**
+ * @brief Queues a frame, making it available to the RX side at once.
+ *
+ * @param words Words of the frame.
+ * @param count Number of words.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE before init, ESP_ERR_NO_MEM if the frame does not fit.
+ */
+static esp_err_t loopback_tx_submit_frame(const uint32_t* words, size_t count) {
+    esp_err_t err = ESP_OK;
+    if (loopback_ctx.ring == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    portENTER_CRITICAL(&loopback_ctx.lock);
+    if (ringBufferFreeSpace(loopback_ctx.ring) < count) {
+        loopback_ctx.stats.tx_rejected += count;
+        err = ESP_ERR_NO_MEM;
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            ringBufferPush(loopback_ctx.ring, words[i]);
+        }
+        loopback_ctx.stats.tx_words += count;
+    }
+    portEXIT_CRITICAL(&loopback_ctx.lock);
+    if (err == ESP_OK) {
+        rx_loop_notify();
+    }
+    return err;
+}
+
+/**
+ * @brief Pops received words.
+ *
+ * @param words Array to store the words.
+ * @param max_words Size of the array.
+ * @return Number of words popped.
+ */
+static size_t loopback_rx_poll_frames(uint32_t* words, size_t max_words) {
+    size_t count = 0;
+    if (loopback_ctx.ring == NULL) {
+        return 0;
+    }
+    portENTER_CRITICAL(&loopback_ctx.lock);
+    while (count < max_words && ringBufferPop(loopback_ctx.ring, &words[count])) {
+        count++;
+    }
+    loopback_ctx.stats.rx_words += count;
+    portEXIT_CRITICAL(&loopback_ctx.lock);
+    return count;
+}
+
+/**
+ * @brief Records the bit period, which has no effect on a loopback.
+ *
+ * @param bit_period_micros New bit period, in microseconds.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a zero period.
+ */
+static esp_err_t loopback_set_rate(uint32_t bit_period_micros) {
+    if (bit_period_micros == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    loopback_ctx.bit_period_micros = bit_period_micros;
+    loopback_ctx.stats.bit_period_micros = bit_period_micros;
+    return ESP_OK;
+}
+
+/**
+ * @brief Reads the counters.
+ *
+ * @param stats Pointer to store the counters.
+ */
+static void loopback_get_stats(vlc_phy_stats_t* stats) {
+    portENTER_CRITICAL(&loopback_ctx.lock);
+    *stats = loopback_ctx.stats;
+    portEXIT_CRITICAL(&loopback_ctx.lock);
+}
+
+const vlc_phy_ops_t phy_loopback_ops = {
+    .name = "loopback",
+    .rx_notifies = true,
+    .init = loopback_init,
+    .tx_submit_frame = loopback_tx_submit_frame,
+    .tx_service = NULL,
+    .rx_poll_frames = loopback_rx_poll_frames,
+    .set_rate = loopback_set_rate,
+    .enable = NULL,
+    .get_stats = loopback_get_stats,
+};
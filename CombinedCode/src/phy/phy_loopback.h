@@ -0,0 +1,41 @@
+/**
+ * @file phy_loopback.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the loopback PHY backend for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the loopback PHY backend. Every submitted frame
+ * is received back unchanged on the same board, so the layers above the PHY can be exercised and
+ * benchmarked without the optical link. The backend only uses portable code.
+ */
+
+#ifndef PHY_LOOPBACK_H
+#define PHY_LOOPBACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+#include "common_utils/config.h"
+#include "common_utils/ring_buffer.h"
+#include "phy/phy.h"
+#include "reception/RX_loop.h"
+
+/**
+ * @brief State of the loopback backend.
+ */
+typedef struct {
+    RingBuffer* ring;               /**< Words in flight */
+    portMUX_TYPE lock;              /**< Protects the ring, written from the TX core and read from the RX core */
+    uint32_t bit_period_micros;     /**< Nominal bit period, only reported */
+    vlc_phy_stats_t stats;          /**< Counters */
+} phy_loopback_ctx_t;
+
+/** @brief Operations of the loopback backend. */
+extern const vlc_phy_ops_t phy_loopback_ops;
+
+#endif /* PHY_LOOPBACK_H */
@@ -0,0 +1,196 @@
+/**
+ * @file phy_pins.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the optical pin setup shared by the PHY backends for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the GPIO setup formerly in the gptimer backend.
+ */
+
+#include "phy_pins.h"
+
+/** @brief Tag for logging pin setup messages */
+static const char *PINS_TAG = "PHY_PINS";
+
+/** @brief Flag to indicate if the TX pin is set up. */
+static bool pins_tx_ready = false;
+
+/** @brief GPIO matrix output signal of the TX bundle. */
+static uint32_t pins_tx_signal = 0;
+
+/** @brief Flag to indicate if the RX pin is set up. */
+static bool pins_rx_ready = false;
+
+/** @brief Diversity combiner of the RX pins. */
+static rx_diversity_t pins_diversity;
+
+DRAM_ATTR const int phy_pins_rx_gpios[RX_DIVERSITY_MAX_BRANCHES] = RX_DIVERSITY_GPIO_PINS;
+
+void phy_pins_setup_tx(void) {
+    if (pins_tx_ready) {
+        return;
+    }
+    pins_tx_ready = true;
+
+    const int TX_bundle_gpios[] = {TX_GPIO_PIN_NUM};
+
+    gpio_config_t io_conf = {
+        .mode = GPIO_MODE_OUTPUT,
+        .pin_bit_mask = TX_GPIO_PIN_SEL,
+    };
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+
+    dedic_gpio_bundle_handle_t TX_bundle = NULL;
+    dedic_gpio_bundle_config_t TX_bundle_config = {
+        .gpio_array = TX_bundle_gpios,
+        .array_size = sizeof(TX_bundle_gpios) / sizeof(TX_bundle_gpios[0]),
+        .flags = {
+            .out_en = 1,
+        },
+    };
+    ESP_ERROR_CHECK(dedic_gpio_new_bundle(&TX_bundle_config, &TX_bundle));
+
+    uint32_t offset = 0;
+    ESP_ERROR_CHECK(dedic_gpio_get_out_offset(TX_bundle, &offset));
+    pins_tx_signal = dedic_gpio_periph_signals.cores[esp_cpu_get_core_id()].out_sig_per_channel[offset];
+    ESP_LOGI(PINS_TAG, "TX GPIO Setup Complete");
+}
+
+void phy_pins_reclaim_tx(void) {
+    if (!pins_tx_ready) {
+        return;
+    }
+    esp_rom_gpio_connect_out_signal(TX_GPIO_PIN_NUM, pins_tx_signal, false, false);
+}
+
+void phy_pins_setup_rx(void) {
+    if (pins_rx_ready) {
+        return;
+    }
+    pins_rx_ready = true;
+
+    uint64_t pin_mask = 0;
+    for (int b = 0; b < RX_DIVERSITY_BRANCHES; b++) {
+        pin_mask |= 1ULL << phy_pins_rx_gpios[b];
+    }
+    gpio_config_t io_conf = {
+        .intr_type = GPIO_INTR_NEGEDGE,
+        .pin_bit_mask = pin_mask,
+        .mode = GPIO_MODE_INPUT,
+        .pull_down_en = 1,
+    };
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+
+#if RX_GLITCH_FILTER_ENABLE
+    // Pulses of less than two IO MUX clock cycles never reach the edge interrupt
+    for (int b = 0; b < RX_DIVERSITY_BRANCHES; b++) {
+        gpio_glitch_filter_handle_t glitch_filter = NULL;
+        gpio_pin_glitch_filter_config_t glitch_filter_config = {
+            .clk_src = GLITCH_FILTER_CLK_SRC_DEFAULT,
+            .gpio_num = phy_pins_rx_gpios[b],
+        };
+        ESP_ERROR_CHECK(gpio_new_pin_glitch_filter(&glitch_filter_config, &glitch_filter));
+        ESP_ERROR_CHECK(gpio_glitch_filter_enable(glitch_filter));
+    }
+#endif
+
+    // Branch b is bit b of every read of the bundle
+    dedic_gpio_bundle_handle_t reception_bundle = NULL;
+    dedic_gpio_bundle_config_t reception_bundle_config = {
+        .gpio_array = phy_pins_rx_gpios,
+        .array_size = RX_DIVERSITY_BRANCHES,
+        .flags = {
+            .in_en = 1,
+        },
+    };
+    ESP_ERROR_CHECK(dedic_gpio_new_bundle(&reception_bundle_config, &reception_bundle));
+    ESP_ERROR_CHECK(gpio_install_isr_service(GPIO_ISR_FLAGS));
+
+    rx_diversity_init(&pins_diversity, RX_DIVERSITY_BRANCHES,
+                      RX_DIVERSITY_BRANCHES >= 3 ? RX_DIVERSITY_MAJORITY : RX_DIVERSITY_SELECT);
+    ESP_LOGI(PINS_TAG, "Reception GPIO Setup Complete, %d branch(es)", RX_DIVERSITY_BRANCHES);
+}
+
+rx_diversity_t* phy_pins_diversity(void) {
+    return &pins_diversity;
+}
+
+esp_err_t phy_pins_setup_link(phy_pins_link_t* pins) {
+    gpio_config_t tx_conf = {
+        .mode = GPIO_MODE_OUTPUT,
+        .pin_bit_mask = 1ULL << pins->tx_gpio,
+    };
+    gpio_config_t rx_conf = {
+        .intr_type = GPIO_INTR_NEGEDGE,
+        .pin_bit_mask = 1ULL << pins->rx_gpio,
+        .mode = GPIO_MODE_INPUT,
+        .pull_down_en = 1,
+    };
+    ESP_ERROR_CHECK(gpio_config(&tx_conf));
+    ESP_ERROR_CHECK(gpio_config(&rx_conf));
+
+#if RX_GLITCH_FILTER_ENABLE
+    gpio_pin_glitch_filter_config_t glitch_filter_config = {
+        .clk_src = GLITCH_FILTER_CLK_SRC_DEFAULT,
+        .gpio_num = pins->rx_gpio,
+    };
+    if (gpio_new_pin_glitch_filter(&glitch_filter_config, &pins->glitch_filter) == ESP_OK) {
+        gpio_glitch_filter_enable(pins->glitch_filter);
+    } else {
+        pins->glitch_filter = NULL;
+    }
+#endif
+
+    dedic_gpio_bundle_config_t tx_bundle_config = {
+        .gpio_array = &pins->tx_gpio,
+        .array_size = 1,
+        .flags = {
+            .out_en = 1,
+        },
+    };
+    dedic_gpio_bundle_config_t rx_bundle_config = {
+        .gpio_array = &pins->rx_gpio,
+        .array_size = 1,
+        .flags = {
+            .in_en = 1,
+        },
+    };
+    esp_err_t err = dedic_gpio_new_bundle(&tx_bundle_config, &pins->tx_bundle);
+    if (err == ESP_OK) {
+        err = dedic_gpio_new_bundle(&rx_bundle_config, &pins->rx_bundle);
+    }
+    if (err != ESP_OK) {
+        phy_pins_release_link(pins);
+        return err;
+    }
+    ESP_ERROR_CHECK(dedic_gpio_get_out_mask(pins->tx_bundle, &pins->tx_mask));
+    ESP_ERROR_CHECK(dedic_gpio_get_in_offset(pins->rx_bundle, &pins->rx_shift));
+
+    // The service is already installed when the RX task set up the main RX pins
+    err = gpio_install_isr_service(GPIO_ISR_FLAGS);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        phy_pins_release_link(pins);
+        return err;
+    }
+    ESP_LOGI(PINS_TAG, "Link GPIO Setup Complete, TX %d, RX %d", pins->tx_gpio, pins->rx_gpio);
+    return ESP_OK;
+}
+
+void phy_pins_release_link(phy_pins_link_t* pins) {
+    if (pins->tx_bundle != NULL) {
+        dedic_gpio_del_bundle(pins->tx_bundle);
+        pins->tx_bundle = NULL;
+    }
+    if (pins->rx_bundle != NULL) {
+        dedic_gpio_del_bundle(pins->rx_bundle);
+        pins->rx_bundle = NULL;
+    }
+    if (pins->glitch_filter != NULL) {
+        gpio_glitch_filter_disable(pins->glitch_filter);
+        gpio_del_glitch_filter(pins->glitch_filter);
+        pins->glitch_filter = NULL;
+    }
+}
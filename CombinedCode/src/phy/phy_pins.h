@@ -0,0 +1,98 @@
+/**
+ * @file phy_pins.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the optical pin setup shared by the PHY backends for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the setup of the TX and RX pins. The pins are driven and
+ * read through dedicated GPIO bundles, which only work on the core that created them, so each side must be
+ * set up from the task running on its core. Every backend using the pins calls these functions; only the
+ * first call configures the hardware.
+ *
+ * With RX_DIVERSITY_BRANCHES above 1, every photodiode input joins the RX bundle and the backends reduce
+ * each read to one level with the shared diversity combiner.
+ *
+ * The extra links of vlc_link.h have one TX and one RX pin each, in bundles of their own on the core of the link.
+ */
+
+#ifndef PHY_PINS_H
+#define PHY_PINS_H
+
+#include <stdbool.h>
+#include "esp_log.h"
+#include "driver/dedic_gpio.h"
+#include "driver/gpio.h"
+#include "driver/gpio_filter.h"
+#include "esp_cpu.h"
+#include "esp_rom_gpio.h"
+#include "soc/dedic_gpio_periph.h"
+
+#include "common_utils/config.h"
+#include "reception/RX_diversity.h"
+
+/**
+ * @brief Pins of an extra link and their dedicated GPIO bundles.
+ */
+typedef struct {
+    int tx_gpio;                            /**< TX pin */
+    int rx_gpio;                            /**< RX pin */
+    dedic_gpio_bundle_handle_t tx_bundle;   /**< Bundle driving the TX pin */
+    dedic_gpio_bundle_handle_t rx_bundle;   /**< Bundle reading the RX pin */
+    gpio_glitch_filter_handle_t glitch_filter; /**< Glitch filter of the RX pin, if any */
+    uint32_t tx_mask;                       /**< Output channel of the TX pin, as a mask */
+    uint32_t rx_shift;                      /**< Input channel of the RX pin */
+} phy_pins_link_t;
+
+/** @brief GPIO pins of the receive-diversity branches, branch 0 first. */
+extern const int phy_pins_rx_gpios[RX_DIVERSITY_MAX_BRANCHES];
+
+/**
+ * @brief Sets up the TX pin and its dedicated GPIO bundle, once.
+ */
+void phy_pins_setup_tx(void);
+
+/**
+ * @brief Routes the TX pin back to its dedicated GPIO bundle.
+ *
+ * Backends driving the TX pin from another peripheral take it over through the GPIO matrix, and call this
+ * function to hand it back when they become inactive. Does nothing before phy_pins_setup_tx().
+ */
+void phy_pins_reclaim_tx(void);
+
+/**
+ * @brief Sets up the RX pins, their glitch filters, the dedicated GPIO bundle and the GPIO ISR service, once.
+ *
+ * The falling-edge interrupt type is configured, but no handler is added.
+ */
+void phy_pins_setup_rx(void);
+
+/**
+ * @brief Gets the diversity combiner shared by the backends sampling the RX pins.
+ *
+ * It combines with majority voting from three branches and with selection for two.
+ *
+ * @return Pointer to the combiner.
+ */
+rx_diversity_t* phy_pins_diversity(void);
+
+/**
+ * @brief Sets up the pins of an extra link on the calling core.
+ *
+ * The TX pin idles high and the RX pin gets a falling-edge interrupt type and a glitch filter, but no handler.
+ *
+ * @param pins Pins of the link, tx_gpio and rx_gpio set; the bundles and channels are filled in.
+ * @return ESP_OK on success, or the error of the dedicated GPIO driver if no channel is free.
+ */
+esp_err_t phy_pins_setup_link(phy_pins_link_t* pins);
+
+/**
+ * @brief Frees the bundles and glitch filter of an extra link.
+ *
+ * @param pins Pins of the link.
+ */
+void phy_pins_release_link(phy_pins_link_t* pins);
+
+#endif /* PHY_PINS_H */
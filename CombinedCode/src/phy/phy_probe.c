@@ -0,0 +1,241 @@
+/**
+ * @file phy_probe.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the capability probe picking the bit rate for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the measurement of the ISR entry latency on a spare timer, the timing of the key
+ * generator and of the ring buffer, and the application of the resulting bit period to the backends.
+ */
+
+#include "phy_probe.h"
+
+/** @brief Tag for logging probe messages */
+static const char *PROBE_TAG = "PHY_PROBE";
+
+/** @brief Budget of the last probe. */
+static rate_probe_result_t probe_last;
+
+/** @brief probe_last holds a budget. */
+static bool probe_valid = false;
+
+/** @brief Task waiting for the latency measurement. */
+static TaskHandle_t probe_task = NULL;
+
+/** @brief Alarms served by the latency measurement. */
+static volatile uint32_t probe_isr_samples;
+
+/** @brief Sum of the timer ticks from each alarm to its callback. */
+static volatile uint64_t probe_isr_total_ticks;
+
+/** @brief Most timer ticks from an alarm to its callback. */
+static volatile uint32_t probe_isr_max_ticks;
+
+/**
+ * @brief Callback of the latency measurement timer.
+ *
+ * The alarm reloads the counter to 0, so its value on entry is the time since the alarm.
+ *
+ * @param timer Timer handle.
+ * @param edata Pointer to alarm event data (unused).
+ * @param arg User-provided argument (unused).
+ * @return true if the waiting task was woken.
+ */
+static bool IRAM_ATTR probe_timer_ISR(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    BaseType_t woken = pdFALSE;
+    uint64_t ticks = 0;
+    gptimer_get_raw_count(timer, &ticks);
+    probe_isr_total_ticks += ticks;
+    if (ticks > probe_isr_max_ticks) {
+        probe_isr_max_ticks = (uint32_t)ticks;
+    }
+    if (++probe_isr_samples == RATE_PROBE_ISR_SAMPLES) {
+        gptimer_stop(timer);
+        vTaskNotifyGiveFromISR(probe_task, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+/**
+ * @brief Measures the ISR entry latency over RATE_PROBE_ISR_SAMPLES alarms of a spare timer.
+ *
+ * @param costs Pointer to store the latencies in.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if all timers are in use, ESP_ERR_TIMEOUT if the alarms stalled.
+ */
+static esp_err_t probe_isr_entry(rate_probe_costs_t* costs) {
+    gptimer_handle_t timer;
+    gptimer_config_t timer_config = {
+        .clk_src = TIMER_CLOCK_SOURCE,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = RATE_PROBE_TIMER_HZ,
+        .intr_priority = TIMER_INTERRUPTION_PRIORITY,
+    };
+    esp_err_t err = gptimer_new_timer(&timer_config, &timer);
+    if (err != ESP_OK) {
+        return err;
+    }
+    gptimer_alarm_config_t alarm_config = {
+        .reload_count = 0,
+        .alarm_count = RATE_PROBE_ISR_PERIOD_TICKS,
+        .flags.auto_reload_on_alarm = true,
+    };
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(timer, &alarm_config));
+    gptimer_event_callbacks_t callbacks = {
+        .on_alarm = probe_timer_ISR,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(timer, &callbacks, NULL));
+    ESP_ERROR_CHECK(gptimer_enable(timer));
+
+    probe_task = xTaskGetCurrentTaskHandle();
+    probe_isr_samples = 0;
+    probe_isr_total_ticks = 0;
+    probe_isr_max_ticks = 0;
+    ulTaskNotifyTake(pdTRUE, 0);
+    ESP_ERROR_CHECK(gptimer_start(timer));
+    uint32_t timeout_ms = (uint32_t)((uint64_t)RATE_PROBE_ISR_SAMPLES * RATE_PROBE_ISR_PERIOD_TICKS * 1000 / RATE_PROBE_TIMER_HZ) + 100;
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) == 0) {
+        gptimer_stop(timer);
+        err = ESP_ERR_TIMEOUT;
+    }
+    gptimer_disable(timer);
+    gptimer_del_timer(timer);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // Timer ticks to cycles at the probe frequency
+    uint64_t cpu_hz = (uint64_t)costs->cpu_mhz * 1000000;
+    costs->isr_entry_cycles = (uint32_t)(probe_isr_total_ticks * cpu_hz / RATE_PROBE_TIMER_HZ / RATE_PROBE_ISR_SAMPLES);
+    costs->isr_entry_max_cycles = (uint32_t)((uint64_t)probe_isr_max_ticks * cpu_hz / RATE_PROBE_TIMER_HZ);
+    return ESP_OK;
+}
+
+/**
+ * @brief Times the key generator.
+ *
+ * @param vars Keystream to advance.
+ * @return Cycles per key.
+ */
+static uint32_t probe_keygen(encryption_vars_t* vars) {
+    esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < RATE_PROBE_KEYGEN_WORDS; i++) {
+        key_generator(vars);
+    }
+    return (uint32_t)((esp_cpu_cycle_count_t)(esp_cpu_get_cycle_count() - start) / RATE_PROBE_KEYGEN_WORDS);
+}
+
+/**
+ * @brief Times the key generator of the configured map, or of every map, keeping the slowest.
+ *
+ * @param vars Keystream whose map is timed, or NULL.
+ * @param costs Pointer to store the cycles per key and the map in.
+ */
+static void probe_keygen_map(const encryption_vars_t* vars, rate_probe_costs_t* costs) {
+    static const map_type_t maps[] = {MAP_DUFFING, MAP_LOGISTIC, MAP_2D_LOGISTIC};
+    encryption_vars_t clone;
+    msws32_var_t clone_msws32;
+
+    if (vars != NULL) {
+        key_generator_clone(&clone, &clone_msws32, vars);
+        costs->keygen_cycles = probe_keygen(&clone);
+        costs->map = vars->type;
+        return;
+    }
+    costs->keygen_cycles = 0;
+    for (size_t m = 0; m < sizeof(maps) / sizeof(maps[0]); m++) {
+        // Initial conditions within the range of every map
+        clone_msws32 = (msws32_var_t){0};
+        clone = (encryption_vars_t){
+            .type = maps[m],
+            .chaotic_map1 = { .x = 0.3, .y = 0.4, .iterations = 200 },
+            .chaotic_map2 = { .x = 0.6, .y = 0.2, .iterations = 200 },
+            .msws32_variables = &clone_msws32,
+        };
+        key_generator_setup(&clone);
+        uint32_t cycles = probe_keygen(&clone);
+        if (cycles > costs->keygen_cycles) {
+            costs->keygen_cycles = cycles;
+            costs->map = maps[m];
+        }
+    }
+}
+
+/**
+ * @brief Times a push and a pop of a ring buffer, each under a spinlock as on the TX side.
+ *
+ * @param costs Pointer to store the cycles in.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the ring buffer could not be created.
+ */
+static esp_err_t probe_queue(rate_probe_costs_t* costs) {
+    RingBuffer* rb = createRingBuffer();
+    if (rb == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    volatile uint32_t value;
+    esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+    for (uint32_t i = 0; i < RATE_PROBE_QUEUE_OPS; i++) {
+        portENTER_CRITICAL(&lock);
+        ringBufferPush(rb, i);
+        portEXIT_CRITICAL(&lock);
+        portENTER_CRITICAL(&lock);
+        ringBufferPop(rb, &value);
+        portEXIT_CRITICAL(&lock);
+    }
+    costs->queue_cycles = (uint32_t)((esp_cpu_cycle_count_t)(esp_cpu_get_cycle_count() - start) / RATE_PROBE_QUEUE_OPS);
+    freeRingBuffer(rb);
+    return ESP_OK;
+}
+
+esp_err_t phy_probe_run(const encryption_vars_t* vars, rate_probe_result_t* result) {
+    rate_probe_costs_t costs = { .cpu_mhz = POWER_CPU_MAX_MHZ };
+
+    power_burst_begin();
+    esp_err_t err = probe_isr_entry(&costs);
+    if (err != ESP_OK) {
+        if (!probe_valid) {
+            power_burst_end();
+            return err;
+        }
+        ESP_LOGW(PROBE_TAG, "ISR latency not measured (%s), keeping the last one", esp_err_to_name(err));
+        costs.isr_entry_cycles = probe_last.costs.isr_entry_cycles;
+        costs.isr_entry_max_cycles = probe_last.costs.isr_entry_max_cycles;
+    }
+    probe_keygen_map(vars, &costs);
+    err = probe_queue(&costs);
+    power_burst_end();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    rate_probe_compute(&costs, result);
+    probe_last = *result;
+    probe_valid = true;
+    ESP_LOGI(PROBE_TAG, "ISR entry %lu cycles (max %lu), %s key %lu cycles, queue %lu cycles: %lu us/bit (%s bound)",
+             (unsigned long)costs.isr_entry_cycles, (unsigned long)costs.isr_entry_max_cycles, rate_probe_map_name(costs.map),
+             (unsigned long)costs.keygen_cycles, (unsigned long)costs.queue_cycles,
+             (unsigned long)result->bit_period_micros, rate_probe_limit_name(result->limit));
+    return ESP_OK;
+}
+
+esp_err_t phy_probe_apply(uint32_t bit_period_micros) {
+    esp_err_t result = ESP_OK;
+    for (size_t i = 0; phy_get(i) != NULL; i++) {
+        const vlc_phy_ops_t* phy = phy_get(i);
+        esp_err_t err = phy->set_rate(bit_period_micros);
+        if (err != ESP_OK) {
+            ESP_LOGW(PROBE_TAG, "%s kept its bit period: %s", phy->name, esp_err_to_name(err));
+            if (phy == phy_active()) {
+                result = err;
+            }
+        }
+    }
+    return result;
+}
+
+const rate_probe_result_t* phy_probe_last(void) {
+    return probe_valid ? &probe_last : NULL;
+}
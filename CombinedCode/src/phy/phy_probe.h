@@ -0,0 +1,67 @@
+/**
+ * @file phy_probe.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the capability probe picking the bit rate for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the self-test measuring the costs of rate_probe.h on target:
+ * - The ISR entry latency, from the alarm of a spare gptimer counting at RATE_PROBE_TIMER_HZ to its callback,
+ *   which reads how far the counter went since the alarm reloaded it.
+ * - The cycles per key of the configured map, on a clone of its keystream, or of the slowest map when no keys
+ *   are set yet.
+ * - The cycles of a push and a pop of a ring buffer under the lock the TX side takes.
+ *
+ * The probe runs on the core the ISRs it measures run on, at POWER_CPU_MAX_MHZ. At boot, the RX task probes
+ * before initialising its side and applies the bit period it finds to every backend.
+ */
+
+#ifndef PHY_PROBE_H
+#define PHY_PROBE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "common_utils/config.h"
+#include "common_utils/encryption.h"
+#include "common_utils/power.h"
+#include "common_utils/rate_probe.h"
+#include "common_utils/ring_buffer.h"
+#include "phy/phy.h"
+
+/**
+ * @brief Measures the costs of the hot paths and computes the shortest sustainable bit period.
+ *
+ * When no timer is free, the ISR entry latency of the previous probe is kept; without one, the probe fails.
+ *
+ * @param vars Keystream whose map is timed, left untouched, or NULL for the slowest map.
+ * @param result Pointer to store the budget, also kept for phy_probe_last().
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no timer is free and no latency was measured before,
+ *         ESP_ERR_NO_MEM if the ring buffer could not be created.
+ */
+esp_err_t phy_probe_run(const encryption_vars_t* vars, rate_probe_result_t* result);
+
+/**
+ * @brief Sets the bit period of every backend, TX and RX timers alike.
+ *
+ * @param bit_period_micros New bit period, in microseconds.
+ * @return ESP_OK if the active backend took it, or its error; other backends only log theirs.
+ */
+esp_err_t phy_probe_apply(uint32_t bit_period_micros);
+
+/**
+ * @brief Gets the budget of the last probe.
+ *
+ * @return The budget, or NULL before the first probe.
+ */
+const rate_probe_result_t* phy_probe_last(void);
+
+#endif /* PHY_PROBE_H */
@@ -0,0 +1,368 @@
+/**
+ * @file phy_rmt.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the RMT PHY backend with TX pre-emphasis for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the rmt backend. The TX task renders a whole frame before
+ * handing it to the RMT driver, which refills the channel memory from it while the frame is sent.
+ */
+
+#include "phy_rmt.h"
+
+/** @brief Tag for logging RMT PHY messages */
+static const char *RMT_PHY_TAG = "PHY_RMT";
+
+/** @brief State of the backend. */
+static phy_rmt_ctx_t rmt_ctx = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+    .led = { .rise_ns = TX_SHAPING_LED_RISE_NS, .fall_ns = TX_SHAPING_LED_FALL_NS },
+    .bit_period_micros = TX_PERIOD_MICROS,
+    .stats = { .bit_period_micros = TX_PERIOD_MICROS },
+};
+
+/**
+ * @brief Converts a bit period to RMT ticks.
+ *
+ * @param bit_period_micros Bit period, in microseconds.
+ * @return Number of ticks of PHY_RMT_RESOLUTION_HZ in one bit period.
+ */
+static inline uint64_t rmt_bit_ticks(uint32_t bit_period_micros) {
+    return (uint64_t)bit_period_micros * (PHY_RMT_RESOLUTION_HZ / 1000000);
+}
+
+/**
+ * @brief Callback of the RMT driver at the end of a frame.
+ *
+ * @param channel RMT channel.
+ * @param edata Event data (unused).
+ * @param user_ctx Pointer to the backend state.
+ * @return false, no task is woken.
+ */
+static bool IRAM_ATTR rmt_tx_done(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata, void *user_ctx) {
+    ((phy_rmt_ctx_t*)user_ctx)->in_transmission = false;
+    return false;
+}
+
+/**
+ * @brief Routes the TX pin to a new RMT channel. Must be called with the mutex held.
+ *
+ * @param ctx Pointer to the backend state.
+ */
+static void rmt_claim_pin(phy_rmt_ctx_t* ctx) {
+    if (ctx->channel != NULL) {
+        return;
+    }
+    rmt_tx_channel_config_t channel_config = {
+        .gpio_num = TX_GPIO_PIN_NUM,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = PHY_RMT_RESOLUTION_HZ,
+        .mem_block_symbols = PHY_RMT_MEM_BLOCK_SYMBOLS,
+        .trans_queue_depth = 1,
+    };
+    ESP_ERROR_CHECK(rmt_new_tx_channel(&channel_config, &ctx->channel));
+
+    rmt_tx_event_callbacks_t callbacks = {
+        .on_trans_done = rmt_tx_done,
+    };
+    ESP_ERROR_CHECK(rmt_tx_register_event_callbacks(ctx->channel, &callbacks, ctx));
+    ESP_ERROR_CHECK(rmt_enable(ctx->channel));
+}
+
+/**
+ * @brief Deletes the RMT channel and hands the TX pin back to the dedicated GPIO bundle. Must be called with
+ * the mutex held.
+ *
+ * A frame being sent is cut short.
+ *
+ * @param ctx Pointer to the backend state.
+ */
+static void rmt_release_pin(phy_rmt_ctx_t* ctx) {
+    if (ctx->channel == NULL) {
+        return;
+    }
+    ESP_ERROR_CHECK(rmt_disable(ctx->channel));
+    ESP_ERROR_CHECK(rmt_del_channel(ctx->channel));
+    ctx->channel = NULL;
+    ctx->in_transmission = false;
+    phy_pins_reclaim_tx();
+}
+
+/**
+ * @brief Initialises one side of the backend.
+ *
+ * The RX side is the one of the sync backend, so only the TX side has work to do. The RMT channel is only
+ * created once the backend is active.
+ *
+ * @param role Side to initialise.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if a ring buffer or the mutex could not be created, or an RMT driver error.
+ */
+static esp_err_t rmt_phy_init(phy_role_t role) {
+    phy_rmt_ctx_t* ctx = &rmt_ctx;
+    if (role == PHY_ROLE_RX) {
+        return ESP_OK;
+    }
+    rx_sync_default_config(&ctx->sync_config);
+    tx_shaping_build(&ctx->shaping, ctx->bit_period_micros, (uint32_t)rmt_bit_ticks(ctx->bit_period_micros), &ctx->led, TX_SHAPING_ENABLE);
+
+    ctx->ring_tx = createRingBuffer();
+    ctx->ring_tx_lengths = createRingBuffer();
+    ctx->mutex = xSemaphoreCreateMutex();
+    if (ctx->ring_tx == NULL || ctx->ring_tx_lengths == NULL || ctx->mutex == NULL) {
+        freeRingBuffer(ctx->ring_tx);
+        freeRingBuffer(ctx->ring_tx_lengths);
+        if (ctx->mutex != NULL) {
+            vSemaphoreDelete(ctx->mutex);
+        }
+        ctx->ring_tx = NULL;
+        ctx->ring_tx_lengths = NULL;
+        ctx->mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    rmt_copy_encoder_config_t encoder_config = {};
+    esp_err_t err = rmt_new_copy_encoder(&encoder_config, &ctx->encoder);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // The bundle must exist on this core before the pin can be handed back to it
+    phy_pins_setup_tx();
+    xSemaphoreTake(ctx->mutex, portMAX_DELAY);
+    if (ctx->active) {
+        rmt_claim_pin(ctx);
+    }
+    xSemaphoreGive(ctx->mutex);
+    ESP_LOGI(RMT_PHY_TAG, "RMT Setup Complete");
+    return ESP_OK;
+}
+
+/**
+ * @brief Queues a frame for transmission.
+ *
+ * @param words Words of the frame.
+ * @param count Number of words.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE before TX init, ESP_ERR_INVALID_SIZE for an empty frame,
+ *         ESP_ERR_NO_MEM if the frame does not fit.
+ */
+static esp_err_t rmt_tx_submit_frame(const uint32_t* words, size_t count) {
+    phy_rmt_ctx_t* ctx = &rmt_ctx;
+    esp_err_t err = ESP_OK;
+    if (ctx->ring_tx == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (count == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    portENTER_CRITICAL(&ctx->lock);
+    if (ringBufferFreeSpace(ctx->ring_tx) < count || ringBufferFreeSpace(ctx->ring_tx_lengths) == 0) {
+        ctx->stats.tx_rejected += count;
+        err = ESP_ERR_NO_MEM;
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            ringBufferPush(ctx->ring_tx, words[i]);
+        }
+        ringBufferPush(ctx->ring_tx_lengths, (uint32_t)count);
+    }
+    portEXIT_CRITICAL(&ctx->lock);
+    return err;
+}
+
+/**
+ * @brief Packs the sync pattern and the words of the frame being sent into one bit array.
+ *
+ * @param ctx Pointer to the backend state.
+ * @param count Number of words of the frame, length word excluded.
+ * @return Number of bits.
+ */
+static uint32_t rmt_pack_bits(phy_rmt_ctx_t* ctx, uint32_t count) {
+    uint32_t pattern_bits = ctx->sync_config.bits;
+    uint32_t bit_count = pattern_bits + (count + 1) * RX_DECODER_WORD_BITS;
+    memset(ctx->bits_tx, 0, ((bit_count + 31) / 32) * sizeof(uint32_t));
+
+    for (uint32_t n = 0; n < pattern_bits; n++) {
+        ctx->bits_tx[n >> 5] |= (uint32_t)((ctx->sync_config.pattern >> (pattern_bits - 1 - n)) & 0x1) << (n & 31);
+    }
+    for (uint32_t w = 0; w <= count; w++) {
+        uint32_t n = pattern_bits + w * RX_DECODER_WORD_BITS;
+        ctx->bits_tx[n >> 5] |= ctx->frame_tx[w] << (n & 31);
+        if (n & 31) {
+            ctx->bits_tx[(n >> 5) + 1] |= ctx->frame_tx[w] >> (32 - (n & 31));
+        }
+    }
+    return bit_count;
+}
+
+/**
+ * @brief Renders and starts sending the next queued frame when the line is idle.
+ */
+static void rmt_tx_service(void) {
+    phy_rmt_ctx_t* ctx = &rmt_ctx;
+    uint32_t count = 0;
+    if (ctx->in_transmission || ctx->ring_tx == NULL || ctx->channel == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&ctx->lock);
+    if (ringBufferPop(ctx->ring_tx_lengths, &count)) {
+        ctx->frame_tx[0] = RX_SYNC_LENGTH_WORD(count);
+        for (uint32_t i = 1; i <= count; i++) {
+            ringBufferPop(ctx->ring_tx, &ctx->frame_tx[i]);
+        }
+    }
+    portEXIT_CRITICAL(&ctx->lock);
+    if (count == 0) {
+        return;
+    }
+
+    uint32_t bit_count = rmt_pack_bits(ctx, count);
+    xSemaphoreTake(ctx->mutex, portMAX_DELAY);
+    size_t halves = tx_shaping_render(&ctx->shaping, ctx->bits_tx, bit_count, ctx->halves_tx, PHY_RMT_MAX_HALVES);
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    if (halves != 0 && ctx->channel != NULL) {
+        rmt_transmit_config_t transmit_config = {
+            .loop_count = 0,
+            .flags.eot_level = 1,
+        };
+        ctx->in_transmission = true;
+        err = rmt_transmit(ctx->channel, ctx->encoder, ctx->halves_tx, halves * sizeof(uint16_t), &transmit_config);
+        if (err != ESP_OK) {
+            ctx->in_transmission = false;
+        }
+    }
+    xSemaphoreGive(ctx->mutex);
+
+    if (err == ESP_OK) {
+        ctx->stats.tx_words += count;
+    } else {
+        ctx->stats.tx_rejected += count;
+        ESP_LOGW(RMT_PHY_TAG, "Frame of %lu word(s) not sent: %s", (unsigned long)count, esp_err_to_name(err));
+    }
+}
+
+/**
+ * @brief Starts the sampling timer of the sync backend.
+ */
+static void rmt_rx_service(void) {
+    phy_sync_ops.rx_service();
+}
+
+/**
+ * @brief Pops words received by the sync backend.
+ *
+ * @param words Array to store the words.
+ * @param max_words Size of the array.
+ * @return Number of words popped.
+ */
+static size_t rmt_rx_poll_frames(uint32_t* words, size_t max_words) {
+    return phy_sync_ops.rx_poll_frames(words, max_words);
+}
+
+/**
+ * @brief Changes the bit period of the RMT channel and of the sync backend, and recomputes the pre-emphasis table.
+ *
+ * @param bit_period_micros New bit period, in microseconds.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a period below 4 ticks or above TX_SHAPING_MAX_RUN ticks,
+ *         ESP_ERR_INVALID_STATE while transmitting, or the error of the sync backend.
+ */
+static esp_err_t rmt_set_rate(uint32_t bit_period_micros) {
+    phy_rmt_ctx_t* ctx = &rmt_ctx;
+    uint64_t ticks = rmt_bit_ticks(bit_period_micros);
+    if (ticks < 4 || ticks > TX_SHAPING_MAX_RUN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ctx->in_transmission || (ctx->ring_tx_lengths != NULL && !ringBufferIsEmpty(ctx->ring_tx_lengths))) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = phy_sync_ops.set_rate(bit_period_micros);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    tx_shaping_t shaping;
+    tx_shaping_build(&shaping, bit_period_micros, (uint32_t)ticks, &ctx->led, ctx->shaping.enabled);
+    if (ctx->mutex != NULL) {
+        xSemaphoreTake(ctx->mutex, portMAX_DELAY);
+    }
+    ctx->shaping = shaping;
+    if (ctx->mutex != NULL) {
+        xSemaphoreGive(ctx->mutex);
+    }
+    ctx->bit_period_micros = bit_period_micros;
+    ctx->stats.bit_period_micros = bit_period_micros;
+    return ESP_OK;
+}
+
+/**
+ * @brief Takes or releases the TX pin, and starts or stops the RX side of the sync backend.
+ *
+ * @param enable true when the backend becomes active, false otherwise.
+ */
+static void rmt_phy_enable(bool enable) {
+    phy_rmt_ctx_t* ctx = &rmt_ctx;
+    phy_sync_ops.enable(enable);
+    if (ctx->mutex == NULL) {
+        // TX side not initialised yet, rmt_phy_init takes the pin
+        ctx->active = enable;
+        return;
+    }
+    xSemaphoreTake(ctx->mutex, portMAX_DELAY);
+    ctx->active = enable;
+    if (enable) {
+        rmt_claim_pin(ctx);
+    } else {
+        rmt_release_pin(ctx);
+    }
+    xSemaphoreGive(ctx->mutex);
+}
+
+/**
+ * @brief Reads the counters, the RX ones being those of the sync backend.
+ *
+ * @param stats Pointer to store the counters.
+ */
+static void rmt_get_stats(vlc_phy_stats_t* stats) {
+    phy_sync_ops.get_stats(stats);
+    stats->tx_words = rmt_ctx.stats.tx_words;
+    stats->tx_rejected = rmt_ctx.stats.tx_rejected;
+    stats->tx_interrupts = 0;
+    stats->bit_period_micros = rmt_ctx.stats.bit_period_micros;
+}
+
+void phy_rmt_set_shaping(bool enable) {
+    phy_rmt_ctx_t* ctx = &rmt_ctx;
+    tx_shaping_t shaping;
+    tx_shaping_build(&shaping, ctx->bit_period_micros, (uint32_t)rmt_bit_ticks(ctx->bit_period_micros), &ctx->led, enable);
+    if (ctx->mutex != NULL) {
+        xSemaphoreTake(ctx->mutex, portMAX_DELAY);
+    }
+    ctx->shaping = shaping;
+    if (ctx->mutex != NULL) {
+        xSemaphoreGive(ctx->mutex);
+    }
+}
+
+void phy_rmt_get_shaping(tx_shaping_t* shaping) {
+    phy_rmt_ctx_t* ctx = &rmt_ctx;
+    if (ctx->mutex != NULL) {
+        xSemaphoreTake(ctx->mutex, portMAX_DELAY);
+    }
+    *shaping = ctx->shaping;
+    if (ctx->mutex != NULL) {
+        xSemaphoreGive(ctx->mutex);
+    }
+}
+
+const vlc_phy_ops_t phy_rmt_ops = {
+    .name = "rmt",
+    .init = rmt_phy_init,
+    .tx_submit_frame = rmt_tx_submit_frame,
+    .tx_service = rmt_tx_service,
+    .rx_service = rmt_rx_service,
+    .rx_poll_frames = rmt_rx_poll_frames,
+    .set_rate = rmt_set_rate,
+    .enable = rmt_phy_enable,
+    .get_stats = rmt_get_stats,
+};
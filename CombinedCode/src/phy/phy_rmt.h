@@ -0,0 +1,84 @@
+/**
+ * @file phy_rmt.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the RMT PHY backend with TX pre-emphasis for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the rmt PHY backend, which sends sync-word frames with
+ * pre-emphasis. The edges of a shaped frame fall between bit boundaries, which the per-bit timer ISRs of the
+ * other backends cannot place, so the TX task renders every frame as RMT symbols (see TX_shaping.h) and the
+ * RMT peripheral clocks them out on the TX pin with the resolution of PHY_RMT_RESOLUTION_HZ.
+ *
+ * The line format is the one of the sync backend, whose RX side this backend uses. The RMT channel only owns
+ * the TX pin while the backend is active; it hands the pin back to the dedicated GPIO bundle when another
+ * backend is selected.
+ */
+
+#ifndef PHY_RMT_H
+#define PHY_RMT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_log.h"
+#include "driver/rmt_tx.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "common_utils/config.h"
+#include "common_utils/ring_buffer.h"
+#include "phy/phy.h"
+#include "phy/phy_pins.h"
+#include "phy/phy_sync.h"
+#include "reception/RX_sync.h"
+#include "transmission/TX_shaping.h"
+
+/** @brief Maximum number of bits of a frame, sync pattern included. */
+#define PHY_RMT_MAX_BITS (64 + (BUFFER_MAX_SIZE + 1) * RX_DECODER_WORD_BITS)
+
+/** @brief Maximum number of symbol halves of a rendered frame, with runs split at TX_SHAPING_MAX_RUN. */
+#define PHY_RMT_MAX_HALVES (2 * (PHY_RMT_MAX_BITS + 3))
+
+/**
+ * @brief State of the rmt backend.
+ */
+typedef struct {
+    rmt_channel_handle_t channel;                   /**< RMT channel, only while the backend is active */
+    rmt_encoder_handle_t encoder;                   /**< Copy encoder sending the rendered symbols */
+    SemaphoreHandle_t mutex;                        /**< Protects the channel and the shaping table, used by the TX task and the console */
+    RingBuffer* ring_tx;                            /**< Words of the frames waiting to be sent */
+    RingBuffer* ring_tx_lengths;                    /**< Number of words of every frame in ring_tx */
+    portMUX_TYPE lock;                              /**< Protects the TX rings, written by submitters and read by the TX task */
+    uint32_t frame_tx[BUFFER_MAX_SIZE + 1];         /**< Length word and words of the frame being sent */
+    uint32_t bits_tx[PHY_RMT_MAX_BITS / 32];        /**< Packed bits of the frame being sent */
+    uint16_t halves_tx[PHY_RMT_MAX_HALVES] __attribute__((aligned(4))); /**< Symbols of the frame being sent, read by the RMT driver */
+    volatile bool in_transmission;                  /**< A frame is being sent */
+    bool active;                                    /**< The backend is the active one */
+    tx_shaping_led_t led;                           /**< LED model of the pre-emphasis */
+    tx_shaping_t shaping;                           /**< Pre-emphasis table for the current bit period */
+    rx_sync_config_t sync_config;                   /**< Sync pattern */
+    uint32_t bit_period_micros;                     /**< Current bit period */
+    volatile vlc_phy_stats_t stats;                 /**< TX counters */
+} phy_rmt_ctx_t;
+
+/** @brief Operations of the rmt backend. */
+extern const vlc_phy_ops_t phy_rmt_ops;
+
+/**
+ * @brief Turns pre-emphasis on or off, taking effect from the next frame.
+ *
+ * @param enable true to shape the edges, false to send them on the bit boundaries.
+ */
+void phy_rmt_set_shaping(bool enable);
+
+/**
+ * @brief Reads the pre-emphasis table in use.
+ *
+ * @param shaping Pointer to store the table, in ticks of PHY_RMT_RESOLUTION_HZ.
+ */
+void phy_rmt_get_shaping(tx_shaping_t* shaping);
+
+#endif /* PHY_RMT_H */
@@ -0,0 +1,427 @@
+/**
+ * @file phy_sync.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the sync-word PHY backend for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the sync PHY backend. The TX task copies a whole frame
+ * out of the queue before starting the TX timer, so the TX ISR only walks a private array. The RX timer runs
+ * continuously while the backend is active and pushes every word found by the synchronizer.
+ *
+ * The ESP32-S3 has four general-purpose timers and the gptimer backend keeps two, so the timers of this backend
+ * only exist while it is active: each is created by the task of its side, whose core its ISR must run on to use
+ * the dedicated GPIO bundles, and both are freed when the backend is disabled.
+ */
+
+#include "phy_sync.h"
+
+/** @brief Tag for logging sync PHY messages */
+static const char *SYNC_PHY_TAG = "PHY_SYNC";
+
+/** @brief State of the backend. */
+static phy_sync_ctx_t sync_ctx = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+    .bit_period_micros = TX_PERIOD_MICROS,
+    .stats = { .bit_period_micros = TX_PERIOD_MICROS },
+};
+
+/**
+ * @brief Converts a bit period to timer ticks.
+ *
+ * @param bit_period_micros Bit period, in microseconds.
+ * @return Number of ticks of PHY_SYNC_RESOLUTION_HZ in one bit period.
+ */
+static inline uint64_t sync_bit_ticks(uint32_t bit_period_micros) {
+    return (uint64_t)bit_period_micros * (PHY_SYNC_RESOLUTION_HZ / TIMER_RESOLUTION_HZ);
+}
+
+/**
+ * @brief Gets the level of one bit of the frame being sent.
+ *
+ * @param ctx Pointer to the backend state.
+ * @param bit Index of the bit, the sync pattern first.
+ * @return The level (0 or 1).
+ */
+static inline uint32_t IRAM_ATTR sync_tx_level(const phy_sync_ctx_t* ctx, uint32_t bit) {
+    if (bit < ctx->sync_config.bits) {
+        return (uint32_t)(ctx->sync_config.pattern >> (ctx->sync_config.bits - 1 - bit)) & 0x1;
+    }
+    bit -= ctx->sync_config.bits;
+    return (ctx->frame_tx[bit >> 5] >> (bit & 31)) & 0x1;
+}
+
+/**
+ * @brief Interrupt Service Routine for the transmission timer.
+ *
+ * Sends the next bit of the frame. After the last bit, the line is held high for one bit period
+ * before the timer stops.
+ *
+ * @param timer Timer handle.
+ * @param edata Pointer to alarm event data.
+ * @param arg Pointer to the backend state.
+ * @return true if the ISR should yield, false otherwise.
+ */
+static bool IRAM_ATTR sync_timer_TX_ISR(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    phy_sync_ctx_t* ctx = (phy_sync_ctx_t*)arg;
+    TRACE_ISR_ENTER(TRACE_ISR_SYNC_TX_TIMER);
+    ctx->stats.tx_interrupts++;
+    uint32_t bit = ctx->bit_counter_tx;
+    if (__builtin_expect(bit < ctx->bits_tx, 1)) {
+        sync_tx_level(ctx, bit) ? directWriteHigh_single() : directWriteLow_single();
+    } else if (bit == ctx->bits_tx) {
+        directWriteHigh_single();
+    } else {
+        gptimer_stop(ctx->timer_tx);
+        ctx->in_transmission = false;
+        TRACE_ISR_EXIT(TRACE_ISR_SYNC_TX_TIMER);
+        return true;
+    }
+    ctx->bit_counter_tx = bit + 1;
+    TRACE_ISR_EXIT(TRACE_ISR_SYNC_TX_TIMER);
+    return true;
+}
+
+/**
+ * @brief Interrupt Service Routine for the sampling timer.
+ *
+ * Feeds one sample of the RX pin to the synchronizer and queues the words it completes.
+ *
+ * @param timer Timer handle.
+ * @param edata Pointer to alarm event data.
+ * @param arg Pointer to the backend state.
+ * @return true if the ISR should yield, false otherwise.
+ */
+static bool IRAM_ATTR sync_timer_RX_ISR(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    phy_sync_ctx_t* ctx = (phy_sync_ctx_t*)arg;
+    uint32_t start = esp_cpu_get_cycle_count();
+    TRACE_ISR_ENTER(TRACE_ISR_SYNC_RX_TIMER);
+    ctx->stats.rx_interrupts++;
+    rx_sync_status_t status = rx_sync_sample(&ctx->sync_rx, rx_diversity_combine(ctx->diversity, gpioDirectRead()));
+    if (__builtin_expect(status != RX_SYNC_BUSY, 0)) {
+        if (status == RX_SYNC_WORD || status == RX_SYNC_FRAME_END) {
+            if (spsc_queue_push(&ctx->rx_queue, ctx->sync_rx.word)) {
+                uint32_t queued = spsc_queue_count(&ctx->rx_queue);
+                ctx->stats.rx_words++;
+                if (queued > ctx->stats.rx_queue_peak) {
+                    ctx->stats.rx_queue_peak = queued;
+                }
+                rx_loop_notify_from_isr();
+            } else {
+                ctx->stats.rx_dropped++;
+            }
+        } else if (status == RX_SYNC_LOCKED) {
+            ctx->stats.rx_syncs++;
+        } else {
+            ctx->stats.rx_framing_errors++;
+        }
+    }
+    TRACE_ISR_EXIT(TRACE_ISR_SYNC_RX_TIMER);
+    ctx->stats.rx_isr_cycles += esp_cpu_get_cycle_count() - start;
+    return true;
+}
+
+/**
+ * @brief Creates a timer with an auto-reloading alarm.
+ *
+ * @param timer Pointer to store the timer handle.
+ * @param on_alarm Alarm callback.
+ * @param ticks Alarm period, in ticks of PHY_SYNC_RESOLUTION_HZ.
+ * @param ctx Backend state passed to the callback.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if all timers are in use, or the error of the gptimer driver.
+ */
+static esp_err_t sync_setup_timer(gptimer_handle_t* timer, gptimer_alarm_cb_t on_alarm, uint64_t ticks, phy_sync_ctx_t* ctx) {
+    gptimer_config_t timer_config = {
+        .clk_src = TIMER_CLOCK_SOURCE,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = PHY_SYNC_RESOLUTION_HZ,
+        .intr_priority = TIMER_INTERRUPTION_PRIORITY,
+    };
+    esp_err_t err = gptimer_new_timer(&timer_config, timer);
+    if (err != ESP_OK) {
+        *timer = NULL;
+        return err;
+    }
+
+    gptimer_alarm_config_t alarm_config = {
+        .reload_count = 0,
+        .alarm_count = ticks,
+        .flags.auto_reload_on_alarm = true,
+    };
+    gptimer_event_callbacks_t call_back_timer = {
+        .on_alarm = on_alarm,
+    };
+    err = gptimer_set_alarm_action(*timer, &alarm_config);
+    if (err == ESP_OK) {
+        err = gptimer_register_event_callbacks(*timer, &call_back_timer, ctx);
+    }
+    if (err == ESP_OK) {
+        err = gptimer_enable(*timer);
+    }
+    if (err != ESP_OK) {
+        gptimer_del_timer(*timer);
+        *timer = NULL;
+    }
+    return err;
+}
+
+/**
+ * @brief Stops and frees a timer.
+ *
+ * @param timer Pointer to the timer handle, cleared.
+ */
+static void sync_release_timer(gptimer_handle_t* timer) {
+    if (*timer == NULL) {
+        return;
+    }
+    gptimer_stop(*timer);
+    gptimer_disable(*timer);
+    gptimer_del_timer(*timer);
+    *timer = NULL;
+}
+
+/**
+ * @brief Initialises one side of the backend.
+ *
+ * The timers are created once the backend is active; the RX side only samples once enabled.
+ *
+ * @param role Side to initialise.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if a ring buffer or the timer lock could not be created.
+ */
+static esp_err_t sync_init(phy_role_t role) {
+    phy_sync_ctx_t* ctx = &sync_ctx;
+    rx_sync_default_config(&ctx->sync_config);
+    if (ctx->timer_lock == NULL) {
+        ctx->timer_lock = xSemaphoreCreateMutex();
+        if (ctx->timer_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (role == PHY_ROLE_TX) {
+        ctx->ring_tx = createRingBuffer();
+        ctx->ring_tx_lengths = createRingBuffer();
+        if (ctx->ring_tx == NULL || ctx->ring_tx_lengths == NULL) {
+            freeRingBuffer(ctx->ring_tx);
+            freeRingBuffer(ctx->ring_tx_lengths);
+            ctx->ring_tx = NULL;
+            ctx->ring_tx_lengths = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+        phy_pins_setup_tx();
+    } else {
+        spsc_queue_init(&ctx->rx_queue, ctx->rx_queue_buffer, RX_PIPELINE_QUEUE_SIZE);
+        rx_sync_init(&ctx->sync_rx, &ctx->sync_config, RX_SYNC_OVERSAMPLING);
+        phy_pins_setup_rx();
+        ctx->diversity = phy_pins_diversity();
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Queues a frame for transmission.
+ *
+ * @param words Words of the frame.
+ * @param count Number of words.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE before TX init, ESP_ERR_INVALID_SIZE for an empty frame,
+ *         ESP_ERR_NO_MEM if the frame does not fit.
+ */
+static esp_err_t sync_tx_submit_frame(const uint32_t* words, size_t count) {
+    phy_sync_ctx_t* ctx = &sync_ctx;
+    esp_err_t err = ESP_OK;
+    if (ctx->ring_tx == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (count == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    portENTER_CRITICAL(&ctx->lock);
+    if (ringBufferFreeSpace(ctx->ring_tx) < count || ringBufferFreeSpace(ctx->ring_tx_lengths) == 0) {
+        ctx->stats.tx_rejected += count;
+        err = ESP_ERR_NO_MEM;
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            ringBufferPush(ctx->ring_tx, words[i]);
+        }
+        ringBufferPush(ctx->ring_tx_lengths, (uint32_t)count);
+    }
+    portEXIT_CRITICAL(&ctx->lock);
+    return err;
+}
+
+/**
+ * @brief Starts sending the next queued frame when the line is idle.
+ *
+ * The first bit is written at once and the timer sends the others. The TX timer is created on the first
+ * frame after the backend became active; if no timer is free, the frame is dropped.
+ */
+static void sync_tx_service(void) {
+    phy_sync_ctx_t* ctx = &sync_ctx;
+    uint32_t count = 0;
+    if (ctx->in_transmission || ctx->ring_tx == NULL || ringBufferIsEmpty(ctx->ring_tx_lengths)) {
+        return;
+    }
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(ctx->timer_lock, portMAX_DELAY);
+    if (ctx->timer_tx == NULL) {
+        err = sync_setup_timer(&ctx->timer_tx, sync_timer_TX_ISR, sync_bit_ticks(ctx->bit_period_micros), ctx);
+    }
+    xSemaphoreGive(ctx->timer_lock);
+
+    portENTER_CRITICAL(&ctx->lock);
+    if (ringBufferPop(ctx->ring_tx_lengths, &count)) {
+        ctx->frame_tx[0] = RX_SYNC_LENGTH_WORD(count);
+        for (uint32_t i = 1; i <= count; i++) {
+            ringBufferPop(ctx->ring_tx, &ctx->frame_tx[i]);
+        }
+    }
+    portEXIT_CRITICAL(&ctx->lock);
+    if (count == 0) {
+        return;
+    }
+    if (err != ESP_OK) {
+        ctx->stats.tx_rejected += count;
+        ESP_LOGE(SYNC_PHY_TAG, "Frame dropped, no timer free: %s", esp_err_to_name(err));
+        return;
+    }
+
+    ctx->bits_tx = ctx->sync_config.bits + (count + 1) * RX_DECODER_WORD_BITS;
+    ctx->bit_counter_tx = 1;
+    ctx->in_transmission = true;
+    ctx->stats.tx_words += count;
+    sync_tx_level(ctx, 0) ? directWriteHigh_single() : directWriteLow_single();
+    gptimer_set_raw_count(ctx->timer_tx, 0);
+    gptimer_start(ctx->timer_tx);
+}
+
+/**
+ * @brief Creates the sampling timer and starts sampling, from the RX task so its ISR runs on RX_TASK_CORE.
+ *
+ * The synchronizer starts from scratch. If no timer is free, sampling stays off until the backend is enabled again.
+ */
+static void sync_rx_service(void) {
+    phy_sync_ctx_t* ctx = &sync_ctx;
+    if (ctx->rx_queue.buffer == NULL || ctx->timer_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(ctx->timer_lock, portMAX_DELAY);
+    if (ctx->rx_enabled && ctx->timer_rx == NULL) {
+        esp_err_t err = sync_setup_timer(&ctx->timer_rx, sync_timer_RX_ISR,
+                                         sync_bit_ticks(ctx->bit_period_micros) / RX_SYNC_OVERSAMPLING, ctx);
+        if (err == ESP_OK) {
+            rx_sync_reset(&ctx->sync_rx);
+            ESP_ERROR_CHECK(gptimer_set_raw_count(ctx->timer_rx, 0));
+            ESP_ERROR_CHECK(gptimer_start(ctx->timer_rx));
+        } else {
+            ctx->rx_enabled = false;
+            ESP_LOGE(SYNC_PHY_TAG, "Sampling disabled, no timer free: %s", esp_err_to_name(err));
+        }
+    }
+    xSemaphoreGive(ctx->timer_lock);
+}
+
+/**
+ * @brief Pops received words.
+ *
+ * @param words Array to store the words.
+ * @param max_words Size of the array.
+ * @return Number of words popped.
+ */
+static size_t sync_rx_poll_frames(uint32_t* words, size_t max_words) {
+    phy_sync_ctx_t* ctx = &sync_ctx;
+    size_t count = 0;
+    if (ctx->rx_queue.buffer == NULL) {
+        return 0;
+    }
+    while (count < max_words && spsc_queue_pop(&ctx->rx_queue, &words[count])) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Changes the bit period of both timers.
+ *
+ * A frame being received while the rate changes is lost.
+ *
+ * @param bit_period_micros New bit period, in microseconds.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a period too short to sample, ESP_ERR_INVALID_STATE while transmitting.
+ */
+static esp_err_t sync_set_rate(uint32_t bit_period_micros) {
+    phy_sync_ctx_t* ctx = &sync_ctx;
+    if (sync_bit_ticks(bit_period_micros) < RX_SYNC_OVERSAMPLING) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ctx->in_transmission || (ctx->ring_tx_lengths != NULL && !ringBufferIsEmpty(ctx->ring_tx_lengths))) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gptimer_alarm_config_t alarm_config = {
+        .reload_count = 0,
+        .alarm_count = sync_bit_ticks(bit_period_micros),
+        .flags.auto_reload_on_alarm = true,
+    };
+    esp_err_t err = ESP_OK;
+    if (ctx->timer_tx != NULL) {
+        err = gptimer_set_alarm_action(ctx->timer_tx, &alarm_config);
+    }
+    if (err == ESP_OK && ctx->timer_rx != NULL) {
+        alarm_config.alarm_count /= RX_SYNC_OVERSAMPLING;
+        err = gptimer_set_alarm_action(ctx->timer_rx, &alarm_config);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    ctx->bit_period_micros = bit_period_micros;
+    ctx->stats.bit_period_micros = bit_period_micros;
+    return ESP_OK;
+}
+
+/**
+ * @brief Starts or stops sampling the RX pin.
+ *
+ * Enabling only requests sampling; the RX task creates the timer in sync_rx_service(). Disabling frees both timers,
+ * the TX one only once the frame being sent is done.
+ *
+ * @param enable true to sample, false to release the RX pin.
+ */
+static void sync_rx_enable(bool enable) {
+    phy_sync_ctx_t* ctx = &sync_ctx;
+    if (ctx->rx_queue.buffer == NULL || ctx->timer_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(ctx->timer_lock, portMAX_DELAY);
+    ctx->rx_enabled = enable;
+    if (!enable) {
+        sync_release_timer(&ctx->timer_rx);
+        if (!ctx->in_transmission) {
+            sync_release_timer(&ctx->timer_tx);
+        }
+    }
+    xSemaphoreGive(ctx->timer_lock);
+    if (enable) {
+        phy_rx_service_request();
+    }
+}
+
+/**
+ * @brief Reads the counters.
+ *
+ * @param stats Pointer to store the counters.
+ */
+static void sync_get_stats(vlc_phy_stats_t* stats) {
+    *stats = *(const vlc_phy_stats_t*)&sync_ctx.stats;
+    stats->rx_queued = spsc_queue_count(&sync_ctx.rx_queue);
+}
+
+const vlc_phy_ops_t phy_sync_ops = {
+    .name = "sync",
+    .init = sync_init,
+    .tx_submit_frame = sync_tx_submit_frame,
+    .tx_service = sync_tx_service,
+    .rx_service = sync_rx_service,
+    .rx_poll_frames = sync_rx_poll_frames,
+    .set_rate = sync_set_rate,
+    .enable = sync_rx_enable,
+    .get_stats = sync_get_stats,
+};
@@ -0,0 +1,66 @@
+/**
+ * @file phy_sync.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the sync-word PHY backend for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the sync PHY backend, which sends every frame as one
+ * continuous bit stream on the TX pin: the sync pattern, the length word and the words of the frame, without
+ * start or stop bits. The RX side samples the RX pin RX_SYNC_OVERSAMPLING times per bit with a free-running
+ * timer and feeds the samples to the synchronizer of RX_sync.h. It shares the pins with the gptimer backend
+ * and only samples while it is the active backend.
+ */
+
+#ifndef PHY_SYNC_H
+#define PHY_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "common_utils/config.h"
+#include "common_utils/gpio_direct_RW.h"
+#include "common_utils/ring_buffer.h"
+#include "common_utils/spsc_queue.h"
+#include "common_utils/trace.h"
+#include "phy/phy.h"
+#include "phy/phy_pins.h"
+#include "reception/RX_loop.h"
+#include "reception/RX_sync.h"
+
+/**
+ * @brief State of the sync backend, passed to its ISRs.
+ */
+typedef struct {
+    gptimer_handle_t timer_tx;              /**< Timer clocking the TX bits */
+    gptimer_handle_t timer_rx;              /**< Timer sampling the RX pin */
+    RingBuffer* ring_tx;                    /**< Words of the frames waiting to be sent */
+    RingBuffer* ring_tx_lengths;            /**< Number of words of every frame in ring_tx */
+    spsc_queue_t rx_queue;                  /**< Words received, pushed by the sampling ISR without a lock */
+    portMUX_TYPE lock;                      /**< Protects the TX rings, written by submitters and read by the TX task */
+    SemaphoreHandle_t timer_lock;           /**< Serialises the creation and release of the timers */
+    uint32_t frame_tx[BUFFER_MAX_SIZE + 1]; /**< Length word and words of the frame being sent */
+    uint32_t bits_tx;                       /**< Number of bits of the frame being sent, sync pattern included */
+    volatile uint32_t bit_counter_tx;       /**< Bit of the frame sent next */
+    volatile bool in_transmission;          /**< A frame is being sent */
+    volatile bool rx_enabled;               /**< Sampling is requested while the backend is active */
+    rx_sync_config_t sync_config;           /**< Sync pattern and tolerance */
+    rx_sync_decoder_t sync_rx;              /**< Synchronizer of the RX side */
+    rx_diversity_t* diversity;              /**< Combiner of the RX branches */
+    uint32_t bit_period_micros;             /**< Current bit period */
+    volatile vlc_phy_stats_t stats;         /**< Counters */
+    uint32_t rx_queue_buffer[RX_PIPELINE_QUEUE_SIZE]; /**< Storage of rx_queue */
+} phy_sync_ctx_t;
+
+/** @brief Operations of the sync backend. */
+extern const vlc_phy_ops_t phy_sync_ops;
+
+#endif /* PHY_SYNC_H */
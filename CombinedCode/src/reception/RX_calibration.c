@@ -0,0 +1,204 @@
+/**
+ * @file RX_calibration.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the sampling-phase calibration for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the calibration sweep. The sweep runs in the calling task
+ * and only exchanges counters with the RX task.
+ */
+
+#include "RX_calibration.h"
+
+/** @brief Tag for logging calibration messages */
+static const char *CAL_TAG = "RX_CAL";
+
+/** @brief Flag to indicate that a sweep is running. */
+static volatile bool cal_running = false;
+
+/** @brief Training words received intact since the start of the step. */
+static volatile uint32_t cal_words_ok = 0;
+
+/** @brief Other words received since the start of the step. */
+static volatile uint32_t cal_words_bad = 0;
+
+esp_err_t rx_calibration_send_training(uint32_t words) {
+    uint32_t chunk[16];
+    for (size_t i = 0; i < sizeof(chunk) / sizeof(chunk[0]); i++) {
+        chunk[i] = RX_CAL_TRAINING_WORD;
+    }
+    uint32_t sent = 0;
+    while (sent < words) {
+        size_t count = (words - sent < sizeof(chunk) / sizeof(chunk[0])) ? words - sent : sizeof(chunk) / sizeof(chunk[0]);
+        esp_err_t err = phy_active()->tx_submit_frame(chunk, count);
+        if (err == ESP_ERR_NO_MEM) {
+            vTaskDelay(1);
+            continue;
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+        sent += count;
+        power_tx_activity();
+    }
+    return ESP_OK;
+}
+
+bool rx_calibration_running(void) {
+    return cal_running;
+}
+
+void rx_calibration_feed(const uint32_t* words, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (words[i] == RX_CAL_TRAINING_WORD) {
+            cal_words_ok++;
+        } else {
+            cal_words_bad++;
+        }
+    }
+}
+
+/**
+ * @brief Tries one sampling offset.
+ *
+ * @param phy Active PHY.
+ * @param offset_micros Sampling offset, in microseconds.
+ * @return true if RX_CAL_WORDS_PER_STEP training words arrived without any error.
+ */
+static bool calibration_step(const vlc_phy_ops_t* phy, uint32_t offset_micros) {
+    vlc_phy_stats_t before, after;
+    if (phy->set_sample_offset(offset_micros) != ESP_OK) {
+        return false;
+    }
+    vTaskDelay(pdMS_TO_TICKS(RX_CAL_SETTLE_MS));
+    phy->get_stats(&before);
+    cal_words_ok = 0;
+    cal_words_bad = 0;
+
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(RX_CAL_STEP_TIMEOUT_MS);
+    while (cal_words_ok < RX_CAL_WORDS_PER_STEP && xTaskGetTickCount() < deadline) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    phy->get_stats(&after);
+    uint32_t rejected = (after.rx_false_starts - before.rx_false_starts) + (after.rx_framing_errors - before.rx_framing_errors);
+    uint32_t ok = cal_words_ok, bad = cal_words_bad;
+    ESP_LOGI(CAL_TAG, "Offset %3lu us: %lu intact, %lu corrupted, %lu rejected", (unsigned long)offset_micros,
+             (unsigned long)ok, (unsigned long)bad, (unsigned long)rejected);
+    return ok >= RX_CAL_WORDS_PER_STEP && bad == 0 && rejected == 0;
+}
+
+esp_err_t rx_calibration_run(rx_calibration_t* calibration) {
+    const vlc_phy_ops_t* phy = phy_active();
+    bool open[RX_CAL_MAX_STEPS] = {0};
+    vlc_phy_stats_t stats;
+    if (phy->set_sample_offset == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    phy->get_stats(&stats);
+    uint32_t period = stats.bit_period_micros;
+    uint32_t step = (period + RX_CAL_MAX_STEPS - 1) / RX_CAL_MAX_STEPS;
+    uint32_t steps = (period - 1) / step;
+
+    cal_running = true;
+    for (uint32_t i = 0; i < steps; i++) {
+        open[i] = calibration_step(phy, (i + 1) * step);
+    }
+    cal_running = false;
+
+    // Widest run of error-free offsets
+    uint32_t best_start = 0, best_length = 0;
+    for (uint32_t i = 0; i < steps;) {
+        uint32_t length = 0;
+        while (i + length < steps && open[i + length]) {
+            length++;
+        }
+        if (length > best_length) {
+            best_start = i;
+            best_length = length;
+        }
+        i += length + 1;
+    }
+
+    calibration->bit_period_micros = period;
+    calibration->eye_start_micros = (best_start + 1) * step;
+    calibration->eye_width_micros = best_length * step;
+    calibration->offset_micros = best_length ? calibration->eye_start_micros + (best_length - 1) * step / 2 : period / 2;
+    phy->set_sample_offset(calibration->offset_micros);
+    return best_length ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t rx_calibration_apply(const rx_calibration_t* calibration) {
+    const vlc_phy_ops_t* phy = phy_active();
+    vlc_phy_stats_t stats;
+    if (phy->set_sample_offset == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    phy->get_stats(&stats);
+    if (stats.bit_period_micros != calibration->bit_period_micros) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return phy->set_sample_offset(calibration->offset_micros);
+}
+
+uint32_t rx_calibration_min_period(const rx_calibration_t* calibration) {
+    if (calibration->eye_width_micros == 0) {
+        return 0;
+    }
+    uint32_t closed = calibration->bit_period_micros - calibration->eye_width_micros;
+    return closed + 1;
+}
+
+/**
+ * @brief Checks a peer name for use as an NVS key.
+ *
+ * @param peer Name of the peer.
+ * @return true if the name is valid.
+ */
+static bool calibration_peer_valid(const char* peer) {
+    size_t length = (peer != NULL) ? strlen(peer) : 0;
+    return length > 0 && length <= RX_CAL_MAX_PEER_NAME;
+}
+
+esp_err_t rx_calibration_save(const char* peer, const rx_calibration_t* calibration) {
+    nvs_handle_t handle;
+    if (!calibration_peer_valid(peer)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (boot_wait(BOOT_STAGE_BIT(BOOT_STAGE_NVS), pdMS_TO_TICKS(BOOT_NVS_WAIT_MS)) != ESP_OK) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    esp_err_t err = nvs_open(RX_CAL_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_set_blob(handle, peer, calibration, sizeof(*calibration));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+esp_err_t rx_calibration_load(const char* peer, rx_calibration_t* calibration) {
+    nvs_handle_t handle;
+    size_t size = sizeof(*calibration);
+    if (!calibration_peer_valid(peer)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (boot_wait(BOOT_STAGE_BIT(BOOT_STAGE_NVS), pdMS_TO_TICKS(BOOT_NVS_WAIT_MS)) != ESP_OK) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    esp_err_t err = nvs_open(RX_CAL_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_get_blob(handle, peer, calibration, &size);
+    nvs_close(handle);
+    if (err == ESP_OK && size != sizeof(*calibration)) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    }
+    return err;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file RX_calibration.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the sampling-phase calibration for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the calibration of the instant at which the receiver samples the bits after a
+ * start edge. The middle of the bit is only best with a symmetric channel; the asymmetric rise and fall of the
+ * LED and the latency of the edge ISR move the best instant from board to board.
+ *
+ * The transmitter of the peer sends RX_CAL_TRAINING_WORD over and over, without encryption. The receiver
+ * diverts the words it receives to the calibration instead of the frame assembly, and moves its sampling
+ * offset across the bit period one microsecond at a time, in at most RX_CAL_MAX_STEPS steps. An offset is
+ * error-free when RX_CAL_WORDS_PER_STEP training words arrive intact without any false start or framing error;
+ * the offset kept is the centre of the widest run of error-free offsets, whose width is the eye width.
+ *
+ * Results are stored in NVS under the name of the peer, so a link can be brought up again without a new sweep.
+ * Only backends sampling relative to a start edge implement set_sample_offset; the others choose their phase
+ * on their own.
+ */
+
+#ifndef RX_CALIBRATION_H
+#define RX_CALIBRATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs.h"
+
+#include "common_utils/boot.h"
+#include "common_utils/config.h"
+#include "common_utils/power.h"
+#include "phy/phy.h"
+
+/** @brief Longest peer name, limited by the length of an NVS key. */
+#define RX_CAL_MAX_PEER_NAME 15
+
+/**
+ * @brief Calibration of the link with one peer.
+ */
+typedef struct {
+    uint32_t bit_period_micros;     /**< Bit period the calibration applies to */
+    uint32_t offset_micros;         /**< Sampling offset from the start edge, centre of the eye */
+    uint32_t eye_start_micros;      /**< First error-free offset */
+    uint32_t eye_width_micros;      /**< Span of consecutive error-free offsets, 0 if the eye is closed */
+} rx_calibration_t;
+
+/**
+ * @brief Sends training words through the active PHY, blocking until all are queued.
+ *
+ * @param words Number of training words.
+ * @return ESP_OK on success, or the error of the PHY.
+ */
+esp_err_t rx_calibration_send_training(uint32_t words);
+
+/**
+ * @brief Sweeps the sampling offset of the active PHY while the peer sends training words.
+ *
+ * Blocks for the whole sweep. The offset found is applied; if the eye is closed, the middle of the bit is.
+ *
+ * @param calibration Pointer to store the result.
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if the active PHY has no sampling offset,
+ *         ESP_ERR_NOT_FOUND if no offset was error-free.
+ */
+esp_err_t rx_calibration_run(rx_calibration_t* calibration);
+
+/**
+ * @brief Checks whether a sweep is running, in which case received words go to rx_calibration_feed().
+ *
+ * @return true while sweeping.
+ */
+bool rx_calibration_running(void);
+
+/**
+ * @brief Checks received words against the training word. Called by the RX task during a sweep.
+ *
+ * @param words Received words.
+ * @param count Number of words.
+ */
+void rx_calibration_feed(const uint32_t* words, size_t count);
+
+/**
+ * @brief Applies a calibration to the active PHY.
+ *
+ * @param calibration Pointer to the calibration.
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if the active PHY has no sampling offset,
+ *         ESP_ERR_INVALID_STATE if the calibration was made at another bit period.
+ */
+esp_err_t rx_calibration_apply(const rx_calibration_t* calibration);
+
+/**
+ * @brief Estimates the shortest bit period keeping the eye open, assuming the closed part of the bit
+ * does not shrink with it.
+ *
+ * @param calibration Pointer to the calibration.
+ * @return The shortest bit period in microseconds, 0 if the eye is closed.
+ */
+uint32_t rx_calibration_min_period(const rx_calibration_t* calibration);
+
+/**
+ * @brief Stores the calibration of a peer in NVS.
+ *
+ * @param peer Name of the peer, at most RX_CAL_MAX_PEER_NAME characters.
+ * @param calibration Pointer to the calibration.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an invalid name, or an NVS error.
+ */
+esp_err_t rx_calibration_save(const char* peer, const rx_calibration_t* calibration);
+
+/**
+ * @brief Reads the calibration of a peer from NVS.
+ *
+ * @param peer Name of the peer.
+ * @param calibration Pointer to store the calibration.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an invalid name, ESP_ERR_NVS_NOT_FOUND if the peer
+ *         was never calibrated, or another NVS error.
+ */
+esp_err_t rx_calibration_load(const char* peer, rx_calibration_t* calibration);
+
+#endif /* RX_CALIBRATION_H */
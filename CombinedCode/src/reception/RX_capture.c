@@ -0,0 +1,221 @@
+/**
+ * @file RX_capture.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of raw RX sample capture for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the capture mode, which samples the RX pin
+ * RX_CAPTURE_OVERSAMPLING times per bit period into a packed bit buffer and records the sample
+ * index of every edge. Buffers are placed in PSRAM when available and in internal RAM otherwise.
+ */
+
+#include "RX_capture.h"
+
+/** @brief Tag for logging capture messages */
+static const char *CAPTURE_TAG = "CAPTURE";
+
+/** @brief Number of capture timer ticks between two samples. */
+#define CAPTURE_PERIOD_TICKS ((RX_CAPTURE_RESOLUTION_HZ / TIMER_RESOLUTION_HZ) * RX_PERIOD_MICROS / RX_CAPTURE_OVERSAMPLING)
+
+/** @brief Handle for the capture timer. */
+static gptimer_handle_t timer_capture = NULL;
+
+/** @brief Header of the current capture. */
+static rx_capture_header_t capture_header;
+
+/** @brief Packed samples of the current capture. */
+static uint32_t* capture_samples = NULL;
+
+/** @brief Edge entries of the current capture. */
+static uint32_t* capture_edges = NULL;
+
+/** @brief Number of samples requested for the current capture. */
+static uint32_t capture_target = 0;
+
+/** @brief Level of the previous sample, used for edge detection. */
+static uint32_t capture_last_level = 1;
+
+/** @brief Flag to indicate if a capture is running. */
+static volatile bool capture_running = false;
+
+/**
+ * @brief Allocates a zeroed buffer, preferring PSRAM.
+ *
+ * @param size Size of the buffer in bytes.
+ * @return Pointer to the buffer, or NULL if allocation fails.
+ */
+static void* capture_alloc(size_t size) {
+    void* buffer = heap_caps_calloc(1, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer == NULL) {
+        buffer = heap_caps_calloc(1, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    return buffer;
+}
+
+/**
+ * @brief ISR for the capture timer.
+ *
+ * Stores one sample of the RX pin and records an edge entry when the level changed.
+ *
+ * @param timer Timer handle.
+ * @param edata Pointer to alarm event data.
+ * @param arg User-provided argument (unused).
+ * @return true if the ISR should yield, false otherwise.
+ */
+static bool IRAM_ATTR timer_capture_ISR(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    TRACE_ISR_ENTER(TRACE_ISR_CAPTURE_TIMER);
+    uint32_t index = capture_header.sample_count;
+    uint32_t level = (REG_READ(GPIO_IN_REG) >> RX_GPIO_PIN_NUM) & 0x1;
+
+    capture_samples[index >> 5] |= (level << (index & 31));
+    if (level != capture_last_level) {
+        if (capture_header.edge_count < RX_CAPTURE_MAX_EDGES) {
+            capture_edges[capture_header.edge_count++] = index | (level << RX_CAPTURE_EDGE_LEVEL_BIT);
+        } else {
+            capture_header.dropped_edges++;
+        }
+        capture_last_level = level;
+    }
+
+    if (__builtin_expect(++capture_header.sample_count == capture_target, 0)) {
+        gptimer_stop(timer_capture);
+        capture_running = false;
+    }
+    TRACE_ISR_EXIT(TRACE_ISR_CAPTURE_TIMER);
+    return false;
+}
+
+/**
+ * @brief Creates the capture timer.
+ *
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if all timers are in use.
+ */
+static esp_err_t capture_create_timer(void) {
+    gptimer_config_t capture_timer_config = {
+        .clk_src = TIMER_CLOCK_SOURCE,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = RX_CAPTURE_RESOLUTION_HZ,
+        .intr_priority = TIMER_INTERRUPTION_PRIORITY,
+    };
+    esp_err_t err = gptimer_new_timer(&capture_timer_config, &timer_capture);
+    if (err != ESP_OK) {
+        timer_capture = NULL;
+        return err;
+    }
+
+    gptimer_alarm_config_t alarm_config = {
+        .reload_count = 0,
+        .alarm_count = CAPTURE_PERIOD_TICKS,
+        .flags.auto_reload_on_alarm = true,
+    };
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(timer_capture, &alarm_config));
+
+    gptimer_event_callbacks_t call_back_timer = {
+        .on_alarm = timer_capture_ISR,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(timer_capture, &call_back_timer, NULL));
+
+    ESP_ERROR_CHECK(gptimer_enable(timer_capture));
+    return ESP_OK;
+}
+
+/**
+ * @brief Frees the capture timer once no capture is running.
+ */
+static void capture_release_timer(void) {
+    if (timer_capture == NULL || capture_running) {
+        return;
+    }
+    gptimer_disable(timer_capture);
+    gptimer_del_timer(timer_capture);
+    timer_capture = NULL;
+}
+
+esp_err_t RX_capture_start(uint32_t sample_count) {
+    if (capture_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    capture_release_timer();
+    esp_err_t err = capture_create_timer();
+    if (err != ESP_OK) {
+        ESP_LOGE(CAPTURE_TAG, "No timer free for the capture: %s", esp_err_to_name(err));
+        return err;
+    }
+    if (sample_count == 0 || sample_count > RX_CAPTURE_MAX_SAMPLES) {
+        sample_count = RX_CAPTURE_MAX_SAMPLES;
+    }
+
+    heap_caps_free(capture_samples);
+    heap_caps_free(capture_edges);
+    capture_samples = capture_alloc(((sample_count + 31) / 32) * sizeof(uint32_t));
+    capture_edges = capture_alloc(RX_CAPTURE_MAX_EDGES * sizeof(uint32_t));
+    if (capture_samples == NULL || capture_edges == NULL) {
+        heap_caps_free(capture_samples);
+        heap_caps_free(capture_edges);
+        capture_samples = NULL;
+        capture_edges = NULL;
+        capture_release_timer();
+        ESP_LOGE(CAPTURE_TAG, "Failed to allocate capture buffers");
+        return ESP_ERR_NO_MEM;
+    }
+
+    capture_header = (rx_capture_header_t) {
+        .magic = RX_CAPTURE_MAGIC,
+        .version = RX_CAPTURE_VERSION,
+        .oversampling = RX_CAPTURE_OVERSAMPLING,
+        .sample_period_ns = (uint32_t)(CAPTURE_PERIOD_TICKS * (1000000000ULL / RX_CAPTURE_RESOLUTION_HZ)),
+        .bit_period_ns = RX_PERIOD_MICROS * 1000,
+    };
+    capture_target = sample_count;
+    capture_last_level = 1; // The line idles high
+    capture_running = true;
+
+    ESP_ERROR_CHECK(gptimer_set_raw_count(timer_capture, 0));
+    ESP_ERROR_CHECK(gptimer_start(timer_capture));
+    ESP_LOGI(CAPTURE_TAG, "Capturing %lu samples every %lu ns", (unsigned long)sample_count,
+             (unsigned long)capture_header.sample_period_ns);
+    return ESP_OK;
+}
+
+void RX_capture_stop(void) {
+    if (capture_running) {
+        gptimer_stop(timer_capture);
+        capture_running = false;
+    }
+    capture_release_timer();
+}
+
+bool RX_capture_is_running(void) {
+    return capture_running;
+}
+
+void RX_capture_release(void) {
+    capture_release_timer();
+}
+
+const rx_capture_header_t* RX_capture_get(const uint32_t** samples, const uint32_t** edges) {
+    if (capture_samples == NULL) {
+        return NULL;
+    }
+    if (samples != NULL) *samples = capture_samples;
+    if (edges != NULL) *edges = capture_edges;
+    return &capture_header;
+}
+
+size_t RX_capture_dump(FILE* out) {
+    if (capture_samples == NULL || capture_running) {
+        return 0;
+    }
+    return rx_capture_file_write(out, &capture_header, capture_samples, capture_edges);
+}
+
+void RX_capture_edge_histogram(uint32_t bins[RX_CAPTURE_OVERSAMPLING]) {
+    if (capture_edges == NULL) {
+        memset(bins, 0, RX_CAPTURE_OVERSAMPLING * sizeof(uint32_t));
+        return;
+    }
+    rx_capture_file_edge_histogram(&capture_header, capture_edges, bins);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file RX_capture.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for raw RX sample capture for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of functions and data structures used to record
+ * the raw state of the RX pin at a multiple of the bit rate, together with the position of every
+ * edge, so that links with a high error rate can be inspected offline.
+ *
+ * The capture timer only exists from the start of a capture until the next call made after it ends, so it
+ * does not hold one of the four general-purpose timers of the ESP32-S3 in between. Its interrupt runs on the
+ * core of the caller, so the pin is read through the GPIO input register instead of a dedicated GPIO bundle.
+ *
+ * The binary dump produced by RX_capture_dump() is described in RX_capture_file.h, shared with the host tools
+ * that convert it to a waveform and replay it into the decoder.
+ */
+
+#ifndef RX_CAPTURE_H
+#define RX_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "driver/gptimer.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+
+#include "common_utils/config.h"
+#include "common_utils/trace.h"
+#include "RX_capture_file.h"
+
+/**
+ * @brief Starts a new capture, discarding the previous one.
+ *
+ * @param sample_count Number of samples to record, clamped to RX_CAPTURE_MAX_SAMPLES.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if a capture is running,
+ *         ESP_ERR_NO_MEM if the buffers could not be allocated, ESP_ERR_NOT_FOUND if all timers are in use.
+ */
+esp_err_t RX_capture_start(uint32_t sample_count);
+
+/**
+ * @brief Stops the running capture, keeping the samples recorded so far.
+ */
+void RX_capture_stop(void);
+
+/**
+ * @brief Checks if a capture is running.
+ * @return true if samples are still being recorded, false otherwise.
+ */
+bool RX_capture_is_running(void);
+
+/**
+ * @brief Frees the timer of a finished capture, keeping its samples. Does nothing while a capture is running.
+ *
+ * A capture that reached its sample count stops in its ISR, which cannot free the timer; call this once
+ * RX_capture_is_running() returned false so the timer is available to the links and backends again.
+ */
+void RX_capture_release(void);
+
+/**
+ * @brief Gets the last capture.
+ *
+ * @param samples Pointer to store the packed samples (may be NULL).
+ * @param edges Pointer to store the edge entries (may be NULL).
+ * @return Pointer to the capture header, or NULL if no capture has been made.
+ */
+const rx_capture_header_t* RX_capture_get(const uint32_t** samples, const uint32_t** edges);
+
+/**
+ * @brief Writes the last capture in binary form.
+ *
+ * @param out Stream to write to.
+ * @return Number of bytes written.
+ */
+size_t RX_capture_dump(FILE* out);
+
+/**
+ * @brief Builds a histogram of edge positions within the bit period.
+ *
+ * Each edge is folded onto one bit period relative to the first edge, which gives the
+ * crossing distribution of an eye diagram at sample resolution.
+ *
+ * @param bins Array of RX_CAPTURE_OVERSAMPLING counters to fill.
+ */
+void RX_capture_edge_histogram(uint32_t bins[RX_CAPTURE_OVERSAMPLING]);
+
+#endif /* RX_CAPTURE_H */
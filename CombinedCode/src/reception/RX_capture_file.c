@@ -0,0 +1,109 @@
+/**
+ * @file RX_capture_file.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the binary layout of RX captures for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the writer and the reader of the capture dumps, the edge listing and folding,
+ * and the conversion of the samples to a Value Change Dump for a waveform viewer.
+ */
+
+#include <string.h>
+
+#include "RX_capture_file.h"
+
+/**
+ * @brief Reads one sample of a packed trace.
+ *
+ * @param samples Packed samples.
+ * @param index Index of the sample.
+ * @return The level, 0 or 1.
+ */
+static inline uint32_t capture_file_level(const uint32_t* samples, uint32_t index) {
+    return (samples[index >> 5] >> (index & 31)) & 0x1;
+}
+
+size_t rx_capture_file_write(FILE* out, const rx_capture_header_t* header, const uint32_t* samples, const uint32_t* edges) {
+    size_t written = fwrite(header, 1, sizeof(*header), out);
+    written += fwrite(samples, 1, RX_CAPTURE_SAMPLE_WORDS(header->sample_count) * sizeof(uint32_t), out);
+    written += fwrite(edges, 1, header->edge_count * sizeof(uint32_t), out);
+    fflush(out);
+    return written;
+}
+
+esp_err_t rx_capture_file_parse(const void* data, size_t length, rx_capture_view_t* view) {
+    if (length < sizeof(rx_capture_header_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const rx_capture_header_t* header = (const rx_capture_header_t*)data;
+    if (header->magic != RX_CAPTURE_MAGIC || header->version != RX_CAPTURE_VERSION || header->oversampling == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t sample_words = RX_CAPTURE_SAMPLE_WORDS((size_t)header->sample_count);
+    if (length < sizeof(*header) + (sample_words + header->edge_count) * sizeof(uint32_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    view->header = header;
+    view->samples = (const uint32_t*)(header + 1);
+    view->edges = view->samples + sample_words;
+    return ESP_OK;
+}
+
+uint32_t rx_capture_file_find_edges(const uint32_t* samples, uint32_t sample_count, uint32_t* edges,
+                                    uint32_t max_edges, uint32_t* dropped) {
+    uint32_t count = 0;
+    uint32_t last_level = 1; // The line idles high
+    *dropped = 0;
+    for (uint32_t i = 0; i < sample_count; i++) {
+        uint32_t level = capture_file_level(samples, i);
+        if (level == last_level) {
+            continue;
+        }
+        if (count < max_edges) {
+            edges[count++] = i | (level << RX_CAPTURE_EDGE_LEVEL_BIT);
+        } else {
+            (*dropped)++;
+        }
+        last_level = level;
+    }
+    return count;
+}
+
+void rx_capture_file_edge_histogram(const rx_capture_header_t* header, const uint32_t* edges, uint32_t* bins) {
+    memset(bins, 0, header->oversampling * sizeof(uint32_t));
+    if (header->edge_count == 0) {
+        return;
+    }
+    uint32_t origin = edges[0] & ~(1UL << RX_CAPTURE_EDGE_LEVEL_BIT);
+    for (uint32_t i = 0; i < header->edge_count; i++) {
+        uint32_t index = edges[i] & ~(1UL << RX_CAPTURE_EDGE_LEVEL_BIT);
+        bins[(index - origin) % header->oversampling]++;
+    }
+}
+
+uint32_t rx_capture_file_write_vcd(FILE* out, const rx_capture_header_t* header, const uint32_t* samples) {
+    fprintf(out, "$comment Secure VLC RX capture, %lu samples every %lu ns, %lu ns per bit $end\n",
+            (unsigned long)header->sample_count, (unsigned long)header->sample_period_ns,
+            (unsigned long)header->bit_period_ns);
+    fprintf(out, "$timescale 1 ns $end\n$scope module vlc $end\n$var wire 1 ! rx $end\n$upscope $end\n"
+                 "$enddefinitions $end\n");
+    if (header->sample_count == 0) {
+        return 0;
+    }
+    uint32_t last_level = capture_file_level(samples, 0);
+    uint32_t changes = 1;
+    fprintf(out, "#0\n%lu!\n", (unsigned long)last_level);
+    for (uint32_t i = 1; i < header->sample_count; i++) {
+        uint32_t level = capture_file_level(samples, i);
+        if (level != last_level) {
+            fprintf(out, "#%llu\n%lu!\n", (unsigned long long)i * header->sample_period_ns, (unsigned long)level);
+            last_level = level;
+            changes++;
+        }
+    }
+    fprintf(out, "#%llu\n", (unsigned long long)header->sample_count * header->sample_period_ns);
+    return changes;
+}
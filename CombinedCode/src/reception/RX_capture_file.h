@@ -0,0 +1,122 @@
+/**
+ * @file RX_capture_file.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the binary layout of RX captures for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the layout of the dumps written by RX_capture_dump() and the functions shared by
+ * the board and the host tools (CombinedCode/host) to write, read, fold and convert them. The dump is laid out
+ * as follows (little endian):
+ * - one rx_capture_header_t;
+ * - (sample_count + 31) / 32 words of packed samples, sample n being bit (n % 32) of word (n / 32);
+ * - edge_count words of edges, each holding the sample index in bits 0..30 and the new level in bit 31.
+ *
+ * Nothing here depends on the ESP-IDF drivers.
+ */
+
+#ifndef RX_CAPTURE_FILE_H
+#define RX_CAPTURE_FILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "common_utils/host_compat.h"
+
+/** @brief Magic number at the start of every capture dump ("VLCC"). */
+#define RX_CAPTURE_MAGIC 0x43434C56
+
+/** @brief Version of the capture dump layout. */
+#define RX_CAPTURE_VERSION 1
+
+/** @brief Bit of an edge entry holding the level the pin changed to. */
+#define RX_CAPTURE_EDGE_LEVEL_BIT 31
+
+/** @brief Number of packed sample words of a capture of n samples. */
+#define RX_CAPTURE_SAMPLE_WORDS(n) (((n) + 31) / 32)
+
+/**
+ * @brief Header describing a capture.
+ */
+typedef struct {
+    uint32_t magic;             /**< Always RX_CAPTURE_MAGIC */
+    uint16_t version;           /**< Layout version, RX_CAPTURE_VERSION */
+    uint16_t oversampling;      /**< Samples taken per bit period */
+    uint32_t sample_period_ns;  /**< Time between two samples in nanoseconds */
+    uint32_t bit_period_ns;     /**< RX bit period in nanoseconds */
+    uint32_t sample_count;      /**< Number of valid samples */
+    uint32_t edge_count;        /**< Number of valid edge entries */
+    uint32_t dropped_edges;     /**< Edges seen after the edge buffer was full */
+} rx_capture_header_t;
+
+/**
+ * @brief Capture read from a dump, pointing into the dump.
+ */
+typedef struct {
+    const rx_capture_header_t* header;  /**< Header */
+    const uint32_t* samples;            /**< Packed samples */
+    const uint32_t* edges;              /**< Edge entries */
+} rx_capture_view_t;
+
+/**
+ * @brief Writes a capture in binary form.
+ *
+ * @param out Stream to write to.
+ * @param header Header of the capture.
+ * @param samples Packed samples.
+ * @param edges Edge entries.
+ * @return Number of bytes written.
+ */
+size_t rx_capture_file_write(FILE* out, const rx_capture_header_t* header, const uint32_t* samples, const uint32_t* edges);
+
+/**
+ * @brief Reads a dump held in memory.
+ *
+ * @param data Dump, aligned on 4 bytes.
+ * @param length Number of bytes of the dump.
+ * @param view Pointer to store the capture, pointing into data.
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the dump is shorter than its header says,
+ *         ESP_ERR_INVALID_ARG for a wrong magic number, version or oversampling.
+ */
+esp_err_t rx_capture_file_parse(const void* data, size_t length, rx_capture_view_t* view);
+
+/**
+ * @brief Lists the edges of packed samples, as the capture ISR does, from an idle high line.
+ *
+ * @param samples Packed samples.
+ * @param sample_count Number of samples.
+ * @param edges Array to store the edge entries.
+ * @param max_edges Size of the edges array.
+ * @param dropped Pointer to store the number of edges past max_edges.
+ * @return Number of edge entries stored.
+ */
+uint32_t rx_capture_file_find_edges(const uint32_t* samples, uint32_t sample_count, uint32_t* edges,
+                                    uint32_t max_edges, uint32_t* dropped);
+
+/**
+ * @brief Builds a histogram of edge positions within the bit period.
+ *
+ * Each edge is folded onto one bit period relative to the first edge, which gives the crossing distribution of
+ * an eye diagram at sample resolution.
+ *
+ * @param header Header of the capture.
+ * @param edges Edge entries.
+ * @param bins Array of header->oversampling counters to fill.
+ */
+void rx_capture_file_edge_histogram(const rx_capture_header_t* header, const uint32_t* edges, uint32_t* bins);
+
+/**
+ * @brief Writes the samples of a capture as a Value Change Dump, one rx wire with a 1 ns timescale.
+ *
+ * @param out Stream to write to.
+ * @param header Header of the capture.
+ * @param samples Packed samples.
+ * @return Number of value changes written, the initial level included.
+ */
+uint32_t rx_capture_file_write_vcd(FILE* out, const rx_capture_header_t* header, const uint32_t* samples);
+
+#endif /* RX_CAPTURE_FILE_H */
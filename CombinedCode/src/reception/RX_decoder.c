@@ -0,0 +1,124 @@
+/**
+ * @file RX_decoder.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the RX bit decoder for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file provides the external definitions for the inline decoder functions
+ * and the trace replay and synthesis functions used to exercise the decoder off-line.
+ */
+
+#include "RX_decoder.h"
+
+/**
+ * @brief External definition for rx_decoder_start function.
+ *
+ * This external definition is provided to satisfy the linker in case
+ * the function is not inlined at all call sites.
+ */
+extern inline void rx_decoder_start(rx_decoder_t* decoder);
+
+/**
+ * @brief External definition for rx_decoder_sample function.
+ *
+ * This external definition is provided to satisfy the linker in case
+ * the function is not inlined at all call sites.
+ */
+extern inline rx_decoder_status_t rx_decoder_sample(rx_decoder_t* decoder, uint32_t level);
+
+/**
+ * @brief Reads one sample from a packed trace.
+ *
+ * @param samples Packed samples.
+ * @param index Index of the sample.
+ * @return The sampled level (0 or 1).
+ */
+static inline uint32_t trace_sample(const uint32_t* samples, uint32_t index) {
+    return (samples[index >> 5] >> (index & 31)) & 0x1;
+}
+
+/**
+ * @brief Writes a level over a range of a packed trace.
+ *
+ * @param samples Zeroed packed samples.
+ * @param first Index of the first sample.
+ * @param count Number of samples.
+ * @param level Level to write (0 or 1).
+ */
+static void trace_fill(uint32_t* samples, uint32_t first, uint32_t count, uint32_t level) {
+    if (!level) {
+        return; // The trace starts zeroed
+    }
+    for (uint32_t i = first; i < first + count; i++) {
+        samples[i >> 5] |= (1UL << (i & 31));
+    }
+}
+
+size_t rx_decoder_replay(const uint32_t* samples, uint32_t sample_count, uint16_t oversampling,
+                         uint32_t* words, size_t max_words, rx_decoder_stats_t* stats) {
+    rx_decoder_t decoder;
+    size_t word_count = 0;
+    uint32_t previous = 1; // The line idles high
+    uint32_t i = 0;
+
+    while (i < sample_count && word_count < max_words) {
+        uint32_t level = trace_sample(samples, i);
+        if (!(previous && !level)) {
+            previous = level;
+            i++;
+            continue;
+        }
+
+        // Falling edge: sample at mid-bit once per bit period, as the reception timer does
+        rx_decoder_start(&decoder);
+        uint32_t sample_index = i + oversampling / 2;
+        rx_decoder_status_t status;
+        while (1) {
+            if (sample_index >= sample_count) {
+                return word_count; // Trace ends in the middle of a word
+            }
+            status = rx_decoder_sample(&decoder, trace_sample(samples, sample_index));
+            if (status != RX_DECODER_BUSY) {
+                break;
+            }
+            sample_index += oversampling;
+        }
+        if (status == RX_DECODER_DONE) {
+            words[word_count++] = decoder.value;
+            if (stats != NULL) {
+                stats->last_word_sample = sample_index;
+            }
+        } else if (stats != NULL) {
+            if (status == RX_DECODER_FALSE_START) stats->false_starts++;
+            else stats->framing_errors++;
+        }
+        previous = trace_sample(samples, sample_index);
+        i = sample_index + 1;
+    }
+    return word_count;
+}
+
+uint32_t rx_decoder_synthesize(const uint32_t* words, size_t word_count, uint16_t oversampling,
+                               uint32_t* samples, uint32_t max_samples) {
+    uint32_t bits_per_word = RX_DECODER_SYNTH_IDLE_BITS + 1 + RX_DECODER_WORD_BITS;
+    uint32_t total = (uint32_t)(word_count * bits_per_word + RX_DECODER_SYNTH_IDLE_BITS) * oversampling;
+    if (total > max_samples) {
+        return 0;
+    }
+
+    uint32_t index = 0;
+    for (size_t w = 0; w < word_count; w++) {
+        trace_fill(samples, index, RX_DECODER_SYNTH_IDLE_BITS * oversampling, 1);
+        index += RX_DECODER_SYNTH_IDLE_BITS * oversampling;
+        index += oversampling; // Start bit, low
+        for (int bit = 0; bit < RX_DECODER_WORD_BITS; bit++) {
+            trace_fill(samples, index, oversampling, (words[w] >> bit) & 0x1);
+            index += oversampling;
+        }
+    }
+    trace_fill(samples, index, RX_DECODER_SYNTH_IDLE_BITS * oversampling, 1);
+    return total;
+}
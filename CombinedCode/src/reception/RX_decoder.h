@@ -0,0 +1,140 @@
+/**
+ * @file RX_decoder.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the RX bit decoder for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the bit decoder shared by the reception ISRs and the trace replay harness.
+ * The decoder has no dependency on the ESP-IDF drivers, so the exact same logic runs on live samples,
+ * on captured traces and on synthetic traces.
+ *
+ * Every bit is sampled at mid-bit: the first sample, half a bit period after the falling edge, must
+ * still read the low start bit, and the sample after the last data bit must read the high stop bit.
+ * A word failing either check is discarded and the receiver re-arms at once.
+ */
+
+#ifndef RX_DECODER_H
+#define RX_DECODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "common_utils/host_compat.h"
+
+/** @brief Number of data bits in one received word. */
+#define RX_DECODER_WORD_BITS 32
+
+/** @brief Number of idle bit periods written before and after every word of a synthetic trace. */
+#define RX_DECODER_SYNTH_IDLE_BITS 4
+
+/** @brief Number of samples taken per word: start bit, data bits and stop bit. */
+#define RX_DECODER_WORD_SAMPLES (RX_DECODER_WORD_BITS + 2)
+
+/**
+ * @brief Structure holding the state of the bit decoder.
+ */
+typedef struct {
+    uint32_t value;       /**< Bits received so far, LSB first */
+    uint8_t bit_counter;  /**< Number of samples taken so far, start bit included */
+} rx_decoder_t;
+
+/**
+ * @brief Result of feeding one sample to the decoder.
+ */
+typedef enum {
+    RX_DECODER_BUSY,            /**< More samples are needed */
+    RX_DECODER_DONE,            /**< The word is complete and its stop bit is valid */
+    RX_DECODER_FALSE_START,     /**< The start bit was high at mid-bit, the edge was noise */
+    RX_DECODER_FRAMING_ERROR,   /**< The stop bit was low, the word is discarded */
+} rx_decoder_status_t;
+
+/**
+ * @brief Counters of rejected words.
+ */
+typedef struct {
+    uint32_t false_starts;      /**< Edges rejected at the start bit */
+    uint32_t framing_errors;    /**< Words rejected at the stop bit */
+    uint32_t last_word_sample;  /**< Sample that completed the last decoded word, set by rx_decoder_replay */
+} rx_decoder_stats_t;
+
+/**
+ * @brief Resets the decoder on a start edge.
+ *
+ * @param decoder Pointer to the decoder.
+ * @note Inline where the compiler chooses to; the external definition in RX_decoder.c is in IRAM, so the function
+ *       can be used from the reception ISRs either way.
+ */
+inline void IRAM_ATTR rx_decoder_start(rx_decoder_t* decoder);
+
+/**
+ * @brief Feeds one mid-bit sample to the decoder.
+ *
+ * The first sample checks the start bit, the next RX_DECODER_WORD_BITS are data and
+ * the last one checks the stop bit, so the line is back at its idle level when the receiver re-arms.
+ *
+ * @param decoder Pointer to the decoder.
+ * @param level Sampled level, only bit 0 is used.
+ * @return The state of the word after this sample.
+ * @note Inline where the compiler chooses to; the external definition in RX_decoder.c is in IRAM, so the function
+ *       can be used from the reception ISRs either way.
+ */
+inline rx_decoder_status_t IRAM_ATTR rx_decoder_sample(rx_decoder_t* decoder, uint32_t level);
+
+/**
+ * @brief Decodes an oversampled trace into words.
+ *
+ * Reproduces the reception path: wait for a falling edge, sample at mid-bit once per bit period
+ * after it, then wait for the next falling edge.
+ *
+ * @param samples Packed samples, sample n being bit (n % 32) of word (n / 32).
+ * @param sample_count Number of samples in the trace.
+ * @param oversampling Number of samples per bit period.
+ * @param words Array to store the decoded words.
+ * @param max_words Size of the words array.
+ * @param stats Pointer to add the rejected words to, or NULL.
+ * @return Number of decoded words.
+ */
+size_t rx_decoder_replay(const uint32_t* samples, uint32_t sample_count, uint16_t oversampling,
+                         uint32_t* words, size_t max_words, rx_decoder_stats_t* stats);
+
+/**
+ * @brief Builds an ideal oversampled trace of the transmission of some words.
+ *
+ * Each word is sent as the TX timer ISR does: idle high, one low start bit,
+ * 32 data bits LSB first and a high stop level.
+ *
+ * @param words Words to transmit.
+ * @param word_count Number of words.
+ * @param oversampling Number of samples per bit period.
+ * @param samples Zeroed array to store the packed samples.
+ * @param max_samples Capacity of the samples array in samples.
+ * @return Number of samples written, 0 if the trace does not fit.
+ */
+uint32_t rx_decoder_synthesize(const uint32_t* words, size_t word_count, uint16_t oversampling,
+                               uint32_t* samples, uint32_t max_samples);
+
+// Function definitions
+
+inline void rx_decoder_start(rx_decoder_t* decoder) {
+    decoder->value = 0;
+    decoder->bit_counter = 0;
+}
+
+inline rx_decoder_status_t rx_decoder_sample(rx_decoder_t* decoder, uint32_t level) {
+    uint8_t index = decoder->bit_counter++;
+    level &= 0x1;
+    if (__builtin_expect(index - 1U < RX_DECODER_WORD_BITS, 1)) {
+        decoder->value |= (level << (index - 1));
+        return RX_DECODER_BUSY;
+    }
+    if (index == 0) {
+        return level ? RX_DECODER_FALSE_START : RX_DECODER_BUSY;
+    }
+    return level ? RX_DECODER_DONE : RX_DECODER_FRAMING_ERROR;
+}
+
+#endif /* RX_DECODER_H */
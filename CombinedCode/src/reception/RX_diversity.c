@@ -0,0 +1,91 @@
+/**
+ * @file RX_diversity.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of receive diversity combining for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the initialisation of the combiner and the choice of the selected branch.
+ */
+
+#include "RX_diversity.h"
+
+/**
+ * @brief External definition for rx_diversity_combine function.
+ *
+ * This external definition is provided to satisfy the linker in case
+ * the function is not inlined at all call sites.
+ */
+extern inline uint32_t rx_diversity_combine(rx_diversity_t* diversity, uint32_t levels);
+
+void rx_diversity_init(rx_diversity_t* diversity, uint8_t branches, rx_diversity_mode_t mode) {
+    memset(diversity, 0, sizeof(*diversity));
+    if (branches == 0) branches = 1;
+    if (branches > RX_DIVERSITY_MAX_BRANCHES) branches = RX_DIVERSITY_MAX_BRANCHES;
+    diversity->branches = branches;
+    diversity->mode = (uint8_t)mode;
+    diversity->last = (uint8_t)((1U << branches) - 1); // The line idles high
+}
+
+void rx_diversity_set_mode(rx_diversity_t* diversity, rx_diversity_mode_t mode) {
+    diversity->requested = (uint8_t)(RX_DIVERSITY_REQUEST | mode);
+}
+
+rx_diversity_mode_t rx_diversity_get_mode(const rx_diversity_t* diversity) {
+    uint8_t requested = diversity->requested;
+    return (rx_diversity_mode_t)((requested != 0) ? (requested & ~RX_DIVERSITY_REQUEST) : diversity->mode);
+}
+
+void IRAM_ATTR rx_diversity_apply_request(rx_diversity_t* diversity) {
+    uint8_t request = diversity->requested;
+    uint8_t branches = diversity->branches;
+    diversity->mode = request & ~RX_DIVERSITY_REQUEST;
+    diversity->selected = 0;
+    diversity->last = (uint8_t)((1U << branches) - 1);
+    diversity->window_samples = 0;
+    for (uint8_t b = 0; b < RX_DIVERSITY_MAX_BRANCHES; b++) {
+        diversity->window_transitions[b] = 0;
+        diversity->stats[b].samples = 0;
+        diversity->stats[b].transitions = 0;
+        diversity->stats[b].disagreements = 0;
+        diversity->stats[b].selections = 0;
+    }
+    if (diversity->requested == request) {
+        diversity->requested = 0; // A newer request is applied on the next sample
+    }
+}
+
+void IRAM_ATTR rx_diversity_select(rx_diversity_t* diversity) {
+    uint32_t most = 0;
+    for (uint8_t b = 0; b < diversity->branches; b++) {
+        if (diversity->window_transitions[b] > most) most = diversity->window_transitions[b];
+    }
+
+    uint8_t best = diversity->selected;
+    uint32_t best_transitions = diversity->window_transitions[best];
+    for (uint8_t b = 0; b < diversity->branches; b++) {
+        uint32_t transitions = diversity->window_transitions[b];
+        bool blocked = (transitions == 0 && most != 0);
+        bool selected_blocked = (best_transitions == 0 && most != 0);
+        if (!blocked && (selected_blocked || transitions < best_transitions)) {
+            best = b;
+            best_transitions = transitions;
+        }
+        diversity->stats[b].samples += diversity->window_samples;
+        diversity->stats[b].transitions += transitions;
+        diversity->window_transitions[b] = 0;
+    }
+    diversity->selected = best;
+    diversity->stats[best].selections++;
+    diversity->window_samples = 0;
+}
+
+const char* rx_diversity_mode_name(rx_diversity_mode_t mode) {
+    switch (mode) {
+        case RX_DIVERSITY_MAJORITY: return "majority";
+        case RX_DIVERSITY_SELECT: return "select";
+        default: return "off";
+    }
+}
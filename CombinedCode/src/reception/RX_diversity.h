@@ -0,0 +1,172 @@
+/**
+ * @file RX_diversity.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for receive diversity combining for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the combiner of the receive-diversity mode, in which several photodiode inputs
+ * are read by the same dedicated GPIO read, bit b of the read being branch b. Every sample is reduced to one
+ * level before it reaches the RX decoder or the synchronizer:
+ * - off: branch 0 only, as without diversity;
+ * - majority: the level seen by most branches, ties going to the selected branch;
+ * - select: the level of the selected branch.
+ *
+ * Every RX_DIVERSITY_WINDOW_SAMPLES samples the selected branch is re-chosen. Noise adds level changes, so the
+ * branch with the fewest changes over the window is the cleanest; a branch without any change while another
+ * one saw some is considered blocked and never selected. All branches see the same transmitter at the same
+ * sampling instant, so switching branch inside a frame does not shift the bits.
+ *
+ * Like the RX decoder, the combiner has no dependency on the ESP-IDF drivers, so the same code runs in the
+ * sampling ISRs and in the link simulator.
+ *
+ * Only the sampling ISR writes the state of a combiner. Another core changes the mode by posting a request in one
+ * byte, which the ISR applies before its next sample, so the console never races with a sample being combined.
+ */
+
+#ifndef RX_DIVERSITY_H
+#define RX_DIVERSITY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "common_utils/host_compat.h"
+
+#include "common_utils/config.h"
+
+/**
+ * @brief Combining modes.
+ */
+typedef enum {
+    RX_DIVERSITY_OFF,       /**< Branch 0 only */
+    RX_DIVERSITY_MAJORITY,  /**< Per-sample majority vote */
+    RX_DIVERSITY_SELECT,    /**< Per-sample selection of the cleanest branch */
+} rx_diversity_mode_t;
+
+/**
+ * @brief Quality counters of one branch.
+ */
+typedef struct {
+    uint32_t samples;       /**< Samples taken */
+    uint32_t transitions;   /**< Level changes */
+    uint32_t disagreements; /**< Samples differing from the combined level */
+    uint32_t selections;    /**< Windows after which this branch was selected */
+} rx_diversity_branch_stats_t;
+
+/** @brief Flag of rx_diversity_t::requested marking a pending mode change. */
+#define RX_DIVERSITY_REQUEST 0x80
+
+/**
+ * @brief State of the combiner.
+ */
+typedef struct {
+    uint8_t branches;                                                   /**< Number of branches, 1 to RX_DIVERSITY_MAX_BRANCHES */
+    uint8_t mode;                                                       /**< An rx_diversity_mode_t */
+    uint8_t selected;                                                   /**< Branch used in selection mode and to break ties */
+    uint8_t last;                                                       /**< Previous levels, branch b in bit b */
+    volatile uint8_t requested;                                         /**< RX_DIVERSITY_REQUEST plus the requested mode, 0 if none */
+    uint32_t window_samples;                                            /**< Samples since the last selection */
+    uint32_t window_transitions[RX_DIVERSITY_MAX_BRANCHES];             /**< Level changes since the last selection */
+    volatile rx_diversity_branch_stats_t stats[RX_DIVERSITY_MAX_BRANCHES]; /**< Counters of each branch */
+} rx_diversity_t;
+
+/**
+ * @brief Initialises the combiner.
+ *
+ * @param diversity Pointer to the combiner.
+ * @param branches Number of branches, clamped to 1..RX_DIVERSITY_MAX_BRANCHES.
+ * @param mode Combining mode.
+ */
+void rx_diversity_init(rx_diversity_t* diversity, uint8_t branches, rx_diversity_mode_t mode);
+
+/**
+ * @brief Requests a change of the combining mode, which also clears the counters.
+ *
+ * Safe to call from any core while the combiner is sampling: the change is applied by the next
+ * rx_diversity_combine() call.
+ *
+ * @param diversity Pointer to the combiner.
+ * @param mode Combining mode.
+ */
+void rx_diversity_set_mode(rx_diversity_t* diversity, rx_diversity_mode_t mode);
+
+/**
+ * @brief Gets the combining mode, the requested one if a change is pending.
+ *
+ * @param diversity Pointer to the combiner.
+ * @return The combining mode.
+ */
+rx_diversity_mode_t rx_diversity_get_mode(const rx_diversity_t* diversity);
+
+/**
+ * @brief Applies a pending mode change, from the sampling context.
+ *
+ * @param diversity Pointer to the combiner.
+ * @note Placed in IRAM, as rx_diversity_combine() calls it from the reception ISRs.
+ */
+void rx_diversity_apply_request(rx_diversity_t* diversity);
+
+/**
+ * @brief Picks the cleanest branch of the last window and starts a new window.
+ *
+ * @param diversity Pointer to the combiner.
+ * @note Placed in IRAM, as rx_diversity_combine() calls it from the reception ISRs.
+ */
+void rx_diversity_select(rx_diversity_t* diversity);
+
+/**
+ * @brief Gets the name of a combining mode.
+ *
+ * @param mode Combining mode.
+ * @return The name, "off", "majority" or "select".
+ */
+const char* rx_diversity_mode_name(rx_diversity_mode_t mode);
+
+/**
+ * @brief Reduces the levels of all branches to one level.
+ *
+ * @param diversity Pointer to the combiner.
+ * @param levels Sampled levels, branch b in bit b; other bits are ignored.
+ * @return The combined level (0 or 1).
+ * @note Inline where the compiler chooses to; the external definition in RX_diversity.c is in IRAM, so the function
+ *       can be used from the reception ISRs either way.
+ */
+inline uint32_t IRAM_ATTR rx_diversity_combine(rx_diversity_t* diversity, uint32_t levels);
+
+// Function definitions
+
+inline uint32_t rx_diversity_combine(rx_diversity_t* diversity, uint32_t levels) {
+    if (__builtin_expect(diversity->requested != 0, 0)) {
+        rx_diversity_apply_request(diversity);
+    }
+    uint8_t branches = diversity->branches;
+    if (__builtin_expect(diversity->mode == RX_DIVERSITY_OFF || branches == 1, 1)) {
+        return levels & 0x1;
+    }
+    levels &= (1U << branches) - 1;
+
+    uint32_t level = (levels >> diversity->selected) & 0x1;
+    if (diversity->mode == RX_DIVERSITY_MAJORITY) {
+        uint32_t votes = 2 * (uint32_t)__builtin_popcount(levels);
+        if (votes != branches) {
+            level = votes > branches;
+        }
+    }
+
+    uint32_t changed = levels ^ diversity->last;
+    uint32_t disagree = levels ^ (level ? (1U << branches) - 1 : 0);
+    diversity->last = (uint8_t)levels;
+    for (uint8_t b = 0; b < branches; b++) {
+        diversity->window_transitions[b] += (changed >> b) & 0x1;
+        diversity->stats[b].disagreements += (disagree >> b) & 0x1;
+    }
+    if (__builtin_expect(++diversity->window_samples == RX_DIVERSITY_WINDOW_SAMPLES, 0)) {
+        rx_diversity_select(diversity);
+    }
+    return level;
+}
+
+#endif /* RX_DIVERSITY_H */
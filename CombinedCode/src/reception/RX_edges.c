@@ -0,0 +1,227 @@
+/**
+ * @file RX_edges.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the RX edge-timestamp decoder for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the run-length decoding of edge times into words, the bit period tracking and
+ * the replay of oversampled traces through the decoder. The tracked period is kept in 1/256 ticks.
+ */
+
+#include "RX_edges.h"
+
+/** @brief Fraction bits of the tracked bit period. */
+#define RX_EDGES_PERIOD_SHIFT 8
+
+void rx_edges_init(rx_edges_t* decoder, uint32_t period_ticks) {
+    decoder->nominal_ticks = period_ticks;
+    decoder->period_ticks = period_ticks << RX_EDGES_PERIOD_SHIFT;
+    decoder->tracked_words = 0;
+    decoder->start = 0;
+    decoder->last = 0;
+    decoder->busy = false;
+    decoder->position = 0;
+    decoder->level = 1;
+    decoder->value = 0;
+}
+
+/**
+ * @brief Rounds a time to a whole number of tracked bit periods.
+ *
+ * @param decoder Pointer to the decoder.
+ * @param elapsed Time, in ticks.
+ * @return The number of bit periods.
+ */
+static uint32_t edges_bits(const rx_edges_t* decoder, uint32_t elapsed) {
+    uint64_t scaled = ((uint64_t)elapsed << RX_EDGES_PERIOD_SHIFT) + decoder->period_ticks / 2;
+    return (uint32_t)(scaled / decoder->period_ticks);
+}
+
+/**
+ * @brief Sets the data bits from one bit boundary to another to the level after the last edge.
+ *
+ * @param decoder Pointer to the decoder.
+ * @param from First bit period, 0 being the start bit.
+ * @param to Bit period after the last one.
+ */
+static void edges_fill(rx_edges_t* decoder, uint32_t from, uint32_t to) {
+    if (!decoder->level) {
+        return;
+    }
+    if (from < 1) {
+        from = 1;
+    }
+    if (to > RX_DECODER_WORD_BITS + 1) {
+        to = RX_DECODER_WORD_BITS + 1;
+    }
+    if (to <= from) {
+        return;
+    }
+    uint32_t width = to - from;
+    uint32_t mask = (width >= 32) ? UINT32_MAX : ((1UL << width) - 1);
+    decoder->value |= mask << (from - 1);
+}
+
+/**
+ * @brief Starts a word on a falling edge.
+ *
+ * @param decoder Pointer to the decoder.
+ * @param time Time of the edge.
+ */
+static void edges_start(rx_edges_t* decoder, uint32_t time) {
+    decoder->busy = true;
+    decoder->start = time;
+    decoder->last = time;
+    decoder->position = 0;
+    decoder->level = 0;
+    decoder->value = 0;
+}
+
+/**
+ * @brief Ends the word once its stop bit is known, and pulls the tracked bit period towards the one of the word.
+ *
+ * @param decoder Pointer to the decoder.
+ * @param word Pointer to store the word if its stop bit is high.
+ * @return RX_DECODER_DONE or RX_DECODER_FRAMING_ERROR.
+ */
+static rx_decoder_status_t edges_end_word(rx_edges_t* decoder, uint32_t* word) {
+    decoder->busy = false;
+    if (!decoder->level) {
+        return RX_DECODER_FRAMING_ERROR;
+    }
+    *word = decoder->value;
+
+    if (decoder->position >= RX_EDGES_DRIFT_MIN_BITS) {
+        uint32_t elapsed = (decoder->last - decoder->start) & RX_EDGES_TIME_MASK;
+        int64_t measured = (((int64_t)elapsed << RX_EDGES_PERIOD_SHIFT) + decoder->position / 2) / decoder->position;
+        int64_t period = decoder->period_ticks;
+        // Mean of the nominal period and the first words, then a moving average
+        if (decoder->tracked_words < (1 << RX_EDGES_DRIFT_SHIFT) - 1) {
+            decoder->tracked_words++;
+        }
+        period += (measured - period) / (decoder->tracked_words + 1);
+        int64_t nominal = (int64_t)decoder->nominal_ticks << RX_EDGES_PERIOD_SHIFT;
+        int64_t limit = nominal / RX_EDGES_DRIFT_LIMIT;
+        if (period < nominal - limit) {
+            period = nominal - limit;
+        } else if (period > nominal + limit) {
+            period = nominal + limit;
+        }
+        decoder->period_ticks = (uint32_t)period;
+    }
+    return RX_DECODER_DONE;
+}
+
+rx_decoder_status_t rx_edges_push(rx_edges_t* decoder, uint32_t time, uint32_t level, uint32_t* word) {
+    level &= 0x1;
+    if (!decoder->busy) {
+        if (!level) {
+            edges_start(decoder, time);
+        }
+        return RX_DECODER_BUSY;
+    }
+
+    uint32_t bits = edges_bits(decoder, (time - decoder->last) & RX_EDGES_TIME_MASK);
+    if (bits == 0) {
+        if (decoder->position == 0 && level) {
+            decoder->busy = false;
+            return RX_DECODER_FALSE_START;
+        }
+        // Glitch: the run goes on
+        decoder->level = (uint8_t)level;
+        return RX_DECODER_BUSY;
+    }
+
+    uint32_t end = decoder->position + bits;
+    edges_fill(decoder, decoder->position, end);
+    if (end >= RX_EDGES_WORD_BITS) {
+        // The run covered the stop bit; a falling edge is the start bit of the next word
+        rx_decoder_status_t status = edges_end_word(decoder, word);
+        if (!level) {
+            edges_start(decoder, time);
+        }
+        return status;
+    }
+    decoder->position = (uint8_t)end;
+    decoder->last = time;
+    decoder->level = (uint8_t)level;
+    return RX_DECODER_BUSY;
+}
+
+rx_decoder_status_t rx_edges_flush(rx_edges_t* decoder, uint32_t now, uint32_t* word) {
+    if (!decoder->busy) {
+        return RX_DECODER_BUSY;
+    }
+    uint64_t elapsed = (uint64_t)((now - decoder->last) & RX_EDGES_TIME_MASK) << (RX_EDGES_PERIOD_SHIFT + 1);
+    uint64_t stop_middle = (uint64_t)(2 * (RX_EDGES_WORD_BITS - decoder->position) - 1) * decoder->period_ticks;
+    if (elapsed < stop_middle) {
+        return RX_DECODER_BUSY;
+    }
+    edges_fill(decoder, decoder->position, RX_EDGES_WORD_BITS);
+    return edges_end_word(decoder, word);
+}
+
+/**
+ * @brief Reads one sample of a packed trace.
+ *
+ * @param samples Packed samples.
+ * @param index Index of the sample.
+ * @return The sample (0 or 1).
+ */
+static inline uint32_t edges_trace_sample(const uint32_t* samples, uint32_t index) {
+    return (samples[index >> 5] >> (index & 31)) & 0x1;
+}
+
+/**
+ * @brief Counts a rejected word.
+ *
+ * @param status Outcome of the word.
+ * @param stats Pointer to the counters, or NULL.
+ */
+static void edges_count_rejected(rx_decoder_status_t status, rx_decoder_stats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    if (status == RX_DECODER_FALSE_START) {
+        stats->false_starts++;
+    } else if (status == RX_DECODER_FRAMING_ERROR) {
+        stats->framing_errors++;
+    }
+}
+
+size_t rx_edges_replay(const uint32_t* samples, uint32_t sample_count, uint16_t oversampling,
+                       uint32_t* words, size_t max_words, rx_decoder_stats_t* stats) {
+    rx_edges_t decoder;
+    size_t word_count = 0;
+    uint32_t previous = 1; // The line idles high
+    uint32_t word;
+
+    rx_edges_init(&decoder, oversampling);
+    for (uint32_t i = 0; i <= sample_count && word_count < max_words; i++) {
+        // The end of the trace only flushes
+        uint32_t level = (i < sample_count) ? edges_trace_sample(samples, i) : previous;
+        if (level == previous && i < sample_count) {
+            continue;
+        }
+        rx_decoder_status_t status = rx_edges_flush(&decoder, i, &word);
+        if (status == RX_DECODER_DONE) {
+            words[word_count++] = word;
+        } else {
+            edges_count_rejected(status, stats);
+        }
+        if (level == previous || word_count >= max_words) {
+            continue;
+        }
+        status = rx_edges_push(&decoder, i, level, &word);
+        if (status == RX_DECODER_DONE) {
+            words[word_count++] = word;
+        } else {
+            edges_count_rejected(status, stats);
+        }
+        previous = level;
+    }
+    return word_count;
+}
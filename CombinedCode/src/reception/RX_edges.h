@@ -0,0 +1,130 @@
+/**
+ * @file RX_edges.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the RX edge-timestamp decoder for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the decoder rebuilding words from the times of the level transitions of the RX
+ * pin instead of from mid-bit samples. Each run between two edges is rounded to a whole number of bit periods,
+ * measured from the previous edge rather than from the start edge, so timing errors do not build up over a word
+ * and an edge may be off by almost half a bit. A word ends at the first edge past its stop bit, or once the line
+ * has stayed put past the middle of the stop bit, which rx_edges_flush() checks from the current time.
+ *
+ * The bit period is tracked: after each word, the period measured between its start edge and its last edge
+ * pulls the estimate by 1 / 2^RX_EDGES_DRIFT_SHIFT, within 1 / RX_EDGES_DRIFT_LIMIT of the nominal period, so
+ * the decoder follows a transmitter clock that is slow or fast. The first words after rx_edges_init() pull it
+ * harder, by 1/2, 1/3 and so on, so the estimate is the mean of the words seen until the moving average takes over
+ * and a transmitter clock far from the nominal one is acquired within a few words.
+ *
+ * The decoder has no dependency on the ESP-IDF drivers, so the same logic runs on live edges and on traces.
+ */
+
+#ifndef RX_EDGES_H
+#define RX_EDGES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "reception/RX_decoder.h"
+
+/**
+ * @brief Weight of each word in the tracked bit period, as a power of two: after a word, the estimate moves by
+ * 1 / 2^RX_EDGES_DRIFT_SHIFT of its difference with the period of the word.
+ */
+#define RX_EDGES_DRIFT_SHIFT 3
+
+/**
+ * @brief Limit of the tracked bit period, as a fraction 1 / RX_EDGES_DRIFT_LIMIT of the nominal period on
+ * either side.
+ */
+#define RX_EDGES_DRIFT_LIMIT 8
+
+/**
+ * @brief Number of bit periods between the start edge and the last edge of a word for it to update the
+ * tracked bit period; shorter spans measure the period too coarsely.
+ */
+#define RX_EDGES_DRIFT_MIN_BITS 8
+
+/** @brief Bit periods of one word on the line: start bit, data bits and stop bit. */
+#define RX_EDGES_WORD_BITS (RX_DECODER_WORD_BITS + 2)
+
+/** @brief Mask of the timestamps, which are 31-bit so an edge fits in one 32-bit queue entry. */
+#define RX_EDGES_TIME_MASK 0x7FFFFFFFUL
+
+/** @brief Packs the time of an edge and the level after it into a queue entry. */
+#define RX_EDGES_EVENT(time, level) ((((uint32_t)(time)) << 1) | ((level) & 0x1))
+
+/** @brief Time of a queue entry. */
+#define RX_EDGES_EVENT_TIME(event) ((event) >> 1)
+
+/** @brief Level after the edge of a queue entry. */
+#define RX_EDGES_EVENT_LEVEL(event) ((event) & 0x1)
+
+/**
+ * @brief State of the edge decoder.
+ */
+typedef struct {
+    uint32_t nominal_ticks;     /**< Nominal bit period */
+    uint32_t period_ticks;      /**< Tracked bit period, in 1/256 ticks */
+    uint32_t start;             /**< Time of the start edge of the word */
+    uint32_t last;              /**< Time of the last edge of the word */
+    uint32_t value;             /**< Data bits received so far, LSB first */
+    uint8_t position;           /**< Bit boundary of the last edge, 0 being the start edge */
+    uint8_t level;              /**< Line level after the last edge */
+    uint8_t tracked_words;      /**< Words averaged into the tracked bit period, up to 2^RX_EDGES_DRIFT_SHIFT - 1 */
+    bool busy;                  /**< A word is being received */
+} rx_edges_t;
+
+/**
+ * @brief Initialises the decoder, idle, for a bit period.
+ *
+ * @param decoder Pointer to the decoder.
+ * @param period_ticks Bit period, in ticks of the timestamps.
+ */
+void rx_edges_init(rx_edges_t* decoder, uint32_t period_ticks);
+
+/**
+ * @brief Feeds one edge to the decoder.
+ *
+ * Edges less than half a bit after the previous one are glitches and only update the level; one right after the
+ * start edge is a false start.
+ *
+ * @param decoder Pointer to the decoder.
+ * @param time Time of the edge, in ticks, wrapping at RX_EDGES_TIME_MASK.
+ * @param level Line level after the edge.
+ * @param word Pointer to store the word when RX_DECODER_DONE is returned.
+ * @return RX_DECODER_BUSY if no word ended, otherwise the outcome of the word that ended.
+ */
+rx_decoder_status_t rx_edges_push(rx_edges_t* decoder, uint32_t time, uint32_t level, uint32_t* word);
+
+/**
+ * @brief Ends the word being received if the line has not moved since past the middle of its stop bit.
+ *
+ * @param decoder Pointer to the decoder.
+ * @param now Current time, in ticks, no earlier than the last edge pushed.
+ * @param word Pointer to store the word when RX_DECODER_DONE is returned.
+ * @return RX_DECODER_BUSY if no word ended, otherwise the outcome of the word that ended.
+ */
+rx_decoder_status_t rx_edges_flush(rx_edges_t* decoder, uint32_t now, uint32_t* word);
+
+/**
+ * @brief Decodes an oversampled trace into words through its edges.
+ *
+ * The edges are the level changes between consecutive samples, timed in samples.
+ *
+ * @param samples Packed samples, sample n being bit (n % 32) of word (n / 32).
+ * @param sample_count Number of samples in the trace.
+ * @param oversampling Number of samples per bit period.
+ * @param words Array to store the decoded words.
+ * @param max_words Size of the words array.
+ * @param stats Pointer to add the rejected words to, or NULL.
+ * @return Number of decoded words.
+ */
+size_t rx_edges_replay(const uint32_t* samples, uint32_t sample_count, uint16_t oversampling,
+                       uint32_t* words, size_t max_words, rx_decoder_stats_t* stats);
+
+#endif /* RX_EDGES_H */
@@ -1,50 +1,100 @@
-/**
- * @file RX_functions.h
- * @author Ricardo Jorge Dias Sampaio
- * @brief Header file for reception for the Secure VLC Project. 
- * @version 1.0
- * @date 2024-09-03
- * \par License:
- *   \ref mit_license "MIT License".
- * 
- * @details This file contains the declarations of functions and variables used for data reception,
- * including buffer management, GPIO setup, and timer configuration for the Secure VLC Project.
- */
-
-#ifndef RX_FUNCTIONS_H
-#define RX_FUNCTIONS_H
-
-#include <stdint.h>
-#include <stdbool.h>
-#include <stddef.h>
-#include <string.h>
-#include <ctype.h>
-#include "esp_log.h"
-#include "driver/dedic_gpio.h"
-#include "driver/gptimer.h"
-#include "driver/gpio.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/queue.h"
-
-#include "common_utils/config.h"
-#include "common_utils/encryption.h"
-#include "common_utils/gpio_direct_RW.h"
-#include "common_utils/ring_buffer.h"
-#include "console/console_commands.h"
-
-
-/** @brief Structure to store the encryption variables for reception */
-extern encryption_vars_t RX_encryption_vars;
-
-/**
- * @brief RX control task.
- *
- * This task sets up the GPIO for reception, initializes the reception timer,
- * waits for encryption values to be set, and then enters a loop to manage the reception buffer.
- *
- * @param pvParameters Pointer to task parameters (unused).
- */
-void RX_control_task(void *pvParameters);
-
-#endif /* RX_FUNCTIONS_H */
+/**
+ * @file RX_functions.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for reception for the Secure VLC Project. 
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ * 
+ * @details This file contains the declarations of functions and variables used for data reception:
+ * frame assembly, authentication and decryption of the words delivered by the active PHY backend.
+ */
+
+#ifndef RX_FUNCTIONS_H
+#define RX_FUNCTIONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <ctype.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#include "common_utils/boot.h"
+#include "common_utils/config.h"
+#include "common_utils/encryption.h"
+#include "common_utils/frame.h"
+#include "common_utils/power.h"
+#include "common_utils/trace.h"
+#include "console/console_commands.h"
+#include "control/ctrl_server.h"
+#include "reception/RX_calibration.h"
+#include "reception/RX_decoder.h"
+#include "reception/RX_loop.h"
+#include "phy/phy.h"
+#include "phy/phy_probe.h"
+
+
+/** @brief Structure to store the encryption variables for reception */
+extern encryption_vars_t RX_encryption_vars;
+
+/**
+ * @brief Creates the lock of the RX keystream. Called by app_main() before the tasks are created.
+ */
+void rx_keys_init(void);
+
+/**
+ * @brief Takes the lock of the RX keystream.
+ *
+ * The RX decode task holds it while it decrypts a batch of words, so RX_encryption_vars may only be read or
+ * replaced by another task while it is held.
+ */
+void rx_keys_lock(void);
+
+/**
+ * @brief Releases the lock of the RX keystream.
+ */
+void rx_keys_unlock(void);
+
+/**
+ * @brief Copies the RX keystream, in step with the RX decode task, without advancing it.
+ *
+ * @param dst Pointer to the encryption_vars_t structure to fill.
+ * @param dst_msws32 Storage for the MSWS32 variables of the copy.
+ */
+void rx_keys_clone(encryption_vars_t* dst, msws32_var_t* dst_msws32);
+
+/**
+ * @brief Counters of the frames assembled by the RX decode task.
+ */
+typedef struct {
+    uint32_t frames;            /**< Frames authenticated and delivered */
+    uint32_t rejected;          /**< Frames rejected by the authentication */
+    uint32_t invalid_headers;   /**< Words dropped as invalid frame headers */
+} rx_frame_stats_t;
+
+/**
+ * @brief Reads the frame counters.
+ *
+ * @param stats Pointer to store the counters.
+ */
+void rx_get_frame_stats(rx_frame_stats_t* stats);
+
+/**
+ * @brief RX control task.
+ *
+ * This task probes the sustainable bit rate (RATE_PROBE_BOOT_ENABLE) and logs it without applying it,
+ * initialises the RX side of every PHY backend, so the RX ISRs run on RX_TASK_CORE, starts the RX decode task
+ * on the other core, RX_DECODE_TASK_CORE, where it drains and decrypts the received words while the RX ISRs keep
+ * sampling, and then starts the RX hardware of the active backend on request.
+ *
+ * @param pvParameters Pointer to task parameters (unused).
+ */
+void RX_control_task(void *pvParameters);
+
+#endif /* RX_FUNCTIONS_H */
@@ -0,0 +1,248 @@
+/**
+ * @file RX_loop.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the hybrid interrupt / busy-poll RX loop for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the notification of the RX task by the backend ISRs, the wait of each mode,
+ * the switching between the modes and the time accounting behind the CPU share of each mode.
+ */
+
+#include "RX_loop.h"
+#include "esp_log.h"
+
+/** @brief Tag for logging RX loop messages */
+static const char *RX_LOOP_TAG = "RX_LOOP";
+
+/** @brief RX task, set by its first wait. */
+static TaskHandle_t rx_loop_task = NULL;
+
+/** @brief The RX task waits for a notification; cleared by the first word that wakes it. */
+static volatile bool rx_loop_armed = false;
+
+/** @brief Time of the first word completed since the RX task last went to poll, 0 if none. */
+static volatile int64_t rx_loop_first_micros = 0;
+
+/** @brief Time of the first word completed before the current poll, 0 if none. */
+static int64_t rx_loop_poll_first_micros = 0;
+
+/** @brief Protects the notification state and the counters. */
+static portMUX_TYPE rx_loop_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/** @brief Counters, only written by the RX task. */
+static rx_loop_stats_t rx_loop_stats;
+
+/** @brief Policy requested by the console, applied at the next poll. */
+static volatile rx_loop_policy_t rx_loop_policy = RX_LOOP_POLICY_AUTO;
+
+/** @brief Time up to which the counters are accounted. */
+static int64_t rx_loop_account_micros = 0;
+
+/** @brief The RX task ran since rx_loop_account_micros. */
+static bool rx_loop_running = false;
+
+/** @brief Start of the window over which the rate of words is measured. */
+static int64_t rx_loop_window_micros = 0;
+
+/** @brief Words received in the current window. */
+static uint32_t rx_loop_window_words = 0;
+
+/** @brief Time of the last poll that returned words. */
+static int64_t rx_loop_word_micros = 0;
+
+/** @brief Start of the current busy-poll slice. */
+static int64_t rx_loop_slice_micros = 0;
+
+/**
+ * @brief Accounts the time since the last call to the current mode. Must be called with rx_loop_lock held.
+ *
+ * @param now Current time.
+ */
+static void rx_loop_account(int64_t now) {
+    rx_loop_mode_stats_t* mode = &rx_loop_stats.modes[rx_loop_stats.mode];
+    if (rx_loop_account_micros != 0) {
+        uint64_t span = (uint64_t)(now - rx_loop_account_micros);
+        mode->elapsed_micros += span;
+        if (rx_loop_running) {
+            mode->busy_micros += span;
+        }
+    }
+    rx_loop_account_micros = now;
+}
+
+void IRAM_ATTR rx_loop_notify_from_isr(void) {
+    int64_t now = esp_timer_get_time();
+    bool wake;
+    portENTER_CRITICAL_ISR(&rx_loop_lock);
+    if (rx_loop_first_micros == 0) {
+        rx_loop_first_micros = now;
+    }
+    wake = rx_loop_armed;
+    rx_loop_armed = false;
+    portEXIT_CRITICAL_ISR(&rx_loop_lock);
+    if (wake) {
+        vTaskNotifyGiveFromISR(rx_loop_task, NULL);
+    }
+}
+
+void rx_loop_notify(void) {
+    int64_t now = esp_timer_get_time();
+    bool wake;
+    portENTER_CRITICAL(&rx_loop_lock);
+    if (rx_loop_first_micros == 0) {
+        rx_loop_first_micros = now;
+    }
+    wake = rx_loop_armed;
+    rx_loop_armed = false;
+    portEXIT_CRITICAL(&rx_loop_lock);
+    if (wake) {
+        xTaskNotifyGive(rx_loop_task);
+    }
+}
+
+void rx_loop_wake(void) {
+    if (rx_loop_task != NULL) {
+        xTaskNotifyGive(rx_loop_task);
+    }
+}
+
+void rx_loop_wait(TickType_t notify_timeout) {
+    int64_t now = esp_timer_get_time();
+    bool block = true;
+    rx_loop_task = xTaskGetCurrentTaskHandle();
+
+    portENTER_CRITICAL(&rx_loop_lock);
+    rx_loop_account(now);
+    if (rx_loop_stats.mode == RX_LOOP_POLL) {
+        block = now - rx_loop_slice_micros >= (int64_t)RX_LOOP_POLL_SLICE_MS * 1000;
+    } else {
+        // A word completed since the last poll would never notify
+        block = (rx_loop_first_micros == 0);
+        rx_loop_armed = block;
+    }
+    rx_loop_running = !block;
+    portEXIT_CRITICAL(&rx_loop_lock);
+
+    if (block) {
+        if (rx_loop_stats.mode == RX_LOOP_POLL) {
+            vTaskDelay(1);
+        } else {
+            ulTaskNotifyTake(pdTRUE, notify_timeout);
+        }
+        now = esp_timer_get_time();
+        portENTER_CRITICAL(&rx_loop_lock);
+        rx_loop_armed = false;
+        rx_loop_account(now);
+        rx_loop_running = true;
+        rx_loop_stats.modes[rx_loop_stats.mode].wakeups++;
+        rx_loop_slice_micros = now;
+        portEXIT_CRITICAL(&rx_loop_lock);
+    } else if (rx_loop_stats.mode == RX_LOOP_POLL) {
+        taskYIELD();
+    }
+
+    // Words completing from here on are left for the next poll
+    portENTER_CRITICAL(&rx_loop_lock);
+    rx_loop_poll_first_micros = rx_loop_first_micros;
+    rx_loop_first_micros = 0;
+    portEXIT_CRITICAL(&rx_loop_lock);
+}
+
+/**
+ * @brief Changes the mode. Must be called with rx_loop_lock held.
+ *
+ * @param mode New mode.
+ * @param now Current time.
+ */
+static void rx_loop_switch(rx_loop_mode_t mode, int64_t now) {
+    if (mode == rx_loop_stats.mode) {
+        return;
+    }
+    rx_loop_account(now);
+    rx_loop_stats.mode = mode;
+    rx_loop_stats.switches++;
+    rx_loop_window_micros = now;
+    rx_loop_window_words = 0;
+    rx_loop_word_micros = now;
+    rx_loop_slice_micros = now;
+}
+
+void rx_loop_complete(size_t words) {
+    int64_t now = esp_timer_get_time();
+    rx_loop_mode_t previous;
+
+    portENTER_CRITICAL(&rx_loop_lock);
+    previous = rx_loop_stats.mode;
+    rx_loop_mode_stats_t* mode = &rx_loop_stats.modes[previous];
+    mode->polls++;
+    if (words == 0) {
+        mode->empty_polls++;
+    } else {
+        mode->words += words;
+        rx_loop_word_micros = now;
+        if (rx_loop_poll_first_micros != 0) {
+            uint32_t latency = (uint32_t)(now - rx_loop_poll_first_micros);
+            mode->latency_count++;
+            mode->latency_total_micros += latency;
+            if (latency > mode->latency_max_micros) {
+                mode->latency_max_micros = latency;
+            }
+        }
+    }
+    rx_loop_poll_first_micros = 0;
+    rx_loop_window_words += words;
+
+    rx_loop_stats.policy = rx_loop_policy;
+    if (rx_loop_stats.policy == RX_LOOP_POLICY_NOTIFY) {
+        rx_loop_switch(RX_LOOP_NOTIFY, now);
+    } else if (rx_loop_stats.policy == RX_LOOP_POLICY_POLL) {
+        rx_loop_switch(RX_LOOP_POLL, now);
+    } else if (rx_loop_stats.mode == RX_LOOP_POLL) {
+        if (now - rx_loop_word_micros >= (int64_t)RX_LOOP_POLL_EXIT_MS * 1000) {
+            rx_loop_switch(RX_LOOP_NOTIFY, now);
+        }
+    } else if (now - rx_loop_window_micros >= (int64_t)RX_LOOP_WINDOW_MS * 1000) {
+        uint64_t rate = (uint64_t)rx_loop_window_words * 1000000 / (uint64_t)(now - rx_loop_window_micros);
+        rx_loop_window_micros = now;
+        rx_loop_window_words = 0;
+        if (rate >= RX_LOOP_POLL_ENTER_WPS) {
+            rx_loop_switch(RX_LOOP_POLL, now);
+        }
+    }
+    portEXIT_CRITICAL(&rx_loop_lock);
+
+    if (rx_loop_stats.mode != previous) {
+        ESP_LOGD(RX_LOOP_TAG, "RX loop: %s mode", rx_loop_mode_name(rx_loop_stats.mode));
+    }
+}
+
+void rx_loop_set_policy(rx_loop_policy_t policy) {
+    rx_loop_policy = policy;
+    // The RX task may be blocked until the next word
+    rx_loop_wake();
+}
+
+void rx_loop_get_stats(rx_loop_stats_t* stats) {
+    portENTER_CRITICAL(&rx_loop_lock);
+    *stats = rx_loop_stats;
+    stats->policy = rx_loop_policy;
+    portEXIT_CRITICAL(&rx_loop_lock);
+}
+
+void rx_loop_reset_stats(void) {
+    portENTER_CRITICAL(&rx_loop_lock);
+    rx_loop_account_micros = esp_timer_get_time();
+    rx_loop_stats.switches = 0;
+    for (int m = 0; m < RX_LOOP_MODE_COUNT; m++) {
+        rx_loop_stats.modes[m] = (rx_loop_mode_stats_t){0};
+    }
+    portEXIT_CRITICAL(&rx_loop_lock);
+}
+
+const char* rx_loop_mode_name(rx_loop_mode_t mode) {
+    static const char* const names[RX_LOOP_MODE_COUNT] = { "notify", "poll" };
+    return (mode < RX_LOOP_MODE_COUNT) ? names[mode] : "?";
+}
@@ -0,0 +1,141 @@
+/**
+ * @file RX_loop.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the hybrid interrupt / busy-poll RX loop for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the wait of the RX task between two polls of the active PHY, which switches
+ * between two modes in the manner of the Linux NAPI:
+ * - Notify: the RX task blocks until a backend ISR completes a word. Only the first word after the task armed
+ *   the notification wakes it, so the words that arrive until it polls again are coalesced into one wake-up.
+ * - Poll: once the rate of received words reaches RX_LOOP_POLL_ENTER_WPS, the RX task polls continuously with
+ *   the notification disarmed, blocking for one tick every RX_LOOP_POLL_SLICE_MS. After RX_LOOP_POLL_EXIT_MS
+ *   without a word it goes back to the notify mode.
+ *
+ * For both modes, the latency from a word completing in an ISR to the RX task processing it, the wake-ups, the
+ * polls and the time the RX task ran are counted, so the latency bought by busy-polling can be weighed
+ * against its CPU time. Backends that decode in the RX task (edge, adc) do not notify (rx_notifies); the notify
+ * mode polls them every RX_LOOP_WAIT_MS, and blocks without a timeout for the others.
+ */
+
+#ifndef RX_LOOP_H
+#define RX_LOOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "common_utils/config.h"
+
+/**
+ * @brief Modes of the RX loop.
+ */
+typedef enum {
+    RX_LOOP_NOTIFY,                 /**< Block until a word completes */
+    RX_LOOP_POLL,                   /**< Poll continuously */
+    RX_LOOP_MODE_COUNT,
+} rx_loop_mode_t;
+
+/**
+ * @brief Policies choosing the mode of the RX loop.
+ */
+typedef enum {
+    RX_LOOP_POLICY_AUTO,            /**< Switch on the rate of received words */
+    RX_LOOP_POLICY_NOTIFY,          /**< Stay in the notify mode */
+    RX_LOOP_POLICY_POLL,            /**< Stay in the poll mode */
+} rx_loop_policy_t;
+
+/**
+ * @brief Counters of one mode of the RX loop.
+ */
+typedef struct {
+    uint32_t words;                 /**< Words processed */
+    uint32_t polls;                 /**< Polls of the PHY */
+    uint32_t empty_polls;           /**< Polls that found no word */
+    uint32_t wakeups;               /**< Returns from blocking, on a notification or a timeout */
+    uint32_t latency_count;         /**< Polls with a latency measured */
+    uint32_t latency_max_micros;    /**< Longest time from the first word completing to its poll */
+    uint64_t latency_total_micros;  /**< Sum of the times from the first word completing to its poll */
+    uint64_t elapsed_micros;        /**< Time spent in the mode */
+    uint64_t busy_micros;           /**< Time the RX task ran in the mode */
+} rx_loop_mode_stats_t;
+
+/**
+ * @brief Counters of the RX loop.
+ */
+typedef struct {
+    rx_loop_mode_t mode;                                /**< Current mode */
+    rx_loop_policy_t policy;                            /**< Current policy */
+    uint32_t switches;                                  /**< Mode changes */
+    rx_loop_mode_stats_t modes[RX_LOOP_MODE_COUNT];     /**< Counters of each mode */
+} rx_loop_stats_t;
+
+/**
+ * @brief Wakes the RX task if it waits for a word, and marks the time of the first word since its last poll.
+ * Called by the backend ISRs after pushing a word.
+ *
+ * @note The calling ISR must request a yield on return; the gptimer callbacks of the backends always do.
+ */
+void rx_loop_notify_from_isr(void);
+
+/**
+ * @brief Same as rx_loop_notify_from_isr(), from a task.
+ */
+void rx_loop_notify(void);
+
+/**
+ * @brief Wakes the RX task whatever its mode, so it acts on a change made by another task.
+ */
+void rx_loop_wake(void);
+
+/**
+ * @brief Waits for the next poll of the RX task in the current mode. Called by power_rx_wait() while the RX
+ * side holds its locks.
+ *
+ * @param notify_timeout Longest time to block in the notify mode: portMAX_DELAY for a backend that notifies
+ *                       and nothing else to wait for, pdMS_TO_TICKS(RX_LOOP_WAIT_MS) for one that must be polled.
+ */
+void rx_loop_wait(TickType_t notify_timeout);
+
+/**
+ * @brief Accounts one poll of the PHY, and switches mode if the policy is automatic.
+ *
+ * @param words Number of words the poll returned.
+ */
+void rx_loop_complete(size_t words);
+
+/**
+ * @brief Sets the policy choosing the mode, taking effect at the next poll.
+ *
+ * @param policy New policy.
+ */
+void rx_loop_set_policy(rx_loop_policy_t policy);
+
+/**
+ * @brief Reads the counters.
+ *
+ * @param stats Pointer to store the counters.
+ */
+void rx_loop_get_stats(rx_loop_stats_t* stats);
+
+/**
+ * @brief Clears the counters, keeping the mode and the policy.
+ */
+void rx_loop_reset_stats(void);
+
+/**
+ * @brief Gets the name of a mode.
+ *
+ * @param mode Mode of the RX loop.
+ * @return The name.
+ */
+const char* rx_loop_mode_name(rx_loop_mode_t mode);
+
+#endif /* RX_LOOP_H */
@@ -0,0 +1,81 @@
+/**
+ * @file RX_slicer.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the adaptive slicer of the analog RX front end for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the block-adaptive slicer.
+ */
+
+#include "RX_slicer.h"
+#include <stdlib.h>
+
+void rx_slicer_init(rx_slicer_t* slicer) {
+    slicer->high = 0;
+    slicer->low = 0;
+    slicer->threshold = 0;
+    slicer->mean = -1;
+    slicer->min_swing = RX_SLICER_MIN_SWING;
+    slicer->shift = RX_SLICER_TRACK_SHIFT;
+    slicer->locked = false;
+}
+
+/**
+ * @brief Updates the trackers with one block and computes its threshold.
+ *
+ * @param slicer Pointer to the slicer.
+ * @param samples Samples of the block.
+ * @param count Number of samples, at most RX_SLICER_BLOCK_SAMPLES.
+ */
+static void slicer_track(rx_slicer_t* slicer, const uint16_t* samples, size_t count) {
+    uint16_t max = 0, min = UINT16_MAX;
+    uint32_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        max = samples[i] > max ? samples[i] : max;
+        min = samples[i] < min ? samples[i] : min;
+        sum += samples[i];
+    }
+
+    int32_t mean = (int32_t)(sum / count);
+    if (max - min >= slicer->min_swing) {
+        if (!slicer->locked) {
+            slicer->high = max;
+            slicer->low = min;
+            slicer->locked = true;
+        } else {
+            slicer->high += ((int32_t)max - slicer->high) >> slicer->shift;
+            slicer->low += ((int32_t)min - slicer->low) >> slicer->shift;
+        }
+    } else if (!slicer->locked) {
+        if (slicer->mean >= 0 && abs(mean - slicer->mean) >= slicer->min_swing) {
+            // The edge fell between the two blocks
+            slicer->high = mean > slicer->mean ? mean : slicer->mean;
+            slicer->low = mean > slicer->mean ? slicer->mean : mean;
+            slicer->locked = true;
+        }
+    } else {
+        // One level only: the ambient light moved both of them
+        int32_t* nearer = (mean - slicer->low > slicer->high - mean) ? &slicer->high : &slicer->low;
+        int32_t delta = (mean - *nearer) >> slicer->shift;
+        slicer->high += delta;
+        slicer->low += delta;
+    }
+    slicer->mean = mean;
+    slicer->threshold = slicer->locked ? (slicer->high + slicer->low) / 2 : -1;
+}
+
+void rx_slicer_process(rx_slicer_t* slicer, const uint16_t* samples, size_t count, uint8_t* levels) {
+    for (size_t start = 0; start < count; start += RX_SLICER_BLOCK_SAMPLES) {
+        size_t block = (count - start < RX_SLICER_BLOCK_SAMPLES) ? count - start : RX_SLICER_BLOCK_SAMPLES;
+        const uint16_t* in = samples + start;
+        uint8_t* out = levels + start;
+        slicer_track(slicer, in, block);
+        int32_t threshold = slicer->threshold;
+        for (size_t i = 0; i < block; i++) {
+            out[i] = (uint8_t)((int32_t)in[i] > threshold);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * @file RX_slicer.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the adaptive slicer of the analog RX front end for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the slicer turning ADC samples of the photodiode into line levels. Ambient light
+ * moves both levels of the signal together, so a fixed threshold fails; the slicer instead tracks the level seen
+ * with the LED on and the level seen with the LED off, and slices halfway between them.
+ *
+ * Samples are processed in blocks of RX_SLICER_BLOCK_SAMPLES sharing one threshold:
+ * - a block whose peak-to-peak swing reaches the minimum swing carries both levels, and its maximum and minimum
+ *   pull the two trackers;
+ * - a flatter block only carries one level, and its mean moves the nearer tracker and the other one by the same
+ *   amount, which removes the ambient offset while the line idles. Before both levels are known, two flat
+ *   blocks whose means differ by the minimum swing also reveal them, as when an edge falls between blocks.
+ *
+ * The threshold only changes between blocks, so the loops within a block have no dependency between samples:
+ * a reduction for the extremes and the mean, then one comparison per sample. Compilers vectorise them, and the
+ * function has no dependency on the ESP-IDF drivers, so the same code runs on DMA buffers and in the link simulator.
+ */
+
+#ifndef RX_SLICER_H
+#define RX_SLICER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "common_utils/config.h"
+
+/**
+ * @brief State of the slicer.
+ */
+typedef struct {
+    int32_t high;           /**< Tracked level with the LED on, in ADC counts */
+    int32_t low;            /**< Tracked level with the LED off, in ADC counts */
+    int32_t threshold;      /**< Threshold of the last block */
+    int32_t mean;           /**< Mean of the last block, -1 before the first one */
+    uint16_t min_swing;     /**< Smallest swing of a block carrying both levels */
+    uint8_t shift;          /**< Time constant of the trackers, as a power of two of blocks */
+    bool locked;            /**< Both levels have been seen */
+} rx_slicer_t;
+
+/**
+ * @brief Initialises the slicer with the settings of config.h.
+ *
+ * @param slicer Pointer to the slicer.
+ */
+void rx_slicer_init(rx_slicer_t* slicer);
+
+/**
+ * @brief Slices ADC samples into line levels.
+ *
+ * Until both levels have been seen, every sample is sliced as the idle high level.
+ *
+ * @param slicer Pointer to the slicer.
+ * @param samples ADC samples.
+ * @param count Number of samples.
+ * @param levels Array to store one level (0 or 1) per sample.
+ */
+void rx_slicer_process(rx_slicer_t* slicer, const uint16_t* samples, size_t count, uint8_t* levels);
+
+#endif /* RX_SLICER_H */
@@ -0,0 +1,130 @@
+/**
+ * @file RX_sync.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the sync-word frame synchronizer for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the initialisation of the synchronizer, the replay of traces through it
+ * and the synthesis of ideal sync-word frame traces.
+ */
+
+#include "RX_sync.h"
+
+/**
+ * @brief External definition for rx_sync_reset function.
+ *
+ * This external definition is provided to satisfy the linker in case
+ * the function is not inlined at all call sites.
+ */
+extern inline void rx_sync_reset(rx_sync_decoder_t* decoder);
+
+/**
+ * @brief External definition for rx_sync_sample function.
+ *
+ * This external definition is provided to satisfy the linker in case
+ * the function is not inlined at all call sites.
+ */
+extern inline rx_sync_status_t rx_sync_sample(rx_sync_decoder_t* decoder, uint32_t level);
+
+/**
+ * @brief Reads one sample from a packed trace.
+ *
+ * @param samples Packed samples.
+ * @param index Index of the sample.
+ * @return The sampled level (0 or 1).
+ */
+static inline uint32_t trace_sample(const uint32_t* samples, uint32_t index) {
+    return (samples[index >> 5] >> (index & 31)) & 0x1;
+}
+
+/**
+ * @brief Writes one bit period of a packed trace.
+ *
+ * @param samples Zeroed packed samples.
+ * @param index Pointer to the index of the first sample, advanced past the bit.
+ * @param oversampling Number of samples per bit period.
+ * @param level Level to write (0 or 1).
+ */
+static void trace_bit(uint32_t* samples, uint32_t* index, uint16_t oversampling, uint32_t level) {
+    for (uint16_t i = 0; i < oversampling; i++, (*index)++) {
+        if (level) {
+            samples[*index >> 5] |= (1UL << (*index & 31));
+        }
+    }
+}
+
+void rx_sync_init(rx_sync_decoder_t* decoder, const rx_sync_config_t* config, uint8_t oversampling) {
+    uint8_t bits = (config->bits == 0 || config->bits > 64) ? 64 : config->bits;
+    decoder->mask = (bits == 64) ? ~0ULL : ((1ULL << bits) - 1);
+    decoder->pattern = config->pattern & decoder->mask;
+    decoder->tolerance = config->tolerance;
+    decoder->oversampling = (oversampling == 0) ? 1 : (oversampling > RX_SYNC_MAX_OVERSAMPLING ? RX_SYNC_MAX_OVERSAMPLING : oversampling);
+    decoder->phase = 0;
+    rx_sync_reset(decoder);
+}
+
+void rx_sync_default_config(rx_sync_config_t* config) {
+    config->pattern = RX_SYNC_PATTERN;
+    config->bits = RX_SYNC_PATTERN_BITS;
+    config->tolerance = RX_SYNC_TOLERANCE;
+}
+
+size_t rx_sync_replay(const uint32_t* samples, uint32_t sample_count, uint16_t oversampling,
+                      const rx_sync_config_t* config, uint32_t* words, size_t max_words, rx_sync_stats_t* stats) {
+    rx_sync_decoder_t decoder;
+    size_t word_count = 0;
+    rx_sync_init(&decoder, config, (uint8_t)oversampling);
+
+    for (uint32_t i = 0; i < sample_count && word_count < max_words; i++) {
+        rx_sync_status_t status = rx_sync_sample(&decoder, trace_sample(samples, i));
+        if (__builtin_expect(status == RX_SYNC_BUSY, 1)) {
+            continue;
+        }
+        if (status == RX_SYNC_WORD || status == RX_SYNC_FRAME_END) {
+            words[word_count++] = decoder.word;
+            if (stats != NULL) {
+                stats->last_word_sample = i;
+            }
+        } else if (stats != NULL) {
+            if (status == RX_SYNC_LOCKED) stats->syncs++;
+            else stats->length_errors++;
+        }
+    }
+    return word_count;
+}
+
+uint32_t rx_sync_trace_samples(size_t word_count, uint16_t oversampling, const rx_sync_config_t* config) {
+    return (uint32_t)(2 * RX_DECODER_SYNTH_IDLE_BITS + config->bits + (word_count + 1) * RX_DECODER_WORD_BITS) * oversampling;
+}
+
+uint32_t rx_sync_synthesize(const uint32_t* words, size_t word_count, uint16_t oversampling,
+                            const rx_sync_config_t* config, uint32_t* samples, uint32_t max_samples) {
+    uint32_t total = rx_sync_trace_samples(word_count, oversampling, config);
+    if (total > max_samples || word_count == 0 || word_count > 0xFFFF) {
+        return 0;
+    }
+
+    uint32_t index = 0;
+    for (int bit = 0; bit < RX_DECODER_SYNTH_IDLE_BITS; bit++) {
+        trace_bit(samples, &index, oversampling, 1);
+    }
+    for (int bit = config->bits - 1; bit >= 0; bit--) {
+        trace_bit(samples, &index, oversampling, (config->pattern >> bit) & 0x1);
+    }
+    uint32_t length = RX_SYNC_LENGTH_WORD(word_count);
+    for (int bit = 0; bit < RX_DECODER_WORD_BITS; bit++) {
+        trace_bit(samples, &index, oversampling, (length >> bit) & 0x1);
+    }
+    for (size_t w = 0; w < word_count; w++) {
+        for (int bit = 0; bit < RX_DECODER_WORD_BITS; bit++) {
+            trace_bit(samples, &index, oversampling, (words[w] >> bit) & 0x1);
+        }
+    }
+    for (int bit = 0; bit < RX_DECODER_SYNTH_IDLE_BITS; bit++) {
+        trace_bit(samples, &index, oversampling, 1);
+    }
+    return total;
+}
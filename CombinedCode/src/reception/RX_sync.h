@@ -0,0 +1,277 @@
+/**
+ * @file RX_sync.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the sync-word frame synchronizer for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the sync-word framing mode. Instead of one start bit per word, a frame is sent
+ * as a continuous NRZ bit stream:
+ * - the sync pattern, most significant bit first;
+ * - a length word, holding the number of words in bits 0..15 and its complement in bits 16..31;
+ * - the words, 32 bits each, least significant bit first;
+ * then the line returns to its idle high level.
+ *
+ * The receiver samples the line oversampling times per bit and keeps, for every sample phase, the last
+ * 64 bits in a shift register. The pattern is detected when the number of differing bits, computed with
+ * one XOR and one popcount, is within the tolerance, so a few corrupted sync bits do not lose the frame.
+ * The phases matching in a row are centred on to pick the sampling phase for the rest of the frame.
+ * As the stream has no start bits, the phase is then nudged by one sample whenever a data transition
+ * is seen away from the expected bit boundary, so the receiver follows the transmitter clock. From three
+ * samples per bit, data bits and transitions are taken from the majority of the last three samples, so a
+ * single corrupted sample neither flips a bit nor moves the phase.
+ *
+ * Like the RX decoder, the synchronizer has no dependency on the ESP-IDF drivers, so the same code runs
+ * in the sampling ISR, on captured traces and in the link simulator.
+ */
+
+#ifndef RX_SYNC_H
+#define RX_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "common_utils/config.h"
+#include "reception/RX_decoder.h"
+
+/** @brief Maximum number of samples per bit handled by the synchronizer. */
+#define RX_SYNC_MAX_OVERSAMPLING 16
+
+/**
+ * @brief Sync pattern and matching tolerance.
+ */
+typedef struct {
+    uint64_t pattern;       /**< Sync pattern, right-aligned, sent most significant bit first */
+    uint8_t bits;           /**< Length of the pattern, 1 to 64 */
+    uint8_t tolerance;      /**< Maximum number of differing bits accepted as a match */
+} rx_sync_config_t;
+
+/**
+ * @brief States of the synchronizer.
+ */
+typedef enum {
+    RX_SYNC_HUNT,       /**< Looking for the sync pattern */
+    RX_SYNC_CONFIRM,    /**< Pattern found, measuring how many phases match */
+    RX_SYNC_LENGTH,     /**< Receiving the length word */
+    RX_SYNC_DATA,       /**< Receiving the words of the frame */
+} rx_sync_state_t;
+
+/**
+ * @brief Result of feeding one sample to the synchronizer.
+ */
+typedef enum {
+    RX_SYNC_BUSY,           /**< Nothing to report */
+    RX_SYNC_LOCKED,         /**< Sync pattern detected and sampling phase chosen */
+    RX_SYNC_WORD,           /**< A word is available in the word field */
+    RX_SYNC_FRAME_END,      /**< The last word of the frame is available in the word field */
+    RX_SYNC_LENGTH_ERROR,   /**< The length word is invalid, the frame is dropped */
+} rx_sync_status_t;
+
+/**
+ * @brief State of the synchronizer.
+ */
+typedef struct {
+    uint64_t shift[RX_SYNC_MAX_OVERSAMPLING];   /**< Last bits seen at every sample phase */
+    uint64_t pattern;                           /**< Sync pattern */
+    uint64_t mask;                              /**< Mask of the pattern bits */
+    uint8_t tolerance;                          /**< Maximum number of differing bits */
+    uint8_t oversampling;                       /**< Samples per bit */
+    uint8_t phase;                              /**< Phase of the next sample */
+    uint8_t state;                              /**< An rx_sync_state_t */
+    uint8_t run;                                /**< Phases matching in a row while confirming */
+    uint8_t countdown;                          /**< Samples left until the next data sample */
+    uint8_t bit;                                /**< Bits of value received so far */
+    uint8_t last;                               /**< Previous filtered level */
+    uint8_t history;                            /**< Last three samples, newest in bit 0 */
+    uint16_t words_left;                        /**< Words of the frame still to receive */
+    uint32_t value;                             /**< Bits of the word being received */
+    uint32_t word;                              /**< Last word received */
+} rx_sync_decoder_t;
+
+/**
+ * @brief Counters of the synchronizer.
+ */
+typedef struct {
+    uint32_t syncs;             /**< Sync patterns detected */
+    uint32_t length_errors;     /**< Frames dropped because of an invalid length word */
+    uint32_t last_word_sample;  /**< Sample that completed the last decoded word, set by rx_sync_replay */
+} rx_sync_stats_t;
+
+/**
+ * @brief Initialises the synchronizer.
+ *
+ * @param decoder Pointer to the synchronizer.
+ * @param config Sync pattern and tolerance.
+ * @param oversampling Samples per bit, 1 to RX_SYNC_MAX_OVERSAMPLING.
+ */
+void rx_sync_init(rx_sync_decoder_t* decoder, const rx_sync_config_t* config, uint8_t oversampling);
+
+/**
+ * @brief Gets the configuration set in config.h.
+ *
+ * @param config Pointer to store the configuration.
+ */
+void rx_sync_default_config(rx_sync_config_t* config);
+
+/**
+ * @brief Forgets the bits seen so far and goes back to hunting.
+ *
+ * @param decoder Pointer to the synchronizer.
+ * @note Inline where the compiler chooses to; the external definition in RX_sync.c is in IRAM, so the function
+ *       can be used from the reception ISRs either way.
+ */
+inline void IRAM_ATTR rx_sync_reset(rx_sync_decoder_t* decoder);
+
+/**
+ * @brief Feeds one sample to the synchronizer.
+ *
+ * @param decoder Pointer to the synchronizer.
+ * @param level Sampled level, only bit 0 is used.
+ * @return What happened on this sample.
+ * @note Inline where the compiler chooses to; the external definition in RX_sync.c is in IRAM, so the function
+ *       can be used from the reception ISRs either way.
+ */
+inline rx_sync_status_t IRAM_ATTR rx_sync_sample(rx_sync_decoder_t* decoder, uint32_t level);
+
+/** @brief Builds the length word of a frame of word_count words. */
+#define RX_SYNC_LENGTH_WORD(word_count) ((uint32_t)(uint16_t)(word_count) | ((uint32_t)(uint16_t)~(uint16_t)(word_count) << 16))
+
+/**
+ * @brief Decodes an oversampled trace of sync-word frames.
+ *
+ * @param samples Packed samples, sample n being bit (n % 32) of word (n / 32).
+ * @param sample_count Number of samples in the trace.
+ * @param oversampling Number of samples per bit period.
+ * @param config Sync pattern and tolerance.
+ * @param words Array to store the words of every frame, one after the other.
+ * @param max_words Size of the words array.
+ * @param stats Pointer to add the counters to, or NULL.
+ * @return Number of decoded words.
+ */
+size_t rx_sync_replay(const uint32_t* samples, uint32_t sample_count, uint16_t oversampling,
+                      const rx_sync_config_t* config, uint32_t* words, size_t max_words, rx_sync_stats_t* stats);
+
+/**
+ * @brief Gets the number of samples of an ideal trace of one sync-word frame.
+ *
+ * @param word_count Number of words of the frame.
+ * @param oversampling Number of samples per bit period.
+ * @param config Sync pattern.
+ * @return Number of samples.
+ */
+uint32_t rx_sync_trace_samples(size_t word_count, uint16_t oversampling, const rx_sync_config_t* config);
+
+/**
+ * @brief Builds an ideal oversampled trace of one sync-word frame.
+ *
+ * The frame is surrounded by RX_DECODER_SYNTH_IDLE_BITS idle bits on both sides.
+ *
+ * @param words Words of the frame.
+ * @param word_count Number of words, at most 65535.
+ * @param oversampling Number of samples per bit period.
+ * @param config Sync pattern.
+ * @param samples Zeroed array to store the packed samples.
+ * @param max_samples Capacity of the samples array in samples.
+ * @return Number of samples written, 0 if the trace does not fit.
+ */
+uint32_t rx_sync_synthesize(const uint32_t* words, size_t word_count, uint16_t oversampling,
+                            const rx_sync_config_t* config, uint32_t* samples, uint32_t max_samples);
+
+// Function definitions
+
+inline void rx_sync_reset(rx_sync_decoder_t* decoder) {
+    for (int i = 0; i < decoder->oversampling; i++) {
+        decoder->shift[i] = ~0ULL; // The line idles high
+    }
+    decoder->state = RX_SYNC_HUNT;
+    decoder->run = 0;
+    decoder->history = 0x7;
+}
+
+inline rx_sync_status_t rx_sync_sample(rx_sync_decoder_t* decoder, uint32_t level) {
+    uint8_t phase = decoder->phase;
+    decoder->phase = (phase + 1 == decoder->oversampling) ? 0 : phase + 1;
+    level &= 0x1;
+
+    decoder->history = (uint8_t)(((decoder->history << 1) | level) & 0x7);
+
+    if (__builtin_expect(decoder->state >= RX_SYNC_LENGTH, 0)) {
+        uint8_t countdown = decoder->countdown - 1;
+        if (decoder->oversampling >= 3) {
+            level = (0xE8 >> decoder->history) & 0x1; // Majority of three, one sample late
+        }
+        if (level != decoder->last && decoder->oversampling >= 3) {
+            // Transitions belong halfway between two data samples
+            uint8_t boundary = decoder->oversampling / 2;
+            if (countdown > boundary) countdown--;
+            else if (countdown < boundary) countdown++;
+        }
+        decoder->last = (uint8_t)level;
+        decoder->countdown = countdown;
+        if (countdown != 0) {
+            return RX_SYNC_BUSY;
+        }
+        decoder->countdown = decoder->oversampling;
+        decoder->value |= (level << decoder->bit);
+        if (++decoder->bit != RX_DECODER_WORD_BITS) {
+            return RX_SYNC_BUSY;
+        }
+        decoder->bit = 0;
+        uint32_t value = decoder->value;
+        decoder->value = 0;
+        if (decoder->state == RX_SYNC_LENGTH) {
+            uint16_t count = (uint16_t)(value & 0xFFFF);
+            if (count == 0 || value != RX_SYNC_LENGTH_WORD(count)) {
+                rx_sync_reset(decoder);
+                return RX_SYNC_LENGTH_ERROR;
+            }
+            decoder->words_left = count;
+            decoder->state = RX_SYNC_DATA;
+            return RX_SYNC_BUSY;
+        }
+        decoder->word = value;
+        if (--decoder->words_left != 0) {
+            return RX_SYNC_WORD;
+        }
+        rx_sync_reset(decoder);
+        return RX_SYNC_FRAME_END;
+    }
+
+    // Bit-parallel correlation: one shift, one XOR and one popcount per sample
+    uint64_t shift = (decoder->shift[phase] << 1) | level;
+    decoder->shift[phase] = shift;
+    bool match = __builtin_popcountll((shift ^ decoder->pattern) & decoder->mask) <= decoder->tolerance;
+
+    if (decoder->state == RX_SYNC_HUNT) {
+        if (match) {
+            decoder->state = RX_SYNC_CONFIRM;
+            decoder->run = 1;
+            if (decoder->oversampling > 1) {
+                return RX_SYNC_BUSY;
+            }
+        } else {
+            return RX_SYNC_BUSY;
+        }
+    } else if (match && ++decoder->run < decoder->oversampling) {
+        return RX_SYNC_BUSY;
+    }
+
+    // Lock on the middle of the matching phases: samples since then, minus one bit period ahead
+    uint8_t run = decoder->run;
+    uint8_t elapsed = match ? run - 1 : run;
+    decoder->countdown = decoder->oversampling - (elapsed - (run - 1) / 2);
+    if (decoder->oversampling >= 3) {
+        decoder->countdown++; // The majority filter delays the level by one sample
+        level = (0xE8 >> decoder->history) & 0x1;
+    }
+    decoder->state = RX_SYNC_LENGTH;
+    decoder->last = (uint8_t)level;
+    decoder->bit = 0;
+    decoder->value = 0;
+    return RX_SYNC_LOCKED;
+}
+
+#endif /* RX_SYNC_H */
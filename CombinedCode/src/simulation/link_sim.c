@@ -0,0 +1,458 @@
+/**
+ * @file link_sim.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the VLC link simulator for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the link simulator and of the parameter grid
+ * explored by the parameter sweep. The simulator uses the same key generator and RX decoder as the
+ * firmware, and a private pseudo-random generator so that results only depend on the seed.
+ */
+
+#include "link_sim.h"
+
+/** @brief Bit periods explored by the sweep, in microseconds. */
+static const uint32_t grid_periods[] = {5, 10, 20, 40};
+
+/** @brief Sample inversion probabilities explored by the sweep, in parts per million. */
+static const uint32_t grid_noise[] = {0, 100, 1000, 10000};
+
+/** @brief RX clock errors explored by the sweep, in parts per million. */
+static const int32_t grid_drift[] = {-1000, 0, 5000, 20000};
+
+/** @brief Chaotic maps explored by the sweep. */
+static const map_type_t grid_maps[] = {MAP_DUFFING, MAP_LOGISTIC, MAP_2D_LOGISTIC};
+
+/** @brief Framing modes explored by the sweep. */
+static const link_sim_framing_t grid_framing[] = {LINK_SIM_FRAMING_WORD, LINK_SIM_FRAMING_SYNC};
+
+/** @brief Receivers explored by the sweep. */
+static const struct {
+    link_sim_front_end_t front_end; /**< Receiver front end */
+    uint8_t branches;               /**< Photodiode inputs */
+    rx_diversity_mode_t mode;       /**< Combining of the inputs */
+} grid_receivers[] = {
+    {LINK_SIM_FRONT_END_GPIO, 1, RX_DIVERSITY_OFF},
+    {LINK_SIM_FRONT_END_GPIO, 2, RX_DIVERSITY_SELECT},
+    {LINK_SIM_FRONT_END_GPIO, 3, RX_DIVERSITY_MAJORITY},
+    {LINK_SIM_FRONT_END_ADC, 1, RX_DIVERSITY_OFF},
+};
+
+/** @brief LED models explored by the sweep. */
+static const link_sim_led_t grid_led[] = {LINK_SIM_LED_IDEAL, LINK_SIM_LED_LOWPASS, LINK_SIM_LED_PRE_EMPHASIS};
+
+/** @brief Number of elements of a static array. */
+#define GRID_LEN(array) (sizeof(array) / sizeof((array)[0]))
+
+/** @brief Resolution of the simulated pre-emphasis, in ticks per bit period. */
+#define SIM_SHAPING_TICKS (LINK_SIM_OVERSAMPLING * 128)
+
+/** @brief Number of sampling phases per bit tried by the eye-opening measurement. */
+#define SIM_EYE_PHASES 32
+
+/**
+ * @brief Light emitted by the simulated LED, walked forward in time.
+ */
+typedef struct {
+    const uint32_t* tx;     /**< Transmitted trace */
+    uint32_t count;         /**< Number of samples in the trace */
+    tx_shaping_t shaping;   /**< Pre-emphasis table, in ticks of SIM_SHAPING_TICKS per bit */
+    float rise;             /**< Time constant of the LED turning on, in samples, 0 for an ideal LED */
+    float fall;             /**< Time constant of the LED turning off, in samples, 0 for an ideal LED */
+    uint32_t boundary;      /**< Next bit boundary to look at for an edge */
+    double next_edge;       /**< Time of the next edge, in samples */
+    uint32_t input;         /**< Drive level */
+    float output;           /**< Light, from 0 (off) to 1 (on) */
+    double time;            /**< Time of output, in samples */
+    double step;            /**< Last time step, in samples */
+    float decay_rise;       /**< Decay towards on over the last step */
+    float decay_fall;       /**< Decay towards off over the last step */
+} sim_led_t;
+
+/**
+ * @brief Generates the next pseudo-random number (xorshift64*).
+ *
+ * @param state Pointer to the generator state, never zero.
+ * @return uint32_t A pseudo-random number.
+ */
+static inline uint32_t sim_random(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (uint32_t)((*state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/**
+ * @brief Generates a pseudo-random double in [0.1, 0.9], valid for every supported map.
+ *
+ * @param state Pointer to the generator state.
+ * @return double A pseudo-random initial condition.
+ */
+static double sim_random_condition(uint64_t* state) {
+    return 0.1 + 0.8 * ((double)sim_random(state) / 4294967296.0);
+}
+
+/**
+ * @brief Generates an approximately normal pseudo-random number (sum of four uniforms).
+ *
+ * @param state Pointer to the generator state.
+ * @return double A number with zero mean and unit variance.
+ */
+static double sim_random_normal(uint64_t* state) {
+    double sum = 0.0;
+    for (int i = 0; i < 4; i++) {
+        sum += (double)sim_random(state) / 4294967296.0;
+    }
+    return (sum - 2.0) * 1.7320508075688772; // sqrt(12 / 4)
+}
+
+/**
+ * @brief Reads one sample from a packed trace.
+ *
+ * @param samples Packed samples.
+ * @param index Index of the sample.
+ * @return The sampled level (0 or 1).
+ */
+static inline uint32_t sim_sample(const uint32_t* samples, uint32_t index) {
+    return (samples[index >> 5] >> (index & 31)) & 0x1;
+}
+
+/**
+ * @brief Reads one bit of a transmitted trace, the line being idle high outside of it.
+ *
+ * @param led Pointer to the LED.
+ * @param k Index of the bit.
+ * @return The level (0 or 1).
+ */
+static inline uint32_t sim_led_bit(const sim_led_t* led, int64_t k) {
+    int64_t index = k * LINK_SIM_OVERSAMPLING;
+    return (index >= 0 && index < led->count) ? sim_sample(led->tx, (uint32_t)index) : 1;
+}
+
+/**
+ * @brief Finds the next edge of the drive level, shifted by the pre-emphasis table.
+ *
+ * @param led Pointer to the LED.
+ */
+static void sim_led_find_edge(sim_led_t* led) {
+    uint32_t last = led->count / LINK_SIM_OVERSAMPLING + 1;
+    for (; led->boundary <= last; led->boundary++) {
+        int64_t k = led->boundary;
+        uint32_t prev = sim_led_bit(led, k - 1), cur = sim_led_bit(led, k);
+        if (prev != cur) {
+            int32_t offset = tx_shaping_offset(&led->shaping, sim_led_bit(led, k - 2), prev, cur);
+            led->next_edge = (double)k * LINK_SIM_OVERSAMPLING + (double)offset * LINK_SIM_OVERSAMPLING / SIM_SHAPING_TICKS;
+            led->boundary++;
+            return;
+        }
+    }
+    led->next_edge = INFINITY;
+}
+
+/**
+ * @brief Sets up the LED of a link, idle and fully on at time 0.
+ *
+ * @param led Pointer to the LED.
+ * @param params Parameters of the link.
+ * @param tx Transmitted trace.
+ * @param count Number of samples in the trace.
+ */
+static void sim_led_init(sim_led_t* led, const link_sim_params_t* params, const uint32_t* tx, uint32_t count) {
+    tx_shaping_led_t model;
+    tx_shaping_default_led(&model);
+    tx_shaping_build(&led->shaping, params->bit_period_micros, SIM_SHAPING_TICKS, &model, params->led == LINK_SIM_LED_PRE_EMPHASIS);
+
+    float sample_ns = (float)params->bit_period_micros * 1000.0f / LINK_SIM_OVERSAMPLING;
+    bool ideal = (params->led == LINK_SIM_LED_IDEAL);
+    led->tx = tx;
+    led->count = count;
+    led->rise = ideal ? 0.0f : (float)model.rise_ns / sample_ns;
+    led->fall = ideal ? 0.0f : (float)model.fall_ns / sample_ns;
+    led->boundary = 1;
+    led->input = 1;
+    led->output = 1.0f;
+    led->time = 0.0;
+    led->step = -1.0;
+    sim_led_find_edge(led);
+}
+
+/**
+ * @brief Moves the light forward with a constant drive level.
+ *
+ * @param led Pointer to the LED.
+ * @param time New time, in samples, not before the current one.
+ */
+static void sim_led_advance(sim_led_t* led, double time) {
+    double step = time - led->time;
+    led->time = time;
+    if (led->rise == 0.0f || led->fall == 0.0f) {
+        led->output = (float)led->input;
+        return;
+    }
+    if (step != led->step) {
+        // The step only changes around edges, so the exponentials are rarely recomputed
+        led->step = step;
+        led->decay_rise = expf(-(float)step / led->rise);
+        led->decay_fall = expf(-(float)step / led->fall);
+    }
+    float target = (float)led->input;
+    led->output = target + (led->output - target) * (led->input ? led->decay_rise : led->decay_fall);
+}
+
+/**
+ * @brief Gets the light of the LED.
+ *
+ * @param led Pointer to the LED.
+ * @param time Time in samples, not before the time of the previous call.
+ * @return The light, from 0 (off) to 1 (on).
+ */
+static float sim_led_light(sim_led_t* led, double time) {
+    while (led->next_edge <= time) {
+        sim_led_advance(led, led->next_edge);
+        led->input ^= 1;
+        sim_led_find_edge(led);
+    }
+    sim_led_advance(led, time);
+    return led->output;
+}
+
+/**
+ * @brief Measures the eye of the light, without noise or clock error.
+ *
+ * The light is sampled once per bit at SIM_EYE_PHASES phases. At every phase, the eye height is the smallest
+ * light of a one minus the largest light of a zero, and the phase is open if slicing at half of the swing gets
+ * every bit right.
+ *
+ * @param params Parameters of the link.
+ * @param tx Transmitted trace.
+ * @param count Number of samples in the trace.
+ * @param result Pointer to store the eye height at the best phase and the fraction of open phases.
+ */
+static void sim_eye(const link_sim_params_t* params, const uint32_t* tx, uint32_t count, link_sim_result_t* result) {
+    uint32_t bits = count / LINK_SIM_OVERSAMPLING;
+    uint32_t open = 0;
+    result->eye_height = -1.0;
+    for (uint32_t phase = 0; phase < SIM_EYE_PHASES; phase++) {
+        sim_led_t led;
+        float ones = 1.0f, zeros = 0.0f;
+        sim_led_init(&led, params, tx, count);
+        for (uint32_t k = 0; k < bits; k++) {
+            float light = sim_led_light(&led, ((double)k + (phase + 0.5) / SIM_EYE_PHASES) * LINK_SIM_OVERSAMPLING);
+            if (sim_led_bit(&led, k)) {
+                ones = light < ones ? light : ones;
+            } else {
+                zeros = light > zeros ? light : zeros;
+            }
+        }
+        result->eye_height = (ones - zeros > result->eye_height) ? ones - zeros : result->eye_height;
+        open += (ones > 0.5f && zeros < 0.5f);
+    }
+    result->eye_width = (double)open / SIM_EYE_PHASES;
+}
+
+/**
+ * @brief Passes a trace through the channel.
+ *
+ * Passes the transmitted trace through the LED, then resamples the light with the RX clock error and slices it
+ * at half of the swing. Every branch inverts samples with the noise probability independently of the others,
+ * and the branches are combined as on the receiver.
+ *
+ * @param params Parameters of the link.
+ * @param state Pointer to the generator state.
+ * @param tx Transmitted trace.
+ * @param rx Zeroed array to store the received trace.
+ * @param count Number of samples in both traces.
+ */
+static void sim_channel(const link_sim_params_t* params, uint64_t* state, const uint32_t* tx, uint32_t* rx, uint32_t count) {
+    rx_diversity_t diversity;
+    sim_led_t led;
+    rx_diversity_init(&diversity, params->branches, params->diversity);
+    sim_led_init(&led, params, tx, count);
+    for (uint32_t j = 0; j < count; j++) {
+        uint64_t source = ((uint64_t)j * (uint64_t)(1000000 + params->drift_ppm)) / 1000000;
+        uint32_t level = sim_led_light(&led, (double)source) > 0.5f;
+        uint32_t levels = 0;
+        for (uint8_t b = 0; b < diversity.branches; b++) {
+            uint32_t branch_level = level;
+            if (params->noise_ppm != 0 && (sim_random(state) % 1000000) < params->noise_ppm) {
+                branch_level ^= 1;
+            }
+            levels |= branch_level << b;
+        }
+        rx[j >> 5] |= (rx_diversity_combine(&diversity, levels) << (j & 31));
+    }
+}
+
+/**
+ * @brief Passes a trace through the channel and the analog front end.
+ *
+ * Passes the transmitted trace through the LED, then resamples the light with the RX clock error and turns it
+ * into ADC samples, adding flickering ambient light and Gaussian noise. With the noise probability, a sample
+ * gets the opposite light.
+ * The samples are then sliced block by block, as on the receiver.
+ *
+ * @param params Parameters of the link.
+ * @param state Pointer to the generator state.
+ * @param tx Transmitted trace.
+ * @param rx Zeroed array to store the received trace.
+ * @param count Number of samples in both traces.
+ */
+static void sim_channel_adc(const link_sim_params_t* params, uint64_t* state, const uint32_t* tx, uint32_t* rx, uint32_t count) {
+    uint16_t samples[RX_SLICER_BLOCK_SAMPLES];
+    uint8_t levels[RX_SLICER_BLOCK_SAMPLES];
+    rx_slicer_t slicer;
+    sim_led_t led;
+    rx_slicer_init(&slicer);
+    sim_led_init(&led, params, tx, count);
+    double flicker_step = 2.0 * M_PI * LINK_SIM_ADC_FLICKER_HZ * params->bit_period_micros / (LINK_SIM_OVERSAMPLING * 1000000.0);
+    double flicker_phase = sim_random_condition(state) * 2.0 * M_PI;
+
+    for (uint32_t start = 0; start < count; start += RX_SLICER_BLOCK_SAMPLES) {
+        uint32_t block = (count - start < RX_SLICER_BLOCK_SAMPLES) ? count - start : RX_SLICER_BLOCK_SAMPLES;
+        for (uint32_t i = 0; i < block; i++) {
+            uint32_t j = start + i;
+            uint64_t source = ((uint64_t)j * (uint64_t)(1000000 + params->drift_ppm)) / 1000000;
+            double light = sim_led_light(&led, (double)source);
+            if (params->noise_ppm != 0 && (sim_random(state) % 1000000) < params->noise_ppm) {
+                light = 1.0 - light;
+            }
+            double ambient = LINK_SIM_ADC_AMBIENT * (1.0 + sin(flicker_phase + flicker_step * j)) / 2.0;
+            double value = LINK_SIM_ADC_DARK + ambient + light * LINK_SIM_ADC_SWING + LINK_SIM_ADC_SIGMA * sim_random_normal(state);
+            samples[i] = (uint16_t)(value < 0.0 ? 0.0 : (value > 4095.0 ? 4095.0 : value));
+        }
+        rx_slicer_process(&slicer, samples, block, levels);
+        for (uint32_t i = 0; i < block; i++) {
+            rx[(start + i) >> 5] |= ((uint32_t)levels[i] << ((start + i) & 31));
+        }
+    }
+}
+
+void link_sim_run(const link_sim_params_t* params, link_sim_workspace_t* workspace, link_sim_result_t* result) {
+    uint32_t* plain = workspace->plain;
+    uint32_t* cipher = workspace->cipher;
+    uint32_t* decoded = workspace->decoded;
+    uint32_t* tx_samples = workspace->tx_samples;
+    uint32_t* rx_samples = workspace->rx_samples;
+    uint64_t state = ((uint64_t)params->seed << 1) | 1;
+    uint32_t word_count = params->word_count > LINK_SIM_MAX_WORDS ? LINK_SIM_MAX_WORDS : params->word_count;
+
+    memset(result, 0, sizeof(*result));
+    memset(workspace->tx_samples, 0, sizeof(workspace->tx_samples));
+    memset(workspace->rx_samples, 0, sizeof(workspace->rx_samples));
+
+    // Both ends share the same keys, as after set_encryption on each board
+    msws32_var_t tx_msws32 = {0};
+    msws32_var_t rx_msws32;
+    encryption_vars_t tx_vars = {
+        .type = params->map_type,
+        .chaotic_map1 = { .x = sim_random_condition(&state), .y = sim_random_condition(&state), .iterations = 200 },
+        .chaotic_map2 = { .x = sim_random_condition(&state), .y = sim_random_condition(&state), .iterations = 200 },
+        .msws32_variables = &tx_msws32,
+    };
+    encryption_vars_t rx_vars;
+    key_generator_setup(&tx_vars);
+    key_generator_clone(&rx_vars, &rx_msws32, &tx_vars);
+
+    for (uint32_t i = 0; i < word_count; i++) {
+        plain[i] = sim_random(&state);
+        cipher[i] = plain[i] ^ key_generator(&tx_vars);
+    }
+
+    void (*channel)(const link_sim_params_t*, uint64_t*, const uint32_t*, uint32_t*, uint32_t) =
+        (params->front_end == LINK_SIM_FRONT_END_ADC) ? sim_channel_adc : sim_channel;
+    uint32_t sample_count;
+    uint32_t last_word_sample;
+    size_t decoded_count;
+    rx_decoder_stats_t rejected = {0};
+    if (params->framing == LINK_SIM_FRAMING_SYNC) {
+        rx_sync_config_t sync_config;
+        rx_sync_stats_t sync_stats = {0};
+        rx_sync_default_config(&sync_config);
+        sample_count = rx_sync_synthesize(cipher, word_count, LINK_SIM_OVERSAMPLING, &sync_config, tx_samples, LINK_SIM_MAX_SAMPLES);
+        channel(params, &state, tx_samples, rx_samples, sample_count);
+        decoded_count = rx_sync_replay(rx_samples, sample_count, LINK_SIM_OVERSAMPLING, &sync_config, decoded, LINK_SIM_MAX_WORDS, &sync_stats);
+        rejected.framing_errors = sync_stats.length_errors;
+        last_word_sample = sync_stats.last_word_sample;
+    } else {
+        sample_count = rx_decoder_synthesize(cipher, word_count, LINK_SIM_OVERSAMPLING, tx_samples, LINK_SIM_MAX_SAMPLES);
+        channel(params, &state, tx_samples, rx_samples, sample_count);
+        decoded_count = rx_decoder_replay(rx_samples, sample_count, LINK_SIM_OVERSAMPLING, decoded, LINK_SIM_MAX_WORDS, &rejected);
+        last_word_sample = rejected.last_word_sample;
+    }
+
+    result->bits = word_count * RX_DECODER_WORD_BITS;
+    result->words_decoded = (uint32_t)decoded_count;
+    result->false_starts = rejected.false_starts;
+    result->framing_errors = rejected.framing_errors;
+    for (uint32_t i = 0; i < word_count; i++) {
+        if (i < decoded_count) {
+            uint32_t errors = (decoded[i] ^ key_generator(&rx_vars)) ^ plain[i];
+            result->bit_errors += (uint32_t)__builtin_popcount(errors);
+            result->words_correct += (errors == 0);
+        } else {
+            result->bit_errors += RX_DECODER_WORD_BITS;
+        }
+    }
+
+    double sample_period_us = (double)params->bit_period_micros / LINK_SIM_OVERSAMPLING;
+    double air_time_us = sample_count * sample_period_us;
+    result->ber = result->bits ? (double)result->bit_errors / result->bits : 0.0;
+    result->goodput_bps = air_time_us > 0 ? (result->words_correct * RX_DECODER_WORD_BITS) / (air_time_us / 1000000.0) : 0.0;
+    if (decoded_count > 0) {
+        // Both traces start with RX_DECODER_SYNTH_IDLE_BITS of idle line; RX sample j sees the light of TX sample j * (1 + drift)
+        double rx_time = (last_word_sample + 1) * (1.0 + params->drift_ppm / 1000000.0);
+        result->latency_us = (rx_time - RX_DECODER_SYNTH_IDLE_BITS * LINK_SIM_OVERSAMPLING) * sample_period_us;
+    }
+    sim_eye(params, tx_samples, sample_count, result);
+}
+
+const char* link_sim_led_name(link_sim_led_t led) {
+    switch (led) {
+        case LINK_SIM_LED_LOWPASS: return "lowpass";
+        case LINK_SIM_LED_PRE_EMPHASIS: return "preemph";
+        default: return "ideal";
+    }
+}
+
+void link_sim_print_header(FILE* out) {
+    fprintf(out, "seed,period_us,noise_ppm,drift_ppm,map,framing,front_end,branches,diversity,led,words,words_decoded,words_correct,false_starts,framing_errors,ber,goodput_bps,latency_us,eye_height,eye_width\n");
+}
+
+void link_sim_print_row(FILE* out, const link_sim_params_t* params, const link_sim_result_t* result) {
+    fprintf(out, "%lu,%lu,%lu,%ld,%d,%s,%s,%u,%s,%s,%lu,%lu,%lu,%lu,%lu,%.6f,%.1f,%.1f,%.3f,%.3f\n",
+            (unsigned long)params->seed, (unsigned long)params->bit_period_micros, (unsigned long)params->noise_ppm,
+            (long)params->drift_ppm, (int)params->map_type,
+            params->framing == LINK_SIM_FRAMING_SYNC ? "sync" : "word",
+            params->front_end == LINK_SIM_FRONT_END_ADC ? "adc" : "gpio", (unsigned)params->branches,
+            rx_diversity_mode_name(params->diversity), link_sim_led_name(params->led), (unsigned long)params->word_count,
+            (unsigned long)result->words_decoded, (unsigned long)result->words_correct,
+            (unsigned long)result->false_starts, (unsigned long)result->framing_errors,
+            result->ber, result->goodput_bps, result->latency_us, result->eye_height, result->eye_width);
+}
+
+size_t link_sim_grid_size(uint32_t seeds) {
+    return GRID_LEN(grid_periods) * GRID_LEN(grid_noise) * GRID_LEN(grid_drift) * GRID_LEN(grid_maps) * GRID_LEN(grid_framing) * GRID_LEN(grid_receivers) * GRID_LEN(grid_led) * seeds;
+}
+
+void link_sim_grid_params(size_t index, uint32_t base_seed, uint32_t word_count, link_sim_params_t* params) {
+    params->seed = base_seed + (uint32_t)index;
+    params->word_count = word_count;
+    params->map_type = grid_maps[index % GRID_LEN(grid_maps)];
+    index /= GRID_LEN(grid_maps);
+    params->framing = grid_framing[index % GRID_LEN(grid_framing)];
+    index /= GRID_LEN(grid_framing);
+    params->front_end = grid_receivers[index % GRID_LEN(grid_receivers)].front_end;
+    params->branches = grid_receivers[index % GRID_LEN(grid_receivers)].branches;
+    params->diversity = grid_receivers[index % GRID_LEN(grid_receivers)].mode;
+    index /= GRID_LEN(grid_receivers);
+    params->led = grid_led[index % GRID_LEN(grid_led)];
+    index /= GRID_LEN(grid_led);
+    params->drift_ppm = grid_drift[index % GRID_LEN(grid_drift)];
+    index /= GRID_LEN(grid_drift);
+    params->noise_ppm = grid_noise[index % GRID_LEN(grid_noise)];
+    index /= GRID_LEN(grid_noise);
+    params->bit_period_micros = grid_periods[index % GRID_LEN(grid_periods)];
+}
@@ -0,0 +1,165 @@
+/**
+ * @file link_sim.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the VLC link simulator for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the link simulator, which encrypts random words,
+ * renders them as an oversampled waveform, passes it through the LED, a noisy and drifting channel and
+ * decodes it with the RX decoder. A simulation only depends on its parameters, including the seed,
+ * so every result can be reproduced. The simulator has no ESP-IDF dependency: the sweep runs it on worker
+ * tasks of the board, and the host build (CombinedCode/host) on threads of the development machine.
+ */
+
+#ifndef LINK_SIM_H
+#define LINK_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "common_utils/config.h"
+#include "common_utils/encryption.h"
+#include "reception/RX_decoder.h"
+#include "reception/RX_diversity.h"
+#include "reception/RX_slicer.h"
+#include "reception/RX_sync.h"
+#include "transmission/TX_shaping.h"
+
+/** @brief Number of samples needed for the longest simulated trace with one start bit per word. */
+#define LINK_SIM_MAX_WORD_SAMPLES ((LINK_SIM_MAX_WORDS * (RX_DECODER_SYNTH_IDLE_BITS + 1 + RX_DECODER_WORD_BITS) + RX_DECODER_SYNTH_IDLE_BITS) * LINK_SIM_OVERSAMPLING)
+
+/** @brief Number of samples needed for the longest simulated trace with a sync pattern. */
+#define LINK_SIM_MAX_SYNC_SAMPLES ((2 * RX_DECODER_SYNTH_IDLE_BITS + 64 + (LINK_SIM_MAX_WORDS + 1) * RX_DECODER_WORD_BITS) * LINK_SIM_OVERSAMPLING)
+
+/** @brief Number of samples needed for the longest simulated trace. */
+#define LINK_SIM_MAX_SAMPLES (LINK_SIM_MAX_WORD_SAMPLES > LINK_SIM_MAX_SYNC_SAMPLES ? LINK_SIM_MAX_WORD_SAMPLES : LINK_SIM_MAX_SYNC_SAMPLES)
+
+/**
+ * @brief Framing modes of a simulated link.
+ */
+typedef enum {
+    LINK_SIM_FRAMING_WORD,  /**< One start bit per word, edge-triggered receiver */
+    LINK_SIM_FRAMING_SYNC,  /**< One sync pattern per frame, correlating receiver */
+} link_sim_framing_t;
+
+/**
+ * @brief Receiver front ends of a simulated link.
+ */
+typedef enum {
+    LINK_SIM_FRONT_END_GPIO,    /**< Digital input with a fixed threshold, no ambient light */
+    LINK_SIM_FRONT_END_ADC,     /**< ADC samples with flickering ambient light, adaptive slicer */
+} link_sim_front_end_t;
+
+/**
+ * @brief LED models of a simulated link.
+ */
+typedef enum {
+    LINK_SIM_LED_IDEAL,         /**< The light follows the drive level at once */
+    LINK_SIM_LED_LOWPASS,       /**< First-order response with the time constants of TX_SHAPING_LED_RISE_NS and TX_SHAPING_LED_FALL_NS */
+    LINK_SIM_LED_PRE_EMPHASIS,  /**< Same response, with the edges moved by the pre-emphasis table of TX_shaping.h */
+} link_sim_led_t;
+
+/**
+ * @brief Parameters of one simulated link.
+ */
+typedef struct {
+    uint32_t bit_period_micros;     /**< Bit period, the equivalent of TX_PERIOD_MICROS */
+    uint32_t noise_ppm;             /**< Probability of a sample being inverted, in parts per million */
+    int32_t drift_ppm;              /**< RX clock error relative to TX, in parts per million */
+    map_type_t map_type;            /**< Chaotic map used by the cipher */
+    link_sim_framing_t framing;     /**< Framing mode */
+    link_sim_front_end_t front_end; /**< Receiver front end */
+    uint8_t branches;               /**< GPIO photodiode inputs with independent noise, 1 to RX_DIVERSITY_MAX_BRANCHES */
+    rx_diversity_mode_t diversity;  /**< Combining of the branches */
+    link_sim_led_t led;             /**< LED model */
+    uint32_t word_count;            /**< Number of words sent, at most LINK_SIM_MAX_WORDS */
+    uint32_t seed;                  /**< Seed of the data, keys and noise */
+} link_sim_params_t;
+
+/**
+ * @brief Results of one simulated link.
+ */
+typedef struct {
+    uint32_t bits;           /**< Payload bits sent */
+    uint32_t bit_errors;     /**< Payload bits wrong or lost after decryption */
+    uint32_t words_decoded;  /**< Words produced by the decoder */
+    uint32_t words_correct;  /**< Words decoded at the right position and decrypted correctly */
+    uint32_t false_starts;   /**< Start edges rejected by the decoder */
+    uint32_t framing_errors; /**< Words rejected by the decoder at the stop bit */
+    double ber;              /**< Bit error rate */
+    double goodput_bps;      /**< Correct payload bits per second of air time */
+    double latency_us;       /**< Time from the first bit on air until the decoder completed the last word it decoded, 0 if none */
+    double eye_height;       /**< Smallest light of a one minus largest light of a zero at the best phase, as a fraction of the swing */
+    double eye_width;        /**< Fraction of the bit period where slicing the light at half of the swing gets every bit right */
+} link_sim_result_t;
+
+/**
+ * @brief Buffers of one simulation, about 5 KB, allocated on the heap by the caller and reused across runs.
+ */
+typedef struct {
+    uint32_t plain[LINK_SIM_MAX_WORDS];                 /**< Words sent */
+    uint32_t cipher[LINK_SIM_MAX_WORDS];                /**< Words sent, encrypted */
+    uint32_t decoded[LINK_SIM_MAX_WORDS];               /**< Words decoded, still encrypted */
+    uint32_t tx_samples[(LINK_SIM_MAX_SAMPLES + 31) / 32]; /**< Packed transmitted trace */
+    uint32_t rx_samples[(LINK_SIM_MAX_SAMPLES + 31) / 32]; /**< Packed received trace */
+} link_sim_workspace_t;
+
+/**
+ * @brief Runs one simulated link.
+ *
+ * @param params Parameters of the link.
+ * @param workspace Buffers of the simulation, their content on entry does not matter.
+ * @param result Pointer to store the results.
+ */
+void link_sim_run(const link_sim_params_t* params, link_sim_workspace_t* workspace, link_sim_result_t* result);
+
+/**
+ * @brief Prints the header of the sweep CSV.
+ *
+ * @param out Stream to print to.
+ */
+void link_sim_print_header(FILE* out);
+
+/**
+ * @brief Prints one simulation as a row of the sweep CSV.
+ *
+ * @param out Stream to print to.
+ * @param params Parameters of the link.
+ * @param result Results of the link.
+ */
+void link_sim_print_row(FILE* out, const link_sim_params_t* params, const link_sim_result_t* result);
+
+/**
+ * @brief Gets the name of an LED model.
+ *
+ * @param led LED model.
+ * @return Name of the model, as printed in the sweep CSV.
+ */
+const char* link_sim_led_name(link_sim_led_t led);
+
+/**
+ * @brief Gets the number of simulations in the parameter sweep grid.
+ *
+ * @param seeds Number of seeds simulated for each combination of parameters.
+ * @return Number of simulations.
+ */
+size_t link_sim_grid_size(uint32_t seeds);
+
+/**
+ * @brief Gets the parameters of one simulation of the sweep grid.
+ *
+ * @param index Index of the simulation, below link_sim_grid_size().
+ * @param base_seed Seed of the first simulation, the others use consecutive seeds.
+ * @param word_count Number of words sent by each simulation.
+ * @param params Pointer to store the parameters.
+ */
+void link_sim_grid_params(size_t index, uint32_t base_seed, uint32_t word_count, link_sim_params_t* params);
+
+#endif /* LINK_SIM_H */
@@ -0,0 +1,203 @@
+/**
+ * @file sim_sweep.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the parallel parameter sweep of the link simulator for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the implementation of the parameter sweep. Workers share an atomic
+ * index into the simulation grid and each claims the next simulation as soon as it is free. The workers of
+ * the link scaling benchmark each stand for one link and run their own transfers.
+ */
+
+#include "sim_sweep.h"
+
+/** @brief Tag for logging sweep messages */
+static const char *SWEEP_TAG = "SWEEP";
+
+/**
+ * @brief State shared by the sweep workers.
+ */
+typedef struct {
+    size_t total;                 /**< Number of simulations in the sweep */
+    size_t next;                  /**< Index of the next unclaimed simulation */
+    uint32_t base_seed;           /**< Seed of the first simulation */
+    uint32_t word_count;          /**< Number of words sent by each simulation */
+    link_sim_result_t* results;   /**< Results, indexed like the grid */
+    uint32_t failed;              /**< Workers that could not allocate their workspace */
+    SemaphoreHandle_t done;       /**< Given by each worker when it exits */
+} sim_sweep_t;
+
+/**
+ * @brief Sweep worker task.
+ *
+ * Allocates the buffers of its simulations on the heap, then claims and runs simulations until the grid is
+ * exhausted. A worker without memory exits at once and leaves the grid to the others.
+ *
+ * @param pvParameters Pointer to the shared sim_sweep_t.
+ */
+static void sim_worker_task(void *pvParameters) {
+    sim_sweep_t* sweep = (sim_sweep_t*)pvParameters;
+    link_sim_workspace_t* workspace = malloc(sizeof(link_sim_workspace_t));
+    size_t index;
+    if (workspace == NULL) {
+        __atomic_fetch_add(&sweep->failed, 1, __ATOMIC_RELAXED);
+    } else {
+        while ((index = __atomic_fetch_add(&sweep->next, 1, __ATOMIC_RELAXED)) < sweep->total) {
+            link_sim_params_t params;
+            link_sim_grid_params(index, sweep->base_seed, sweep->word_count, &params);
+            link_sim_run(&params, workspace, &sweep->results[index]);
+        }
+        free(workspace);
+    }
+    xSemaphoreGive(sweep->done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t sim_sweep_run(uint32_t seeds, uint32_t word_count, uint32_t base_seed, FILE* out) {
+    sim_sweep_t sweep = {
+        .total = link_sim_grid_size(seeds),
+        .next = 0,
+        .base_seed = base_seed,
+        .word_count = word_count,
+        .failed = 0,
+    };
+    sweep.results = calloc(sweep.total, sizeof(link_sim_result_t));
+    sweep.done = xSemaphoreCreateCounting(portNUM_PROCESSORS, 0);
+    if (sweep.results == NULL || sweep.done == NULL) {
+        free(sweep.results);
+        ESP_LOGE(SWEEP_TAG, "Failed to allocate memory for %u simulations", (unsigned)sweep.total);
+        return ESP_ERR_NO_MEM;
+    }
+
+    int64_t start = esp_timer_get_time();
+    int workers = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (xTaskCreatePinnedToCore(sim_worker_task, "SIM Worker", SIM_WORKER_STACK_SIZE, &sweep, 1, NULL, core) == pdPASS) {
+            workers++;
+        }
+    }
+    for (int i = 0; i < workers; i++) {
+        xSemaphoreTake(sweep.done, portMAX_DELAY);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    vSemaphoreDelete(sweep.done);
+
+    if (workers == 0 || sweep.failed == (uint32_t)workers) {
+        free(sweep.results);
+        ESP_LOGE(SWEEP_TAG, "Failed to create sweep workers");
+        return ESP_ERR_NO_MEM;
+    }
+
+    link_sim_print_header(out);
+    for (size_t i = 0; i < sweep.total; i++) {
+        link_sim_params_t params;
+        link_sim_grid_params(i, base_seed, word_count, &params);
+        link_sim_print_row(out, &params, &sweep.results[i]);
+    }
+    fflush(out);
+    free(sweep.results);
+
+    ESP_LOGI(SWEEP_TAG, "%u simulations on %d workers in %lld ms", (unsigned)sweep.total, workers, (long long)(elapsed / 1000));
+    return ESP_OK;
+}
+
+/**
+ * @brief State of one simulated link of the scaling benchmark.
+ */
+typedef struct {
+    uint32_t rounds;              /**< Number of transfers to simulate */
+    uint32_t word_count;          /**< Number of words of each transfer */
+    uint32_t seed;                /**< Seed of the first transfer */
+    uint64_t bits_correct;        /**< Payload bits decoded correctly */
+    uint64_t bit_errors;          /**< Payload bits wrong or lost */
+    link_sim_workspace_t* workspace; /**< Buffers of the transfers, on the heap */
+    SemaphoreHandle_t done;       /**< Given when the link is done, shared by all links */
+} sim_link_t;
+
+/**
+ * @brief Simulated link task.
+ *
+ * @param pvParameters Pointer to the sim_link_t.
+ */
+static void sim_link_task(void *pvParameters) {
+    sim_link_t* link = (sim_link_t*)pvParameters;
+    for (uint32_t r = 0; r < link->rounds; r++) {
+        link_sim_params_t params;
+        link_sim_result_t result;
+        link_sim_grid_params(0, link->seed + r, link->word_count, &params);
+        link_sim_run(&params, link->workspace, &result);
+        link->bits_correct += (uint64_t)result.words_correct * 32;
+        link->bit_errors += result.bit_errors;
+    }
+    xSemaphoreGive(link->done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t sim_sweep_links(uint32_t max_links, uint32_t rounds, uint32_t word_count, uint32_t base_seed, FILE* out) {
+    if (max_links == 0 || max_links > SIM_SWEEP_MAX_LINKS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_link_t* links = calloc(max_links, sizeof(sim_link_t));
+    link_sim_workspace_t* workspaces = malloc(max_links * sizeof(link_sim_workspace_t));
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(max_links, 0);
+    if (links == NULL || workspaces == NULL || done == NULL) {
+        free(links);
+        free(workspaces);
+        if (done != NULL) {
+            vSemaphoreDelete(done);
+        }
+        ESP_LOGE(SWEEP_TAG, "Failed to allocate memory for %lu links", (unsigned long)max_links);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = ESP_OK;
+    double single_bps = 0;
+    fprintf(out, "links,rounds,words,bits_correct,bit_errors,wall_ms,throughput_bps,speedup\n");
+    for (uint32_t n = 1; n <= max_links && err == ESP_OK; n++) {
+        uint32_t started = 0;
+        int64_t start = esp_timer_get_time();
+        for (uint32_t k = 0; k < n; k++) {
+            links[k] = (sim_link_t) {
+                .rounds = rounds,
+                .word_count = word_count,
+                .seed = base_seed + k * rounds,
+                .workspace = &workspaces[k],
+                .done = done,
+            };
+            if (xTaskCreatePinnedToCore(sim_link_task, "SIM Link", SIM_WORKER_STACK_SIZE, &links[k], 1, NULL, k % portNUM_PROCESSORS) != pdPASS) {
+                err = ESP_ERR_NO_MEM;
+                break;
+            }
+            started++;
+        }
+        for (uint32_t k = 0; k < started; k++) {
+            xSemaphoreTake(done, portMAX_DELAY);
+        }
+        int64_t elapsed = esp_timer_get_time() - start;
+        if (err != ESP_OK) {
+            ESP_LOGE(SWEEP_TAG, "Failed to create the worker of link %lu", (unsigned long)started + 1);
+            break;
+        }
+
+        uint64_t bits_correct = 0, bit_errors = 0;
+        for (uint32_t k = 0; k < n; k++) {
+            bits_correct += links[k].bits_correct;
+            bit_errors += links[k].bit_errors;
+        }
+        double throughput = elapsed > 0 ? bits_correct * 1e6 / (double)elapsed : 0;
+        if (n == 1) {
+            single_bps = throughput;
+        }
+        fprintf(out, "%lu,%lu,%lu,%llu,%llu,%.1f,%.1f,%.2f\n", (unsigned long)n, (unsigned long)rounds,
+                (unsigned long)word_count, (unsigned long long)bits_correct, (unsigned long long)bit_errors,
+                elapsed / 1000.0, throughput, single_bps > 0 ? throughput / single_bps : 0);
+        fflush(out);
+    }
+    vSemaphoreDelete(done);
+    free(workspaces);
+    free(links);
+    return err;
+}
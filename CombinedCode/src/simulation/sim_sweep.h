@@ -0,0 +1,64 @@
+/**
+ * @file sim_sweep.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the parallel parameter sweep of the link simulator for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the declarations of the parameter sweep, which runs every simulation
+ * of the link simulator grid on worker tasks pinned to each core and prints the results as CSV, and of the
+ * link scaling benchmark, which simulates several links at once to see how the throughput grows with them.
+ * The host build runs the same grid and scaling benchmark on the development machine with
+ * host/tools/sim_sweep_host.c, printing the same CSV.
+ */
+
+#ifndef SIM_SWEEP_H
+#define SIM_SWEEP_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "common_utils/config.h"
+#include "simulation/link_sim.h"
+
+/**
+ * @brief Runs the parameter sweep and prints the results as CSV.
+ *
+ * Simulations are handed out one at a time to a worker per core, so faster workers take more of them.
+ * Rows are printed in grid order once all workers are done, so the output only depends on the arguments.
+ *
+ * @param seeds Number of seeds simulated for each combination of parameters.
+ * @param word_count Number of words sent by each simulation.
+ * @param base_seed Seed of the first simulation.
+ * @param out Stream to print the CSV to.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the results could not be allocated.
+ */
+esp_err_t sim_sweep_run(uint32_t seeds, uint32_t word_count, uint32_t base_seed, FILE* out);
+
+/**
+ * @brief Simulates 1 to max_links links at once and prints the throughput of each count as CSV.
+ *
+ * Every link is a worker of its own, pinned to the cores in turn like the extra links of vlc_link.h, and
+ * simulates rounds transfers of the first combination of the sweep grid with seeds of its own. The throughput
+ * is the number of payload bits decoded correctly per second of wall-clock time, the rate the board could
+ * sustain if the CPU were the bottleneck.
+ *
+ * @param max_links Largest number of links, 1 to SIM_SWEEP_MAX_LINKS.
+ * @param rounds Number of transfers simulated by each link.
+ * @param word_count Number of words of each transfer.
+ * @param base_seed Seed of the first transfer.
+ * @param out Stream to print the CSV to.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if max_links is out of range, ESP_ERR_NO_MEM if the workers could
+ *         not be created.
+ */
+esp_err_t sim_sweep_links(uint32_t max_links, uint32_t rounds, uint32_t word_count, uint32_t base_seed, FILE* out);
+
+#endif /* SIM_SWEEP_H */
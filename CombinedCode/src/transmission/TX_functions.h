@@ -1,60 +1,101 @@
-/**
- * @file TX_functions.h
- * @author Ricardo Jorge Dias Sampaio
- * @brief Header file for transmission for the Secure VLC Project.
- * @version 1.0
- * @date 2024-09-03
- * \par License:
- *   \ref mit_license "MIT License".
- * 
- * @details This file contains the declarations of functions and variables used for data transmission,
- * including buffer management, GPIO setup, and timer configuration for the Secure VLC Project.
- */
-
-#ifndef TX_FUNCTIONS_H
-#define TX_FUNCTIONS_H
-
-#include <stdint.h>
-#include <stdbool.h>
-#include <stddef.h>
-#include <string.h>
-#include "esp_log.h"
-#include "driver/dedic_gpio.h"
-#include "driver/gptimer.h"
-#include "driver/gpio.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/queue.h"
-
-#include "common_utils/config.h"
-#include "common_utils/encryption.h"
-#include "common_utils/gpio_direct_RW.h"
-#include "common_utils/ring_buffer.h"
-#include "console/console_commands.h"
-
-/**
- * @brief Structure to store the encryption variables for transmission.
- */
-extern encryption_vars_t TX_encryption_vars;
-
-/**
- * @brief Adds a string to the transmission buffer.
- * 
- * This function takes an input string, processes it in 4-byte chunks,
- * applies encryption, and pushes the resulting values to the ring buffer.
- * 
- * @param input_str The input string to be added to the buffer
- */
-void add_str_to_buffer(const char* input_str);
-
-/**
- * @brief TX control task.
- *
- * This task sets up the GPIO for transmission, initializes the transmission timer,
- * waits for encryption values to be set, and then enters a loop to manage the transmission buffer.
- *
- * @param pvParameters Pointer to task parameters (unused).
- */
-void TX_control_task(void *pvParameters);
-
-#endif /* TX_FUNCTIONS_H */
+/**
+ * @file TX_functions.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for transmission for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ * 
+ * @details This file contains the declarations of functions and variables used for data transmission:
+ * framing and encryption of outgoing strings, handed to the active PHY backend.
+ */
+
+#ifndef TX_FUNCTIONS_H
+#define TX_FUNCTIONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#include "common_utils/boot.h"
+#include "common_utils/config.h"
+#include "common_utils/encryption.h"
+#include "common_utils/frame.h"
+#include "common_utils/power.h"
+#include "common_utils/trace.h"
+#include "console/console_commands.h"
+#include "phy/phy.h"
+
+/**
+ * @brief Structure to store the encryption variables for transmission.
+ */
+extern encryption_vars_t TX_encryption_vars;
+
+/**
+ * @brief Creates the lock of the TX keystream. Called by app_main() before the tasks are created.
+ */
+void tx_keys_init(void);
+
+/**
+ * @brief Takes the lock of the TX keystream.
+ *
+ * submit_str_frame() holds it while it encrypts a frame, so TX_encryption_vars may only be read or replaced by
+ * another task while it is held.
+ */
+void tx_keys_lock(void);
+
+/**
+ * @brief Releases the lock of the TX keystream.
+ */
+void tx_keys_unlock(void);
+
+/**
+ * @brief Copies the TX keystream, in step with the transmitting jobs, without advancing it.
+ *
+ * @param dst Pointer to the encryption_vars_t structure to fill.
+ * @param dst_msws32 Storage for the MSWS32 variables of the copy.
+ */
+void tx_keys_clone(encryption_vars_t* dst, msws32_var_t* dst_msws32);
+
+/**
+ * @brief Submits a string to the active PHY as one frame.
+ * 
+ * This function builds an encrypted frame from the input string, with an
+ * authentication tag when FRAME_AUTH_ENABLE is set, and submits the whole frame
+ * to the active PHY. If the PHY refuses the frame, the keystream is rolled back
+ * so both ends stay in step.
+ * 
+ * @param input_str The input string to send.
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the string does not fit in a frame,
+ *         or the error returned by the PHY.
+ */
+esp_err_t submit_str_frame(const char* input_str);
+
+/**
+ * @brief Adds a string to the transmission buffer.
+ * 
+ * This function submits the string as one frame with submit_str_frame()
+ * and logs why it was dropped, if it was.
+ * 
+ * @param input_str The input string to be added to the buffer
+ */
+void add_str_to_buffer(const char* input_str);
+
+/**
+ * @brief TX control task.
+ *
+ * This task initialises the TX side of every PHY backend, waits for encryption
+ * values to be set, and then enters a loop driving the active PHY.
+ *
+ * @param pvParameters Pointer to task parameters (unused).
+ */
+void TX_control_task(void *pvParameters);
+
+#endif /* TX_FUNCTIONS_H */
@@ -0,0 +1,83 @@
+/**
+ * @file TX_runlength.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of the TX run-length encoder for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the decoder checking the runs and the timing run of the encoder.
+ */
+
+#include "TX_runlength.h"
+
+/**
+ * @brief External definition of the inline function, emitted in this translation unit in case
+ * the function is not inlined at all call sites.
+ */
+extern inline uint8_t tx_runlength_encode(uint32_t word, uint8_t runs[TX_RUNLENGTH_MAX_RUNS]);
+
+uint32_t tx_runlength_decode(const uint8_t* runs, uint8_t count, bool* valid) {
+    uint32_t word = 0;
+    uint32_t position = 0;     // bit period of the word, 0 being the start bit
+    bool ok = (count >= 2) && ((count & 1) == 0);
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t end = position + runs[i];
+        ok = ok && runs[i] > 0 && end <= TX_RUNLENGTH_WORD_BITS;
+        if (ok && (i & 1)) {
+            for (uint32_t p = position; p < end; p++) {
+                if (p >= 1 && p <= RX_DECODER_WORD_BITS) {
+                    word |= 1UL << (p - 1);
+                }
+            }
+        }
+        position = end;
+    }
+    *valid = ok && position == TX_RUNLENGTH_WORD_BITS;
+    return word;
+}
+
+/**
+ * @brief Gets the next pseudo-random word.
+ *
+ * @param state Pointer to the generator state, not 0.
+ * @return The next word.
+ */
+static uint32_t runlength_next_word(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+void tx_runlength_benchmark(uint32_t words, uint32_t seed, uint32_t (*read_cycles)(void), tx_runlength_bench_t* result) {
+    uint8_t runs[TX_RUNLENGTH_MAX_RUNS];
+    uint32_t state = seed ? seed : 1;
+    *result = (tx_runlength_bench_t){ .words = words };
+
+    // Timed pass: encode only
+    uint32_t sink = 0;
+    uint32_t start = read_cycles();
+    for (uint32_t i = 0; i < words; i++) {
+        uint8_t count = tx_runlength_encode(runlength_next_word(&state), runs);
+        sink += count + runs[count - 1];
+    }
+    result->cycles = read_cycles() - start;
+    // Keeps the timed loop from being optimised away
+    __asm__ volatile("" : : "r"(sink));
+
+    // Checked pass: the same words, with the idle patterns first
+    state = seed ? seed : 1;
+    for (uint32_t i = 0; i < words; i++) {
+        uint32_t word = (i == 0) ? 0 : (i == 1) ? UINT32_MAX : runlength_next_word(&state);
+        uint8_t count = tx_runlength_encode(word, runs);
+        bool valid;
+        if (tx_runlength_decode(runs, count, &valid) != word || !valid) {
+            result->mismatches++;
+        }
+        result->runs += count;
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * @file TX_runlength.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for the TX run-length encoder for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the encoder turning a word into the runs of constant level the TX pin goes
+ * through: the start bit, the 32 data bits (least significant first) and the stop bit. Run i has level i % 2,
+ * so the first run is low and holds the start bit, and the last run is high and holds the stop bit. Only the
+ * durations are stored, in bit periods.
+ *
+ * A TX timer alarming at the end of each run instead of every bit period takes one interrupt per edge: from 2
+ * for a word of zeros to TX_RUNLENGTH_MAX_RUNS for alternating bits, against 34 for every word bit by bit.
+ *
+ * The encoder has no dependency on the ESP-IDF drivers, so the same logic runs in the TX ISRs and on a host.
+ */
+
+#ifndef TX_RUNLENGTH_H
+#define TX_RUNLENGTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "common_utils/host_compat.h"
+#include "reception/RX_decoder.h"
+
+/** @brief Number of bit periods in one word on the line: start bit, data bits and stop bit. */
+#define TX_RUNLENGTH_WORD_BITS (RX_DECODER_WORD_BITS + 2)
+
+/** @brief Largest number of runs of one word, every bit differing from the one before. */
+#define TX_RUNLENGTH_MAX_RUNS TX_RUNLENGTH_WORD_BITS
+
+/**
+ * @brief Result of a timing run of the encoder.
+ */
+typedef struct {
+    uint32_t words;             /**< Words encoded */
+    uint32_t runs;              /**< Runs produced, i.e. TX timer interrupts needed */
+    uint32_t mismatches;        /**< Words not decoded back to themselves */
+    uint32_t cycles;            /**< CPU cycles spent encoding, exact while the loop takes under 2^32 cycles */
+} tx_runlength_bench_t;
+
+/**
+ * @brief Splits a word into runs of constant level.
+ *
+ * @param word Word to send.
+ * @param runs Array of TX_RUNLENGTH_MAX_RUNS durations to fill, in bit periods.
+ * @return Number of runs, even and at least 2.
+ * @note Inline where the compiler chooses to; the external definition in TX_runlength.c is in IRAM, so the function
+ *       can be used from the TX ISRs either way.
+ */
+inline uint8_t IRAM_ATTR tx_runlength_encode(uint32_t word, uint8_t runs[TX_RUNLENGTH_MAX_RUNS]);
+
+/**
+ * @brief Rebuilds a word from its runs.
+ *
+ * @param runs Durations of the runs, in bit periods.
+ * @param count Number of runs.
+ * @param valid Pointer to store whether the runs form a word: an even count of non-empty runs spanning
+ *              TX_RUNLENGTH_WORD_BITS periods.
+ * @return The data bits of the word.
+ */
+uint32_t tx_runlength_decode(const uint8_t* runs, uint8_t count, bool* valid);
+
+/**
+ * @brief Encodes pseudo-random words, including the all-zero and all-one ones, and checks them by decoding.
+ *
+ * @param words Number of words.
+ * @param seed Seed of the words, not 0.
+ * @param read_cycles 32-bit cycle counter, called before and after the encoding loop; the difference is taken
+ *                    modulo 2^32, so the counter may wrap once.
+ * @param result Pointer to store the result.
+ */
+void tx_runlength_benchmark(uint32_t words, uint32_t seed, uint32_t (*read_cycles)(void), tx_runlength_bench_t* result);
+
+inline uint8_t tx_runlength_encode(uint32_t word, uint8_t runs[TX_RUNLENGTH_MAX_RUNS]) {
+    uint8_t count = 0;
+    uint32_t level = 0;
+    uint32_t length = 1;                    // start bit
+    uint32_t left = RX_DECODER_WORD_BITS;
+    while (left > 0) {
+        // Bits differing from the current level; only 32-bit scans, a 64-bit one is a library call
+        uint32_t edges = level ? ~word : word;
+        uint32_t same = edges ? (uint32_t)__builtin_ctz(edges) : RX_DECODER_WORD_BITS;
+        if (same >= left) {
+            length += left;
+            break;
+        }
+        runs[count++] = (uint8_t)(length + same);
+        word >>= same;
+        left -= same;
+        level ^= 1;
+        length = 0;
+    }
+    // The stop bit extends a high run or makes one of its own
+    if (level) {
+        length++;
+    } else {
+        runs[count++] = (uint8_t)length;
+        length = 1;
+    }
+    runs[count++] = (uint8_t)length;
+    return count;
+}
+
+#endif /* TX_RUNLENGTH_H */
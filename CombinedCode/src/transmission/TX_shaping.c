@@ -0,0 +1,144 @@
+/**
+ * @file TX_shaping.c
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Implementation of TX pre-emphasis pulse shaping for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the computation of the pre-emphasis table and the rendering of shaped runs.
+ */
+
+#include "TX_shaping.h"
+
+/**
+ * @brief External definition of the inline function, emitted in this translation unit in case
+ * the function is not inlined at all call sites.
+ */
+extern inline int32_t tx_shaping_offset(const tx_shaping_t* shaping, uint32_t prev2, uint32_t prev, uint32_t cur);
+
+void tx_shaping_default_led(tx_shaping_led_t* led) {
+    led->rise_ns = TX_SHAPING_LED_RISE_NS;
+    led->fall_ns = TX_SHAPING_LED_FALL_NS;
+}
+
+/**
+ * @brief Computes how long after an unshaped edge the LED output crosses half of its swing.
+ *
+ * The LED starts from the steady level of prev2, spends one bit period at prev if it differs, then heads for cur.
+ * Earlier edges are taken as unshaped.
+ *
+ * @param period_ns Bit period, in nanoseconds.
+ * @param led LED model.
+ * @param prev2 Bit before prev.
+ * @param prev Bit before the edge.
+ * @param cur Bit after the edge, different from prev.
+ * @return The delay in nanoseconds, 0 if the output is already past half of the swing.
+ */
+static float shaping_crossing_delay(float period_ns, const tx_shaping_led_t* led, uint32_t prev2, uint32_t prev, uint32_t cur) {
+    float level = (float)prev;
+    if (prev2 != prev) {
+        level = prev ? 1.0f - expf(-period_ns / (float)led->rise_ns) : expf(-period_ns / (float)led->fall_ns);
+    }
+    // Distance to the target at the edge, relative to the half swing left to cross
+    float distance = 2.0f * (cur ? 1.0f - level : level);
+    if (distance <= 1.0f) {
+        return 0.0f;
+    }
+    return (float)(cur ? led->rise_ns : led->fall_ns) * logf(distance);
+}
+
+void tx_shaping_build(tx_shaping_t* shaping, uint32_t bit_period_micros, uint32_t bit_ticks, const tx_shaping_led_t* led, bool enabled) {
+    float period_ns = (float)bit_period_micros * 1000.0f;
+    float delays[TX_SHAPING_CONTEXTS] = {0};
+    float min_delay = INFINITY, max_delay = 0.0f;
+
+    shaping->bit_ticks = bit_ticks;
+    shaping->enabled = enabled;
+    for (uint32_t context = 0; context < TX_SHAPING_CONTEXTS; context++) {
+        shaping->offsets[context] = 0;
+        uint32_t prev2 = (context >> 2) & 0x1, prev = (context >> 1) & 0x1, cur = context & 0x1;
+        if (prev != cur && led->rise_ns != 0 && led->fall_ns != 0) {
+            delays[context] = shaping_crossing_delay(period_ns, led, prev2, prev, cur);
+            min_delay = delays[context] < min_delay ? delays[context] : min_delay;
+            max_delay = delays[context] > max_delay ? delays[context] : max_delay;
+        }
+    }
+    if (!enabled || max_delay == 0.0f) {
+        return;
+    }
+
+    // Every edge is moved to the middle delay, which keeps the shifts as small as possible
+    float target = (min_delay + max_delay) / 2.0f;
+    int32_t limit = (int32_t)((bit_ticks - 1) / 2);
+    for (uint32_t context = 0; context < TX_SHAPING_CONTEXTS; context++) {
+        if (((context >> 1) & 0x1) == (context & 0x1)) {
+            continue;
+        }
+        int32_t offset = (int32_t)lroundf((target - delays[context]) * (float)bit_ticks / period_ns);
+        shaping->offsets[context] = offset > limit ? limit : (offset < -limit ? -limit : offset);
+    }
+}
+
+/**
+ * @brief Stores one run, split into halves of at most TX_SHAPING_MAX_RUN ticks.
+ *
+ * @param halves Array of halves.
+ * @param count Number of halves already stored.
+ * @param max_halves Size of the array.
+ * @param level Level of the run.
+ * @param ticks Duration of the run, at least 1.
+ * @return The new number of halves, or 0 if the run does not fit.
+ */
+static size_t shaping_emit(uint16_t* halves, size_t count, size_t max_halves, uint32_t level, int64_t ticks) {
+    while (ticks > 0) {
+        uint32_t chunk = ticks > TX_SHAPING_MAX_RUN ? TX_SHAPING_MAX_RUN : (uint32_t)ticks;
+        if (count == max_halves) {
+            return 0;
+        }
+        halves[count++] = (uint16_t)((level << 15) | chunk);
+        ticks -= chunk;
+    }
+    return count;
+}
+
+size_t tx_shaping_render(const tx_shaping_t* shaping, const uint32_t* bits, uint32_t bit_count, uint16_t* halves, size_t max_halves) {
+    size_t count = 0;
+    int64_t start = 0;
+    uint32_t prev2 = 1, prev = 1;
+
+    // Time 0 is the start of the idle bit before the first one
+    for (uint32_t k = 0; k <= bit_count; k++) {
+        uint32_t cur = (k < bit_count) ? TX_SHAPING_BIT(bits, k) : 1;
+        if (cur != prev) {
+            int64_t edge = (int64_t)(k + 1) * shaping->bit_ticks + tx_shaping_offset(shaping, prev2, prev, cur);
+            count = shaping_emit(halves, count, max_halves, prev, edge - start);
+            if (count == 0) {
+                return 0;
+            }
+            start = edge;
+        }
+        prev2 = prev;
+        prev = cur;
+    }
+    count = shaping_emit(halves, count, max_halves, 1, (int64_t)(bit_count + 2) * shaping->bit_ticks - start);
+    if (count == 0) {
+        return 0;
+    }
+
+    if (count & 0x1) {
+        // Split the final idle run so the halves pair up into symbols
+        uint16_t last = halves[count - 1] & TX_SHAPING_MAX_RUN;
+        if (count == max_halves) {
+            return 0;
+        }
+        if (last >= 2) {
+            halves[count - 1] = (uint16_t)((1 << 15) | (last / 2));
+            halves[count++] = (uint16_t)((1 << 15) | (last - last / 2));
+        } else {
+            halves[count++] = (uint16_t)((1 << 15) | 1);
+        }
+    }
+    return count;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file TX_shaping.h
+ * @author Ricardo Jorge Dias Sampaio
+ * @brief Header file for TX pre-emphasis pulse shaping for the Secure VLC Project.
+ * @version 1.0
+ * @date 2024-09-03
+ * \par License:
+ *   \ref mit_license "MIT License".
+ *
+ * @details This file contains the pre-emphasis applied to the line levels before they reach the LED. The LED
+ * behaves as a low-pass filter whose fall is slower than its rise, so at short bit periods the light crosses the
+ * receiver threshold late after a falling edge, on-pulses come out longer than off-pulses, and a single bit after
+ * a long run may not cross the threshold at all.
+ *
+ * Pre-emphasis moves every edge by an amount looked up in a table indexed by the bit context: the two bits before
+ * the edge and the bit after it. The table is precomputed from a first-order model of the LED for the current bit
+ * period, so that every edge crosses the threshold with the same delay; it shortens on-pulses and lengthens single
+ * bits following a long run. Edges move by less than half a bit, so they never swap.
+ *
+ * The shaped levels are rendered as runs for a timing-capable PHY, in the layout of the halves of an RMT symbol.
+ * The link simulator uses the same table through tx_shaping_offset().
+ */
+
+#ifndef TX_SHAPING_H
+#define TX_SHAPING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "common_utils/config.h"
+
+/** @brief Number of bit contexts of the pre-emphasis table. */
+#define TX_SHAPING_CONTEXTS 8
+
+/** @brief Index in the pre-emphasis table of the edge between prev and cur, prev2 being the bit before prev. */
+#define TX_SHAPING_CONTEXT(prev2, prev, cur) (((prev2) << 2) | ((prev) << 1) | (cur))
+
+/** @brief Longest run of one half of a rendered symbol, in ticks. */
+#define TX_SHAPING_MAX_RUN 0x7FFF
+
+/** @brief Reads bit k of a packed bit array. */
+#define TX_SHAPING_BIT(bits, k) (((bits)[(k) >> 5] >> ((k) & 31)) & 0x1)
+
+/**
+ * @brief First-order model of the LED.
+ */
+typedef struct {
+    uint32_t rise_ns;   /**< Time constant of the LED turning on, in nanoseconds */
+    uint32_t fall_ns;   /**< Time constant of the LED turning off, in nanoseconds */
+} tx_shaping_led_t;
+
+/**
+ * @brief Pre-emphasis table for one bit period.
+ */
+typedef struct {
+    int32_t offsets[TX_SHAPING_CONTEXTS];   /**< Shift of the edge ending each context, in ticks, positive when later */
+    uint32_t bit_ticks;                     /**< Ticks per bit period */
+    bool enabled;                           /**< Pre-emphasis applied, all offsets are 0 otherwise */
+} tx_shaping_t;
+
+/**
+ * @brief Fills an LED model with the settings of config.h.
+ *
+ * @param led Pointer to the model.
+ */
+void tx_shaping_default_led(tx_shaping_led_t* led);
+
+/**
+ * @brief Precomputes the pre-emphasis table for a bit period.
+ *
+ * @param shaping Pointer to the table.
+ * @param bit_period_micros Bit period, in microseconds.
+ * @param bit_ticks Ticks per bit period of the PHY rendering the edges, at least 4.
+ * @param led LED model.
+ * @param enabled true to apply pre-emphasis, false for a table of zeros.
+ */
+void tx_shaping_build(tx_shaping_t* shaping, uint32_t bit_period_micros, uint32_t bit_ticks, const tx_shaping_led_t* led, bool enabled);
+
+/**
+ * @brief Gets the shift of the edge between two bits.
+ *
+ * @param shaping Pointer to the table.
+ * @param prev2 Bit before prev.
+ * @param prev Bit before the edge.
+ * @param cur Bit after the edge.
+ * @return Shift of the edge in ticks, positive when later, 0 if the bits are equal.
+ */
+inline int32_t tx_shaping_offset(const tx_shaping_t* shaping, uint32_t prev2, uint32_t prev, uint32_t cur);
+
+/**
+ * @brief Renders shaped bits as runs of constant level.
+ *
+ * The line is idle high for one bit before and one bit after the bits. Every run is stored as a 16-bit half
+ * of an RMT symbol: the level in bit 15 and the duration in ticks in bits 0 to 14, runs longer than
+ * TX_SHAPING_MAX_RUN being split. An even number of halves is always produced, so they can be sent as symbols.
+ *
+ * @param shaping Pointer to the table.
+ * @param bits Packed bits, bit k being bit k % 32 of word k / 32.
+ * @param bit_count Number of bits.
+ * @param halves Array to store the runs.
+ * @param max_halves Size of the array.
+ * @return Number of halves stored, or 0 if they do not fit.
+ */
+size_t tx_shaping_render(const tx_shaping_t* shaping, const uint32_t* bits, uint32_t bit_count, uint16_t* halves, size_t max_halves);
+
+inline int32_t tx_shaping_offset(const tx_shaping_t* shaping, uint32_t prev2, uint32_t prev, uint32_t cur) {
+    return shaping->offsets[TX_SHAPING_CONTEXT(prev2, prev, cur)];
+}
+
+#endif /* TX_SHAPING_H */